@@ -102,12 +102,12 @@ void VulkanRender::init(GLFWwindow* window){
     // Создаем фреймбуфферы для вьюшек изображений окна
     createWindowFrameBuffers();
     
-    // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
-    createDescriptorsSetLayout();
-    
     // Грузим шейдеры
     loadShaders();
     
+    // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
+    createDescriptorsSetLayout();
+    
     // Создание пайплайна отрисовки
     createGraphicsPipeline();
     
@@ -279,21 +279,12 @@ void VulkanRender::createWindowFrameBuffers(){
 
 // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
 void VulkanRender::createDescriptorsSetLayout(){
-    VulkanDescriptorSetConfig uniformBuffer;
-    uniformBuffer.binding = 0;          // Юниформ буффер биндим на 0 индекс
-    uniformBuffer.desriptorsCount = 1;  // 1н дескриптор
-    uniformBuffer.desriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Тип - юниформ буффер
-    uniformBuffer.descriptorStageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Используется в вершинном шейдере
-    
-    VulkanDescriptorSetConfig sampler;
-    sampler.binding = 1;         // Семплер будет на 1м индексе
-    sampler.desriptorsCount = 1; // 1н дескриптор
-    sampler.desriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // Тип - семплер
-    sampler.descriptorStageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Используется в фраггментном шейдере
-
-    std::vector<VulkanDescriptorSetConfig> configs;
-    configs.push_back(uniformBuffer);
-    configs.push_back(sampler);
+    // Описание берем из рефлексии шейдеров, стадии вершинного и фрагментного шейдера уже объединены
+    if (vulkanShadersReflection.descriptorSets.empty()) {
+        LOG("Shaders have no descriptor sets!\n");
+        throw std::runtime_error("Shaders have no descriptor sets!");
+    }
+    const std::vector<VulkanDescriptorSetConfig>& configs = vulkanShadersReflection.descriptorSets[0];
     
     vulkanDescriptorSetLayout = std::make_shared<VulkanDescriptorSetLayout>(vulkanLogicalDevice, configs);
 }
@@ -304,9 +295,22 @@ void VulkanRender::loadShaders(){
     std::vector<unsigned char> vertShaderCode = readFile("res/shaders/shader_vert.spv");
     std::vector<unsigned char> fragShaderCode = readFile("res/shaders/shader_frag.spv");
     
-    LOG("\nInformation about vertex shader %s\n", "res/shaders/shader_vert.spv");
-    //reflectShaderUsingSPIRVCross(vertShaderCode);
-    reflectShaderUsingSPIRVReflect(vertShaderCode);
+    // Рефлексия для лэйаута дескрипторов, push констант и описания вершин.
+    // Результат кешируется в папке рядом с бинарником, res - ссылка на исходники
+    TIME_BEGIN(SHADERS_REFLECTION);
+    std::vector<std::vector<unsigned char>> modulesCode;
+    modulesCode.push_back(vertShaderCode);
+    modulesCode.push_back(fragShaderCode);
+    bool loadedFromCache = false;
+    vulkanShadersReflection = reflectShaders(modulesCode, "cache", &loadedFromCache);
+    TIME_END_MICROSEC(SHADERS_REFLECTION, loadedFromCache ? "Shaders reflection time (cache)" : "Shaders reflection time");
+    
+    // Подробный вывод только вместе с самой рефлексией, при попадании в кеш шейдер не разбирается
+    if (loadedFromCache == false) {
+        LOG("\nInformation about vertex shader %s\n", "res/shaders/shader_vert.spv");
+        //reflectShaderUsingSPIRVCross(vertShaderCode);
+        reflectShaderUsingSPIRVReflect(vertShaderCode);
+    }
     
     // Создаем шейдерные модули
     vulkanVertexModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, vertShaderCode);
@@ -315,9 +319,13 @@ void VulkanRender::loadShaders(){
 
 // Создание пайплайна отрисовки
 void VulkanRender::createGraphicsPipeline() {
-    // Описание вершин, шага по вершинам и описание данных
-    VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
-    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = Vertex::getAttributeDescriptions();
+    // Описание вершин, шага по вершинам и описание данных из рефлексии вершинного шейдера
+    VkVertexInputBindingDescription bindingDescription = vulkanShadersReflection.vertexBinding;
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = vulkanShadersReflection.vertexAttributes;
+    if (bindingDescription.stride != sizeof(Vertex)) {
+        LOG("Vertex shader input does not match Vertex struct!\n");
+        throw std::runtime_error("Vertex shader input does not match Vertex struct!");
+    }
     
     // Настраиваем вьюпорт
     VkViewport viewport = {};
@@ -354,19 +362,17 @@ void VulkanRender::createGraphicsPipeline() {
     blendConfig.dstFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     
     // Push константы
-    std::vector<VkPushConstantRange> pushConstants;
-    VkPushConstantRange pushConstantRange = {};
-    memset(&pushConstantRange, 0, sizeof(VkPushConstantRange));
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(glm::mat4);
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    pushConstants.push_back(pushConstantRange);
+    std::vector<VkPushConstantRange> pushConstants = vulkanShadersReflection.pushConstantRanges;
     
     // Динамически изменяемые параметры
     std::vector<VkDynamicState> dynamicStates;
     dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
     dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
     
+    // Лэйауты наборов дескрипторов
+    std::vector<VulkanDescriptorSetLayoutPtr> layouts;
+    layouts.push_back(vulkanDescriptorSetLayout);
+    
     // Пайплайн
     vulkanPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
                                                       vulkanVertexModule, vulkanFragmentModule,
@@ -378,7 +384,7 @@ void VulkanRender::createGraphicsPipeline() {
                                                       scissor,
                                                       cullingConfig,
                                                       blendConfig,
-                                                      vulkanDescriptorSetLayout,
+                                                      layouts,
                                                       vulkanRenderPass,
                                                       pushConstants,
                                                       dynamicStates);
@@ -72,6 +72,7 @@ public:
     VulkanImageViewPtr vulkanWindowDepthImageView;
     VulkanRenderPassPtr vulkanRenderPass;
     std::vector<VulkanFrameBufferPtr> vulkanWindowFrameBuffers;
+    VulkanShadersReflectionInfo vulkanShadersReflection;
     VulkanDescriptorSetLayoutPtr vulkanDescriptorSetLayout;
     VulkanShaderModulePtr vulkanVertexModule;
     VulkanShaderModulePtr vulkanFragmentModule;
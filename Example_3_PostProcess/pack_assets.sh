@@ -0,0 +1,16 @@
+#! /usr/bin/env bash
+
+# Сборка шейдеров и моделей в assets.pak, который Example_3 открывает при старте вместо отдельных файлов.
+# Текстуры и материалы .mtl пример читает с диска, в архив они не кладутся
+# Использование: ./pack_assets.sh <путь к AssetPacker> [папка запуска примера с ссылками res и static_res] [--lz4]
+# По умолчанию записи несжатые - пример читает их прямо из мапинга без копии.
+# --lz4 уменьшает архив, но каждая загрузка тогда распаковывает запись в свой буффер
+# Без архива пример читает те же пути отдельными файлами
+
+PACKER=${1:-AssetPacker}
+RUN_DIR=${2:-.}
+COMPRESS=${3:-}
+
+cd "$RUN_DIR"
+
+"$PACKER" -o assets.pak $COMPRESS --ext .spv,.obj res/shaders static_res
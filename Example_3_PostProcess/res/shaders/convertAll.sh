@@ -4,4 +4,6 @@ glslangValidator -V model_shader.vert -o model_shader_vert.spv
 glslangValidator -V model_shader.frag -o model_shader_frag.spv
 
 glslangValidator -V post_shader.vert -o post_shader_vert.spv
-glslangValidator -V post_shader.frag -o post_shader_frag.spv
\ No newline at end of file
+glslangValidator -V post_shader.frag -o post_shader_frag.spv
+glslangValidator -V post_subpass.frag -o post_subpass_frag.spv
+glslangValidator -V mip_downsample.comp -o mip_downsample_comp.spv
\ No newline at end of file
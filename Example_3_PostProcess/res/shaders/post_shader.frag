@@ -6,15 +6,42 @@ layout(location = 0) in vec2 fragTexCoord;
 // Uniforms
 layout(binding = 0) uniform sampler2D texSampler;
 
+// Specialization constants
+layout(constant_id = 0) const bool SPECIALIZED = false;  // false - режимы берутся из push констант и ветвятся в рантайме
+layout(constant_id = 1) const int TONE_MAP_MODE = 0;     // 0 - нет, 1 - Reinhard, 2 - экспонента
+layout(constant_id = 2) const int BLUR_RADIUS = 0;       // Радиус размытия в текселях
+
 // Push const
 layout(push_constant) uniform PushConsts {
 	float coeff;
+	int toneMapMode;
+	int blurRadius;
 } pushConsts;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord)*vec4(pushConsts.coeff, 0.8, 0.9, 1.0);
+    int toneMapMode = SPECIALIZED ? TONE_MAP_MODE : pushConsts.toneMapMode;
+    int blurRadius = SPECIALIZED ? BLUR_RADIUS : pushConsts.blurRadius;
+    
+    // Размытие, количество итераций известно при компиляции только у специализированного варианта
+    vec2 texelSize = 1.0 / vec2(textureSize(texSampler, 0));
+    vec4 color = vec4(0.0);
+    for (int x = -blurRadius; x <= blurRadius; x++) {
+        for (int y = -blurRadius; y <= blurRadius; y++) {
+            color += texture(texSampler, fragTexCoord + vec2(x, y) * texelSize);
+        }
+    }
+    color /= float((blurRadius * 2 + 1) * (blurRadius * 2 + 1));
+    
+    // Тонмаппинг
+    if (toneMapMode == 1) {
+        color.rgb = color.rgb / (color.rgb + vec3(1.0));
+    } else if (toneMapMode == 2) {
+        color.rgb = vec3(1.0) - exp(-color.rgb * 2.0);
+    }
+    
+    outColor = color*vec4(pushConsts.coeff, 0.8, 0.9, 1.0);
     //outColor = vec4(fragTexCoord.x, fragTexCoord.y, 0.0, 0.5);
     //outColor = vec4(fragColor, 1.0);
     //outColor = texture(texSampler, vec2(0.5, 0.5));
@@ -0,0 +1,33 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Результат подпрохода модели, доступен только текущий пиксель - размытия в этом варианте нет
+layout(input_attachment_index = 0, binding = 0) uniform subpassInput sceneColor;
+
+// Specialization constants
+layout(constant_id = 0) const bool SPECIALIZED = false;  // false - режим берется из push констант и ветвится в рантайме
+layout(constant_id = 1) const int TONE_MAP_MODE = 0;     // 0 - нет, 1 - Reinhard, 2 - экспонента
+
+// Push const
+layout(push_constant) uniform PushConsts {
+	float coeff;
+	int toneMapMode;
+	int blurRadius;
+} pushConsts;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    int toneMapMode = SPECIALIZED ? TONE_MAP_MODE : pushConsts.toneMapMode;
+    
+    vec4 color = subpassLoad(sceneColor);
+    
+    // Тонмаппинг
+    if (toneMapMode == 1) {
+        color.rgb = color.rgb / (color.rgb + vec3(1.0));
+    } else if (toneMapMode == 2) {
+        color.rgb = vec3(1.0) - exp(-color.rgb * 2.0);
+    }
+    
+    outColor = color*vec4(pushConsts.coeff, 0.8, 0.9, 1.0);
+}
@@ -2,7 +2,9 @@
 #include <array>
 #include <limits>
 #include <numeric>
+#include <algorithm>
 #include <cmath>
+#include <thread>
 #include <Helpers.h>
 
 // TinyObj
@@ -22,12 +24,50 @@
 
 #define TARGET_FBO_TEXTURE_WIDTH 1024
 #define TARGET_FBO_TEXTURE_HEIGHT 768
+#define ASSET_ARCHIVE_PATH "assets.pak"    // Собирается pack_assets.sh, без него ассеты читаются отдельными файлами
+
+// Push константы пост эффекта, режимы используются только вариантом с ветвлением
+struct PostPushConstants {
+    float coeff;
+    int32_t toneMapMode;
+    int32_t blurRadius;
+};
+
+// Камера модели неподвижна
+static const glm::vec3 MODEL_CAMERA_POSITION(0.0f, 3.0f, 2.0f);
+static const float MODEL_CAMERA_FOV = 45.0f;
 
 static VulkanRender* renderInstance = nullptr;
 
-void VulkanRender::initInstance(GLFWwindow* window){
+// Прежний пайплайн используется, пока новый не скомпилирован
+static void replaceWithReadyPipeline(VulkanPipelinePtr& pipeline, const VulkanPipelineFuture& future){
+    VulkanPipelinePtr readyPipeline = VulkanPipelineCompiler::getIfReady(future);
+    if (readyPipeline) {
+        pipeline = readyPipeline;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderSettings::VulkanRenderSettings():
+    postUseSubpass(false),
+    postToneMapMode(1),
+    postBlurRadius(2),
+    pipelineVariantsCount(1),
+    pipelineCompileAsync(true),
+    streamingTotalSizeMB(0),
+    streamingChunkSizeMB(8),
+    streamingTargetSizeMB(64),
+    textureStreamingBudgetMB(32),
+    printMemoryStats(true){
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VulkanRender::initInstance(GLFWwindow* window, const VulkanRenderSettings& settings){
     if (renderInstance == nullptr) {
         renderInstance = new VulkanRender();
+        renderInstance->settings = settings;
         renderInstance->init(window);
     }
 }
@@ -47,15 +87,40 @@ VulkanRender::VulkanRender(){
     modelTotalVertexesCount = 0;
     modelTotalIndexesCount = 0;
     modelImageIndex = 0;
+    modelRadius = 0.0f;
 	totalTime = 0.0f;
     rotateAngle = 0.0f;
     vulkanImageIndex = 0;
+    firstFrameLogged = false;
+    pipelinesCompiledLogged = false;
+    postUseSpecialized = false;
+    postLastUsedSpecialized = false;
+    postBranchingGPUTime = 0.0;
+    postSpecializedGPUTime = 0.0;
+    postBranchingSamplesCount = 0;
+    postSpecializedSamplesCount = 0;
+    streamingPhaseBytes = 0;
+    streamingTargetOffset = 0;
+    descriptorUpdateTemplateSupported = false;
 }
 
 void VulkanRender::init(GLFWwindow* window){
+    initBeginTime = std::chrono::high_resolution_clock::now();
+    
+    // Один замапленный архив вместо открытия каждого ассета
+    assetArchive = AssetArchive::tryOpen(ASSET_ARCHIVE_PATH);
+    if (assetArchive) {
+        assetArchive->printStats();
+    }else{
+        LOG("Asset archive %s not found, loading loose files\n", ASSET_ARCHIVE_PATH);
+    }
+    
     // Создаем рабочие объекты Vulkan
     createSharedVulkanObjects(window);
     
+    // Описываем проходы кадра, граф создает картинку пост эффекта и глубину
+    createRenderGraph();
+    
     ////////////////////////////////////////////////////////////////////////////////
     
     // Создаем картинки для отрисовки в текстуру
@@ -64,11 +129,17 @@ void VulkanRender::init(GLFWwindow* window){
     // Создаем текстуры для буффера глубины
     createPostDepthResources();
     
-    // Создаем рендер проход
-    createRenderToPostRenderPass();
-    
-    // Создаем фреймбуффер для отрисовки в текстуру
-    createPostFrameBuffer();
+    if (settings.postUseSubpass) {
+        // Один рендер проход в окно, промежуточный цвет остается в памяти тайла
+        createSubpassRenderPass();
+        createSubpassFrameBuffers();
+    }else{
+        // Создаем рендер проход
+        createRenderToPostRenderPass();
+        
+        // Создаем фреймбуффер для отрисовки в текстуру
+        createPostFrameBuffer();
+    }
     
     // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
     createPostDescriptorsSetLayout();
@@ -82,17 +153,16 @@ void VulkanRender::init(GLFWwindow* window){
     // Создание буфферов вершин
     createPostBuffers();
     
-    // Создаем семплер для текстуры
-    postTextureSampler = std::make_shared<VulkanSampler>(vulkanLogicalDevice,
-                                                          VK_FILTER_LINEAR, VK_FILTER_LINEAR,
-                                                          VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-                                                          1);
+    // Семплер для текстуры, картинка выводится на весь экран без искажений - анизотропия не нужна
+    postTextureSampler = vulkanSamplerCache->getSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+                                                        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                                        1, 0, 0.0f, 1.0f);
     
-    // Создаем пул дескрипторов ресурсов
-    createPostRenderDescriptorPool();
+    // Создаем кеш наборов дескрипторов
+    vulkanDescriptorSetCache = std::make_shared<VulkanDescriptorSetCache>(vulkanLogicalDevice);
     
-    // Создаем набор дескрипторов ресурсов
-    createPostRenderDescriptorSet();
+    // Получаем набор дескрипторов ресурсов
+    updatePostRenderDescriptorSet();
     
     ////////////////////////////////////////////////////////////////////////////////
     
@@ -105,17 +175,38 @@ void VulkanRender::init(GLFWwindow* window){
     // Создание пайплайна отрисовки
     createModelGraphicsPipeline();
     
-    // Грузим текстуру
-    modelTextureImage = createTextureImage(vulkanLogicalDevice, vulkanRenderQueue, vulkanRenderCommandPool, "static_res/textures/chalet.jpg");
-    
-    // Вью для текстуры
-    modelTextureImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice, modelTextureImage, VK_IMAGE_ASPECT_COLOR_BIT);
+    // Дополнительные варианты пайплайна, отрисовка их не ждет
+    createModelPipelineVariants();
+    
+    // Грузим текстуру: сначала сжатые варианты с готовыми мипмапами, которые поддерживает устройство, jpeg - запасной вариант
+    std::vector<std::string> texturePaths = {
+        "static_res/textures/chalet_astc.ktx2",
+        "static_res/textures/chalet_bc7.ktx2",
+        "static_res/textures/chalet_bc7.dds",
+        "static_res/textures/chalet_etc2.ktx2",
+        "static_res/textures/chalet.jpg"
+    };
+    uint32_t modelTextureLevelsCount = 0;
+    if (settings.textureStreamingBudgetMB > 0) {
+        // Сначала только хвост мипмапов, старшие уровни подгружаются по мере надобности
+        textureStreamer = std::make_shared<VulkanTextureStreamer>(vulkanLogicalDevice, vulkanRenderQueue, (VkDeviceSize)settings.textureStreamingBudgetMB * 1024 * 1024);
+        VulkanTextureData textureData = loadTextureDataFromCandidates(vulkanPhysicalDevice->getDevice(), texturePaths);
+        modelStreamedTexture = textureStreamer->addTexture(textureData);
+        modelTextureImage = modelStreamedTexture->getImage();
+        modelTextureImageView = modelStreamedTexture->getImageView();
+        modelTextureLevelsCount = modelStreamedTexture->getLevelsCount();
+    }else{
+        modelTextureImage = createTextureImageFromCandidates(vulkanLogicalDevice, vulkanRenderQueue, vulkanRenderCommandPool, texturePaths);
+        
+        // Вью для текстуры
+        modelTextureImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice, modelTextureImage, VK_IMAGE_ASPECT_COLOR_BIT);
+        modelTextureLevelsCount = modelTextureImage->getBaseMipmapsCount();
+    }
     
-    // Создаем семплер для текстуры
-    modelTextureSampler = std::make_shared<VulkanSampler>(vulkanLogicalDevice,
-                                                          VK_FILTER_LINEAR, VK_FILTER_LINEAR,
-                                                          VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-                                                          modelTextureImage->getBaseMipmapsCount());
+    // Семплер из кеша с анизотропией, при стриминге - на полную цепочку, у картинки просто меньше уровней
+    modelTextureSampler = vulkanSamplerCache->getSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+                                                         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                                         modelTextureLevelsCount);
     
     // Грузим данные для модели
     loadModelSrcData();
@@ -126,11 +217,13 @@ void VulkanRender::init(GLFWwindow* window){
     // Создаем буффер юниформов
     createModelUniformBuffer();
     
-    // Создаем пул дескрипторов ресурсов
-    createModelDescriptorPool();
+    // Получаем набор дескрипторов ресурсов
+    updateModelDescriptorSet();
     
-    // Создаем набор дескрипторов ресурсов
-    createModelDescriptorSet();
+    // Замер потоковой загрузки только по запросу: сначала через выделенную очередь копирования, затем через очередь отрисовки
+    if (settings.streamingTotalSizeMB > 0) {
+        createStreamingResources();
+    }
     
     //////////////////////////////
     
@@ -139,6 +232,11 @@ void VulkanRender::init(GLFWwindow* window){
     
     // Создаем фреймбуфферы для вьюшек изображений окна
     createWindowFrameBuffers();
+    
+    // Синхронный вариант - первый кадр ждет все пайплайны
+    if (settings.pipelineCompileAsync == false) {
+        vulkanPipelineCompiler->waitAll();
+    }
 }
 
 // Ресайз окна
@@ -163,20 +261,22 @@ void VulkanRender::rebuildRendering(){
 	vulkanSwapchain = nullptr;
 	vulkanSwapchain = newVulkanSwapchain;
     
-    // Создаем текстуры для буффера глубины
-    createPostDepthResources();
+    // Картинки графа в режиме с отдельным проходом не зависят от размера окна - не пересоздаем
+    if (settings.postUseSubpass) {
+        // Промежуточные картинки размером с окно
+        addRenderGraphImages();
+        renderGraph->allocate(vulkanLogicalDevice);
+        createPostImageAndView();
+        createPostDepthResources();
+        createSubpassFrameBuffers();
+    }
     
     // Создаем фреймбуфферы для вьюшек изображений окна
     createWindowFrameBuffers();
     
-    // Создание пайплайна отрисовки
-	createPostGraphicsPipeline();
+    // Пайплайны не зависят от размера окна - вьюпорт динамический
 
-	// Создаем пул дескрипторов ресурсов
-	createPostRenderDescriptorPool();
-    
-    // Создаем набор дескрипторов ресурсов
-	createPostRenderDescriptorSet();
+    // Набор дескрипторов не пересоздаем, картинка и семплер не изменились - он останется в кеше
     
     // Создаем коммандные буфферы отрисовки модели
     resetCommandBuffers();
@@ -198,7 +298,7 @@ void VulkanRender::printGPUStats(){
         for (uint32_t i = 0; i < validBitscount; i++){
             maskValue |= 1 << i;
         }
-        LOG("Timestamp infos (period %f, bitsCount %d): \n", period, validBitscount);
+        LOG("Timestamp infos (period %f, bitsCount %d, post effect %s): \n", period, validBitscount, settings.postUseSubpass ? "subpass" : "separate render pass");
         
         std::vector<uint64_t> testResults = vulkanTimeStampQueryPool->getPoolTimeStampResults();
         for (size_t i = 0; i < testResults.size(); i += 2) {
@@ -208,8 +308,54 @@ void VulkanRender::printGPUStats(){
             LOG("-> %d-%d: %.0f microSec\n", (int)i, (int)i + 1, microsecondsValue);
         }
         
+        // Время пост эффекта (таймстампы 2-3) накапливаем для варианта, которым был нарисован последний кадр
+        if ((testResults.size() >= 4) && postPipeline) {
+            double postMicroseconds = (((testResults[3] & maskValue) - (testResults[2] & maskValue)) * period) / 1000.0;
+            if (postLastUsedSpecialized) {
+                postSpecializedGPUTime += postMicroseconds;
+                postSpecializedSamplesCount++;
+            }else{
+                postBranchingGPUTime += postMicroseconds;
+                postBranchingSamplesCount++;
+            }
+            LOG("Post effect GPU time: branching %.1f microSec (%d samples), specialized %.1f microSec (%d samples)\n",
+                postBranchingGPUTime / std::max(postBranchingSamplesCount, 1u), postBranchingSamplesCount,
+                postSpecializedGPUTime / std::max(postSpecializedSamplesCount, 1u), postSpecializedSamplesCount);
+            
+            // Следующий замер делаем другим вариантом
+            postUseSpecialized = !postUseSpecialized;
+        }
+        
         LOG("\n");
     }
+    
+    if (vulkanDescriptorSetCache) {
+        vulkanDescriptorSetCache->printStats();
+    }
+    if (vulkanLayoutCache) {
+        vulkanLayoutCache->printStats();
+    }
+    if (vulkanSamplerCache) {
+        vulkanSamplerCache->printStats();
+    }
+    if (assetArchive) {
+        assetArchive->printStats();
+    }
+    if (settings.printMemoryStats) {
+        vulkanLogicalDevice->getMemoryStats()->printStats();
+    }
+    if (vulkanPipelineVariantCache) {
+        vulkanPipelineVariantCache->printStats();
+    }
+    if (streamingActiveRing) {
+        streamingActiveRing->printStats();
+    }
+    if (textureStreamer) {
+        textureStreamer->printStats();
+    }
+    if (renderGraph) {
+        renderGraph->printStats();
+    }
 }
 
 // Создаем рабочие объекты Vulkan
@@ -226,11 +372,23 @@ void VulkanRender::createSharedVulkanObjects(GLFWwindow* window){
     vulkanDeviceExtensions.push_back("VK_KHR_swapchain");
     vulkanPhysicalDevice = std::make_shared<VulkanPhysicalDevice>(vulkanInstance, vulkanDeviceExtensions, vulkanInstanceValidationLayers, vulkanWindowSurface);
     
+    // Шаблоны обновления дескрипторов - только если есть, без них наборы обновляются обычным путем
+    descriptorUpdateTemplateSupported = vulkanPhysicalDevice->isExtensionSupported("VK_KHR_descriptor_update_template");
+    if (descriptorUpdateTemplateSupported) {
+        vulkanDeviceExtensions.push_back("VK_KHR_descriptor_update_template");
+    }
+    
+    // Бюджет памяти от драйвера - только если есть, устройство без него не отбрасываем
+    if (VulkanMemoryStats::isBudgetSupported(vulkanPhysicalDevice)) {
+        vulkanDeviceExtensions.push_back(VulkanMemoryStats::getBudgetExtensionName());
+    }
+    
     // Создаем логическое устройство
     VulkanQueuesFamiliesIndexes vulkanQueuesFamiliesIndexes = vulkanPhysicalDevice->getQueuesFamiliesIndexes(); // Получаем индексы семейств очередей для дальнейшего использования
     VulkanSwapChainSupportDetails vulkanSwapchainSuppportDetails = vulkanPhysicalDevice->getSwapChainSupportDetails();    // Получаем возможности свопчейна
     std::vector<float> renderPriorities = {0.5f};
     VkPhysicalDeviceFeatures logicalDeviceFeatures = {};
+    logicalDeviceFeatures.samplerAnisotropy = vulkanPhysicalDevice->getPossibleDeviceFeatures().samplerAnisotropy;  // Анизотропия, если есть
     vulkanLogicalDevice = std::make_shared<VulkanLogicalDevice>(vulkanPhysicalDevice,
                                                                 vulkanQueuesFamiliesIndexes,
                                                                 0.5f,
@@ -265,6 +423,18 @@ void VulkanRender::createSharedVulkanObjects(GLFWwindow* window){
     // Создание рендер прохода
     createRenderToWindowsRenderPass();
     
+    // Кеш лэйаутов дескрипторов и пайплайнов
+    vulkanLayoutCache = std::make_shared<VulkanLayoutCache>(vulkanLogicalDevice);
+    
+    // Кеш семплеров, одинаковые семплеры общие для всех текстур
+    vulkanSamplerCache = std::make_shared<VulkanSamplerCache>(vulkanLogicalDevice);
+    
+    // Фоновая компиляция пайплайнов с общим кешем
+    vulkanPipelineCompiler = std::make_shared<VulkanPipelineCompiler>(vulkanLogicalDevice);
+    
+    // Кеш пайплайнов по описанию состояния
+    vulkanPipelineVariantCache = std::make_shared<VulkanPipelineVariantCache>(vulkanLogicalDevice, vulkanPipelineCompiler->getPipelineCache());
+    
     // Создание пула запроса статистики
     createQueryPool();
 }
@@ -275,8 +445,8 @@ void VulkanRender::createRenderToWindowsRenderPass(){
     imageConfig.format = vulkanSwapchain->getSwapChainImageFormat();
     imageConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;   // Чистим цвет
     imageConfig.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Сохраняем для отрисовки
-    imageConfig.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageConfig.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    imageConfig.initLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;  // Переходы в лаяуты делает граф
+    imageConfig.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     imageConfig.refLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     vulkanRenderToWindowRenderPass = std::make_shared<VulkanRenderPass>(vulkanLogicalDevice, imageConfig);
 }
@@ -287,7 +457,7 @@ void VulkanRender::createQueryPool(){
     if (vulkanPhysicalDevice->getDeviceProperties().limits.timestampComputeAndGraphics &&
         (vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits > 0)) {
         VulkanQueryPoolTimeStamp config;
-        config.testCount = 1 * 2;
+        config.testCount = 2 * 2;   // Весь кадр + пост эффект
         vulkanTimeStampQueryPool = std::make_shared<VulkanQueryPool>(vulkanLogicalDevice, config);
     }
 }
@@ -296,16 +466,8 @@ void VulkanRender::createQueryPool(){
 
 // Создаем картинки для отрисовки в текстуру
 void VulkanRender::createPostImageAndView(){
-    // Изображение
-    postImage = std::make_shared<VulkanImage>(vulkanLogicalDevice,
-                                              //vulkanSwapchain->getSwapChainExtent().width, vulkanSwapchain->getSwapChainExtent().height,
-                                              VkExtent2D{TARGET_FBO_TEXTURE_WIDTH, TARGET_FBO_TEXTURE_HEIGHT},
-                                              VK_FORMAT_R8G8B8A8_UNORM,
-                                              VK_IMAGE_TILING_OPTIMAL,
-                                              VK_IMAGE_LAYOUT_UNDEFINED,
-                                              VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                              1);
+    // Изображение создано графом
+    postImage = renderGraph->getImage("post");
     
     //  Вьюшка
     postImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice, postImage, VK_IMAGE_ASPECT_COLOR_BIT);
@@ -313,52 +475,13 @@ void VulkanRender::createPostImageAndView(){
 
 // Создаем буфферы для глубины
 void VulkanRender::createPostDepthResources() {
-    // Определяем подходящий формат изображения для глубины
-    std::vector<VkFormat> candidates = {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT};
-    VkFormat vulkanDepthFormat = findSupportedFormat(vulkanPhysicalDevice->getDevice(),
-                                                     candidates,
-                                                     VK_IMAGE_TILING_OPTIMAL,
-                                                     VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-    
-    // Создаем изображение для глубины
-    uint32_t width = TARGET_FBO_TEXTURE_WIDTH;
-    uint32_t height = TARGET_FBO_TEXTURE_HEIGHT;
-    postDepthImage = std::make_shared<VulkanImage>(vulkanLogicalDevice,
-                                                   VkExtent2D{width, height}, // Размеры
-                                                   vulkanDepthFormat,           // Формат текстуры
-                                                   VK_IMAGE_TILING_OPTIMAL,     // Оптимальный тайлинг
-                                                   VK_IMAGE_LAYOUT_UNDEFINED,   // Лаяут начальной текстуры (must be VK_IMAGE_LAYOUT_UNDEFINED or VK_IMAGE_LAYOUT_PREINITIALIZED)
-                                                   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, // Использоваться будет в качестве аттачмента глубины
-                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,   // Хранится только на GPU
-                                                   1);                          // 1 уровень мипмапов
+    // Изображение создано графом, лаяут глубины граф выставит перед первым проходом
+    postDepthImage = renderGraph->getImage("depth");
     
     // Создаем вью для изображения буффера глубины
     postDepthImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice,
                                                                  postDepthImage,
                                                                  VK_IMAGE_ASPECT_DEPTH_BIT);  // Используем как глубину
-    
-    // Обновляем лаяут текстуры глубины на правильный
-    VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(vulkanLogicalDevice, vulkanRenderCommandPool);
-    
-    VkImageAspectFlags aspectMask;
-    aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-    if (hasStencilComponent(postDepthImage->getBaseFormat())) {
-        aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-    }
-    
-    // Конвертируем в формат, пригодный для глубины
-    transitionImageLayout(commandBuffer,
-                          postDepthImage,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                          0, 1,
-                          aspectMask,
-                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                          VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-                          0,
-                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
-    
-    endAndQueueWaitSingleTimeCommands(commandBuffer, vulkanRenderQueue);
 }
 
 // Создание рендер прохода
@@ -367,8 +490,8 @@ void VulkanRender::createRenderToPostRenderPass(){
     imageConfig.format = postImage->getBaseFormat();
     imageConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;   // Чистим цвет
     imageConfig.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Сохраняем для отрисовки
-    imageConfig.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageConfig.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;	// В каком лаяуте будет изображение после завершения рендер прохода
+    imageConfig.initLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;  // Переходы в лаяуты делает граф
+    imageConfig.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     imageConfig.refLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     VulkanRenderPassConfig depthConfig;
     depthConfig.format = postDepthImage->getBaseFormat();
@@ -392,29 +515,84 @@ void VulkanRender::createPostFrameBuffer(){
                                                           postImage->getBaseSize());
 }
 
+// Рендер проход с подпроходами модели и пост эффекта
+void VulkanRender::createSubpassRenderPass(){
+    VulkanRenderPassConfig imageConfig;
+    imageConfig.format = vulkanSwapchain->getSwapChainImageFormat();
+    imageConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    imageConfig.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    imageConfig.initLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;  // Переходы в лаяуты делает граф
+    imageConfig.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    imageConfig.refLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    // Промежуточный цвет после рендер прохода не нужен
+    VulkanRenderPassConfig inputConfig;
+    inputConfig.format = postImage->getBaseFormat();
+    inputConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    inputConfig.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    inputConfig.initLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    inputConfig.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    inputConfig.refLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    VulkanRenderPassConfig depthConfig;
+    depthConfig.format = postDepthImage->getBaseFormat();
+    depthConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthConfig.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthConfig.initLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthConfig.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthConfig.refLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    subpassRenderPass = std::make_shared<VulkanRenderPass>(vulkanLogicalDevice, imageConfig, inputConfig, depthConfig);
+}
+
+// Фреймбуфферы подпроходов для изображений окна
+void VulkanRender::createSubpassFrameBuffers(){
+    subpassFrameBuffers.clear();
+    
+    const std::vector<VulkanImageViewPtr>& windowImagesViews = vulkanSwapchain->getImageViews();
+    for (size_t i = 0; i < windowImagesViews.size(); i++) {
+        // Порядок как у аттачментов прохода: результат, промежуточный цвет, глубина
+        std::vector<VulkanImageViewPtr> views;
+        views.push_back(windowImagesViews[i]);
+        views.push_back(postImageView);
+        views.push_back(postDepthImageView);
+        subpassFrameBuffers.push_back(std::make_shared<VulkanFrameBuffer>(vulkanLogicalDevice, subpassRenderPass, views, vulkanSwapchain->getSwapChainExtent()));
+    }
+}
+
+// Модель в режиме подпроходов рисуется сразу в размер окна
+VkExtent2D VulkanRender::getPostTargetSize() const{
+    if (settings.postUseSubpass) {
+        return vulkanSwapchain->getSwapChainExtent();
+    }
+    return VkExtent2D{TARGET_FBO_TEXTURE_WIDTH, TARGET_FBO_TEXTURE_HEIGHT};
+}
+
 // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
 void VulkanRender::createPostDescriptorsSetLayout(){
     VulkanDescriptorSetConfig sampler;
     sampler.binding = 0;         // Семплер будет на 0м индексе
     sampler.desriptorsCount = 1; // 1н дескриптор
-    sampler.desriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // Тип - семплер
+    if (settings.postUseSubpass) {
+        sampler.desriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; // Результат предыдущего подпрохода
+    }else{
+        sampler.desriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // Тип - семплер
+    }
     sampler.descriptorStageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Используется в фраггментном шейдере
     
     std::vector<VulkanDescriptorSetConfig> configs;
     configs.push_back(sampler);
     
-    postDescriptorSetLayout = std::make_shared<VulkanDescriptorSetLayout>(vulkanLogicalDevice, configs);
+    postDescriptorSetLayout = vulkanLayoutCache->getDescriptorSetLayout(configs);
 }
 
 // Грузим шейдеры
 void VulkanRender::loadPostShaders(){
-    // Читаем байт-код шейдеров
-    std::vector<unsigned char> vertShaderCode = readFile("res/shaders/post_shader_vert.spv");
-    std::vector<unsigned char> fragShaderCode = readFile("res/shaders/post_shader_frag.spv");
+    // Байт-код шейдеров из архива или отдельных файлов без копирования, данные нужны только до создания модулей
+    AssetDataPtr vertShaderData = loadAsset(assetArchive, "res/shaders/post_shader_vert.spv");
+    const char* fragShaderPath = settings.postUseSubpass ? "res/shaders/post_subpass_frag.spv" : "res/shaders/post_shader_frag.spv";
+    AssetDataPtr fragShaderData = loadAsset(assetArchive, fragShaderPath);
     
     // Создаем шейдерные модули
-    postVertexModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, vertShaderCode);
-    postFragmentModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, fragShaderCode);
+    postVertexModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, vertShaderData->getView());
+    postFragmentModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, fragShaderData->getView());
 }
 
 // Создание пайплайна отрисовки
@@ -462,30 +640,52 @@ void VulkanRender::createPostGraphicsPipeline() {
     VkPushConstantRange pushConstantRange = {};
     memset(&pushConstantRange, 0, sizeof(VkPushConstantRange));
     pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(float);
+    pushConstantRange.size = sizeof(PostPushConstants);
     pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     pushConstants.push_back(pushConstantRange);
     
-    // Динамически изменяемые параметры
+    // Лаяут пайплайна из кеша, при пересоздании пайплайна не меняется
+    std::vector<VulkanDescriptorSetLayoutPtr> setLayouts;
+    setLayouts.push_back(postDescriptorSetLayout);
+    VulkanPipelineLayoutPtr pipelineLayout = vulkanLayoutCache->getPipelineLayout(setLayouts, pushConstants);
+    
+    // Динамически изменяемые параметры, при ресайзе пайплайн не пересоздается
     std::vector<VkDynamicState> dynamicStates;
-    //dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
-    //dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
-    
-    // Пайплайн
-    postPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
-                                                    postVertexModule, postFragmentModule,
-                                                    depthConfig,
-                                                    bindingDescription,
-                                                    attributeDescriptions,
-                                                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-                                                    viewport,
-                                                    scissor,
-                                                    cullingConfig,
-                                                    blendConfig,
-                                                    postDescriptorSetLayout,
-                                                    vulkanRenderToWindowRenderPass,
-                                                    pushConstants,
-                                                    dynamicStates);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    
+    // Описание пайплайна
+    VulkanPipelineDesc desc;
+    desc.vertexShader = postVertexModule;
+    desc.fragmentShader = postFragmentModule;
+    desc.depthConfig = depthConfig;
+    desc.vertexBindingDescription = bindingDescription;
+    desc.vertexAttributesDescriptions = attributeDescriptions;
+    desc.primitivesTypes = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    desc.viewport = viewport;
+    desc.scissor = scissor;
+    desc.cullingConfig = cullingConfig;
+    desc.blendConfig = blendConfig;
+    desc.pipelineLayout = pipelineLayout;
+    if (settings.postUseSubpass) {
+        desc.renderPass = subpassRenderPass;
+        desc.subpass = 1;
+    }else{
+        desc.renderPass = vulkanRenderToWindowRenderPass;
+    }
+    desc.dynamicStates = dynamicStates;
+    desc.fragmentSpecialization.addBool(0, false);  // Режимы из push констант, ветвление в шейдере
+    
+    // Тот же шейдер, но режимы заданы константами, ветки убираются при компиляции
+    VulkanPipelineDesc specializedDesc = desc;
+    specializedDesc.fragmentSpecialization = VulkanPipelineSpecialization();
+    specializedDesc.fragmentSpecialization.addBool(0, true);
+    specializedDesc.fragmentSpecialization.addInt(1, settings.postToneMapMode);
+    specializedDesc.fragmentSpecialization.addInt(2, settings.postBlurRadius);
+    
+    // Пайплайн собирается в фоне, до готовности рисуем прежним, а при первом создании вывод пост эффекта пропускается
+    postPipelineFuture = vulkanPipelineVariantCache->getPipelineAsync(desc, vulkanPipelineCompiler);
+    postSpecializedPipelineFuture = vulkanPipelineVariantCache->getPipelineAsync(specializedDesc, vulkanPipelineCompiler);
 }
 
 // Создание буфферов вершин
@@ -501,33 +701,22 @@ void VulkanRender::createPostBuffers(){
                                           (unsigned char*)QUAD_INDICES.data(), sizeof(QUAD_INDICES[0]) * QUAD_INDICES.size());
 }
 
-// Создаем пул дескрипторов ресурсов
-void VulkanRender::createPostRenderDescriptorPool() {
-    // Структура с типами пулов
-    std::vector<VkDescriptorPoolSize> poolSizes;
-    poolSizes.resize(1);
-    // Семплер для текстуры
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 1;
-    
-    // Создаем пул
-    postDescriptorPool = std::make_shared<VulkanDescriptorPool>(vulkanLogicalDevice, poolSizes, 1);
-}
-
-// Создаем набор дескрипторов ресурсов
-void VulkanRender::createPostRenderDescriptorSet() {
-    postDescriptorSet = std::make_shared<VulkanDescriptorSet>(vulkanLogicalDevice, postDescriptorSetLayout, postDescriptorPool);
-    
+// Получаем набор дескрипторов ресурсов из кеша, обновление происходит только при изменении ресурсов
+void VulkanRender::updatePostRenderDescriptorSet() {
     VulkanDescriptorSetUpdateConfig samplerSet;
     samplerSet.binding = 0; // Биндится на 1м значении в шейдере
-    samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     samplerSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     samplerSet.imageInfo.imageView = postImageView;
-    samplerSet.imageInfo.sampler = postTextureSampler;
+    if (settings.postUseSubpass) {
+        samplerSet.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;  // Семплер не нужен
+    }else{
+        samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerSet.imageInfo.sampler = postTextureSampler;
+    }
     
     std::vector<VulkanDescriptorSetUpdateConfig> configs;
     configs.push_back(samplerSet);
-    postDescriptorSet->updateDescriptorSet(configs);
+    postDescriptorSet = vulkanDescriptorSetCache->getSet(postDescriptorSetLayout, configs);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -550,22 +739,36 @@ void VulkanRender::createModelDescriptorsSetLayout(){
     configs.push_back(uniformBuffer);
     configs.push_back(sampler);
     
-    modelDescriptorSetLayout = std::make_shared<VulkanDescriptorSetLayout>(vulkanLogicalDevice, configs);
+    modelDescriptorSetLayout = vulkanLayoutCache->getDescriptorSetLayout(configs);
 }
 
 // Грузим шейдеры
 void VulkanRender::loadModelShaders(){
-    // Читаем байт-код шейдеров
-    std::vector<unsigned char> vertShaderCode = readFile("res/shaders/model_shader_vert.spv");
-    std::vector<unsigned char> fragShaderCode = readFile("res/shaders/model_shader_frag.spv");
+    // Байт-код шейдеров из архива или отдельных файлов без копирования, данные нужны только до создания модулей
+    AssetDataPtr vertShaderData = loadAsset(assetArchive, "res/shaders/model_shader_vert.spv");
+    AssetDataPtr fragShaderData = loadAsset(assetArchive, "res/shaders/model_shader_frag.spv");
     
     // Создаем шейдерные модули
-    modelVertexModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, vertShaderCode);
-    modelFragmentModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, fragShaderCode);
+    modelVertexModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, vertShaderData->getView());
+    modelFragmentModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, fragShaderData->getView());
 }
 
 // Создание пайплайна отрисовки
 void VulkanRender::createModelGraphicsPipeline() {
+    modelPipelineFuture = compileModelGraphicsPipeline(0);
+}
+
+// Варианты пайплайна модели для замера времени до первого кадра, как набор материалов
+void VulkanRender::createModelPipelineVariants() {
+    modelPipelineVariantsFutures.clear();
+    for (uint32_t i = 1; i < settings.pipelineVariantsCount; i++) {
+        modelPipelineVariantsFutures.push_back(compileModelGraphicsPipeline(i));
+    }
+}
+
+// Ставим в очередь компиляцию пайплайна модели. Варианты - материалы с 8 комбинациями состояния,
+// индекс материала уходит константой специализации, поэтому у каждого варианта свой ключ и своя компиляция
+VulkanPipelineFuture VulkanRender::compileModelGraphicsPipeline(uint32_t variantIndex) {
     // Описание вершин, шага по вершинам и описание данных
     VkVertexInputBindingDescription bindingDescription = Vertex3D::getBindingDescription();
     std::vector<VkVertexInputAttributeDescription> attributeDescriptions = Vertex3D::getAttributeDescriptions();
@@ -590,16 +793,16 @@ void VulkanRender::createModelGraphicsPipeline() {
     VulkanPipelineDepthConfig depthConfig;
     depthConfig.depthTestEnabled = VK_TRUE;
     depthConfig.depthWriteEnabled = VK_TRUE;
-    depthConfig.depthFunc = VK_COMPARE_OP_LESS;
+    depthConfig.depthFunc = (variantIndex % 2 == 0) ? VK_COMPARE_OP_LESS : VK_COMPARE_OP_LESS_OR_EQUAL;
     
     // Настройки кулинга
     VulkanPipelineCullingConfig cullingConfig;
     cullingConfig.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    cullingConfig.cullMode = VK_CULL_MODE_BACK_BIT;
+    cullingConfig.cullMode = ((variantIndex / 2) % 2 == 0) ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE;
     
     // Блендинг
     VulkanPipelineBlendConfig blendConfig;
-    blendConfig.enabled = VK_FALSE;
+    blendConfig.enabled = ((variantIndex / 4) % 2 == 0) ? VK_FALSE : VK_TRUE;
     blendConfig.blendOp = VK_BLEND_OP_ADD;
     blendConfig.srcFactor = VK_BLEND_FACTOR_SRC_ALPHA;
     blendConfig.dstFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
@@ -613,26 +816,41 @@ void VulkanRender::createModelGraphicsPipeline() {
     pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     pushConstants.push_back(pushConstantRange);
     
-    // Динамически изменяемые параметры
+    // Лаяут пайплайна из кеша
+    std::vector<VulkanDescriptorSetLayoutPtr> setLayouts;
+    setLayouts.push_back(modelDescriptorSetLayout);
+    VulkanPipelineLayoutPtr pipelineLayout = vulkanLayoutCache->getPipelineLayout(setLayouts, pushConstants);
+    
+    // Динамически изменяемые параметры, при ресайзе пайплайн не пересоздается
     std::vector<VkDynamicState> dynamicStates;
-    //dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
-    //dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
-    
-    // Пайплайн
-    modelPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
-                                                      modelVertexModule, modelFragmentModule,
-                                                      depthConfig,
-                                                      bindingDescription,
-                                                      attributeDescriptions,
-                                                      VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-                                                      viewport,
-                                                      scissor,
-                                                      cullingConfig,
-                                                      blendConfig,
-                                                      modelDescriptorSetLayout,
-                                                      postRenderToRenderPass,
-                                                      pushConstants,
-                                                      dynamicStates);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    
+    // Описание пайплайна
+    VulkanPipelineDesc desc;
+    desc.vertexShader = modelVertexModule;
+    desc.fragmentShader = modelFragmentModule;
+    desc.depthConfig = depthConfig;
+    desc.vertexBindingDescription = bindingDescription;
+    desc.vertexAttributesDescriptions = attributeDescriptions;
+    desc.primitivesTypes = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    desc.viewport = viewport;
+    desc.scissor = scissor;
+    desc.cullingConfig = cullingConfig;
+    desc.blendConfig = blendConfig;
+    desc.pipelineLayout = pipelineLayout;
+    if (settings.postUseSubpass) {
+        desc.renderPass = subpassRenderPass;
+        desc.subpass = 0;
+    }else{
+        desc.renderPass = postRenderToRenderPass;
+    }
+    desc.dynamicStates = dynamicStates;
+    // Индекс материала: шейдер константу не читает, драйвер такую запись игнорирует, но ключ в кеше вариантов различается
+    desc.fragmentSpecialization.addUInt(0, variantIndex);
+    
+    // Пайплайн собирается в фоне, до готовности отрисовка модели пропускается
+    return vulkanPipelineVariantCache->getPipelineAsync(desc, vulkanPipelineCompiler);
 }
 
 
@@ -644,7 +862,14 @@ void VulkanRender::loadModelSrcData(){
     std::vector<tinyobj::material_t> materials;
     std::string err;
     
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, "static_res/models/chalet.obj")) {
+    // Модель из архива или замапленного файла парсится потоком прямо из памяти, материалы ищутся рядом с моделью
+    AssetDataPtr modelData = loadAsset(assetArchive, "static_res/models/chalet.obj");
+    // Парсер идет по модели подряд - просим ядро читать страницы наперед
+    modelData->adviseSequential();
+    modelData->prefetch();
+    AssetFileStream modelStream(modelData->getView());
+    tinyobj::MaterialFileReader materialReader("static_res/models/");
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &modelStream, &materialReader)) {
         throw std::runtime_error(err);
     }
     
@@ -666,6 +891,7 @@ void VulkanRender::loadModelSrcData(){
             
             vertex.color = {1.0f, 1.0f, 1.0f};
             
+            modelRadius = std::max(modelRadius, glm::length(vertex.pos));
             modelVertices.push_back(vertex);
             modelIndices.push_back(modelIndices.size());
         }
@@ -714,8 +940,8 @@ void VulkanRender::createModelUniformBuffer() {
     // Обновляем юниформ буффер
     ModelUniformBuffer ubo = {};
     memset(&ubo, 0, sizeof(ModelUniformBuffer));
-    ubo.view = glm::lookAt(glm::vec3(0.0f, 3.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    ubo.proj = glm::perspective(glm::radians(45.0f), (float)postImage->getBaseSize().width / (float)postImage->getBaseSize().height, 0.1f, 10.0f);
+    ubo.view = glm::lookAt(MODEL_CAMERA_POSITION, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    ubo.proj = glm::perspective(glm::radians(MODEL_CAMERA_FOV), (float)postImage->getBaseSize().width / (float)postImage->getBaseSize().height, 0.1f, 10.0f);
     
     // GLM был разработан для OpenGL, где координата Y клип координат перевернута,
     // самым простым путем решения данного вопроса будет изменить знак оси Y в матрице проекции
@@ -730,26 +956,8 @@ void VulkanRender::createModelUniformBuffer() {
     endAndQueueWaitSingleTimeCommands(commandBuffer, vulkanRenderQueue);
 }
 
-// Создаем пул дескрипторов ресурсов
-void VulkanRender::createModelDescriptorPool() {
-    // Структура с типами пулов
-    std::vector<VkDescriptorPoolSize> poolSizes;
-    poolSizes.resize(2);
-    // Юниформ буффер
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = 1;
-    // Семплер для текстуры
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = 1;
-    
-    // Создаем пул
-    modelDescriptorPool = std::make_shared<VulkanDescriptorPool>(vulkanLogicalDevice, poolSizes, 1);
-}
-
-// Создаем набор дескрипторов ресурсов
-void VulkanRender::createModelDescriptorSet() {
-    modelDescriptorSet = std::make_shared<VulkanDescriptorSet>(vulkanLogicalDevice, modelDescriptorSetLayout, modelDescriptorPool);
-    
+// Получаем набор дескрипторов ресурсов из кеша, обновление происходит только при изменении ресурсов
+void VulkanRender::updateModelDescriptorSet() {
     VulkanDescriptorSetUpdateConfig vertexBufferSet;
     vertexBufferSet.binding = 0; // Биндится на 0м значении в шейдере
     vertexBufferSet.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Тип - юниформ буффер
@@ -767,7 +975,7 @@ void VulkanRender::createModelDescriptorSet() {
     std::vector<VulkanDescriptorSetUpdateConfig> configs;
     configs.push_back(vertexBufferSet);
     configs.push_back(samplerSet);
-    modelDescriptorSet->updateDescriptorSet(configs);
+    modelDescriptorSet = vulkanDescriptorSetCache->getSet(modelDescriptorSetLayout, configs);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -798,52 +1006,199 @@ void VulkanRender::createWindowFrameBuffers(){
     }
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Уровень по размеру модели на экране, картинка и вью текстуры подменяются после загрузки
+void VulkanRender::updateTextureStreaming(){
+    if (textureStreamer == nullptr) {
+        return;
+    }
+    
+    float distance = glm::length(MODEL_CAMERA_POSITION);
+    uint32_t level = VulkanTextureStreamer::computeDesiredLevel(modelStreamedTexture->getBaseSize(),
+                                                                modelRadius * 2.0f,
+                                                                distance,
+                                                                glm::radians(MODEL_CAMERA_FOV),
+                                                                postImage->getBaseSize().height);
+    textureStreamer->requestLevel(modelStreamedTexture, level);
+    textureStreamer->update();
+    
+    // Набор дескрипторов берется из кеша по вью, старая картинка живет, пока ее держат кадры в полете
+    if (modelTextureImageView != modelStreamedTexture->getImageView()) {
+        modelTextureImage = modelStreamedTexture->getImage();
+        modelTextureImageView = modelStreamedTexture->getImageView();
+        LOG("Model texture streamed: level %d of %d resident, %d requested\n",
+            (int)modelStreamedTexture->getResidentLevel(), (int)modelStreamedTexture->getLevelsCount(), (int)level);
+    }
+}
 
-VulkanCommandBufferPtr VulkanRender::updateRenderCommandBuffer(uint32_t frameIndex){
-    // Создаем новый буффер или сбрасываем старый
-    VulkanCommandBufferPtr& buffer = vulkanDrawCommandBuffers[vulkanImageIndex];
-    if (buffer == nullptr) {
-        buffer = std::make_shared<VulkanCommandBuffer>(vulkanLogicalDevice, vulkanRenderCommandPool);
+// Забираем скомпилированные в фоне пайплайны, не готовые пока не рисуем
+void VulkanRender::updateReadyPipelines(){
+    replaceWithReadyPipeline(modelPipeline, modelPipelineFuture);
+    replaceWithReadyPipeline(postPipeline, postPipelineFuture);
+    replaceWithReadyPipeline(postSpecializedPipeline, postSpecializedPipelineFuture);
+    
+    if ((pipelinesCompiledLogged == false) && (vulkanPipelineCompiler->getPendingCount() == 0)) {
+        pipelinesCompiledLogged = true;
+        double milliseconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - initBeginTime).count() / 1000.0;
+        LOG("All pipelines compiled: %d pipelines, %d threads, %.1fms since init\n",
+            (int)vulkanPipelineCompiler->getCompiledCount(), (int)vulkanPipelineCompiler->getThreadsCount(), milliseconds);
+    }
+}
+
+// Граф проходов кадра: барьеры и лаяуты выводятся из чтений и записей, картинки проходов создает граф
+void VulkanRender::createRenderGraph(){
+    renderGraph = std::make_shared<VulkanRenderGraph>();
+    addRenderGraphImages();
+    
+    // После кадра картинка свопчейна должна быть готова к показу
+    renderGraph->setFinalLayout("swapchain", VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+    renderGraph->markOutput("swapchain");
+    
+    if (settings.postUseSubpass) {
+        // Промежуточный цвет и глубина живут внутри одного прохода графа - попадают в lazily allocated память
+        VulkanRenderGraphPassPtr scenePass = renderGraph->addPass("scene");
+        scenePass->write("post", VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT);
+        scenePass->write("depth", VULKAN_RENDER_GRAPH_DEPTH_ATTACHMENT);
+        scenePass->write("swapchain", VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT);
+        scenePass->setExecute([this](const VulkanCommandBufferPtr& buffer){
+            recordSubpassPass(buffer);
+        });
     }else{
-        //buffer->reset(0);   // Можно отправить сброс, но с VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT - не нужно
+        VulkanRenderGraphPassPtr modelPass = renderGraph->addPass("model");
+        modelPass->write("post", VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT);
+        modelPass->write("depth", VULKAN_RENDER_GRAPH_DEPTH_ATTACHMENT);
+        modelPass->setExecute([this](const VulkanCommandBufferPtr& buffer){
+            recordModelPass(buffer);
+        });
+        
+        VulkanRenderGraphPassPtr postPass = renderGraph->addPass("post");
+        postPass->read("post", VULKAN_RENDER_GRAPH_SAMPLED_FRAGMENT);
+        postPass->write("swapchain", VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT);
+        postPass->setExecute([this](const VulkanCommandBufferPtr& buffer){
+            recordPostPass(buffer);
+        });
     }
     
-    // Буфер команд может быть представлен еще раз, если он так же уже находится в ожидании исполнения. VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT
-    buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    renderGraph->compile();
+    renderGraph->allocate(vulkanLogicalDevice);
+}
 
-    uint32_t timeStampIndex = 0;
-    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampIndex++);
-    
-    // Отрисовка модели
-    {
-        // Изменяем лаяут текстуры, в которую рисуем
-        transitionImageLayout(buffer,
-                              postImage,
-                              VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                              0, 1,
-                              VK_IMAGE_ASPECT_COLOR_BIT,
-							  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-							  VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
-        
-        // Информация о запуске рендер-прохода
-        std::vector<VkClearValue> clearValues;
-        clearValues.resize(2);
-        clearValues[0].color = {{0.3f, 0.3f, 0.3f, 1.0f}};
-        clearValues[1].depthStencil = {1.0f, 0};
-        VulkanRenderPassBeginInfo beginInfo;
-        beginInfo.renderPass = postRenderToRenderPass;
-        beginInfo.framebuffer = postFrameBuffer;
-        beginInfo.renderArea.offset = {0, 0};
-        beginInfo.renderArea.extent = postImage->getBaseSize();
-        beginInfo.clearValues = clearValues;
-        
-        // Запуск рендер-прохода
-        buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
-        
+// Описание картинок графа, при смене размера нужно повторить allocate()
+void VulkanRender::addRenderGraphImages(){
+    // Текстура пост эффекта живет от отрисовки модели до пост эффекта
+    VulkanRenderGraphImageDesc postDesc;
+    postDesc.size = getPostTargetSize();
+    postDesc.format = VK_FORMAT_R8G8B8A8_UNORM;
+    if (settings.postUseSubpass) {
+        postDesc.usage = VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }else{
+        postDesc.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    }
+    renderGraph->addImage("post", postDesc);
+    
+    // Глубина нужна только внутри прохода модели - может не занимать видеопамять
+    std::vector<VkFormat> candidates = {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT};
+    VulkanRenderGraphImageDesc depthDesc;
+    depthDesc.size = postDesc.size;
+    depthDesc.format = findSupportedFormat(vulkanPhysicalDevice->getDevice(), candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    depthDesc.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    depthDesc.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (hasStencilComponent(depthDesc.format)) {
+        depthDesc.aspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    renderGraph->addImage("depth", depthDesc);
+}
+
+// Отрисовка модели в текстуру
+void VulkanRender::recordModelPass(const VulkanCommandBufferPtr& buffer){
+    // Информация о запуске рендер-прохода
+    std::vector<VkClearValue> clearValues;
+    clearValues.resize(2);
+    clearValues[0].color = {{0.3f, 0.3f, 0.3f, 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+    VulkanRenderPassBeginInfo beginInfo;
+    beginInfo.renderPass = postRenderToRenderPass;
+    beginInfo.framebuffer = postFrameBuffer;
+    beginInfo.renderArea.offset = {0, 0};
+    beginInfo.renderArea.extent = postImage->getBaseSize();
+    beginInfo.clearValues = clearValues;
+    
+    // Запуск рендер-прохода
+    buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    
+    drawModel(buffer);
+
+    // Заканчиваем рендер проход
+    buffer->cmdEndRenderPass();
+}
+
+// Отрисовка текстуры пост эффекта в окно
+void VulkanRender::recordPostPass(const VulkanCommandBufferPtr& buffer){
+    // Информация о запуске рендер-прохода
+    std::vector<VkClearValue> clearValues;
+    clearValues.resize(1);
+    clearValues[0].color = {{0.4f, 0.1f, 0.1f, 1.0f}};
+    VulkanRenderPassBeginInfo beginInfo;
+    beginInfo.renderPass = vulkanRenderToWindowRenderPass;
+    beginInfo.framebuffer = vulkanWindowFrameBuffers[vulkanImageIndex];
+    beginInfo.renderArea.offset = {0, 0};
+    beginInfo.renderArea.extent = vulkanSwapchain->getSwapChainExtent();
+    beginInfo.clearValues = clearValues;
+    
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, 2);
+    
+    // Запуск рендер-прохода
+    buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    
+    drawPost(buffer);
+    
+    // Заканчиваем рендер проход
+    buffer->cmdEndRenderPass();
+    
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, 3);
+}
+
+// Модель и пост эффект подпроходами одного рендер прохода, таймстампы 2-3 покрывают оба
+void VulkanRender::recordSubpassPass(const VulkanCommandBufferPtr& buffer){
+    // Очистка в порядке аттачментов: окно, промежуточный цвет, глубина
+    std::vector<VkClearValue> clearValues;
+    clearValues.resize(3);
+    clearValues[0].color = {{0.4f, 0.1f, 0.1f, 1.0f}};
+    clearValues[1].color = {{0.3f, 0.3f, 0.3f, 1.0f}};
+    clearValues[2].depthStencil = {1.0f, 0};
+    VulkanRenderPassBeginInfo beginInfo;
+    beginInfo.renderPass = subpassRenderPass;
+    beginInfo.framebuffer = subpassFrameBuffers[vulkanImageIndex];
+    beginInfo.renderArea.offset = {0, 0};
+    beginInfo.renderArea.extent = vulkanSwapchain->getSwapChainExtent();
+    beginInfo.clearValues = clearValues;
+    
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, 2);
+    
+    buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    drawModel(buffer);
+    
+    // Переход к пост эффекту, промежуточный цвет читается через subpassLoad
+    buffer->cmdNextSubpass(VK_SUBPASS_CONTENTS_INLINE);
+    drawPost(buffer);
+    buffer->cmdEndRenderPass();
+    
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, 3);
+}
+
+// Команды отрисовки модели внутри рендер прохода
+void VulkanRender::drawModel(const VulkanCommandBufferPtr& buffer){
+    // Пока пайплайн компилируется - только очищаем текстуру
+    if (modelPipeline) {
         // Устанавливаем пайплайн у коммандного буффера
         buffer->cmdBindPipeline(modelPipeline);
         
+        // Вьюпорт и сциссор динамические
+        VkRect2D modelArea = {};
+        modelArea.offset = {0, 0};
+        modelArea.extent = getPostTargetSize();
+        buffer->cmdSetViewport(modelArea);
+        buffer->cmdSetScissor(modelArea);
+        
         // Привязываем вершинный буффер к пайлпайну
         buffer->cmdBindVertexBuffer(modelVertexBuffer);
         
@@ -851,6 +1206,7 @@ VulkanCommandBufferPtr VulkanRender::updateRenderCommandBuffer(uint32_t frameInd
         buffer->cmdBindIndexBuffer(modelIndexBuffer, VK_INDEX_TYPE_UINT32);
         
         // Подключаем дескрипторы ресурсов для юниформ буффера и текстуры
+        updateModelDescriptorSet();
         buffer->cmdBindDescriptorSet(modelPipeline->getLayout(), modelDescriptorSet);
         
         // Push константы для динамической отрисовки
@@ -859,39 +1215,29 @@ VulkanCommandBufferPtr VulkanRender::updateRenderCommandBuffer(uint32_t frameInd
         
         // Вызов поиндексной отрисовки - индексы вершин, один инстанс
         buffer->cmdDrawIndexed(modelTotalIndexesCount);
+    }
+}
 
-        // Заканчиваем рендер проход
-        buffer->cmdEndRenderPass();
+// Команды отрисовки пост эффекта внутри рендер прохода
+void VulkanRender::drawPost(const VulkanCommandBufferPtr& buffer){
+    // Вариант пост эффекта для сравнения времени на GPU
+    VulkanPipelinePtr pipeline = postPipeline;
+    if (postUseSpecialized && postSpecializedPipeline) {
+        pipeline = postSpecializedPipeline;
     }
+    postLastUsedSpecialized = (pipeline != nullptr) && (pipeline == postSpecializedPipeline);
     
-    // Отрисовка текстуры пост эффекта
-    {
-        // Изменяем лаяут текстуры, для использования как текстуру отрисовки
-		// Конвертация в нужный ляут происходит автоматически предыдущим рендер проходом - в дополнительной конвертации нету нужнды
-        /*transitionImageLayout(buffer,
-                              postImage,
-							  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                              0, 1,
-                              VK_IMAGE_ASPECT_COLOR_BIT,
-                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);*/
-        
-        // Информация о запуске рендер-прохода
-        std::vector<VkClearValue> clearValues;
-        clearValues.resize(1);
-        clearValues[0].color = {{0.4f, 0.1f, 0.1f, 1.0f}};
-        VulkanRenderPassBeginInfo beginInfo;
-        beginInfo.renderPass = vulkanRenderToWindowRenderPass;
-        beginInfo.framebuffer = vulkanWindowFrameBuffers[frameIndex];
-        beginInfo.renderArea.offset = {0, 0};
-        beginInfo.renderArea.extent = vulkanSwapchain->getSwapChainExtent();
-        beginInfo.clearValues = clearValues;
-        
-        // Запуск рендер-прохода
-        buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
-        
+    // Пока пайплайн компилируется - выводим только цвет очистки
+    if (pipeline) {
         // Устанавливаем пайплайн у коммандного буффера
-        buffer->cmdBindPipeline(postPipeline);
+        buffer->cmdBindPipeline(pipeline);
+        
+        // Вьюпорт и сциссор динамические
+        VkRect2D postArea = {};
+        postArea.offset = {0, 0};
+        postArea.extent = vulkanSwapchain->getSwapChainExtent();
+        buffer->cmdSetViewport(postArea);
+        buffer->cmdSetScissor(postArea);
         
         // Привязываем вершинный буффер
         buffer->cmdBindVertexBuffer(postVertexBuffer);
@@ -900,20 +1246,49 @@ VulkanCommandBufferPtr VulkanRender::updateRenderCommandBuffer(uint32_t frameInd
         buffer->cmdBindIndexBuffer(postIndexBuffer, VK_INDEX_TYPE_UINT16);
         
         // Подключаем дескрипторы ресурсов для юниформ буффера и текстуры
-        buffer->cmdBindDescriptorSet(postPipeline->getLayout(), postDescriptorSet);
+        updatePostRenderDescriptorSet();
+        buffer->cmdBindDescriptorSet(pipeline->getLayout(), postDescriptorSet);
 
         // Push константы для динамической отрисовки
-        float effectCoeff = std::abs(std::sin(totalTime * 3.1415926535 / 10.0f));
-        buffer->cmdPushConstants(postPipeline->getLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, (void*)&effectCoeff, sizeof(effectCoeff));
+        PostPushConstants pushConstants;
+        pushConstants.coeff = std::abs(std::sin(totalTime * 3.1415926535 / 10.0f));
+        pushConstants.toneMapMode = settings.postToneMapMode;
+        pushConstants.blurRadius = settings.postBlurRadius;
+        buffer->cmdPushConstants(pipeline->getLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, (void*)&pushConstants, sizeof(pushConstants));
         
         // Вызов поиндексной отрисовки - индексы вершин, один инстанс
         buffer->cmdDrawIndexed(QUAD_INDICES.size());
-        
-        // Заканчиваем рендер проход
-        buffer->cmdEndRenderPass();
     }
+}
+
+VulkanCommandBufferPtr VulkanRender::updateRenderCommandBuffer(uint32_t frameIndex){
+    // Создаем новый буффер или сбрасываем старый
+    VulkanCommandBufferPtr& buffer = vulkanDrawCommandBuffers[vulkanImageIndex];
+    if (buffer == nullptr) {
+        buffer = std::make_shared<VulkanCommandBuffer>(vulkanLogicalDevice, vulkanRenderCommandPool);
+    }else{
+        //buffer->reset(0);   // Можно отправить сброс, но с VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT - не нужно
+    }
+    
+    // Буфер команд может быть представлен еще раз, если он так же уже находится в ожидании исполнения. VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT
+    buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    
+    // Захват владения загруженными в очереди копирования данными
+    if (streamingActiveRing) {
+        streamingActiveRing->acquireUploaded(buffer, streamingWaitSemaphores[vulkanImageIndex], streamingWaitStages[vulkanImageIndex]);
+    }
+
+    // Таймстампы: 0-1 весь кадр, 2-3 пост эффект
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, 0);
+    
+    // Картинка свопчейна приходит после презентации, старое содержимое не нужно
+    renderGraph->setImage("swapchain", vulkanSwapchain->getImages()[frameIndex], VK_IMAGE_ASPECT_COLOR_BIT);
+    renderGraph->setImageState("swapchain", VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0);
+    
+    // Проходы с барьерами между ними
+    renderGraph->execute(buffer);
     
-    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampIndex++);
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, 1);
     
     // Заканчиваем подготовку коммандного буффера
 	buffer->end();
@@ -966,21 +1341,44 @@ void VulkanRender::drawFrame() {
 	TIME_END_MICROSEC_OFF(WAIT_FENCE, "Fence render wait time");
 
     //VkCommandBuffer drawBuffer = modelDrawCommandBuffers[vulkanImageIndex]->getBuffer();
+    // Удаляем из кеша давно не использованные наборы дескрипторов
+    vulkanDescriptorSetCache->nextFrame();
+    
+    // Подхватываем готовые пайплайны
+    updateReadyPipelines();
+    
+    // Семафоры копирования прошлого кадра с этим индексом уже отработали
+    if (streamingWaitSemaphores.empty() == false) {
+        streamingWaitSemaphores[vulkanImageIndex].clear();
+        streamingWaitStages[vulkanImageIndex].clear();
+    }
+    
+    // Фоновая загрузка данных
+    updateStreaming();
+    updateTextureStreaming();
+    
     TIME_BEGIN_OFF(MAKE_MODEL_DRAW_BUFFER);
     VulkanCommandBufferPtr buffer = updateRenderCommandBuffer(vulkanImageIndex);
     VkCommandBuffer drawBuffer = buffer->getBuffer();
     TIME_END_MICROSEC_OFF(MAKE_MODEL_DRAW_BUFFER, "Make model draw buffer wait time");
 
     // Настраиваем отправление в очередь комманд отрисовки
-    VkSemaphore waitSemaphores[] = {vulkanImageAvailableSemaphore->getSemafore()}; // Семафор ожидания картинки для вывода туда графики
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};    // Ждать будем c помощью семафора возможности вывода в буфер цвета
+    std::vector<VkSemaphore> waitSemaphores = {vulkanImageAvailableSemaphore->getSemafore()}; // Семафор ожидания картинки для вывода туда графики
+    std::vector<VkPipelineStageFlags> waitStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};    // Ждать будем c помощью семафора возможности вывода в буфер цвета
+    if (streamingWaitSemaphores.empty() == false) {
+        // Копирование в отдельной очереди - ждем только на стадиях, где используются данные
+        for (size_t i = 0; i < streamingWaitSemaphores[vulkanImageIndex].size(); i++) {
+            waitSemaphores.push_back(streamingWaitSemaphores[vulkanImageIndex][i]->getSemafore());
+            waitStages.push_back(streamingWaitStages[vulkanImageIndex][i]);
+        }
+    }
     VkSemaphore signalSemaphores[] = {vulkanRenderFinishedSemaphore->getSemafore()}; // Семафор оповещения о завершении рендеринга
     VkSubmitInfo submitInfo = {};
     memset(&submitInfo, 0, sizeof(VkSubmitInfo));
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;    // Ожидаем доступное изображение, в которое можно было бы записывать пиксели
-    submitInfo.pWaitDstStageMask = waitStages;      // Ждать будем возможности вывода в буфер цвета
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();    // Ожидаем доступное изображение, в которое можно было бы записывать пиксели
+    submitInfo.pWaitDstStageMask = waitStages.data();      // Ждать будем возможности вывода в буфер цвета
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &drawBuffer; // Указываем коммандный буффер отрисовки
     submitInfo.signalSemaphoreCount = 1;
@@ -1014,6 +1412,14 @@ void VulkanRender::drawFrame() {
 	TIME_BEGIN_OFF(PRESENT_DURATION);
     VkResult presentResult = vkQueuePresentKHR(vulkanPresentQueue->getQueue(), &presentInfo);
 	TIME_END_MICROSEC_OFF(PRESENT_DURATION, "Present wait time");
+    
+    // Время до первого кадра не должно зависеть от количества пайплайнов
+    if (firstFrameLogged == false) {
+        firstFrameLogged = true;
+        double milliseconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - initBeginTime).count() / 1000.0;
+        LOG("Time to first frame: %.1fms (pipeline variants %d, async %d, model pipeline ready %d, post pipeline ready %d)\n",
+            milliseconds, (int)settings.pipelineVariantsCount, (int)settings.pipelineCompileAsync, (int)(modelPipeline != nullptr), (int)(postPipeline != nullptr));
+    }
 
 	// Можно не получать индекс, а просто делать как в Metal, либо на всякий случай получить индекс на старте
 	// TODO: Операции на семафорах - нужно ли вообще это???
@@ -1038,21 +1444,46 @@ VulkanRender::~VulkanRender(){
     vulkanPresentQueue->wait();
     vulkanLogicalDevice->wait();
     
+    // Останавливаем фоновую компиляцию до удаления ресурсов
+    vulkanPipelineCompiler = nullptr;
+    modelPipelineVariantsFutures.clear();
+    modelPipelineFuture = VulkanPipelineFuture();
+    postPipelineFuture = VulkanPipelineFuture();
+    postSpecializedPipelineFuture = VulkanPipelineFuture();
+    vulkanPipelineVariantCache = nullptr;
+    
     vulkanDrawCommandBuffers.clear();
+    streamingActiveRing = nullptr;
+    streamingTransferRing = nullptr;
+    streamingRenderRing = nullptr;
+    streamingTargetBuffer = nullptr;
+    streamingWaitSemaphores.clear();
     modelDescriptorSet = nullptr;
-    modelDescriptorPool = nullptr;
+    postDescriptorSet = nullptr;
+    vulkanDescriptorSetCache = nullptr;
     modelUniformGPUBuffer = nullptr;
     modelVertexBuffer = nullptr;
     modelIndexBuffer = nullptr;
     modelTextureSampler = nullptr;
     modelTextureImage = nullptr;
     modelTextureImageView = nullptr;
+    modelStreamedTexture = nullptr;
+    textureStreamer = nullptr;
     vulkanRenderCommandPool = nullptr;
     modelPipeline = nullptr;
     modelVertexModule = nullptr;
     modelFragmentModule = nullptr;
     modelDescriptorSetLayout = nullptr;
+    postPipeline = nullptr;
+    postSpecializedPipeline = nullptr;
+    postDescriptorSetLayout = nullptr;
+    vulkanLayoutCache = nullptr;
+    vulkanSamplerCache = nullptr;
+    assetArchive = nullptr;
     vulkanWindowFrameBuffers.clear();
+    subpassFrameBuffers.clear();
+    subpassRenderPass = nullptr;
+    renderGraph = nullptr;
     postRenderToRenderPass = nullptr;
     postDepthImageView = nullptr;
     postDepthImage = nullptr;
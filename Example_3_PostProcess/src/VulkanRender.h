@@ -2,6 +2,7 @@
 #define VULKAN_RENDER_H
 
 #include <vector>
+#include <chrono>
 
 // GLFW include
 #define GLFW_INCLUDE_VULKAN
@@ -23,13 +24,26 @@
 #include <VulkanDescriptorSetLayout.h>
 #include <VulkanShaderModule.h>
 #include <VulkanPipeline.h>
+#include <VulkanLayoutCache.h>
+#include <VulkanPipelineCompiler.h>
+#include <VulkanPipelineVariantCache.h>
 #include <VulkanCommandPool.h>
 #include <VulkanCommandBuffer.h>
 #include <VulkanSampler.h>
+#include <VulkanSamplerCache.h>
 #include <VulkanBuffer.h>
+#include <VulkanStagingRing.h>
 #include <VulkanDescriptorPool.h>
 #include <VulkanDescriptorSet.h>
+#include <VulkanDescriptorSetCache.h>
+#include <VulkanDescriptorUpdateTemplate.h>
 #include <VulkanQueryPool.h>
+#include <VulkanRenderGraph.h>
+#include <VulkanTextureLoader.h>
+#include <VulkanTextureBatchLoader.h>
+#include <VulkanTextureStreamer.h>
+#include <VulkanMipGenerator.h>
+#include <AssetArchive.h>
 
 #include "Vertex2D.h"
 #include "Vertex3D.h"
@@ -38,9 +52,25 @@
 
 #define RenderI VulkanRender::getInstance()
 
+// Настройки рендера из командной строки, нужны до создания рендера
+struct VulkanRenderSettings {
+    bool postUseSubpass;    // Модель и пост эффект подпроходами одного рендер прохода через input attachment, без размытия
+    int32_t postToneMapMode;    // Режим тонмаппинга пост эффекта: 0 - нет, 1 - Reinhard, 2 - экспонента
+    int32_t postBlurRadius;     // Радиус размытия пост эффекта
+    uint32_t pipelineVariantsCount; // Сколько материалов модели запрашиваем (1, 10, 100) для замера времени до первого кадра
+    bool pipelineCompileAsync;      // false - ждем компиляции всех пайплайнов в init
+    uint32_t streamingTotalSizeMB;  // Сколько данных загружаем в фоне для замера разброса времени кадра, 0 - не загружаем (по умолчанию)
+    uint32_t streamingChunkSizeMB;  // Сколько загружаем за кадр
+    uint32_t streamingTargetSizeMB; // Размер приемника на GPU, куски пишутся в него по кругу
+    uint32_t textureStreamingBudgetMB;  // Бюджет памяти мипмапов текстуры модели, 0 - текстура грузится целиком сразу
+    bool printMemoryStats;          // Вывод статистики памяти устройства вместе со статистикой GPU
+    
+    VulkanRenderSettings();
+};
+
 struct VulkanRender {
 public:
-    static void initInstance(GLFWwindow* window);
+    static void initInstance(GLFWwindow* window, const VulkanRenderSettings& settings);
     static VulkanRender* getInstance();
     static void destroyRender();
 
@@ -53,18 +83,26 @@ public:
     void drawFrame();
     // Вывести статы GPU
     void printGPUStats();
+    // Замер параллельной загрузки всех картинок из папки с разным числом потоков
+    void runTextureBenchmark(const std::string& directory);
+    // Замер времени GPU генерации мипмапов 4K текстуры: цепочка блитов против compute шейдера
+    void runMipBenchmark();
+    // Замер скорости обновления наборов дескрипторов: обычный путь против шаблона обновления
+    void runDescriptorBenchmark();
     
 private:
     VulkanRender();
     ~VulkanRender();
     
 public:
+    VulkanRenderSettings settings;
     VulkanInstancePtr vulkanInstance;
     VulkanSurfacePtr vulkanWindowSurface;
     VulkanPhysicalDevicePtr vulkanPhysicalDevice;
     VulkanLogicalDevicePtr vulkanLogicalDevice;
     VulkanQueuePtr vulkanRenderQueue;
     VulkanQueuePtr vulkanPresentQueue;
+    bool descriptorUpdateTemplateSupported;
     VulkanSemaforePtr vulkanImageAvailableSemaphore;
     VulkanSemaforePtr vulkanRenderFinishedSemaphore;
     std::vector<VulkanFencePtr> vulkanPresentFences;
@@ -75,6 +113,13 @@ public:
     std::vector<VulkanFrameBufferPtr> vulkanWindowFrameBuffers;
     std::vector<VulkanCommandBufferPtr> vulkanDrawCommandBuffers;
     VulkanQueryPoolPtr vulkanTimeStampQueryPool;
+    VulkanDescriptorSetCachePtr vulkanDescriptorSetCache;
+    VulkanLayoutCachePtr vulkanLayoutCache;
+    VulkanSamplerCachePtr vulkanSamplerCache;
+    VulkanPipelineCompilerPtr vulkanPipelineCompiler;
+    VulkanPipelineVariantCachePtr vulkanPipelineVariantCache;
+    VulkanRenderGraphPtr renderGraph;
+    AssetArchivePtr assetArchive;
     
     VulkanImagePtr postImage;
     VulkanImageViewPtr postImageView;
@@ -82,39 +127,70 @@ public:
     VulkanRenderPassPtr vulkanRenderToWindowRenderPass;
     VulkanRenderPassPtr postRenderToRenderPass;
     VulkanFrameBufferPtr postFrameBuffer;
+    VulkanRenderPassPtr subpassRenderPass;
+    std::vector<VulkanFrameBufferPtr> subpassFrameBuffers;
     VulkanDescriptorSetLayoutPtr postDescriptorSetLayout;
     VulkanShaderModulePtr postVertexModule;
     VulkanShaderModulePtr postFragmentModule;
     VulkanPipelinePtr postPipeline;
+    VulkanPipelineFuture postPipelineFuture;
+    VulkanPipelinePtr postSpecializedPipeline;
+    VulkanPipelineFuture postSpecializedPipelineFuture;
+    bool postUseSpecialized;
+    bool postLastUsedSpecialized;
+    double postBranchingGPUTime;
+    double postSpecializedGPUTime;
+    uint32_t postBranchingSamplesCount;
+    uint32_t postSpecializedSamplesCount;
     VulkanBufferPtr postVertexBuffer;
     VulkanBufferPtr postIndexBuffer;
     VulkanSamplerPtr postTextureSampler;
-    VulkanDescriptorPoolPtr postDescriptorPool;
     VulkanDescriptorSetPtr postDescriptorSet;
     
     VulkanDescriptorSetLayoutPtr modelDescriptorSetLayout;
     VulkanShaderModulePtr modelVertexModule;
     VulkanShaderModulePtr modelFragmentModule;
     VulkanPipelinePtr modelPipeline;
+    VulkanPipelineFuture modelPipelineFuture;
+    std::vector<VulkanPipelineFuture> modelPipelineVariantsFutures;
     VulkanImagePtr modelTextureImage;
     VulkanImageViewPtr modelTextureImageView;
     VulkanSamplerPtr modelTextureSampler;
     std::vector<Vertex3D> modelVertices;
     std::vector<uint32_t> modelIndices;
+    float modelRadius;
     size_t modelTotalVertexesCount;
     size_t modelTotalIndexesCount;
     uint32_t modelImageIndex;
     VulkanBufferPtr modelVertexBuffer;
     VulkanBufferPtr modelIndexBuffer;
     VulkanBufferPtr modelUniformGPUBuffer;
-    VulkanDescriptorPoolPtr modelDescriptorPool;
     VulkanDescriptorSetPtr modelDescriptorSet;
     
+    VulkanStagingRingPtr streamingTransferRing;
+    VulkanStagingRingPtr streamingRenderRing;
+    VulkanStagingRingPtr streamingActiveRing;
+    VulkanBufferPtr streamingTargetBuffer;
+    std::vector<unsigned char> streamingChunkData;
+    std::vector<std::vector<VulkanSemaforePtr>> streamingWaitSemaphores;
+    std::vector<std::vector<VkPipelineStageFlags>> streamingWaitStages;
+    uint64_t streamingPhaseBytes;
+    VkDeviceSize streamingTargetOffset;
+    std::vector<double> streamingFrameTimes;
+    std::chrono::high_resolution_clock::time_point streamingLastFrameTime;
+    
+    VulkanTextureStreamerPtr textureStreamer;
+    VulkanStreamedTexturePtr modelStreamedTexture;
+    
 	float totalTime;
     float rotateAngle;
     
     uint32_t vulkanImageIndex;
     
+    std::chrono::high_resolution_clock::time_point initBeginTime;
+    bool firstFrameLogged;
+    bool pipelinesCompiledLogged;
+    
 private:
     void init(GLFWwindow* window);
     
@@ -136,6 +212,12 @@ private:
     void createRenderToPostRenderPass();
     // Создаем фреймбуффер для отрисовки в текстуру
     void createPostFrameBuffer();
+    // Рендер проход с подпроходами модели и пост эффекта
+    void createSubpassRenderPass();
+    // Фреймбуфферы подпроходов для изображений окна
+    void createSubpassFrameBuffers();
+    // Размер картинки, в которую рисуется модель
+    VkExtent2D getPostTargetSize() const;
     // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
     void createPostDescriptorsSetLayout();
     // Грузим шейдеры
@@ -144,10 +226,8 @@ private:
     void createPostGraphicsPipeline();
     // Создание буфферов вершин
     void createPostBuffers();
-    // Создаем пул дескрипторов ресурсов
-    void createPostRenderDescriptorPool();
-    // Создаем набор дескрипторов ресурсов
-    void createPostRenderDescriptorSet();
+    // Получаем набор дескрипторов ресурсов из кеша
+    void updatePostRenderDescriptorSet();
     
     // Создаем фреймбуфферы для вьюшек изображений окна
     void createWindowFrameBuffers();
@@ -157,20 +237,48 @@ private:
     void loadModelShaders();
     // Создание пайплайна отрисовки
     void createModelGraphicsPipeline();
+    // Варианты пайплайна модели для замера времени до первого кадра
+    void createModelPipelineVariants();
+    // Компиляция пайплайна модели в фоне
+    VulkanPipelineFuture compileModelGraphicsPipeline(uint32_t variantIndex);
     // Грузим данные для модели
     void loadModelSrcData();
     // Создание буфферов вершин
     void createModelBuffers();
     // Создаем буффер юниформов
     void createModelUniformBuffer();
-    // Создаем пул дескрипторов ресурсов
-    void createModelDescriptorPool();
-    // Создаем набор дескрипторов ресурсов
-    void createModelDescriptorSet();
+    // Получаем набор дескрипторов ресурсов из кеша
+    void updateModelDescriptorSet();
+    
+    // Кольца загрузки и приемник для замера потоковой загрузки
+    void createStreamingResources();
+    // Загружаем очередной кусок данных и считаем время кадра
+    void updateStreaming();
+    // Выводим разброс времени кадра и переходим к следующему способу загрузки
+    void finishStreamingPhase();
+    // Запрос уровня мипмапа текстуры модели по размеру на экране и подхват загруженных уровней
+    void updateTextureStreaming();
+    
+    // Забираем скомпилированные в фоне пайплайны
+    void updateReadyPipelines();
     
     // Сбрасываем коммандные буфферы
     void resetCommandBuffers();
     
+    // Граф проходов кадра: барьеры и лаяуты выводятся из чтений и записей, картинки проходов создает граф
+    void createRenderGraph();
+    // Описание картинок графа
+    void addRenderGraphImages();
+    // Отрисовка модели в текстуру
+    void recordModelPass(const VulkanCommandBufferPtr& buffer);
+    // Отрисовка текстуры пост эффекта в окно
+    void recordPostPass(const VulkanCommandBufferPtr& buffer);
+    // Модель и пост эффект подпроходами одного рендер прохода
+    void recordSubpassPass(const VulkanCommandBufferPtr& buffer);
+    // Команды отрисовки внутри рендер прохода
+    void drawModel(const VulkanCommandBufferPtr& buffer);
+    void drawPost(const VulkanCommandBufferPtr& buffer);
+    
     // Коммандный буффер рендеринга
     VulkanCommandBufferPtr updateRenderCommandBuffer(uint32_t frameIndex);
 };
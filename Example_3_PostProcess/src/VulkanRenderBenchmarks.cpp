@@ -0,0 +1,328 @@
+#include "VulkanRender.h"
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <Helpers.h>
+
+
+
+#define DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS 10000
+#define MIP_BENCHMARK_SIZE 4096         // Размер текстуры для замера генерации мипмапов
+#define MIP_BENCHMARK_ITERATIONS 10
+
+// Упакованные данные для шаблона обновления дескрипторов модели, порядок как в лэйауте
+struct ModelDescriptorsTemplateData {
+    VkDescriptorBufferInfo uniformBuffer;   // binding 0
+    VkDescriptorImageInfo texture;          // binding 1
+};
+
+
+// Замер параллельной загрузки всех картинок из папки с разным числом потоков
+void VulkanRender::runTextureBenchmark(const std::string& directory){
+    std::vector<std::string> paths;
+    const char* extensions[] = {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".ktx2", ".dds"};
+    std::vector<std::string> files = listDirectoryFiles(directory);
+    for (const std::string& file: files) {
+        std::string lowerFile = file;
+        std::transform(lowerFile.begin(), lowerFile.end(), lowerFile.begin(), ::tolower);
+        for (const char* extension: extensions) {
+            std::string extensionText = extension;
+            if ((lowerFile.size() > extensionText.size()) && (lowerFile.compare(lowerFile.size() - extensionText.size(), extensionText.size(), extensionText) == 0)) {
+                paths.push_back(file);
+                break;
+            }
+        }
+    }
+    if (paths.empty()) {
+        LOG("Texture benchmark: no images in %s\n", directory.c_str());
+        return;
+    }
+    LOG("Texture benchmark: %d images in %s\n", (int)paths.size(), directory.c_str());
+    
+    // 1, 2, 4... потоков до числа ядер, первый проход прогревает файловый кеш
+    std::vector<uint32_t> threadsCounts;
+    uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    threadsCounts.push_back(1);
+    for (uint32_t threads = 1; threads < hardwareThreads; ) {
+        threads = std::min(threads * 2, hardwareThreads);
+        threadsCounts.push_back(threads);
+    }
+    
+    VulkanTextureBatchLoaderPtr warmupLoader = std::make_shared<VulkanTextureBatchLoader>(vulkanLogicalDevice, vulkanRenderQueue, vulkanRenderCommandPool);
+    warmupLoader->loadTextures(paths);
+    warmupLoader = nullptr;
+    
+    double singleThreadSpeed = 0.0;
+    for (uint32_t threadsCount: threadsCounts) {
+        VulkanTextureBatchLoaderPtr loader = std::make_shared<VulkanTextureBatchLoader>(vulkanLogicalDevice, vulkanRenderQueue, vulkanRenderCommandPool, threadsCount);
+        loader->loadTextures(paths);
+        loader->printStats();
+        
+        VulkanTextureBatchStats stats = loader->getLastStats();
+        double speed = (stats.totalTime > 0.0) ? (double(stats.decodedBytes) / (1024.0 * 1024.0)) / stats.totalTime : 0.0;
+        if (threadsCount == 1) {
+            singleThreadSpeed = speed;
+        }
+        LOG("-> %d threads: %.0f MB/s decoded, scaling x%.2f\n", (int)threadsCount, speed, (singleThreadSpeed > 0.0) ? speed / singleThreadSpeed : 0.0);
+    }
+}
+
+// Уровень 0 заливается шумом заново перед каждым замером, время копирования в замер не входит
+void VulkanRender::runMipBenchmark(){
+    if ((vulkanPhysicalDevice->getDeviceProperties().limits.timestampComputeAndGraphics == VK_FALSE) ||
+        (vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits == 0)) {
+        LOG("Mip benchmark: timestamps are not supported\n");
+        return;
+    }
+    
+    VulkanMipGeneratorPtr mipGenerator = std::make_shared<VulkanMipGenerator>(vulkanLogicalDevice, vulkanRenderQueue, "res/shaders/mip_downsample_comp.spv");
+    
+    VulkanQueryPoolTimeStamp queryConfig;
+    queryConfig.testCount = 2 * 2;  // Блиты + compute
+    VulkanQueryPoolPtr queryPool = std::make_shared<VulkanQueryPool>(vulkanLogicalDevice, queryConfig);
+    
+    float period = vulkanPhysicalDevice->getDeviceProperties().limits.timestampPeriod;
+    uint32_t validBitscount = vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits;
+    uint64_t maskValue = (validBitscount >= 64) ? ~0ULL : ((1ULL << validBitscount) - 1);
+    
+    VkExtent2D size = {MIP_BENCHMARK_SIZE, MIP_BENCHMARK_SIZE};
+    VkDeviceSize levelSize = (VkDeviceSize)size.width * size.height * 4;
+    VulkanBufferPtr stagingBuffer = std::make_shared<VulkanBuffer>(vulkanLogicalDevice,
+                                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                   levelSize);
+    uint32_t* stagingData = (uint32_t*)stagingBuffer->map(levelSize);
+    uint32_t seed = 12345;
+    for (VkDeviceSize i = 0; i < levelSize / 4; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        stagingData[i] = seed;
+    }
+    stagingBuffer->unmap();
+    
+    std::vector<VkBufferImageCopy> regions;
+    makePackedCopyRegions(VK_FORMAT_R8G8B8A8_UNORM, size, 1, 1, regions);
+    uint32_t levelsCount = (uint32_t)floor(log2(std::max(size.width, size.height))) + 1;
+    
+    std::vector<VkFormat> formats = {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB};
+    for (VkFormat format: formats) {
+        VulkanImagePtr image = std::make_shared<VulkanImage>(vulkanLogicalDevice,
+                                                             size,
+                                                             format,
+                                                             VK_IMAGE_TILING_OPTIMAL,
+                                                             VK_IMAGE_LAYOUT_UNDEFINED,
+                                                             mipGenerator->getImageUsage(format),
+                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                             levelsCount,
+                                                             VK_SAMPLE_COUNT_1_BIT,
+                                                             mipGenerator->getImageFlags(format));
+        bool computeSupported = mipGenerator->isComputeSupported(image);
+        
+        double blitTime = 0.0;
+        double computeTime = 0.0;
+        for (uint32_t i = 0; i < MIP_BENCHMARK_ITERATIONS; i++) {
+            VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(vulkanLogicalDevice, vulkanRenderCommandPool);
+            queryPool->resetPool(commandBuffer, 0, queryConfig.testCount);
+            
+            // Цепочка блитов
+            transitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, levelsCount,
+                                  VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+            commandBuffer->cmdCopyBufferToImage(stagingBuffer, image, regions);
+            commandBuffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+            generateMipmapsForImage(commandBuffer, image);
+            commandBuffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+            
+            // Compute, если формат или устройство не подходят - те же блиты
+            transitionImageLayout(commandBuffer, image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, levelsCount,
+                                  VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+            commandBuffer->cmdCopyBufferToImage(stagingBuffer, image, regions);
+            commandBuffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 2);
+            mipGenerator->generateMips(commandBuffer, image);
+            commandBuffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 3);
+            endAndQueueWaitSingleTimeCommands(commandBuffer, vulkanRenderQueue);
+            
+            // Первый проход - прогрев
+            std::vector<uint64_t> results = queryPool->getPoolTimeStampResults();
+            if (i > 0) {
+                blitTime += (((results[1] & maskValue) - (results[0] & maskValue)) * period) / 1000.0;
+                computeTime += (((results[3] & maskValue) - (results[2] & maskValue)) * period) / 1000.0;
+            }
+        }
+        blitTime /= (MIP_BENCHMARK_ITERATIONS - 1);
+        computeTime /= (MIP_BENCHMARK_ITERATIONS - 1);
+        
+        LOG("Mip benchmark %dx%d %s, %d levels: blit chain %.1f microSec, %s %.1f microSec, x%.2f\n",
+            (int)size.width, (int)size.height, (format == VK_FORMAT_R8G8B8A8_SRGB) ? "sRGB" : "UNORM", (int)levelsCount,
+            blitTime, computeSupported ? "compute" : "blit fallback", computeTime, (computeTime > 0.0) ? blitTime / computeTime : 0.0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Замер скорости обновления наборов дескрипторов: обычный путь против шаблона обновления
+void VulkanRender::runDescriptorBenchmark(){
+    // Отдельный набор, чтобы не трогать наборы из кеша
+    VulkanDescriptorAllocatorPtr allocator = std::make_shared<VulkanDescriptorAllocator>(vulkanLogicalDevice);
+    VulkanDescriptorSetPtr set = allocator->allocateSet(modelDescriptorSetLayout);
+    
+    // Обычный путь - вектор VkWriteDescriptorSet строится на каждом вызове
+    std::chrono::high_resolution_clock::time_point configsBegin = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS; i++) {
+        VulkanDescriptorSetUpdateConfig vertexBufferSet;
+        vertexBufferSet.binding = 0;
+        vertexBufferSet.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        vertexBufferSet.bufferInfo.buffer = modelUniformGPUBuffer;
+        vertexBufferSet.bufferInfo.offset = 0;
+        vertexBufferSet.bufferInfo.range = sizeof(ModelUniformBuffer);
+        
+        VulkanDescriptorSetUpdateConfig samplerSet;
+        samplerSet.binding = 1;
+        samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        samplerSet.imageInfo.imageView = modelTextureImageView;
+        samplerSet.imageInfo.sampler = modelTextureSampler;
+        
+        std::vector<VulkanDescriptorSetUpdateConfig> configs;
+        configs.push_back(vertexBufferSet);
+        configs.push_back(samplerSet);
+        set->updateDescriptorSet(configs);
+    }
+    std::chrono::high_resolution_clock::time_point configsEnd = std::chrono::high_resolution_clock::now();
+    double configsSeconds = std::chrono::duration_cast<std::chrono::microseconds>(configsEnd - configsBegin).count() / 1000000.0;
+    
+    // Без расширения сравнивать не с чем
+    if (descriptorUpdateTemplateSupported == false) {
+        LOG("Descriptor updates (%d iterations): configs %.0f updates/sec, template not supported\n",
+            DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS,
+            DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS / std::max(configsSeconds, 0.000001));
+        return;
+    }
+    
+    // Шаблон создается один раз на лэйаут, дальше обновление одним вызовом из POD структуры
+    VulkanDescriptorUpdateTemplatePtr updateTemplate = std::make_shared<VulkanDescriptorUpdateTemplate>(vulkanLogicalDevice, modelDescriptorSetLayout);
+    if (updateTemplate->getDataSize() != sizeof(ModelDescriptorsTemplateData)) {
+        LOG("Invalid descriptor update template data size!\n");
+        throw std::runtime_error("Invalid descriptor update template data size!");
+    }
+    
+    std::chrono::high_resolution_clock::time_point templateBegin = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS; i++) {
+        ModelDescriptorsTemplateData data;
+        data.uniformBuffer.buffer = modelUniformGPUBuffer->getBuffer();
+        data.uniformBuffer.offset = 0;
+        data.uniformBuffer.range = sizeof(ModelUniformBuffer);
+        data.texture.sampler = modelTextureSampler->getSampler();
+        data.texture.imageView = modelTextureImageView->getImageView();
+        data.texture.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        set->updateDescriptorSet(updateTemplate, &data);
+    }
+    std::chrono::high_resolution_clock::time_point templateEnd = std::chrono::high_resolution_clock::now();
+    
+    double templateSeconds = std::chrono::duration_cast<std::chrono::microseconds>(templateEnd - templateBegin).count() / 1000000.0;
+    LOG("Descriptor updates (%d iterations): configs %.0f updates/sec, template %.0f updates/sec\n",
+        DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS,
+        DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS / std::max(configsSeconds, 0.000001),
+        DESCRIPTOR_UPDATE_BENCHMARK_ITERATIONS / std::max(templateSeconds, 0.000001));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Кольца загрузки и приемник для замера потоковой загрузки
+void VulkanRender::createStreamingResources(){
+    if ((settings.streamingChunkSizeMB == 0) || (settings.streamingChunkSizeMB > settings.streamingTargetSizeMB)) {
+        LOG("Streaming: invalid chunk size %dMB for target %dMB\n", (int)settings.streamingChunkSizeMB, (int)settings.streamingTargetSizeMB);
+        return;
+    }
+    
+    streamingTargetBuffer = std::make_shared<VulkanBuffer>(vulkanLogicalDevice,
+                                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                           (VkDeviceSize)settings.streamingTargetSizeMB * 1024 * 1024);
+    
+    // Данные не важны, главное - объем
+    streamingChunkData.resize((size_t)settings.streamingChunkSizeMB * 1024 * 1024);
+    for (size_t i = 0; i < streamingChunkData.size(); i++) {
+        streamingChunkData[i] = static_cast<unsigned char>(i * 31);
+    }
+    
+    streamingWaitSemaphores.resize(vulkanSwapchain->getImageViews().size());
+    streamingWaitStages.resize(vulkanSwapchain->getImageViews().size());
+    
+    VulkanQueuePtr transferQueue = vulkanLogicalDevice->getTransferQueue();
+    if (transferQueue) {
+        streamingTransferRing = std::make_shared<VulkanStagingRing>(vulkanLogicalDevice, transferQueue, vulkanRenderQueue);
+    }else{
+        LOG("No dedicated transfer queue family, streaming only through render queue\n");
+    }
+    streamingRenderRing = std::make_shared<VulkanStagingRing>(vulkanLogicalDevice, nullptr, vulkanRenderQueue);
+    
+    streamingActiveRing = streamingTransferRing ? streamingTransferRing : streamingRenderRing;
+    streamingLastFrameTime = std::chrono::high_resolution_clock::now();
+}
+
+// Загружаем очередной кусок данных и считаем время кадра
+void VulkanRender::updateStreaming(){
+    if (streamingActiveRing == nullptr) {
+        return;
+    }
+    
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    streamingFrameTimes.push_back((double)std::chrono::duration_cast<std::chrono::microseconds>(now - streamingLastFrameTime).count() / 1000.0);
+    streamingLastFrameTime = now;
+    
+    // Освобождаем место от завершенных копирований
+    streamingActiveRing->update();
+    
+    if (streamingPhaseBytes >= (uint64_t)settings.streamingTotalSizeMB * 1024 * 1024) {
+        finishStreamingPhase();
+        return;
+    }
+    
+    VkDeviceSize chunkSize = streamingChunkData.size();
+    if ((streamingTargetOffset + chunkSize) > streamingTargetBuffer->getBaseSize()) {
+        streamingTargetOffset = 0;
+    }
+    streamingActiveRing->uploadBuffer(streamingTargetBuffer, streamingChunkData.data(), chunkSize, streamingTargetOffset,
+                                      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+    streamingActiveRing->flush();
+    
+    streamingTargetOffset += chunkSize;
+    streamingPhaseBytes += chunkSize;
+}
+
+// Выводим разброс времени кадра и переходим к следующему способу загрузки
+void VulkanRender::finishStreamingPhase(){
+    // Первый интервал захватывает инициализацию
+    if (streamingFrameTimes.size() > 1) {
+        streamingFrameTimes.erase(streamingFrameTimes.begin());
+    }
+    
+    double mean = std::accumulate(streamingFrameTimes.begin(), streamingFrameTimes.end(), 0.0) / streamingFrameTimes.size();
+    double variance = 0.0;
+    for (size_t i = 0; i < streamingFrameTimes.size(); i++) {
+        variance += (streamingFrameTimes[i] - mean) * (streamingFrameTimes[i] - mean);
+    }
+    variance /= streamingFrameTimes.size();
+    
+    std::vector<double> sorted = streamingFrameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double p99 = sorted[std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99))];
+    
+    LOG("Streaming %dMB through %s: %d frames, frame time mean %.2fms, stddev %.2fms, p99 %.2fms, max %.2fms\n",
+        (int)settings.streamingTotalSizeMB, streamingActiveRing->isOwnershipTransfer() ? "dedicated transfer queue" : "render queue",
+        (int)streamingFrameTimes.size(), mean, std::sqrt(variance), p99, sorted.back());
+    streamingActiveRing->printStats();
+    
+    streamingFrameTimes.clear();
+    streamingPhaseBytes = 0;
+    streamingTargetOffset = 0;
+    
+    // После выделенной очереди замеряем загрузку через очередь отрисовки
+    streamingActiveRing->waitIdle();
+    if (streamingActiveRing == streamingTransferRing) {
+        streamingActiveRing = streamingRenderRing;
+        streamingLastFrameTime = std::chrono::high_resolution_clock::now();
+    }else{
+        streamingActiveRing = nullptr;
+    }
+}
@@ -5,6 +5,7 @@
 #endif
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
 #include <iostream>
@@ -60,8 +61,76 @@ int local_main(int argc, char** argv) {
         throw std::runtime_error("Vulkan support not found!");
     }
 
+    // Настройки, влияющие на создание рендера: --post-subpass, --sync-pipelines, --no-memory-stats,
+    // --tone-map <0-2>, --blur-radius <n>, --pipeline-variants <n>, --texture-budget-mb <n>,
+    // --streaming-total-mb <n>, --streaming-chunk-mb <n>, --streaming-target-mb <n>
+    VulkanRenderSettings settings;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--post-subpass") == 0) {
+            settings.postUseSubpass = true;
+        }else if (strcmp(argv[i], "--sync-pipelines") == 0) {
+            settings.pipelineCompileAsync = false;
+        }else if (strcmp(argv[i], "--no-memory-stats") == 0) {
+            settings.printMemoryStats = false;
+        }else if (i + 1 < argc) {
+            // Дальше только настройки со значением
+            int value = std::max(atoi(argv[i + 1]), 0);
+            if (strcmp(argv[i], "--tone-map") == 0) {
+                settings.postToneMapMode = std::min(value, 2);
+            }else if (strcmp(argv[i], "--blur-radius") == 0) {
+                settings.postBlurRadius = value;
+            }else if (strcmp(argv[i], "--pipeline-variants") == 0) {
+                settings.pipelineVariantsCount = std::max(value, 1);
+            }else if (strcmp(argv[i], "--texture-budget-mb") == 0) {
+                settings.textureStreamingBudgetMB = value;
+            }else if (strcmp(argv[i], "--streaming-total-mb") == 0) {
+                settings.streamingTotalSizeMB = value;
+            }else if (strcmp(argv[i], "--streaming-chunk-mb") == 0) {
+                settings.streamingChunkSizeMB = value;
+            }else if (strcmp(argv[i], "--streaming-target-mb") == 0) {
+                settings.streamingTargetSizeMB = value;
+            }else{
+                continue;
+            }
+            i++;
+        }
+    }
+
     // Создаем рендер
-    VulkanRender::initInstance(window);    
+    VulkanRender::initInstance(window, settings);    
+    
+    // Режим замера загрузки текстур: --texture-benchmark <папка с картинками>
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--texture-benchmark") == 0) {
+            VulkanRender::getInstance()->runTextureBenchmark(argv[i + 1]);
+            VulkanRender::destroyRender();
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 0;
+        }
+    }
+    
+    // Замер генерации мипмапов: --mip-benchmark
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mip-benchmark") == 0) {
+            VulkanRender::getInstance()->runMipBenchmark();
+            VulkanRender::destroyRender();
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 0;
+        }
+    }
+    
+    // Замер обновления наборов дескрипторов: --descriptor-benchmark
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--descriptor-benchmark") == 0) {
+            VulkanRender::getInstance()->runDescriptorBenchmark();
+            VulkanRender::destroyRender();
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 0;
+        }
+    }
     
     // Цикл обработки графики
     std::chrono::high_resolution_clock::time_point lastDrawTime = std::chrono::high_resolution_clock::now();
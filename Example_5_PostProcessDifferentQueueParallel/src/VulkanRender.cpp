@@ -3,6 +3,7 @@
 #include <limits>
 #include <numeric>
 #include <cmath>
+#include <algorithm>
 #include <Helpers.h>
 
 // TinyObj
@@ -23,6 +24,20 @@
 #define TARGET_FBO_TEXTURE_WIDTH 1024
 #define TARGET_FBO_TEXTURE_HEIGHT 768
 
+// Количество слотов кадров: геометрия кадра N+1 рисуется в другой слот, пока считается пост-эффект кадра N
+#define POST_FRAMES_COUNT 2
+// Размер рабочей группы вычислительного шейдера (local_size_x/y в post_shader.comp)
+#define POST_COMPUTE_GROUP_SIZE 16
+
+// Таймстампы одного кадра, в пуле идут блоками по слотам кадров
+#define POST_TIMESTAMPS_PER_FRAME 6
+#define TIMESTAMP_GEOMETRY_BEGIN 0
+#define TIMESTAMP_GEOMETRY_END 1
+#define TIMESTAMP_COMPUTE_BEGIN 2
+#define TIMESTAMP_COMPUTE_END 3
+#define TIMESTAMP_COMPOSE_BEGIN 4
+#define TIMESTAMP_COMPOSE_END 5
+
 static VulkanRender* renderInstance = nullptr;
 
 void VulkanRender::initInstance(GLFWwindow* window){
@@ -50,6 +65,9 @@ VulkanRender::VulkanRender(){
 	totalTime = 0.0f;
     rotateAngle = 0.0f;
     vulkanImageIndex = 0;
+    vulkanComputeOwnershipTransfer = false;
+    computeTimeStampsEnabled = false;
+    postFrameIndex = 0;
 }
 
 void VulkanRender::init(GLFWwindow* window){
@@ -58,8 +76,8 @@ void VulkanRender::init(GLFWwindow* window){
     
     ////////////////////////////////////////////////////////////////////////////////
     
-    // Создаем картинки для отрисовки в текстуру
-    createPostImageAndView();
+    // Создаем картинки для отрисовки в текстуру и для результата вычислений
+    createPostImagesAndViews();
     
     // Создаем текстуры для буффера глубины
     createPostDepthResources();
@@ -67,8 +85,8 @@ void VulkanRender::init(GLFWwindow* window){
     // Создаем рендер проход
     createRenderToPostRenderPass();
     
-    // Создаем фреймбуффер для отрисовки в текстуру
-    createPostFrameBuffer();
+    // Создаем фреймбуфферы для отрисовки в текстуру
+    createPostFrameBuffers();
     
     // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
     createPostDescriptorsSetLayout();
@@ -91,8 +109,15 @@ void VulkanRender::init(GLFWwindow* window){
     // Создаем пул дескрипторов ресурсов
     createPostRenderDescriptorPool();
     
-    // Создаем набор дескрипторов ресурсов
-    createPostRenderDescriptorSet();
+    // Создаем наборы дескрипторов ресурсов
+    createPostRenderDescriptorSets();
+    
+    // Вычислительный проход пост-эффекта
+    createPostComputeDescriptorsSetLayout();
+    loadPostComputeShader();
+    createPostComputePipeline();
+    createPostComputeDescriptorPool();
+    createPostComputeDescriptorSets();
     
     ////////////////////////////////////////////////////////////////////////////////
     
@@ -151,6 +176,7 @@ void VulkanRender::rebuildRendering(){
     // Ждем завершения работы Vulkan
     vulkanRenderQueue1->wait();
     vulkanRenderQueue2->wait();
+    vulkanComputeQueue->wait();
     vulkanPresentQueue->wait();
     vulkanLogicalDevice->wait();
     
@@ -176,8 +202,8 @@ void VulkanRender::rebuildRendering(){
 	// Создаем пул дескрипторов ресурсов
 	createPostRenderDescriptorPool();
     
-    // Создаем набор дескрипторов ресурсов
-	createPostRenderDescriptorSet();
+    // Создаем наборы дескрипторов ресурсов
+	createPostRenderDescriptorSets();
     
     // Создаем коммандные буфферы отрисовки модели
     resetCommandBuffers();
@@ -186,28 +212,77 @@ void VulkanRender::rebuildRendering(){
     vulkanImageIndex = 0;
 }
 
+// Маска валидных бит таймстампа
+static uint64_t timeStampMask(uint32_t validBitsCount){
+    if (validBitsCount >= 64) {
+        return ~0ULL;
+    }
+    return (1ULL << validBitsCount) - 1;
+}
+
+// Таймстамп в микросекундах относительно начала отсчета
+static double timeStampToMicroSec(uint64_t value, uint64_t origin, float period){
+    return (double(int64_t(value - origin)) * period) / 1000.0;
+}
+
 // Вывести статы GPU
 void VulkanRender::printGPUStats(){
-    if (vulkanTimeStampQueryPool) {
-        // Подождем пока сформируется таймстамп
-        //vulkanLogicalDevice->wait();
+    // Нужны два последних кадра: N и N+1
+    if (vulkanTimeStampQueryPool && (postFrameIndex >= POST_FRAMES_COUNT)) {
+        // Подождем пока сформируются таймстампы
         vulkanRenderQueue1->wait();
         vulkanRenderQueue2->wait();
+        vulkanComputeQueue->wait();
         
+        VulkanQueuesFamiliesIndexes families = vulkanPhysicalDevice->getQueuesFamiliesIndexes();
         float period = vulkanPhysicalDevice->getDeviceProperties().limits.timestampPeriod;
-        uint32_t validBitscount = vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits;
-        uint64_t maskValue = 0;
-        for (uint32_t i = 0; i < validBitscount; i++){
-            maskValue |= 1 << i;
+        uint64_t renderMask = timeStampMask(families.renderQueuesTimeStampValidBits);
+        uint64_t computeMask = vulkanComputeOwnershipTransfer ? timeStampMask(families.computeQueuesTimeStampValidBits) : renderMask;
+        
+        // Очереди уже простаивают, ждать не нужно. Незаписанные запросы остаются нулями
+        std::vector<uint64_t> testResults = vulkanTimeStampQueryPool->getPoolTimeStampResults((VkQueryResultFlagBits)0);
+        
+        uint32_t slots[2] = {
+            (postFrameIndex - 2) % POST_FRAMES_COUNT,
+            (postFrameIndex - 1) % POST_FRAMES_COUNT
+        };
+        const char* framesNames[2] = {"N  ", "N+1"};
+        uint64_t origin = testResults[slots[0] * POST_TIMESTAMPS_PER_FRAME + TIMESTAMP_GEOMETRY_BEGIN] & renderMask;
+        
+        // Таймстампы разных очередей одного устройства в общем домене времени
+        LOG("GPU timeline (period %f, post process on %s), microSec from frame N geometry begin: \n",
+            period, vulkanComputeOwnershipTransfer ? "async compute queue" : "second render queue");
+        double frameTimes[2][POST_TIMESTAMPS_PER_FRAME];
+        for (size_t i = 0; i < 2; i++) {
+            uint32_t base = slots[i] * POST_TIMESTAMPS_PER_FRAME;
+            for (uint32_t j = 0; j < POST_TIMESTAMPS_PER_FRAME; j++) {
+                bool computeTimeStamp = (j == TIMESTAMP_COMPUTE_BEGIN) || (j == TIMESTAMP_COMPUTE_END);
+                uint64_t mask = computeTimeStamp ? computeMask : renderMask;
+                frameTimes[i][j] = timeStampToMicroSec(testResults[base + j] & mask, origin, period);
+            }
+            
+            if (computeTimeStampsEnabled) {
+                LOG("-> frame %s: geometry %.0f - %.0f, compute %.0f - %.0f, compose %.0f - %.0f\n", framesNames[i],
+                    frameTimes[i][TIMESTAMP_GEOMETRY_BEGIN], frameTimes[i][TIMESTAMP_GEOMETRY_END],
+                    frameTimes[i][TIMESTAMP_COMPUTE_BEGIN], frameTimes[i][TIMESTAMP_COMPUTE_END],
+                    frameTimes[i][TIMESTAMP_COMPOSE_BEGIN], frameTimes[i][TIMESTAMP_COMPOSE_END]);
+            }else{
+                LOG("-> frame %s: geometry %.0f - %.0f, compute -, compose %.0f - %.0f\n", framesNames[i],
+                    frameTimes[i][TIMESTAMP_GEOMETRY_BEGIN], frameTimes[i][TIMESTAMP_GEOMETRY_END],
+                    frameTimes[i][TIMESTAMP_COMPOSE_BEGIN], frameTimes[i][TIMESTAMP_COMPOSE_END]);
+            }
         }
-        LOG("Timestamp infos (period %f, bitsCount %d): \n", period, validBitscount);
         
-        std::vector<uint64_t> testResults = vulkanTimeStampQueryPool->getPoolTimeStampResults();
-        for (size_t i = 0; i < testResults.size(); i += 2) {
-            uint64_t val1 = testResults[i] & maskValue;
-            uint64_t val2 = testResults[i+1] & maskValue;
-            double microsecondsValue = ((val2 - val1) * period) / 1000.0;
-            LOG("-> %d-%d: %.0f microSec\n", (int)i, (int)i + 1, microsecondsValue);
+        // Пересечение вычислений кадра N с геометрией кадра N+1
+        if (computeTimeStampsEnabled) {
+            double computeDuration = frameTimes[0][TIMESTAMP_COMPUTE_END] - frameTimes[0][TIMESTAMP_COMPUTE_BEGIN];
+            double overlapBegin = std::max(frameTimes[0][TIMESTAMP_COMPUTE_BEGIN], frameTimes[1][TIMESTAMP_GEOMETRY_BEGIN]);
+            double overlapEnd = std::min(frameTimes[0][TIMESTAMP_COMPUTE_END], frameTimes[1][TIMESTAMP_GEOMETRY_END]);
+            double overlap = std::max(overlapEnd - overlapBegin, 0.0);
+            double overlapPercent = (computeDuration > 0.0) ? (overlap / computeDuration) * 100.0 : 0.0;
+            LOG("-> compute N overlaps geometry N+1: %.0f microSec (%.0f%% of compute %.0f microSec)\n", overlap, overlapPercent, computeDuration);
+        }else{
+            LOG("-> compute queue family has no timestamps, overlap is not measured\n");
         }
         
         LOG("\n");
@@ -245,11 +320,29 @@ void VulkanRender::createSharedVulkanObjects(GLFWwindow* window){
     vulkanRenderQueue2 = vulkanLogicalDevice->getRenderQueues()[1];      // Получаем очередь рендеринга
     vulkanPresentQueue = vulkanLogicalDevice->getPresentQueue();    // Получаем очередь отрисовки
     
+    // Пост-эффект считаем в асинхронной очереди вычислений, если ее нету - во второй очереди отрисовки
+    int32_t computeFamilyIndex = vulkanQueuesFamiliesIndexes.renderQueuesFamilyIndex;
+    vulkanComputeQueue = vulkanLogicalDevice->getComputeQueue();
+    if (vulkanComputeQueue) {
+        computeFamilyIndex = vulkanQueuesFamiliesIndexes.computeQueuesFamilyIndex;
+        vulkanComputeOwnershipTransfer = true;
+        LOG("Post process runs on async compute queue family %d\n", computeFamilyIndex);
+    }else{
+        vulkanComputeQueue = vulkanRenderQueue2;
+        vulkanComputeOwnershipTransfer = false;
+        LOG("No async compute queue, post process runs on second render queue\n");
+    }
+    
     // Создаем семафоры для отображения и ренедринга
     vulkanImageAvailableSemaphore = std::make_shared<VulkanSemafore>(vulkanLogicalDevice);
-    vulkanModelRenderFinishedSemaphore = std::make_shared<VulkanSemafore>(vulkanLogicalDevice);
     vulkanPostRenderFinishedSemaphoreSwapchain = std::make_shared<VulkanSemafore>(vulkanLogicalDevice);
-    vulkanPostRenderFinishedSemaphoreModel = std::make_shared<VulkanSemafore>(vulkanLogicalDevice);
+    for (size_t i = 0; i < POST_FRAMES_COUNT; i++) {
+        vulkanGeometryFinishedSemaphores.push_back(std::make_shared<VulkanSemafore>(vulkanLogicalDevice));
+        vulkanComputeFinishedSemaphores.push_back(std::make_shared<VulkanSemafore>(vulkanLogicalDevice));
+        vulkanComputeToGeometrySemaphores.push_back(std::make_shared<VulkanSemafore>(vulkanLogicalDevice));
+        vulkanComposeToComputeSemaphores.push_back(std::make_shared<VulkanSemafore>(vulkanLogicalDevice));
+    }
+    postFrameSlotsUsed.resize(POST_FRAMES_COUNT, false);
     
     // Создаем свопчейн + получаем изображения свопчейна
     vulkanSwapchain = std::make_shared<VulkanSwapchain>(vulkanWindowSurface, vulkanLogicalDevice, vulkanQueuesFamiliesIndexes, vulkanSwapchainSuppportDetails, nullptr);
@@ -257,18 +350,22 @@ void VulkanRender::createSharedVulkanObjects(GLFWwindow* window){
     // Создаем барьеры для защиты от переполнения очереди заданий рендеринга
     vulkanRenderFences1.reserve(vulkanSwapchain->getImageViews().size());
     vulkanRenderFences2.reserve(vulkanSwapchain->getImageViews().size());
+    vulkanComputeFences.reserve(vulkanSwapchain->getImageViews().size());
     vulkanPresentFences.reserve(vulkanSwapchain->getImageViews().size());
     for (size_t i = 0; i < vulkanSwapchain->getImageViews().size(); i++) {
         VulkanFencePtr renderFence1 = std::make_shared<VulkanFence>(vulkanLogicalDevice, true);
         vulkanRenderFences1.push_back(renderFence1);
         VulkanFencePtr renderFence2 = std::make_shared<VulkanFence>(vulkanLogicalDevice, true);
         vulkanRenderFences2.push_back(renderFence2);
+        VulkanFencePtr computeFence = std::make_shared<VulkanFence>(vulkanLogicalDevice, true);
+        vulkanComputeFences.push_back(computeFence);
         VulkanFencePtr presentFence = std::make_shared<VulkanFence>(vulkanLogicalDevice, false);
         vulkanPresentFences.push_back(presentFence);
     }
     
     // Создаем пулл комманд для отрисовки
     vulkanRenderCommandPool = std::make_shared<VulkanCommandPool>(vulkanLogicalDevice, vulkanQueuesFamiliesIndexes.renderQueuesFamilyIndex);
+    vulkanComputeCommandPool = std::make_shared<VulkanCommandPool>(vulkanLogicalDevice, computeFamilyIndex);
     
     // Создание рендер прохода
     createRenderToWindowsRenderPass();
@@ -295,28 +392,47 @@ void VulkanRender::createQueryPool(){
     if (vulkanPhysicalDevice->getDeviceProperties().limits.timestampComputeAndGraphics &&
         (vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits > 0)) {
         VulkanQueryPoolTimeStamp config;
-        config.testCount = 1 * 2;
+        config.testCount = POST_FRAMES_COUNT * POST_TIMESTAMPS_PER_FRAME;
         vulkanTimeStampQueryPool = std::make_shared<VulkanQueryPool>(vulkanLogicalDevice, config);
+        
+        // Семейство вычислений может не поддерживать таймстампы
+        if (vulkanComputeOwnershipTransfer) {
+            computeTimeStampsEnabled = (vulkanPhysicalDevice->getQueuesFamiliesIndexes().computeQueuesTimeStampValidBits > 0);
+        }else{
+            computeTimeStampsEnabled = true;
+        }
     }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Создаем картинки для отрисовки в текстуру
-void VulkanRender::createPostImageAndView(){
-    // Изображение
-    postImage = std::make_shared<VulkanImage>(vulkanLogicalDevice,
-                                              //vulkanSwapchain->getSwapChainExtent().width, vulkanSwapchain->getSwapChainExtent().height,
-                                              VkExtent2D{TARGET_FBO_TEXTURE_WIDTH, TARGET_FBO_TEXTURE_HEIGHT},
-                                              VK_FORMAT_R8G8B8A8_UNORM,
-                                              VK_IMAGE_TILING_OPTIMAL,
-                                              VK_IMAGE_LAYOUT_UNDEFINED,
-                                              VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                              1);
-    
-    //  Вьюшка
-    postImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice, postImage, VK_IMAGE_ASPECT_COLOR_BIT);
+// Создаем картинки для отрисовки в текстуру и для результата вычислений
+void VulkanRender::createPostImagesAndViews(){
+    for (size_t i = 0; i < POST_FRAMES_COUNT; i++) {
+        // Изображение для геометрии
+        VulkanImagePtr image = std::make_shared<VulkanImage>(vulkanLogicalDevice,
+                                                             VkExtent2D{TARGET_FBO_TEXTURE_WIDTH, TARGET_FBO_TEXTURE_HEIGHT},
+                                                             VK_FORMAT_R8G8B8A8_UNORM,
+                                                             VK_IMAGE_TILING_OPTIMAL,
+                                                             VK_IMAGE_LAYOUT_UNDEFINED,
+                                                             VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                             1);
+        postImages.push_back(image);
+        postImageViews.push_back(std::make_shared<VulkanImageView>(vulkanLogicalDevice, image, VK_IMAGE_ASPECT_COLOR_BIT));
+        
+        // Результат вычислительного прохода, пишется как storage картинка в лаяуте GENERAL
+        VulkanImagePtr computeImage = std::make_shared<VulkanImage>(vulkanLogicalDevice,
+                                                                    VkExtent2D{TARGET_FBO_TEXTURE_WIDTH, TARGET_FBO_TEXTURE_HEIGHT},
+                                                                    VK_FORMAT_R8G8B8A8_UNORM,
+                                                                    VK_IMAGE_TILING_OPTIMAL,
+                                                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                                                    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+                                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                                    1);
+        postComputeImages.push_back(computeImage);
+        postComputeImageViews.push_back(std::make_shared<VulkanImageView>(vulkanLogicalDevice, computeImage, VK_IMAGE_ASPECT_COLOR_BIT));
+    }
 }
 
 // Создаем буфферы для глубины
@@ -372,11 +488,12 @@ void VulkanRender::createPostDepthResources() {
 // Создание рендер прохода
 void VulkanRender::createRenderToPostRenderPass(){
     VulkanRenderPassConfig imageConfig;
-    imageConfig.format = postImage->getBaseFormat();
+    imageConfig.format = postImages[0]->getBaseFormat();
     imageConfig.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;   // Чистим цвет
     imageConfig.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Сохраняем для отрисовки
     imageConfig.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageConfig.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;	// В каком лаяуте будет изображение после завершения рендер прохода
+    // Перевод в SHADER_READ_ONLY делается барьером после прохода вместе с передачей владения в очередь вычислений
+    imageConfig.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     imageConfig.refLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     VulkanRenderPassConfig depthConfig;
     depthConfig.format = postDepthImage->getBaseFormat();
@@ -388,16 +505,20 @@ void VulkanRender::createRenderToPostRenderPass(){
     postRenderToRenderPass = std::make_shared<VulkanRenderPass>(vulkanLogicalDevice, imageConfig, depthConfig);
 }
 
-// Создаем фреймбуффер для отрисовки в текстуру
-void VulkanRender::createPostFrameBuffer(){
-    // Вьюшка текстуры отображения + глубины
-    std::vector<VulkanImageViewPtr> views;
-    views.push_back(postImageView);
-    views.push_back(postDepthImageView);
-    postFrameBuffer = std::make_shared<VulkanFrameBuffer>(vulkanLogicalDevice,
-                                                          postRenderToRenderPass,
-                                                          views,
-                                                          postImage->getBaseSize());
+// Создаем фреймбуфферы для отрисовки в текстуру
+void VulkanRender::createPostFrameBuffers(){
+    // Глубина общая: проходы геометрии идут в одной очереди друг за другом
+    for (size_t i = 0; i < POST_FRAMES_COUNT; i++) {
+        // Вьюшка текстуры отображения + глубины
+        std::vector<VulkanImageViewPtr> views;
+        views.push_back(postImageViews[i]);
+        views.push_back(postDepthImageView);
+        VulkanFrameBufferPtr frameBuffer = std::make_shared<VulkanFrameBuffer>(vulkanLogicalDevice,
+                                                                               postRenderToRenderPass,
+                                                                               views,
+                                                                               postImages[i]->getBaseSize());
+        postFrameBuffers.push_back(frameBuffer);
+    }
 }
 
 // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
@@ -465,20 +586,18 @@ void VulkanRender::createPostGraphicsPipeline() {
     blendConfig.srcFactor = VK_BLEND_FACTOR_SRC_ALPHA;
     blendConfig.dstFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     
-    // Push константы
+    // Push константы не нужны - эффект уже посчитан в вычислительном проходе
     std::vector<VkPushConstantRange> pushConstants;
-    VkPushConstantRange pushConstantRange = {};
-    memset(&pushConstantRange, 0, sizeof(VkPushConstantRange));
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(float);
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    pushConstants.push_back(pushConstantRange);
     
     // Динамически изменяемые параметры
     std::vector<VkDynamicState> dynamicStates;
     //dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
     //dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
     
+    // Лэйауты наборов дескрипторов
+    std::vector<VulkanDescriptorSetLayoutPtr> layouts;
+    layouts.push_back(postDescriptorSetLayout);
+    
     // Пайплайн
     postPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
                                                     postVertexModule, postFragmentModule,
@@ -490,7 +609,7 @@ void VulkanRender::createPostGraphicsPipeline() {
                                                     scissor,
                                                     cullingConfig,
                                                     blendConfig,
-                                                    postDescriptorSetLayout,
+                                                    layouts,
                                                     vulkanRenderToWindowRenderPass,
                                                     pushConstants,
                                                     dynamicStates);
@@ -516,26 +635,115 @@ void VulkanRender::createPostRenderDescriptorPool() {
     poolSizes.resize(1);
     // Семплер для текстуры
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 1;
+    poolSizes[0].descriptorCount = POST_FRAMES_COUNT;
     
     // Создаем пул
-    postDescriptorPool = std::make_shared<VulkanDescriptorPool>(vulkanLogicalDevice, poolSizes, 1);
+    postDescriptorPool = std::make_shared<VulkanDescriptorPool>(vulkanLogicalDevice, poolSizes, POST_FRAMES_COUNT);
 }
 
-// Создаем набор дескрипторов ресурсов
-void VulkanRender::createPostRenderDescriptorSet() {
-    postDescriptorSet = std::make_shared<VulkanDescriptorSet>(vulkanLogicalDevice, postDescriptorSetLayout, postDescriptorPool);
+// Создаем наборы дескрипторов ресурсов
+void VulkanRender::createPostRenderDescriptorSets() {
+    postDescriptorSets.clear();
+    for (size_t i = 0; i < POST_FRAMES_COUNT; i++) {
+        VulkanDescriptorSetPtr set = std::make_shared<VulkanDescriptorSet>(vulkanLogicalDevice, postDescriptorSetLayout, postDescriptorPool);
+        
+        // Выводим на экран результат вычислительного прохода, он остается в лаяуте GENERAL
+        VulkanDescriptorSetUpdateConfig samplerSet;
+        samplerSet.binding = 0; // Биндится на 0м значении в шейдере
+        samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        samplerSet.imageInfo.imageView = postComputeImageViews[i];
+        samplerSet.imageInfo.sampler = postTextureSampler;
+        
+        std::vector<VulkanDescriptorSetUpdateConfig> configs;
+        configs.push_back(samplerSet);
+        set->updateDescriptorSet(configs);
+        postDescriptorSets.push_back(set);
+    }
+}
+
+// Создаем структуру дескрипторов вычислительного прохода (входная текстура + картинка результата)
+void VulkanRender::createPostComputeDescriptorsSetLayout(){
+    VulkanDescriptorSetConfig sampler;
+    sampler.binding = 0;         // Картинка геометрии
+    sampler.desriptorsCount = 1;
+    sampler.desriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    sampler.descriptorStageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     
-    VulkanDescriptorSetUpdateConfig samplerSet;
-    samplerSet.binding = 0; // Биндится на 1м значении в шейдере
-    samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    samplerSet.imageInfo.imageView = postImageView;
-    samplerSet.imageInfo.sampler = postTextureSampler;
+    VulkanDescriptorSetConfig outputImage;
+    outputImage.binding = 1;     // Картинка результата
+    outputImage.desriptorsCount = 1;
+    outputImage.desriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    outputImage.descriptorStageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     
-    std::vector<VulkanDescriptorSetUpdateConfig> configs;
-    configs.push_back(samplerSet);
-    postDescriptorSet->updateDescriptorSet(configs);
+    std::vector<VulkanDescriptorSetConfig> configs;
+    configs.push_back(sampler);
+    configs.push_back(outputImage);
+    
+    postComputeDescriptorSetLayout = std::make_shared<VulkanDescriptorSetLayout>(vulkanLogicalDevice, configs);
+}
+
+// Грузим вычислительный шейдер
+void VulkanRender::loadPostComputeShader(){
+    std::vector<unsigned char> computeShaderCode = readFile("res/shaders/post_shader_comp.spv");
+    postComputeModule = std::make_shared<VulkanShaderModule>(vulkanLogicalDevice, computeShaderCode);
+}
+
+// Создание вычислительного пайплайна
+void VulkanRender::createPostComputePipeline(){
+    // Push константа - коэффициент эффекта
+    std::vector<VkPushConstantRange> pushConstants;
+    VkPushConstantRange pushConstantRange = {};
+    memset(&pushConstantRange, 0, sizeof(VkPushConstantRange));
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(float);
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstants.push_back(pushConstantRange);
+    
+    std::vector<VulkanDescriptorSetLayoutPtr> layouts;
+    layouts.push_back(postComputeDescriptorSetLayout);
+    postComputePipelineLayout = std::make_shared<VulkanPipelineLayout>(vulkanLogicalDevice, layouts, pushConstants);
+    
+    postComputePipeline = std::make_shared<VulkanComputePipeline>(vulkanLogicalDevice, postComputeModule, postComputePipelineLayout);
+}
+
+// Создаем пул дескрипторов вычислительного прохода
+void VulkanRender::createPostComputeDescriptorPool(){
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.resize(2);
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = POST_FRAMES_COUNT;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[1].descriptorCount = POST_FRAMES_COUNT;
+    
+    postComputeDescriptorPool = std::make_shared<VulkanDescriptorPool>(vulkanLogicalDevice, poolSizes, POST_FRAMES_COUNT);
+}
+
+// Создаем наборы дескрипторов вычислительного прохода
+void VulkanRender::createPostComputeDescriptorSets(){
+    postComputeDescriptorSets.clear();
+    for (size_t i = 0; i < POST_FRAMES_COUNT; i++) {
+        VulkanDescriptorSetPtr set = std::make_shared<VulkanDescriptorSet>(vulkanLogicalDevice, postComputeDescriptorSetLayout, postComputeDescriptorPool);
+        
+        VulkanDescriptorSetUpdateConfig samplerSet;
+        samplerSet.binding = 0;
+        samplerSet.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        samplerSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        samplerSet.imageInfo.imageView = postImageViews[i];
+        samplerSet.imageInfo.sampler = postTextureSampler;
+        
+        VulkanDescriptorSetUpdateConfig outputSet;
+        outputSet.binding = 1;
+        outputSet.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        outputSet.imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        outputSet.imageInfo.imageView = postComputeImageViews[i];
+        
+        std::vector<VulkanDescriptorSetUpdateConfig> configs;
+        configs.push_back(samplerSet);
+        configs.push_back(outputSet);
+        set->updateDescriptorSet(configs);
+        postComputeDescriptorSets.push_back(set);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -583,8 +791,8 @@ void VulkanRender::createModelGraphicsPipeline() {
     memset(&viewport, 0, sizeof(VkViewport));
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(postImage->getBaseSize().width);
-    viewport.height = static_cast<float>(postImage->getBaseSize().height);
+    viewport.width = static_cast<float>(postImages[0]->getBaseSize().width);
+    viewport.height = static_cast<float>(postImages[0]->getBaseSize().height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     
@@ -592,7 +800,7 @@ void VulkanRender::createModelGraphicsPipeline() {
     VkRect2D scissor = {};
     memset(&scissor, 0, sizeof(VkRect2D));
     scissor.offset = {0, 0};
-    scissor.extent = postImage->getBaseSize();
+    scissor.extent = postImages[0]->getBaseSize();
     
     // Настройка глубины
     VulkanPipelineDepthConfig depthConfig;
@@ -626,6 +834,10 @@ void VulkanRender::createModelGraphicsPipeline() {
     //dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
     //dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
     
+    // Лэйауты наборов дескрипторов
+    std::vector<VulkanDescriptorSetLayoutPtr> layouts;
+    layouts.push_back(modelDescriptorSetLayout);
+    
     // Пайплайн
     modelPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
                                                       modelVertexModule, modelFragmentModule,
@@ -637,7 +849,7 @@ void VulkanRender::createModelGraphicsPipeline() {
                                                       scissor,
                                                       cullingConfig,
                                                       blendConfig,
-                                                      modelDescriptorSetLayout,
+                                                      layouts,
                                                       postRenderToRenderPass,
                                                       pushConstants,
                                                       dynamicStates);
@@ -723,7 +935,7 @@ void VulkanRender::createModelUniformBuffer() {
     ModelUniformBuffer ubo = {};
     memset(&ubo, 0, sizeof(ModelUniformBuffer));
     ubo.view = glm::lookAt(glm::vec3(0.0f, 3.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    ubo.proj = glm::perspective(glm::radians(45.0f), (float)postImage->getBaseSize().width / (float)postImage->getBaseSize().height, 0.1f, 10.0f);
+    ubo.proj = glm::perspective(glm::radians(45.0f), (float)postImages[0]->getBaseSize().width / (float)postImages[0]->getBaseSize().height, 0.1f, 10.0f);
     
     // GLM был разработан для OpenGL, где координата Y клип координат перевернута,
     // самым простым путем решения данного вопроса будет изменить знак оси Y в матрице проекции
@@ -785,6 +997,8 @@ void VulkanRender::resetCommandBuffers() {
     // Ресайзим массив
     vulkanModelDrawCommandBuffers.clear();
     vulkanModelDrawCommandBuffers.resize(vulkanSwapchain->getImageViews().size());
+    vulkanPostComputeCommandBuffers.clear();
+    vulkanPostComputeCommandBuffers.resize(vulkanSwapchain->getImageViews().size());
     vulkanPostDrawCommandBuffers.clear();
     vulkanPostDrawCommandBuffers.resize(vulkanSwapchain->getImageViews().size());
 }
@@ -810,9 +1024,30 @@ void VulkanRender::createWindowFrameBuffers(){
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-VulkanCommandBufferPtr VulkanRender::updateModelRenderCommandBuffer(uint32_t frameIndex){
+// Барьер картинки пост-эффекта, при разных семействах очередей - с передачей владения
+static void postImageBarrier(const VulkanCommandBufferPtr& buffer, const VulkanImagePtr& image,
+                             VkImageLayout oldLayout, VkImageLayout newLayout,
+                             VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
+                             VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                             uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex){
+    VulkanImageBarrierInfo barrierInfo;
+    barrierInfo.image = image;
+    barrierInfo.oldLayout = oldLayout;
+    barrierInfo.newLayout = newLayout;
+    barrierInfo.startMipmapLevel = 0;
+    barrierInfo.levelsCount = 1;
+    barrierInfo.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrierInfo.srcAccessBarrier = srcAccess;
+    barrierInfo.dstAccessBarrier = dstAccess;
+    barrierInfo.srcQueueFamilyIndex = srcQueueFamilyIndex;
+    barrierInfo.dstQueueFamilyIndex = dstQueueFamilyIndex;
+    buffer->cmdPipelineBarrier(srcStage, dstStage, &barrierInfo, 1, nullptr, 0, nullptr, 0);
+}
+
+// Отрисовка геометрии в картинку слота postSlot (очередь vulkanRenderQueue1)
+VulkanCommandBufferPtr VulkanRender::updateModelRenderCommandBuffer(uint32_t frameIndex, uint32_t postSlot){
     // Создаем новый буффер или сбрасываем старый
-    VulkanCommandBufferPtr& buffer = vulkanModelDrawCommandBuffers[vulkanImageIndex];
+    VulkanCommandBufferPtr& buffer = vulkanModelDrawCommandBuffers[frameIndex];
     if (buffer == nullptr) {
         buffer = std::make_shared<VulkanCommandBuffer>(vulkanLogicalDevice, vulkanRenderCommandPool);
     }else{
@@ -822,18 +1057,24 @@ VulkanCommandBufferPtr VulkanRender::updateModelRenderCommandBuffer(uint32_t fra
     // Буфер команд может быть представлен еще раз, если он так же уже находится в ожидании исполнения. VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT
     buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
     
-    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, 0);
+    // Каждая очередь сбрасывает только свои таймстампы
+    uint32_t timeStampBase = postSlot * POST_TIMESTAMPS_PER_FRAME;
+    if (vulkanTimeStampQueryPool) {
+        vulkanTimeStampQueryPool->resetPool(buffer, timeStampBase + TIMESTAMP_GEOMETRY_BEGIN, 2);
+    }
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_GEOMETRY_BEGIN);
     
     // Отрисовка модели
     {
-        // Изменяем лаяут текстуры, в которую рисуем
+        // Изменяем лаяут текстуры, в которую рисуем, старое содержимое не нужно.
+        // Чтение картинки вычислениями уже завершено - ждем семафор на стадии вывода цвета
         transitionImageLayout(buffer,
-                              postImage,
+                              postImages[postSlot],
                               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                               0, 1,
                               VK_IMAGE_ASPECT_COLOR_BIT,
-							  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-							  VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+							  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+							  0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
         
         // Информация о запуске рендер-прохода
         std::vector<VkClearValue> clearValues;
@@ -842,9 +1083,9 @@ VulkanCommandBufferPtr VulkanRender::updateModelRenderCommandBuffer(uint32_t fra
         clearValues[1].depthStencil = {1.0f, 0};
         VulkanRenderPassBeginInfo beginInfo;
         beginInfo.renderPass = postRenderToRenderPass;
-        beginInfo.framebuffer = postFrameBuffer;
+        beginInfo.framebuffer = postFrameBuffers[postSlot];
         beginInfo.renderArea.offset = {0, 0};
-        beginInfo.renderArea.extent = postImage->getBaseSize();
+        beginInfo.renderArea.extent = postImages[postSlot]->getBaseSize();
         beginInfo.clearValues = clearValues;
         
         // Запуск рендер-прохода
@@ -892,15 +1133,90 @@ VulkanCommandBufferPtr VulkanRender::updateModelRenderCommandBuffer(uint32_t fra
         buffer->cmdEndRenderPass();
     }
     
+    // Переводим картинку для чтения в вычислительном шейдере, при другом семействе очередей - освобождаем владение
+    uint32_t renderFamily = vulkanComputeOwnershipTransfer ? vulkanRenderQueue1->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t computeFamily = vulkanComputeOwnershipTransfer ? vulkanComputeQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+    postImageBarrier(buffer, postImages[postSlot],
+                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0,
+                     renderFamily, computeFamily);
+    
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_GEOMETRY_END);
+    
     // Заканчиваем подготовку коммандного буффера
 	buffer->end();
 
     return buffer;
 }
 
-VulkanCommandBufferPtr VulkanRender::updatePostRenderCommandBuffer(uint32_t frameIndex){
+// Пост-эффект вычислительным шейдером (очередь vulkanComputeQueue)
+VulkanCommandBufferPtr VulkanRender::updatePostComputeCommandBuffer(uint32_t frameIndex, uint32_t postSlot){
     // Создаем новый буффер или сбрасываем старый
-    VulkanCommandBufferPtr& buffer = vulkanPostDrawCommandBuffers[vulkanImageIndex];
+    VulkanCommandBufferPtr& buffer = vulkanPostComputeCommandBuffers[frameIndex];
+    if (buffer == nullptr) {
+        buffer = std::make_shared<VulkanCommandBuffer>(vulkanLogicalDevice, vulkanComputeCommandPool);
+    }
+    
+    buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    
+    uint32_t timeStampBase = postSlot * POST_TIMESTAMPS_PER_FRAME;
+    if (vulkanTimeStampQueryPool && computeTimeStampsEnabled) {
+        vulkanTimeStampQueryPool->resetPool(buffer, timeStampBase + TIMESTAMP_COMPUTE_BEGIN, 2);
+        buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_COMPUTE_BEGIN);
+    }
+    
+    uint32_t renderFamily = vulkanComputeOwnershipTransfer ? vulkanRenderQueue1->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t computeFamily = vulkanComputeOwnershipTransfer ? vulkanComputeQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+    
+    // Захват владения картинкой геометрии, барьер должен совпадать с барьером освобождения
+    if (vulkanComputeOwnershipTransfer) {
+        postImageBarrier(buffer, postImages[postSlot],
+                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, VK_ACCESS_SHADER_READ_BIT,
+                         renderFamily, computeFamily);
+    }
+    
+    // Результат перезаписывается целиком - старое содержимое и владение не нужны
+    postImageBarrier(buffer, postComputeImages[postSlot],
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                     0, VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+    
+    buffer->cmdBindComputePipeline(postComputePipeline);
+    buffer->cmdBindComputeDescriptorSet(postComputePipeline->getLayout(), postComputeDescriptorSets[postSlot]);
+    
+    float effectCoeff = std::abs(std::sin(totalTime * 3.1415926535 / 10.0f));
+    buffer->cmdPushConstants(postComputePipeline->getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, (void*)&effectCoeff, sizeof(effectCoeff));
+    
+    VkExtent2D size = postComputeImages[postSlot]->getBaseSize();
+    buffer->cmdDispatch((size.width + POST_COMPUTE_GROUP_SIZE - 1) / POST_COMPUTE_GROUP_SIZE,
+                        (size.height + POST_COMPUTE_GROUP_SIZE - 1) / POST_COMPUTE_GROUP_SIZE);
+    
+    // Освобождаем результат для очереди отрисовки
+    if (vulkanComputeOwnershipTransfer) {
+        postImageBarrier(buffer, postComputeImages[postSlot],
+                         VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         VK_ACCESS_SHADER_WRITE_BIT, 0,
+                         computeFamily, renderFamily);
+    }
+    
+    if (vulkanTimeStampQueryPool && computeTimeStampsEnabled) {
+        buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_COMPUTE_END);
+    }
+    
+    buffer->end();
+    
+    return buffer;
+}
+
+// Вывод результата вычислений на экран (очередь vulkanRenderQueue2)
+VulkanCommandBufferPtr VulkanRender::updatePostRenderCommandBuffer(uint32_t frameIndex, uint32_t postSlot){
+    // Создаем новый буффер или сбрасываем старый
+    VulkanCommandBufferPtr& buffer = vulkanPostDrawCommandBuffers[frameIndex];
     if (buffer == nullptr) {
         buffer = std::make_shared<VulkanCommandBuffer>(vulkanLogicalDevice, vulkanRenderCommandPool);
     }else{
@@ -910,18 +1226,23 @@ VulkanCommandBufferPtr VulkanRender::updatePostRenderCommandBuffer(uint32_t fram
     // Буфер команд может быть представлен еще раз, если он так же уже находится в ожидании исполнения. VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT
     buffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
     
+    uint32_t timeStampBase = postSlot * POST_TIMESTAMPS_PER_FRAME;
+    if (vulkanTimeStampQueryPool) {
+        vulkanTimeStampQueryPool->resetPool(buffer, timeStampBase + TIMESTAMP_COMPOSE_BEGIN, 2);
+    }
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_COMPOSE_BEGIN);
+    
+    // Захват владения результатом вычислений
+    if (vulkanComputeOwnershipTransfer) {
+        postImageBarrier(buffer, postComputeImages[postSlot],
+                         VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, VK_ACCESS_SHADER_READ_BIT,
+                         vulkanComputeQueue->getFamilyIndex(), vulkanRenderQueue2->getFamilyIndex());
+    }
+    
     // Отрисовка текстуры пост эффекта
     {
-        // Изменяем лаяут текстуры, для использования как текстуру отрисовки
-        // Конвертация в нужный ляут происходит автоматически предыдущим рендер проходом - в дополнительной конвертации нету нужнды
-        /*transitionImageLayout(buffer,
-         postImage,
-         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         0, 1,
-         VK_IMAGE_ASPECT_COLOR_BIT,
-         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);*/
-        
         // Информация о запуске рендер-прохода
         std::vector<VkClearValue> clearValues;
         clearValues.resize(1);
@@ -945,23 +1266,17 @@ VulkanCommandBufferPtr VulkanRender::updatePostRenderCommandBuffer(uint32_t fram
         // Привязываем индексный буффер
         buffer->cmdBindIndexBuffer(postIndexBuffer, VK_INDEX_TYPE_UINT16);
         
-        // Подключаем дескрипторы ресурсов для юниформ буффера и текстуры
-        buffer->cmdBindDescriptorSet(postPipeline->getLayout(), postDescriptorSet);
+        // Подключаем дескрипторы результата вычислений
+        buffer->cmdBindDescriptorSet(postPipeline->getLayout(), postDescriptorSets[postSlot]);
         
-        // Push константы для динамической отрисовки
-        for(int i = 0; i < 1; i++){
-            float effectCoeff = std::abs(std::sin(totalTime * 3.1415926535 / 10.0f));
-            buffer->cmdPushConstants(postPipeline->getLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, (void*)&effectCoeff, sizeof(effectCoeff));
-            
-            // Вызов поиндексной отрисовки - индексы вершин, один инстанс
-            buffer->cmdDrawIndexed(QUAD_INDICES.size());
-        }
+        // Вызов поиндексной отрисовки - индексы вершин, один инстанс
+        buffer->cmdDrawIndexed(QUAD_INDICES.size());
         
         // Заканчиваем рендер проход
         buffer->cmdEndRenderPass();
     }
     
-    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, 1);
+    buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, timeStampBase + TIMESTAMP_COMPOSE_END);
     
     // Заканчиваем подготовку коммандного буффера
     buffer->end();
@@ -979,14 +1294,13 @@ void VulkanRender::updateRender(float delta){
     rotateAngle += delta * 30.0f;
 }
 
-bool firstRender = true;
-
 // Непосредственно отрисовка кадра
 void VulkanRender::drawFrame() {
 #ifdef __APPLE__
     // TODO: Помогает против подвисания на ресайзах и тд
 	vulkanRenderQueue1->wait();
     vulkanRenderQueue2->wait();
+    vulkanComputeQueue->wait();
 	vulkanPresentQueue->wait();
 #endif
     
@@ -1015,6 +1329,11 @@ void VulkanRender::drawFrame() {
         LOG("Vulkan image index not equal to swapchain image index (swapchain %d, program %d)!\n", swapchainImageIndex, vulkanImageIndex);
     }
 
+    // Слот картинок пост-эффекта этого кадра.
+    // Геометрия кадра N+1 идет в другой слот и выполняется параллельно с вычислениями кадра N
+    uint32_t postSlot = postFrameIndex % POST_FRAMES_COUNT;
+    bool slotUsed = postFrameSlotsUsed[postSlot];
+
 	// Ожидаем доступность закидывания задач на рендеринг, чтобы не удалялись буфферы комманд активные
 	TIME_BEGIN_OFF(WAIT_FENCE);
 	vulkanRenderFences1[vulkanImageIndex]->waitAndReset();
@@ -1022,28 +1341,25 @@ void VulkanRender::drawFrame() {
 
     // Model Draw buffer
     TIME_BEGIN_OFF(MAKE_MODEL_DRAW_BUFFER);
-    VulkanCommandBufferPtr modelBuffer = updateModelRenderCommandBuffer(vulkanImageIndex);
-    vulkanModelDrawCommandBuffers[vulkanImageIndex] = modelBuffer;
+    VulkanCommandBufferPtr modelBuffer = updateModelRenderCommandBuffer(vulkanImageIndex, postSlot);
     VkCommandBuffer modelDrawBuffer = modelBuffer->getBuffer();
     TIME_END_MICROSEC_OFF(MAKE_MODEL_DRAW_BUFFER, "Make model draw buffer wait time");
     
-    // Настраиваем отправление в очередь комманд отрисовки
-    VkSemaphore modelWaitSemaphores[] = {vulkanPostRenderFinishedSemaphoreModel->getSemafore()};
-    VkPipelineStageFlags modelWaitStages[] = {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
-    VkSemaphore modelSignalSemaphores[] = {vulkanModelRenderFinishedSemaphore->getSemafore()};
+    // Геометрия ждет, пока вычисления кадра N-2 дочитают картинку этого слота
+    VkSemaphore modelWaitSemaphores[] = {vulkanComputeToGeometrySemaphores[postSlot]->getSemafore()};
+    VkPipelineStageFlags modelWaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    VkSemaphore modelSignalSemaphores[] = {vulkanGeometryFinishedSemaphores[postSlot]->getSemafore()};
     VkSubmitInfo modelSubmitInfo = {};
     memset(&modelSubmitInfo, 0, sizeof(VkSubmitInfo));
     modelSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    modelSubmitInfo.waitSemaphoreCount = firstRender ? 0 : 1;
-    modelSubmitInfo.pWaitSemaphores = firstRender ? nullptr : modelWaitSemaphores;
-    modelSubmitInfo.pWaitDstStageMask = firstRender ? nullptr : modelWaitStages;
+    modelSubmitInfo.waitSemaphoreCount = slotUsed ? 1 : 0;
+    modelSubmitInfo.pWaitSemaphores = slotUsed ? modelWaitSemaphores : nullptr;
+    modelSubmitInfo.pWaitDstStageMask = slotUsed ? modelWaitStages : nullptr;
     modelSubmitInfo.commandBufferCount = 1;
     modelSubmitInfo.pCommandBuffers = &modelDrawBuffer; // Указываем коммандный буффер отрисовки
     modelSubmitInfo.signalSemaphoreCount = 1;
     modelSubmitInfo.pSignalSemaphores = modelSignalSemaphores;
     
-    firstRender = false;
-    
     // Кидаем в очередь задачу на отрисовку с указанным коммандным буффером
     TIME_BEGIN_OFF(SUBMIT_TIME);
     if (vkQueueSubmit(vulkanRenderQueue1->getQueue(), 1, &modelSubmitInfo, vulkanRenderFences1[vulkanImageIndex]->getFence()/*VK_NULL_HANDLE*/) != VK_SUCCESS) {
@@ -1052,6 +1368,39 @@ void VulkanRender::drawFrame() {
     }
     TIME_END_MICROSEC_OFF(SUBMIT_TIME, "Submit wait time");
     
+    // Ожидаем доступность буффера вычислений
+    TIME_BEGIN_OFF(WAIT_FENCE);
+    vulkanComputeFences[vulkanImageIndex]->waitAndReset();
+    TIME_END_MICROSEC_OFF(WAIT_FENCE, "Fence compute wait time");
+    
+    // Post compute buffer
+    TIME_BEGIN_OFF(MAKE_POST_COMPUTE_BUFFER);
+    VulkanCommandBufferPtr computeBuffer = updatePostComputeCommandBuffer(vulkanImageIndex, postSlot);
+    VkCommandBuffer postComputeBuffer = computeBuffer->getBuffer();
+    TIME_END_MICROSEC_OFF(MAKE_POST_COMPUTE_BUFFER, "Make post compute buffer wait time");
+    
+    // Вычисления ждут геометрию этого кадра и вывод на экран кадра N-2, который читал результат слота
+    VkSemaphore computeWaitSemaphores[] = {vulkanGeometryFinishedSemaphores[postSlot]->getSemafore(), vulkanComposeToComputeSemaphores[postSlot]->getSemafore()};
+    VkPipelineStageFlags computeWaitStages[] = {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT};
+    VkSemaphore computeSignalSemaphores[] = {vulkanComputeFinishedSemaphores[postSlot]->getSemafore(), vulkanComputeToGeometrySemaphores[postSlot]->getSemafore()};
+    VkSubmitInfo computeSubmitInfo = {};
+    memset(&computeSubmitInfo, 0, sizeof(VkSubmitInfo));
+    computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    computeSubmitInfo.waitSemaphoreCount = slotUsed ? 2 : 1;
+    computeSubmitInfo.pWaitSemaphores = computeWaitSemaphores;
+    computeSubmitInfo.pWaitDstStageMask = computeWaitStages;
+    computeSubmitInfo.commandBufferCount = 1;
+    computeSubmitInfo.pCommandBuffers = &postComputeBuffer;
+    computeSubmitInfo.signalSemaphoreCount = 2;
+    computeSubmitInfo.pSignalSemaphores = computeSignalSemaphores;
+    
+    TIME_BEGIN_OFF(SUBMIT_TIME);
+    if (vkQueueSubmit(vulkanComputeQueue->getQueue(), 1, &computeSubmitInfo, vulkanComputeFences[vulkanImageIndex]->getFence()) != VK_SUCCESS) {
+        LOG("Failed to submit compute command buffer!\n");
+        throw std::runtime_error("Failed to submit compute command buffer!");
+    }
+    TIME_END_MICROSEC_OFF(SUBMIT_TIME, "Submit wait time");
+    
     // Ожидаем доступность закидывания задач на рендеринг, чтобы не удалялись буфферы комманд активные
     TIME_BEGIN_OFF(WAIT_FENCE);
     vulkanRenderFences2[vulkanImageIndex]->waitAndReset();
@@ -1059,14 +1408,14 @@ void VulkanRender::drawFrame() {
     
     // Post Draw buffer
     TIME_BEGIN_OFF(MAKE_POST_DRAW_BUFFER);
-    VulkanCommandBufferPtr postBuffer = updatePostRenderCommandBuffer(vulkanImageIndex);
+    VulkanCommandBufferPtr postBuffer = updatePostRenderCommandBuffer(vulkanImageIndex, postSlot);
     VkCommandBuffer postDrawBuffer = postBuffer->getBuffer();
     TIME_END_MICROSEC_OFF(MAKE_POST_DRAW_BUFFER, "Make post draw buffer wait time");
     
     // Настраиваем отправление в очередь комманд отрисовки
-    VkSemaphore postWaitSemaphores[] = {vulkanImageAvailableSemaphore->getSemafore(), vulkanModelRenderFinishedSemaphore->getSemafore()};
+    VkSemaphore postWaitSemaphores[] = {vulkanImageAvailableSemaphore->getSemafore(), vulkanComputeFinishedSemaphores[postSlot]->getSemafore()};
     VkPipelineStageFlags postWaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
-    VkSemaphore postSignalSemaphores[] = {vulkanPostRenderFinishedSemaphoreSwapchain->getSemafore(), vulkanPostRenderFinishedSemaphoreModel->getSemafore()};
+    VkSemaphore postSignalSemaphores[] = {vulkanPostRenderFinishedSemaphoreSwapchain->getSemafore(), vulkanComposeToComputeSemaphores[postSlot]->getSemafore()};
     VkSubmitInfo postSubmitInfo = {};
     memset(&postSubmitInfo, 0, sizeof(VkSubmitInfo));
     postSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1086,6 +1435,10 @@ void VulkanRender::drawFrame() {
     }
     TIME_END_MICROSEC_OFF(SUBMIT_TIME, "Submit wait time");
     
+    // Все семафоры слота теперь будут просигналены, следующий кадр этого слота должен их дождаться
+    postFrameSlotsUsed[postSlot] = true;
+    postFrameIndex++;
+    
 	// Ждем доступности отображения
 	//TIME_BEGIN_OFF(WAIT_FENCE_PRESENT);
 	//vulkanPresentFences[vulkanImageIndex]->waitAndReset();
@@ -1129,10 +1482,33 @@ VulkanRender::~VulkanRender(){
     // Ждем завершения работы Vulkan
     vulkanRenderQueue1->wait();
     vulkanRenderQueue2->wait();
+    vulkanComputeQueue->wait();
     vulkanPresentQueue->wait();
     vulkanLogicalDevice->wait();
     
     vulkanModelDrawCommandBuffers.clear();
+    vulkanPostComputeCommandBuffers.clear();
+    vulkanPostDrawCommandBuffers.clear();
+    postComputeDescriptorSets.clear();
+    postComputeDescriptorPool = nullptr;
+    postComputePipeline = nullptr;
+    postComputePipelineLayout = nullptr;
+    postComputeModule = nullptr;
+    postComputeDescriptorSetLayout = nullptr;
+    postDescriptorSets.clear();
+    postDescriptorPool = nullptr;
+    postPipeline = nullptr;
+    postVertexModule = nullptr;
+    postFragmentModule = nullptr;
+    postDescriptorSetLayout = nullptr;
+    postVertexBuffer = nullptr;
+    postIndexBuffer = nullptr;
+    postTextureSampler = nullptr;
+    postFrameBuffers.clear();
+    postImageViews.clear();
+    postImages.clear();
+    postComputeImageViews.clear();
+    postComputeImages.clear();
     modelDescriptorSet = nullptr;
     modelDescriptorPool = nullptr;
     modelUniformGPUBuffer = nullptr;
@@ -1142,6 +1518,7 @@ VulkanRender::~VulkanRender(){
     modelTextureImage = nullptr;
     modelTextureImageView = nullptr;
     vulkanRenderCommandPool = nullptr;
+    vulkanComputeCommandPool = nullptr;
     modelPipeline = nullptr;
     modelVertexModule = nullptr;
     modelFragmentModule = nullptr;
@@ -1154,9 +1531,15 @@ VulkanRender::~VulkanRender(){
     vulkanPresentFences.clear();
     vulkanRenderFences1.clear();
     vulkanRenderFences2.clear();
+    vulkanComputeFences.clear();
     vulkanImageAvailableSemaphore = nullptr;
     vulkanPostRenderFinishedSemaphoreSwapchain = nullptr;
-    vulkanPostRenderFinishedSemaphoreModel = nullptr;
+    vulkanGeometryFinishedSemaphores.clear();
+    vulkanComputeFinishedSemaphores.clear();
+    vulkanComputeToGeometrySemaphores.clear();
+    vulkanComposeToComputeSemaphores.clear();
+    vulkanTimeStampQueryPool = nullptr;
+    vulkanComputeQueue = nullptr;
     vulkanRenderQueue1 = nullptr;
     vulkanRenderQueue2 = nullptr;
     vulkanPresentQueue = nullptr;
@@ -23,6 +23,8 @@
 #include <VulkanDescriptorSetLayout.h>
 #include <VulkanShaderModule.h>
 #include <VulkanPipeline.h>
+#include <VulkanPipelineLayout.h>
+#include <VulkanComputePipeline.h>
 #include <VulkanCommandPool.h>
 #include <VulkanCommandBuffer.h>
 #include <VulkanSampler.h>
@@ -65,27 +67,41 @@ public:
     VulkanQueuePtr vulkanRenderQueue1;
     VulkanQueuePtr vulkanRenderQueue2;
     VulkanQueuePtr vulkanPresentQueue;
+    VulkanQueuePtr vulkanComputeQueue;      // Асинхронная очередь вычислений, либо vulkanRenderQueue2 при ее отсутствии
+    bool vulkanComputeOwnershipTransfer;    // Очередь вычислений из другого семейства - нужна передача владения картинками
     VulkanSemaforePtr vulkanImageAvailableSemaphore;
-    VulkanSemaforePtr vulkanModelRenderFinishedSemaphore;
-    VulkanSemaforePtr vulkanPostRenderFinishedSemaphoreModel;
     VulkanSemaforePtr vulkanPostRenderFinishedSemaphoreSwapchain;
+    std::vector<VulkanSemaforePtr> vulkanGeometryFinishedSemaphores;    // Геометрия -> вычисления, по слотам кадров
+    std::vector<VulkanSemaforePtr> vulkanComputeFinishedSemaphores;     // Вычисления -> вывод на экран
+    std::vector<VulkanSemaforePtr> vulkanComputeToGeometrySemaphores;   // Вычисления прочитали картинку слота, можно снова рисовать геометрию
+    std::vector<VulkanSemaforePtr> vulkanComposeToComputeSemaphores;    // Вывод прочитал результат слота, можно снова считать
     std::vector<VulkanFencePtr> vulkanPresentFences;
     std::vector<VulkanFencePtr> vulkanRenderFences1;
     std::vector<VulkanFencePtr> vulkanRenderFences2;
+    std::vector<VulkanFencePtr> vulkanComputeFences;
     VulkanSwapchainPtr vulkanSwapchain;
     VulkanCommandPoolPtr vulkanRenderCommandPool;
+    VulkanCommandPoolPtr vulkanComputeCommandPool;
     VulkanImagePtr postDepthImage;
     std::vector<VulkanFrameBufferPtr> vulkanWindowFrameBuffers;
     std::vector<VulkanCommandBufferPtr> vulkanModelDrawCommandBuffers;
+    std::vector<VulkanCommandBufferPtr> vulkanPostComputeCommandBuffers;
     std::vector<VulkanCommandBufferPtr> vulkanPostDrawCommandBuffers;
     VulkanQueryPoolPtr vulkanTimeStampQueryPool;
+    bool computeTimeStampsEnabled;
     
-    VulkanImagePtr postImage;
-    VulkanImageViewPtr postImageView;
+    // Картинки отрисовки геометрии и результата вычислений двойные:
+    // пока кадр N обрабатывается в очереди вычислений, кадр N+1 рисует геометрию в другой слот
+    std::vector<VulkanImagePtr> postImages;
+    std::vector<VulkanImageViewPtr> postImageViews;
+    std::vector<VulkanImagePtr> postComputeImages;
+    std::vector<VulkanImageViewPtr> postComputeImageViews;
+    std::vector<bool> postFrameSlotsUsed;
+    uint32_t postFrameIndex;
     VulkanImageViewPtr postDepthImageView;
     VulkanRenderPassPtr vulkanRenderToWindowRenderPass;
     VulkanRenderPassPtr postRenderToRenderPass;
-    VulkanFrameBufferPtr postFrameBuffer;
+    std::vector<VulkanFrameBufferPtr> postFrameBuffers;
     VulkanDescriptorSetLayoutPtr postDescriptorSetLayout;
     VulkanShaderModulePtr postVertexModule;
     VulkanShaderModulePtr postFragmentModule;
@@ -94,9 +110,16 @@ public:
     VulkanBufferPtr postIndexBuffer;
     VulkanSamplerPtr postTextureSampler;
     VulkanDescriptorPoolPtr postDescriptorPool;
-    VulkanDescriptorSetPtr postDescriptorSet;
+    std::vector<VulkanDescriptorSetPtr> postDescriptorSets;
     std::vector<VulkanCommandBufferPtr> postDrawCommandBuffers;
     
+    VulkanDescriptorSetLayoutPtr postComputeDescriptorSetLayout;
+    VulkanShaderModulePtr postComputeModule;
+    VulkanPipelineLayoutPtr postComputePipelineLayout;
+    VulkanComputePipelinePtr postComputePipeline;
+    VulkanDescriptorPoolPtr postComputeDescriptorPool;
+    std::vector<VulkanDescriptorSetPtr> postComputeDescriptorSets;
+    
     VulkanDescriptorSetLayoutPtr modelDescriptorSetLayout;
     VulkanShaderModulePtr modelVertexModule;
     VulkanShaderModulePtr modelFragmentModule;
@@ -135,12 +158,12 @@ private:
     // Создание пула запроса статистики
     void createQueryPool();
     
-    // Создаем картинки для отрисовки в текстуру
-    void createPostImageAndView();
+    // Создаем картинки для отрисовки в текстуру и для результата вычислений
+    void createPostImagesAndViews();
     // Создание рендер прохода
     void createRenderToPostRenderPass();
-    // Создаем фреймбуффер для отрисовки в текстуру
-    void createPostFrameBuffer();
+    // Создаем фреймбуфферы для отрисовки в текстуру
+    void createPostFrameBuffers();
     // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
     void createPostDescriptorsSetLayout();
     // Грузим шейдеры
@@ -151,8 +174,19 @@ private:
     void createPostBuffers();
     // Создаем пул дескрипторов ресурсов
     void createPostRenderDescriptorPool();
-    // Создаем набор дескрипторов ресурсов
-    void createPostRenderDescriptorSet();
+    // Создаем наборы дескрипторов ресурсов
+    void createPostRenderDescriptorSets();
+    
+    // Создаем структуру дескрипторов вычислительного прохода (входная текстура + картинка результата)
+    void createPostComputeDescriptorsSetLayout();
+    // Грузим вычислительный шейдер
+    void loadPostComputeShader();
+    // Создание вычислительного пайплайна
+    void createPostComputePipeline();
+    // Создаем пул дескрипторов вычислительного прохода
+    void createPostComputeDescriptorPool();
+    // Создаем наборы дескрипторов вычислительного прохода
+    void createPostComputeDescriptorSets();
     
     // Создаем фреймбуфферы для вьюшек изображений окна
     void createWindowFrameBuffers();
@@ -177,8 +211,9 @@ private:
     void resetCommandBuffers();
     
     // Коммандный буффер рендеринга
-    VulkanCommandBufferPtr updateModelRenderCommandBuffer(uint32_t frameIndex);
-    VulkanCommandBufferPtr updatePostRenderCommandBuffer(uint32_t frameIndex);
+    VulkanCommandBufferPtr updateModelRenderCommandBuffer(uint32_t frameIndex, uint32_t postSlot);
+    VulkanCommandBufferPtr updatePostComputeCommandBuffer(uint32_t frameIndex, uint32_t postSlot);
+    VulkanCommandBufferPtr updatePostRenderCommandBuffer(uint32_t frameIndex, uint32_t postSlot);
 };
 
 typedef std::shared_ptr<VulkanRender> VulkanRenderPtr;
@@ -18,9 +18,18 @@
 
 static VulkanRender* renderInstance = nullptr;
 
-void VulkanRender::initInstance(GLFWwindow* window){
+////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderSettings::VulkanRenderSettings():
+    multisampleSamplesCount(4){
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void VulkanRender::initInstance(GLFWwindow* window, const VulkanRenderSettings& settings){
     if (renderInstance == nullptr) {
         renderInstance = new VulkanRender();
+        renderInstance->settings = settings;
         renderInstance->init(window);
     }
 }
@@ -42,6 +51,11 @@ VulkanRender::VulkanRender(){
     modelImageIndex = 0;
     rotateAngle = 0;
     vulkanImageIndex = 0;
+    multisampleColorLazyMemory = false;
+    multisampleDepthLazyMemory = false;
+    multisampleMemorySize = 0;
+    multisampleGPUTime = 0.0;
+    multisampleGPUSamplesCount = 0;
 }
 
 void VulkanRender::init(GLFWwindow* window){
@@ -103,8 +117,12 @@ void VulkanRender::init(GLFWwindow* window){
     createMultisampleImagesAndViews();
     
     // Создаем рендер проход
+    vulkanRenderPassCache = std::make_shared<VulkanRenderPassCache>(vulkanLogicalDevice);
     createMainRenderPass();
     
+    // Создание пула запроса времени на GPU
+    createQueryPool();
+    
     // Создаем фреймбуфферы для вьюшек изображений окна
     createWindowFrameBuffers();
     
@@ -176,6 +194,9 @@ void VulkanRender::rebuildRendering(){
 	// Создание изображения для мультисемплинга и вью для него
 	createMultisampleImagesAndViews();
     
+    // Формат свопчейна мог поменяться, при том же описании проход вернется из кеша
+    createMainRenderPass();
+    
     // Создаем фреймбуфферы для вьюшек изображений окна
     createWindowFrameBuffers();
     
@@ -251,18 +272,19 @@ void VulkanRender::createWindowDepthResources() {
 
 // Создание изображения для мультисемплинга и вью для него
 void VulkanRender::createMultisampleImagesAndViews(){
-    VkSampleCountFlagBits samplingValue = VK_SAMPLE_COUNT_64_BIT;
-    VkSampleCountFlags counts = std::min(vulkanPhysicalDevice->getDeviceProperties().limits.framebufferColorSampleCounts,
-                                         vulkanPhysicalDevice->getDeviceProperties().limits.framebufferDepthSampleCounts);
-    if (counts & VK_SAMPLE_COUNT_64_BIT)      { samplingValue = VK_SAMPLE_COUNT_64_BIT; }
-    else if (counts & VK_SAMPLE_COUNT_32_BIT) { samplingValue = VK_SAMPLE_COUNT_32_BIT; }
-    else if (counts & VK_SAMPLE_COUNT_16_BIT) { samplingValue = VK_SAMPLE_COUNT_16_BIT; }
-    else if (counts & VK_SAMPLE_COUNT_8_BIT)  { samplingValue = VK_SAMPLE_COUNT_8_BIT; }
-    else if (counts & VK_SAMPLE_COUNT_4_BIT)  { samplingValue = VK_SAMPLE_COUNT_4_BIT; }
-    else if (counts & VK_SAMPLE_COUNT_2_BIT)  { samplingValue = VK_SAMPLE_COUNT_2_BIT; }
-    else { samplingValue = VK_SAMPLE_COUNT_1_BIT; }
-    
-    LOG("Selected multisampling value: X%d\n", static_cast<int>(samplingValue));
+    // Количество семплов должно поддерживаться одновременно для цвета и для глубины
+    const VkPhysicalDeviceLimits& limits = vulkanPhysicalDevice->getDeviceProperties().limits;
+    VkSampleCountFlags counts = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+    // Запрошенное значение может быть не степенью двойки, берем наибольшее поддерживаемое не больше него
+    VkSampleCountFlagBits samplingValue = VK_SAMPLE_COUNT_1_BIT;
+    for (uint32_t value = VK_SAMPLE_COUNT_64_BIT; value > 1; value /= 2) {
+        if ((value <= settings.multisampleSamplesCount) && (counts & value)) {
+            samplingValue = static_cast<VkSampleCountFlagBits>(value);
+            break;
+        }
+    }
+    
+    LOG("Selected multisampling value: X%d (requested X%d)\n", static_cast<int>(samplingValue), static_cast<int>(settings.multisampleSamplesCount));
     
     // Изображение для мультисемплинга цвета
     multisampleColorImage = std::make_shared<VulkanImage>(vulkanLogicalDevice,
@@ -271,9 +293,10 @@ void VulkanRender::createMultisampleImagesAndViews(){
                                                           VK_IMAGE_TILING_OPTIMAL,
                                                           VK_IMAGE_LAYOUT_UNDEFINED,
                                                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                          0,        // Память привязываем сами
                                                           1,
                                                           samplingValue);
+    multisampleColorMemory = bindMultisampleMemory(multisampleColorImage, multisampleColorLazyMemory);
     
     //  Вью изображения для мультисемплинга цвета
     multisampleColorImageView = std::make_shared<VulkanImageView>(vulkanLogicalDevice,
@@ -291,9 +314,10 @@ void VulkanRender::createMultisampleImagesAndViews(){
                                                           VK_IMAGE_TILING_OPTIMAL,
                                                           VK_IMAGE_LAYOUT_UNDEFINED,
                                                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                          0,        // Память привязываем сами
                                                           1,
                                                           samplingValue);
+    multisampleDepthMemory = bindMultisampleMemory(multisampleDepthImage, multisampleDepthLazyMemory);
     // Вью изображения мультисемплинга глубины
 	VkImageAspectFlags depthAspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 	if (hasStencilComponent(vulkanDepthFormat)) {
@@ -303,141 +327,92 @@ void VulkanRender::createMultisampleImagesAndViews(){
                                                                   multisampleDepthImage,
 		                                                          depthAspectMask);
 
-	// Обновляем лаяут текстур
-	VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(vulkanLogicalDevice, vulkanRenderCommandPool);
-	transitionImageLayout(commandBuffer,
-						  multisampleColorImage,
-		                  VK_IMAGE_LAYOUT_UNDEFINED,
-						  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-						  0, 1,
-						  VK_IMAGE_ASPECT_COLOR_BIT,
-						  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-						  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-						  0,
-						  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT);
-	transitionImageLayout(commandBuffer,
-						  multisampleDepthImage,
-						  VK_IMAGE_LAYOUT_UNDEFINED,
-						  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-					      0, 1,
-					      depthAspectMask,
-					      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-					      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-					      0,
-					      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
-	endAndQueueWaitSingleTimeCommands(commandBuffer, vulkanRenderQueue);
+    // Лэйаут не переводим: рендер проход начинает с VK_IMAGE_LAYOUT_UNDEFINED, а лишняя работа
+    // с картинкой вне прохода может заставить драйвер выделить lazily allocated память
+    multisampleMemorySize = multisampleColorImage->getMemoryRequirements().size + multisampleDepthImage->getMemoryRequirements().size;
+    LOG("Multisample attachments: %.1f MB, lazily allocated memory: color %s, depth %s\n",
+        multisampleMemorySize / (1024.0 * 1024.0), multisampleColorLazyMemory ? "yes" : "no", multisampleDepthLazyMemory ? "yes" : "no");
+}
+
+// Содержимое мультисемплинга не нужно после резолва - на тайловых GPU память под него может вообще не выделяться.
+// Допустимые типы памяти у каждой картинки свои, если lazily allocated среди них нет - обычная память устройства
+VulkanDeviceMemoryPtr VulkanRender::bindMultisampleMemory(const VulkanImagePtr& image, bool& lazy){
+    VkMemoryRequirements requirements = image->getMemoryRequirements();
+    VkPhysicalDevice physicalDevice = vulkanPhysicalDevice->getDevice();
+    
+    int32_t lazyMemoryType = findLazyMemoryType(physicalDevice, requirements.memoryTypeBits);
+    lazy = (lazyMemoryType >= 0);
+    uint32_t memoryType = lazy ? static_cast<uint32_t>(lazyMemoryType) :
+                                 findMemoryType(physicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+    VulkanDeviceMemoryPtr memory = std::make_shared<VulkanDeviceMemory>(vulkanLogicalDevice, requirements.size, memoryType);
+    image->bindMemory(memory, 0);
+    return memory;
 }
 
 // Создание рендер прохода
 void VulkanRender::createMainRenderPass(){
-    // Массив аттачментов
-    std::array<VkAttachmentDescription, 3> attachments = {};
-    memset(attachments.data(), 0, sizeof(VkAttachmentDescription)*attachments.size());
+    VulkanRenderPassDesc desc;
     
     // Аттачмент мультисемплинга цвета
-    attachments[0].format = multisampleColorImage->getBaseFormat();
-    attachments[0].samples = multisampleColorImage->getBaseSampleCount();
-    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;	// Чистим на старт
-    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;	// Сохраняем после
-    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    
-    // This is the frame buffer attachment to where the multisampled image
-    // will be resolved to and which will be presented to the swapchain
-    // Аттачмент представления цвета, который будет рисовать картинку
-    attachments[1].format = vulkanSwapchain->getSwapChainImageFormat();
-    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[1].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;	// Картинка будет использоваться для отбражения
-    
-    // Multisampled depth attachment we render to
-    attachments[2].format = multisampleDepthImage->getBaseFormat();
-    attachments[2].samples = multisampleDepthImage->getBaseSampleCount();
-    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[2].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-    
-    // аттачмент резолва глубины - не используется
-    /*attachments[3].format = vulkanWindowDepthImage->getBaseFormat();
-    attachments[3].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[3].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[3].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachments[3].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[3].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[3].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[3].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;*/
-    
-    // Реф цвета, аттач 0 с мультисемплингом
-    VkAttachmentReference colorReference = {};
-    memset(&colorReference, 0, sizeof(VkAttachmentReference));
-    colorReference.attachment = 0;
-    colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    
-	// Референс для ресолва мультисемплинга для цвета, аттач 1 без семплинга
-	VkAttachmentReference resolveReference = {};
-	memset(&resolveReference, 0, sizeof(VkAttachmentReference));
-	resolveReference.attachment = 1;
-	resolveReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Реф глубины, аттач 2 с семплингом
-    VkAttachmentReference depthReference = {};
-    memset(&depthReference, 0, sizeof(VkAttachmentReference));
-    depthReference.attachment = 2;
-    depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-    
-    // Описание подпроходов рендеринга
-    VkSubpassDescription subpass = {};
-    memset(&subpass, 0, sizeof(VkSubpassDescription));
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorReference;
-    subpass.pResolveAttachments = &resolveReference;    // Проход резолва мультисемплинга
-    subpass.pDepthStencilAttachment = &depthReference;
-    
-    // Зависимости подпроходов
-    std::array<VkSubpassDependency, 2> dependencies;
-    memset(dependencies.data(), 0, sizeof(VkSubpassDependency)*dependencies.size());
-    
-    // Подпроход-зависимость 1
-    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;   // Должны выполниться все комманды до начала рендер прохода
-    dependencies[0].dstSubpass = 0; // Можно будет выводить на 0 подпроход
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;    // Все комманды до самого конца
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;   // Вывод будет разрешен на стадии вывода изображения в аттачмент
-    dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;  // Все операции чтения должны быть завершены до???
-    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; // После - можно читать и писать в аттачмент
-    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;  // Зависимость по регионам отрисовки
-    
-    // Подпроход-зависимость 2
-    dependencies[1].srcSubpass = 0; // Можно будет работать после вывода данных в 0 подпроход
-    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL; // После могут исполняться все комманды после окончания рендер прохода
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;   // До начала должны выполниться все выводы в изображение
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;    // Последняя стадия - после нее можно все
-    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT; // До начальной стадии долны выполниться все операции с аттачментом цвета
-    dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;  // После - можно работать с памятью на чтение
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;  // Зависимость по регионам отрисовки
-    
-    // Создание рендер прохода
-    VkRenderPassCreateInfo renderPassInfo = {};
-	memset(&renderPassInfo, 0, sizeof(VkRenderPassCreateInfo));
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = attachments.size();
-    renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 2;
-    renderPassInfo.pDependencies = dependencies.data();
+    VulkanRenderPassAttachmentDesc multisampleColor;
+    multisampleColor.format = multisampleColorImage->getBaseFormat();
+    multisampleColor.samples = multisampleColorImage->getBaseSampleCount();
+    multisampleColor.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;	// Чистим на старт
+    multisampleColor.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;	// После резолва содержимое не нужно, из памяти тайла не выгружаем
+    multisampleColor.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    multisampleColor.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    uint32_t multisampleColorIndex = desc.addAttachment(multisampleColor);
+    
+    // Аттачмент представления цвета, в который резолвится мультисемплинг и который будет показан
+    VulkanRenderPassAttachmentDesc windowColor;
+    windowColor.format = vulkanSwapchain->getSwapChainImageFormat();
+    windowColor.samples = VK_SAMPLE_COUNT_1_BIT;
+    windowColor.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    windowColor.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    windowColor.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    windowColor.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;	// Картинка будет использоваться для отбражения
+    uint32_t windowColorIndex = desc.addAttachment(windowColor);
+    
+    // Аттачмент глубины с мультисемплингом
+    VulkanRenderPassAttachmentDesc multisampleDepth;
+    multisampleDepth.format = multisampleDepthImage->getBaseFormat();
+    multisampleDepth.samples = multisampleDepthImage->getBaseSampleCount();
+    multisampleDepth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    multisampleDepth.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    multisampleDepth.initLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    multisampleDepth.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    uint32_t multisampleDepthIndex = desc.addAttachment(multisampleDepth);
+    
+    // Один подпроход, резолв мультисемплинга делается в конце подпрохода
+    VulkanRenderPassSubpassDesc subpass;
+    subpass.colorAttachments.push_back(VulkanRenderPassDesc::makeReference(multisampleColorIndex, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+    subpass.resolveAttachments.push_back(VulkanRenderPassDesc::makeReference(windowColorIndex, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+    subpass.depthAttachment = VulkanRenderPassDesc::makeReference(multisampleDepthIndex, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    desc.addSubpass(subpass);
+    
+    // Должны выполниться все комманды до начала рендер прохода, после - можно читать и писать в аттачмент
+    desc.addDependency(VK_SUBPASS_EXTERNAL, 0,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                       VK_ACCESS_MEMORY_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    
+    // Комманды после рендер прохода ждут завершения вывода в аттачмент
+    desc.addDependency(0, VK_SUBPASS_EXTERNAL,
+                       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                       VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT);
     
     // Создание рендер-прохода
-    vulkanRenderPass = std::make_shared<VulkanRenderPass>(vulkanLogicalDevice, renderPassInfo);
+    vulkanRenderPass = vulkanRenderPassCache->getRenderPass(desc);
+}
+
+// Создание пула запроса времени на GPU
+void VulkanRender::createQueryPool(){
+    if (vulkanPhysicalDevice->getDeviceProperties().limits.timestampComputeAndGraphics &&
+        (vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits > 0)) {
+        VulkanQueryPoolTimeStamp config;
+        config.testCount = 2;   // Рендер проход с резолвом
+        vulkanTimeStampQueryPool = std::make_shared<VulkanQueryPool>(vulkanLogicalDevice, config);
+    }
 }
 
 // Создаем фреймбуфферы для вьюшек изображений окна
@@ -550,6 +525,10 @@ void VulkanRender::createGraphicsPipeline() {
     dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
     dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
     
+    // Лаяуты дескрипторов
+    std::vector<VulkanDescriptorSetLayoutPtr> layouts;
+    layouts.push_back(vulkanDescriptorSetLayout);
+    
     // Пайплайн
     vulkanPipeline = std::make_shared<VulkanPipeline>(vulkanLogicalDevice,
                                                       vulkanVertexModule, vulkanFragmentModule,
@@ -561,7 +540,7 @@ void VulkanRender::createGraphicsPipeline() {
                                                       scissor,
                                                       cullingConfig,
                                                       blendConfig,
-                                                      vulkanDescriptorSetLayout,
+                                                      layouts,
                                                       vulkanRenderPass,
                                                       pushConstants,
                                                       dynamicStates,
@@ -722,6 +701,11 @@ VulkanCommandBufferPtr VulkanRender::makeModelCommandBuffer(uint32_t frameIndex)
     beginInfo.renderArea.extent = vulkanSwapchain->getSwapChainExtent();
     beginInfo.clearValues = clearValues;
     
+    if (vulkanTimeStampQueryPool) {
+        vulkanTimeStampQueryPool->resetPool(buffer);
+        buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vulkanTimeStampQueryPool, 0);
+    }
+    
     // Запуск рендер-прохода
     buffer->cmdBeginRenderPass(beginInfo, VK_SUBPASS_CONTENTS_INLINE);
     
@@ -761,6 +745,10 @@ VulkanCommandBufferPtr VulkanRender::makeModelCommandBuffer(uint32_t frameIndex)
     // Заканчиваем рендер проход
     buffer->cmdEndRenderPass();
     
+    if (vulkanTimeStampQueryPool) {
+        buffer->cmdWriteTimeStamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vulkanTimeStampQueryPool, 1);
+    }
+    
     // Заканчиваем подготовку коммандного буффера
     buffer->end();
 
@@ -885,6 +873,40 @@ void VulkanRender::drawFrame() {
 	//LOG("\n\n");
 }
 
+// Вывести статы GPU: время рендер прохода с резолвом и реально выделенная под мультисемплинг память
+void VulkanRender::printGPUStats(){
+    if (vulkanTimeStampQueryPool) {
+        // Подождем пока сформируется таймстамп
+        vulkanRenderQueue->wait();
+        
+        float period = vulkanPhysicalDevice->getDeviceProperties().limits.timestampPeriod;
+        uint32_t validBitscount = vulkanPhysicalDevice->getQueuesFamiliesIndexes().renderQueuesTimeStampValidBits;
+        uint64_t maskValue = (validBitscount >= 64) ? ~0ULL : ((1ULL << validBitscount) - 1);
+        
+        std::vector<uint64_t> testResults = vulkanTimeStampQueryPool->getPoolTimeStampResults();
+        if (testResults.size() >= 2) {
+            double microsecondsValue = (((testResults[1] & maskValue) - (testResults[0] & maskValue)) * period) / 1000.0;
+            multisampleGPUTime += microsecondsValue;
+            multisampleGPUSamplesCount++;
+            LOG("MSAA X%d render pass GPU time: %.0f microSec, average %.1f microSec (%d samples)\n",
+                static_cast<int>(multisampleColorImage->getBaseSampleCount()), microsecondsValue,
+                multisampleGPUTime / multisampleGPUSamplesCount, multisampleGPUSamplesCount);
+        }
+    }
+    
+    // Для lazily allocated памяти драйвер сообщает, сколько реально выделено, обычная выделена целиком
+    if (multisampleColorLazyMemory || multisampleDepthLazyMemory) {
+        VkDeviceSize colorCommitted = multisampleColorLazyMemory ? multisampleColorMemory->getCommitment() : multisampleColorMemory->getBaseSize();
+        VkDeviceSize depthCommitted = multisampleDepthLazyMemory ? multisampleDepthMemory->getCommitment() : multisampleDepthMemory->getBaseSize();
+        LOG("MSAA X%d attachments memory: %.1f MB requested, %.1f MB committed\n",
+            static_cast<int>(multisampleColorImage->getBaseSampleCount()),
+            multisampleMemorySize / (1024.0 * 1024.0), (colorCommitted + depthCommitted) / (1024.0 * 1024.0));
+    }else{
+        LOG("MSAA X%d attachments memory: %.1f MB, no lazily allocated memory\n",
+            static_cast<int>(multisampleColorImage->getBaseSampleCount()), multisampleMemorySize / (1024.0 * 1024.0));
+    }
+}
+
 VulkanRender::~VulkanRender(){    
     // Ждем завершения работы Vulkan
     vulkanRenderQueue->wait();
@@ -903,12 +925,18 @@ VulkanRender::~VulkanRender(){
     modelTextureImageView = nullptr;
     multisampleColorImage = nullptr;
     multisampleColorImageView = nullptr;
+    multisampleDepthImage = nullptr;
+    multisampleDepthImageView = nullptr;
+    multisampleColorMemory = nullptr;
+    multisampleDepthMemory = nullptr;
+    vulkanTimeStampQueryPool = nullptr;
     vulkanRenderCommandPool = nullptr;
     vulkanPipeline = nullptr;
     vulkanVertexModule = nullptr;
     vulkanFragmentModule = nullptr;
     vulkanDescriptorSetLayout = nullptr;
     vulkanRenderPass = nullptr;
+    vulkanRenderPassCache = nullptr;
     vulkanWindowFrameBuffers.clear();
     vulkanWindowDepthImageView = nullptr;
     vulkanWindowDepthImage = nullptr;
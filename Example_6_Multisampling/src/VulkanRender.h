@@ -19,6 +19,7 @@
 #include "VulkanImage.h"
 #include "VulkanImageView.h"
 #include "VulkanRenderPass.h"
+#include "VulkanRenderPassCache.h"
 #include "VulkanFrameBuffer.h"
 #include "VulkanDescriptorSetLayout.h"
 #include "VulkanShaderModule.h"
@@ -29,6 +30,7 @@
 #include "VulkanBuffer.h"
 #include "VulkanDescriptorPool.h"
 #include "VulkanDescriptorSet.h"
+#include "VulkanQueryPool.h"
 
 #include "Vertex.h"
 #include "UniformBuffer.h"
@@ -36,9 +38,16 @@
 
 #define RenderI VulkanRender::getInstance()
 
+// Настройки рендера из командной строки, нужны до создания рендера
+struct VulkanRenderSettings {
+    uint32_t multisampleSamplesCount;   // Желаемое количество семплов (2, 4, 8), берется ближайшее поддерживаемое не больше
+    
+    VulkanRenderSettings();
+};
+
 struct VulkanRender {
 public:
-    static void initInstance(GLFWwindow* window);
+    static void initInstance(GLFWwindow* window, const VulkanRenderSettings& settings);
     static VulkanRender* getInstance();
     static void destroyRender();
 
@@ -49,12 +58,15 @@ public:
     void updateRender(float delta);
     // Непосредственно отрисовка кадра
     void drawFrame();
+    // Вывести статы GPU
+    void printGPUStats();
     
 private:
     VulkanRender();
     ~VulkanRender();
     
 public:
+    VulkanRenderSettings settings;
     VulkanInstancePtr vulkanInstance;
     VulkanSurfacePtr vulkanWindowSurface;
     VulkanPhysicalDevicePtr vulkanPhysicalDevice;
@@ -68,6 +80,7 @@ public:
     VulkanSwapchainPtr vulkanSwapchain;
     VulkanImagePtr vulkanWindowDepthImage;
     VulkanImageViewPtr vulkanWindowDepthImageView;
+    VulkanRenderPassCachePtr vulkanRenderPassCache;
     VulkanRenderPassPtr vulkanRenderPass;
     std::vector<VulkanFrameBufferPtr> vulkanWindowFrameBuffers;
     VulkanDescriptorSetLayoutPtr vulkanDescriptorSetLayout;
@@ -81,6 +94,14 @@ public:
     VulkanImagePtr multisampleDepthImage;
     VulkanImageViewPtr multisampleDepthImageView;
     VulkanRenderPassPtr multisampleRenderPass;
+    VulkanDeviceMemoryPtr multisampleColorMemory;
+    VulkanDeviceMemoryPtr multisampleDepthMemory;
+    bool multisampleColorLazyMemory;
+    bool multisampleDepthLazyMemory;
+    VkDeviceSize multisampleMemorySize;
+    VulkanQueryPoolPtr vulkanTimeStampQueryPool;
+    double multisampleGPUTime;
+    uint32_t multisampleGPUSamplesCount;
     
     VulkanImagePtr modelTextureImage;
     VulkanImageViewPtr modelTextureImageView;
@@ -112,10 +133,14 @@ private:
     void createWindowDepthResources();
     // Создание изображения для мультисемплинга и вью для него
     void createMultisampleImagesAndViews();
+    // Выделяем и привязываем память картинки мультисемплинга, lazy - выбрана lazily allocated память
+    VulkanDeviceMemoryPtr bindMultisampleMemory(const VulkanImagePtr& image, bool& lazy);
     // Создаем фреймбуфферы для вьюшек изображений окна
     void createWindowFrameBuffers();
     // Создание рендер прохода
     void createMainRenderPass();
+    // Создание пула запроса времени на GPU
+    void createQueryPool();
     // Создаем структуру дескрипторов для отрисовки (юниформ буффер, семплер и тд)
     void createDescriptorsSetLayout();
     // Грузим шейдеры
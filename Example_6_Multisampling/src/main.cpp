@@ -65,8 +65,17 @@ int local_main(int argc, char** argv) {
         throw std::runtime_error("Vulkan support not found!");
     }
 
+    // Настройки, влияющие на создание рендера: --samples <n>
+    VulkanRenderSettings settings;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0) {
+            settings.multisampleSamplesCount = static_cast<uint32_t>(std::max(atoi(argv[i + 1]), 1));
+            i++;
+        }
+    }
+
     // Создаем рендер
-    VulkanRender::initInstance(window);    
+    VulkanRender::initInstance(window, settings);    
     
     // Цикл обработки графики
     std::chrono::high_resolution_clock::time_point lastDrawTime = std::chrono::high_resolution_clock::now();
@@ -108,6 +117,8 @@ int local_main(int argc, char** argv) {
                     (double)std::chrono::duration_cast<std::chrono::microseconds>(drawCallDuration).count() / 1000.0,
                     (double)std::chrono::duration_cast<std::chrono::microseconds>(sleepDuration).count() / 1000.0 );
             glfwSetWindowTitle(window, outText);
+            
+            VulkanRender::getInstance()->printGPUStats();
         }
    }
         
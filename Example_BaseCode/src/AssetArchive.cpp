@@ -0,0 +1,218 @@
+#include "AssetArchive.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "Helpers.h"
+
+
+AssetData::AssetData(const AssetFilePtr& file, const AssetFileView& view):
+    _file(file),
+    _view(view){
+}
+
+AssetData::AssetData(std::vector<unsigned char>& buffer){
+    _buffer.swap(buffer);
+    _view = AssetFileView(_buffer.data(), _buffer.size());
+}
+
+AssetFileView AssetData::getView() const{
+    return _view;
+}
+
+const unsigned char* AssetData::getData() const{
+    return _view.data;
+}
+
+size_t AssetData::getSize() const{
+    return _view.size;
+}
+
+bool AssetData::isCopied() const{
+    return _file == nullptr;
+}
+
+void AssetData::prefetch() const{
+    if (_file) {
+        _file->prefetch(static_cast<size_t>(_view.data - _file->getData()), _view.size);
+    }
+}
+
+void AssetData::adviseSequential() const{
+    if (_file) {
+        _file->adviseSequential(static_cast<size_t>(_view.data - _file->getData()), _view.size);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Поля архива не доверенные - проверяем без переполнения offset + size
+static bool isRangeInside(uint64_t offset, uint64_t size, uint64_t limit){
+    return (offset <= limit) && (size <= limit - offset);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetArchive::AssetArchive(const std::string& path):
+    _path(path),
+    _header(nullptr),
+    _buckets(nullptr),
+    _entries(nullptr),
+    _names(nullptr){
+    
+    // Архив мапится всегда, каким бы маленьким он ни был - записи отдаются прямо из мапинга
+    _file = std::make_shared<AssetFile>(path, 0);
+    AssetFileView view = _file->getView();
+    
+    if (view.size < sizeof(AssetArchiveHeader)) {
+        LOG("Asset archive %s is too small!\n", path.c_str());
+        throw std::runtime_error("Asset archive is too small!");
+    }
+    _header = reinterpret_cast<const AssetArchiveHeader*>(view.data);
+    if ((_header->magic != ASSET_ARCHIVE_MAGIC) || (_header->version != ASSET_ARCHIVE_VERSION) || (_header->bucketBits > 31)) {
+        LOG("Asset archive %s has wrong header!\n", path.c_str());
+        throw std::runtime_error("Asset archive has wrong header!");
+    }
+    
+    // Все таблицы должны лежать внутри файла, дальше в рантайме границы уже не проверяются
+    uint64_t bucketsSize = ((1ULL << _header->bucketBits) + 1) * sizeof(uint32_t);
+    uint64_t entriesSize = (uint64_t)_header->entriesCount * sizeof(AssetArchiveEntry);
+    bool tablesValid = (_header->bucketsOffset % sizeof(uint32_t) == 0) &&
+                       (_header->entriesOffset % sizeof(uint64_t) == 0) &&
+                       isRangeInside(_header->bucketsOffset, bucketsSize, view.size) &&
+                       isRangeInside(_header->entriesOffset, entriesSize, view.size) &&
+                       isRangeInside(_header->namesOffset, _header->namesSize, view.size);
+    if (tablesValid == false) {
+        LOG("Asset archive %s is truncated!\n", path.c_str());
+        throw std::runtime_error("Asset archive is truncated!");
+    }
+    _buckets = reinterpret_cast<const uint32_t*>(view.data + _header->bucketsOffset);
+    _entries = reinterpret_cast<const AssetArchiveEntry*>(view.data + _header->entriesOffset);
+    _names = reinterpret_cast<const char*>(view.data + _header->namesOffset);
+    
+    for (uint32_t i = 0; i < _header->entriesCount; i++) {
+        const AssetArchiveEntry& entry = _entries[i];
+        if ((isRangeInside(entry.offset, entry.storedSize, view.size) == false) || (isRangeInside(entry.nameOffset, entry.nameSize, _header->namesSize) == false)) {
+            LOG("Asset archive %s has broken entry %d!\n", path.c_str(), (int)i);
+            throw std::runtime_error("Asset archive has broken entry!");
+        }
+    }
+    uint32_t bucketsCount = 1u << _header->bucketBits;
+    if (_buckets[bucketsCount] != _header->entriesCount) {
+        LOG("Asset archive %s has broken index!\n", path.c_str());
+        throw std::runtime_error("Asset archive has broken index!");
+    }
+    
+    // Таблицы нужны при каждом поиске - подгружаем их сразу
+    _file->prefetch(0, _header->namesOffset + _header->namesSize);
+}
+
+AssetArchive::~AssetArchive(){
+}
+
+const AssetArchiveEntry* AssetArchive::findEntry(const std::string& path) const{
+    std::string normalizedPath = normalizeAssetPath(path);
+    uint64_t hash = hashAssetPath(normalizedPath);
+    uint32_t bucket = getAssetArchiveBucket(hash, _header->bucketBits);
+    uint32_t end = std::min(_buckets[bucket + 1], _header->entriesCount);
+    for (uint32_t i = _buckets[bucket]; i < end; i++) {
+        const AssetArchiveEntry& entry = _entries[i];
+        if (entry.pathHash > hash) {
+            break;
+        }
+        // Хеш может совпасть у разных путей - сравниваем сам путь
+        if ((entry.pathHash == hash) &&
+            (entry.nameSize == normalizedPath.size()) &&
+            (memcmp(_names + entry.nameOffset, normalizedPath.data(), entry.nameSize) == 0)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetArchive::contains(const std::string& path) const{
+    return findEntry(path) != nullptr;
+}
+
+AssetDataPtr AssetArchive::load(const std::string& path) const{
+    const AssetArchiveEntry* entry = findEntry(path);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    
+    AssetFileView stored = _file->getView().subview(static_cast<size_t>(entry->offset), static_cast<size_t>(entry->storedSize));
+    switch (entry->compression) {
+        case ASSET_ARCHIVE_COMPRESSION_NONE:
+            return std::make_shared<AssetData>(_file, stored);
+            
+        case ASSET_ARCHIVE_COMPRESSION_LZ4: {
+            std::vector<unsigned char> buffer(static_cast<size_t>(entry->size));
+            if (decompressLZ4Block(stored.data, stored.size, buffer.data(), buffer.size()) == false) {
+                LOG("Failed to decompress %s from asset archive %s!\n", path.c_str(), _path.c_str());
+                throw std::runtime_error("Failed to decompress asset!");
+            }
+            return std::make_shared<AssetData>(buffer);
+        }
+    }
+    
+    LOG("Unknown compression %d of %s in asset archive %s!\n", (int)entry->compression, path.c_str(), _path.c_str());
+    throw std::runtime_error("Unknown asset compression!");
+}
+
+void AssetArchive::prefetch(const std::string& path) const{
+    const AssetArchiveEntry* entry = findEntry(path);
+    if (entry) {
+        _file->prefetch(static_cast<size_t>(entry->offset), static_cast<size_t>(entry->storedSize));
+    }
+}
+
+void AssetArchive::printStats() const{
+    uint32_t compressedCount = 0;
+    uint64_t size = 0;
+    uint64_t storedSize = 0;
+    for (uint32_t i = 0; i < _header->entriesCount; i++) {
+        compressedCount += (_entries[i].compression != ASSET_ARCHIVE_COMPRESSION_NONE) ? 1 : 0;
+        size += _entries[i].size;
+        storedSize += _entries[i].storedSize;
+    }
+    LOG("Asset archive %s: %d entries (%d compressed), %.1f MB of data stored in %.1f MB, file %.1f MB\n",
+        _path.c_str(), (int)_header->entriesCount, (int)compressedCount,
+        double(size) / (1024.0 * 1024.0), double(storedSize) / (1024.0 * 1024.0), double(_file->getSize()) / (1024.0 * 1024.0));
+}
+
+uint32_t AssetArchive::getEntriesCount() const{
+    return _header->entriesCount;
+}
+
+const AssetArchiveEntry* AssetArchive::getEntries() const{
+    return _entries;
+}
+
+std::string AssetArchive::getEntryPath(const AssetArchiveEntry& entry) const{
+    return std::string(_names + entry.nameOffset, entry.nameSize);
+}
+
+const std::string& AssetArchive::getBasePath() const{
+    return _path;
+}
+
+AssetArchivePtr AssetArchive::tryOpen(const std::string& path){
+    try {
+        return std::make_shared<AssetArchive>(path);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetDataPtr loadAsset(const AssetArchivePtr& archive, const std::string& path){
+    if (archive) {
+        AssetDataPtr data = archive->load(path);
+        if (data) {
+            return data;
+        }
+    }
+    AssetFilePtr file = std::make_shared<AssetFile>(path);
+    return std::make_shared<AssetData>(file, file->getView());
+}
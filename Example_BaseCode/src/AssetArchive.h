@@ -0,0 +1,82 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "AssetFile.h"
+#include "AssetArchiveFormat.h"
+
+
+// Данные одного ассета: кусок мапинга архива или отдельного файла без копирования, либо распакованный буффер
+class AssetData {
+public:
+    AssetData(const AssetFilePtr& file, const AssetFileView& view);
+    AssetData(std::vector<unsigned char>& buffer);  // Забирает содержимое буффера
+    AssetFileView getView() const;
+    const unsigned char* getData() const;
+    size_t getSize() const;
+    bool isCopied() const;
+    // Подсказки ядру для данных прямо из мапинга, для скопированных данных ничего не делают
+    void prefetch() const;
+    void adviseSequential() const;
+    
+private:
+    AssetFilePtr _file;     // Держит мапинг, пока нужны данные
+    std::vector<unsigned char> _buffer;
+    AssetFileView _view;
+    
+private:
+    AssetData(const AssetData&);
+    AssetData& operator=(const AssetData&);
+};
+
+typedef std::shared_ptr<AssetData> AssetDataPtr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Архив ассетов, собранный утилитой AssetPacker: один открытый и замапленный файл вместо отдельного файла на ассет.
+// Поиск - хеш пути, корзина по старшим битам хеша, сравнение пути внутри корзины, в среднем одна запись.
+// Несжатые записи отдаются прямо из мапинга, LZ4 записи распаковываются при каждой загрузке
+class AssetArchive {
+public:
+    AssetArchive(const std::string& path);
+    ~AssetArchive();
+    // nullptr, если такого пути в архиве нет
+    const AssetArchiveEntry* findEntry(const std::string& path) const;
+    bool contains(const std::string& path) const;
+    // nullptr, если такого пути в архиве нет. Поврежденная запись - исключение
+    AssetDataPtr load(const std::string& path) const;
+    // Асинхронная подгрузка страниц записи, например для ассетов следующего уровня
+    void prefetch(const std::string& path) const;
+    void printStats() const;
+    uint32_t getEntriesCount() const;
+    const AssetArchiveEntry* getEntries() const;
+    std::string getEntryPath(const AssetArchiveEntry& entry) const;
+    const std::string& getBasePath() const;
+    
+    // Без исключения: если архива нет или он поврежден - nullptr
+    static std::shared_ptr<AssetArchive> tryOpen(const std::string& path);
+    
+private:
+    std::string _path;
+    AssetFilePtr _file;
+    const AssetArchiveHeader* _header;
+    const uint32_t* _buckets;
+    const AssetArchiveEntry* _entries;
+    const char* _names;
+    
+private:
+    AssetArchive(const AssetArchive&);
+    AssetArchive& operator=(const AssetArchive&);
+};
+
+typedef std::shared_ptr<AssetArchive> AssetArchivePtr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ассет сначала ищется в архиве (может быть nullptr), потом отдельным файлом. Нет нигде - исключение
+AssetDataPtr loadAsset(const AssetArchivePtr& archive, const std::string& path);
+
+#endif
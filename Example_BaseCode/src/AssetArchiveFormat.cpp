@@ -0,0 +1,214 @@
+#include "AssetArchiveFormat.h"
+#include <cstring>
+#include <vector>
+#include "Helpers.h"
+
+
+// Ограничения формата LZ4: последние 5 байт - всегда литералы, совпадение не начинается ближе 12 байт к концу
+static const size_t LZ4_MIN_MATCH = 4;
+static const size_t LZ4_LAST_LITERALS = 5;
+static const size_t LZ4_MATCH_START_LIMIT = 12;
+static const size_t LZ4_MAX_OFFSET = 65535;
+static const uint32_t LZ4_HASH_BITS = 16;
+
+static uint32_t readUint32(const unsigned char* data){
+    uint32_t value = 0;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Длина больше 15 дописывается байтами 255 и остатком
+static bool writeLZ4Length(size_t length, unsigned char*& op, const unsigned char* opEnd){
+    while (length >= 255) {
+        if (op >= opEnd) {
+            return false;
+        }
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= opEnd) {
+        return false;
+    }
+    *op++ = static_cast<unsigned char>(length);
+    return true;
+}
+
+static bool readLZ4Length(size_t& length, const unsigned char*& ip, const unsigned char* ipEnd){
+    unsigned char value = 255;
+    while (value == 255) {
+        if (ip >= ipEnd) {
+            return false;
+        }
+        value = *ip++;
+        length += value;
+    }
+    return true;
+}
+
+// Последовательность: токен, литералы, смещение и длина совпадения. Последняя последовательность - только литералы
+static bool writeLZ4Sequence(const unsigned char* literals, size_t literalsCount, size_t offset, size_t matchLength,
+                             unsigned char*& op, const unsigned char* opEnd){
+    if (op >= opEnd) {
+        return false;
+    }
+    unsigned char* token = op++;
+    *token = static_cast<unsigned char>(((literalsCount >= 15) ? 15 : literalsCount) << 4);
+    if ((literalsCount >= 15) && (writeLZ4Length(literalsCount - 15, op, opEnd) == false)) {
+        return false;
+    }
+    if (static_cast<size_t>(opEnd - op) < literalsCount) {
+        return false;
+    }
+    memcpy(op, literals, literalsCount);
+    op += literalsCount;
+    
+    if (matchLength == 0) {
+        return true;
+    }
+    if (opEnd - op < 2) {
+        return false;
+    }
+    *op++ = static_cast<unsigned char>(offset & 0xFF);
+    *op++ = static_cast<unsigned char>(offset >> 8);
+    size_t matchCode = matchLength - LZ4_MIN_MATCH;
+    *token |= static_cast<unsigned char>((matchCode >= 15) ? 15 : matchCode);
+    if ((matchCode >= 15) && (writeLZ4Length(matchCode - 15, op, opEnd) == false)) {
+        return false;
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string normalizeAssetPath(const std::string& path){
+    std::string result = path;
+    for (char& c: result) {
+        if (c == '\\') {
+            c = '/';
+        }
+    }
+    while ((result.size() > 2) && (result[0] == '.') && (result[1] == '/')) {
+        result.erase(0, 2);
+    }
+    return result;
+}
+
+uint64_t hashAssetPath(const std::string& normalizedPath){
+    return hashBytes(normalizedPath.data(), normalizedPath.size());
+}
+
+uint32_t getAssetArchiveBucketBits(uint32_t entriesCount){
+    uint32_t bits = 0;
+    while ((bits < 31) && ((1u << bits) < entriesCount)) {
+        bits++;
+    }
+    return bits;
+}
+
+uint32_t getAssetArchiveBucket(uint64_t pathHash, uint32_t bucketBits){
+    // Старшие биты: порядок корзин совпадает с порядком отсортированных хешей
+    if (bucketBits == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(pathHash >> (64 - bucketBits));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t getLZ4CompressBound(size_t srcSize){
+    return srcSize + srcSize / 255 + 16;
+}
+
+// Жадный поиск совпадений по хеш таблице последних позиций 4-байтовых последовательностей
+size_t compressLZ4Block(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstCapacity){
+    unsigned char* op = dst;
+    const unsigned char* opEnd = dst + dstCapacity;
+    size_t anchor = 0;
+    
+    if (srcSize > LZ4_MATCH_START_LIMIT) {
+        std::vector<uint32_t> table(1 << LZ4_HASH_BITS, 0);    // Позиция + 1, 0 - пусто
+        size_t matchStartLimit = srcSize - LZ4_MATCH_START_LIMIT;
+        size_t matchEndLimit = srcSize - LZ4_LAST_LITERALS;
+        size_t ip = 0;
+        while (ip < matchStartLimit) {
+            uint32_t sequence = readUint32(src + ip);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(ip + 1);
+            
+            if ((candidate == 0) || (ip - (candidate - 1) > LZ4_MAX_OFFSET) || (readUint32(src + candidate - 1) != sequence)) {
+                ip++;
+                continue;
+            }
+            candidate--;
+            
+            size_t matchLength = LZ4_MIN_MATCH;
+            while ((ip + matchLength < matchEndLimit) && (src[candidate + matchLength] == src[ip + matchLength])) {
+                matchLength++;
+            }
+            if (writeLZ4Sequence(src + anchor, ip - anchor, ip - candidate, matchLength, op, opEnd) == false) {
+                return 0;
+            }
+            ip += matchLength;
+            anchor = ip;
+        }
+    }
+    
+    if (writeLZ4Sequence(src + anchor, srcSize - anchor, 0, 0, op, opEnd) == false) {
+        return 0;
+    }
+    return static_cast<size_t>(op - dst);
+}
+
+bool decompressLZ4Block(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize){
+    const unsigned char* ip = src;
+    const unsigned char* ipEnd = src + srcSize;
+    unsigned char* op = dst;
+    unsigned char* opEnd = dst + dstSize;
+    
+    while (ip < ipEnd) {
+        unsigned char token = *ip++;
+        
+        size_t literalsCount = token >> 4;
+        if ((literalsCount == 15) && (readLZ4Length(literalsCount, ip, ipEnd) == false)) {
+            return false;
+        }
+        if ((static_cast<size_t>(ipEnd - ip) < literalsCount) || (static_cast<size_t>(opEnd - op) < literalsCount)) {
+            return false;
+        }
+        memcpy(op, ip, literalsCount);
+        ip += literalsCount;
+        op += literalsCount;
+        
+        // Последняя последовательность без совпадения
+        if (ip == ipEnd) {
+            break;
+        }
+        
+        if (ipEnd - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        size_t matchLength = token & 0x0F;
+        if ((matchLength == 15) && (readLZ4Length(matchLength, ip, ipEnd) == false)) {
+            return false;
+        }
+        matchLength += LZ4_MIN_MATCH;
+        if ((offset == 0) || (offset > static_cast<size_t>(op - dst)) || (static_cast<size_t>(opEnd - op) < matchLength)) {
+            return false;
+        }
+        
+        // Совпадение может перекрываться с тем, что пишется - тогда копируем побайтово
+        const unsigned char* match = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        }else{
+            for (size_t i = 0; i < matchLength; i++) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return op == opEnd;
+}
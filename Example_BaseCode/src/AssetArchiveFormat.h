@@ -0,0 +1,66 @@
+#ifndef ASSET_ARCHIVE_FORMAT_H
+#define ASSET_ARCHIVE_FORMAT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// Формат архива ассетов, общий для рантайма (AssetArchive) и утилиты AssetPacker.
+// Без зависимостей от Vulkan и остального кода, все числа little-endian.
+//
+// [AssetArchiveHeader]
+// [uint32 bucketsStart[(1 << bucketBits) + 1]]  - корзины по старшим битам хеша пути: записи корзины b - [start[b], start[b + 1])
+// [AssetArchiveEntry entries[entriesCount]]     - отсортированы по хешу пути
+// [пути записей подряд, без нулей]
+// [данные записей, каждая с границы ASSET_ARCHIVE_ALIGNMENT]
+
+#define ASSET_ARCHIVE_MAGIC 0x4B505641  // "AVPK"
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ARCHIVE_ALIGNMENT 4096    // Данные с границы страницы: мапинг и подкачка не задевают соседние записи
+
+enum AssetArchiveCompression {
+    ASSET_ARCHIVE_COMPRESSION_NONE = 0,
+    ASSET_ARCHIVE_COMPRESSION_LZ4 = 1   // Блок LZ4 без фрейма
+};
+
+struct AssetArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entriesCount;
+    uint32_t bucketBits;
+    uint64_t bucketsOffset;
+    uint64_t entriesOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct AssetArchiveEntry {
+    uint64_t pathHash;
+    uint64_t offset;
+    uint64_t size;          // Размер после распаковки
+    uint64_t storedSize;    // Размер в архиве
+    uint32_t nameOffset;    // Относительно namesOffset
+    uint32_t nameSize;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 48, "AssetArchiveHeader layout");
+static_assert(sizeof(AssetArchiveEntry) == 48, "AssetArchiveEntry layout");
+
+// Пути в архиве с прямыми слешами и без "./" в начале, как их передает код: "res/shaders/model_shader_vert.spv"
+std::string normalizeAssetPath(const std::string& path);
+// FNV-1a 64 нормализованного пути
+uint64_t hashAssetPath(const std::string& normalizedPath);
+// Число корзин - степень двойки не меньше числа записей, в среднем одна запись на корзину
+uint32_t getAssetArchiveBucketBits(uint32_t entriesCount);
+uint32_t getAssetArchiveBucket(uint64_t pathHash, uint32_t bucketBits);
+
+// Сжатие блока LZ4, 0 - результат не влез в dstCapacity
+size_t getLZ4CompressBound(size_t srcSize);
+size_t compressLZ4Block(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstCapacity);
+// Распаковка ровно в dstSize байт, false - поврежденные данные
+bool decompressLZ4Block(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize);
+
+#endif
@@ -0,0 +1,203 @@
+#include "AssetFile.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include "Helpers.h"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+
+AssetFileView::AssetFileView():
+    data(nullptr),
+    size(0){
+}
+
+AssetFileView::AssetFileView(const unsigned char* data, size_t size):
+    data(data),
+    size(size){
+}
+
+const unsigned char* AssetFileView::begin() const{
+    return data;
+}
+
+const unsigned char* AssetFileView::end() const{
+    return data + size;
+}
+
+bool AssetFileView::empty() const{
+    return size == 0;
+}
+
+AssetFileView AssetFileView::subview(size_t offset, size_t count) const{
+    if (offset >= size) {
+        return AssetFileView(end(), 0);
+    }
+    return AssetFileView(data + offset, std::min(count, size - offset));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetFile::AssetFile(const std::string& path, size_t preadThreshold):
+    _path(path),
+    _data(nullptr),
+    _size(0),
+    _mapping(nullptr){
+    
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG("Failed to open file %s!\n", path.c_str());
+        throw std::runtime_error("Failed to open file!");
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        LOG("Failed to stat file %s!\n", path.c_str());
+        throw std::runtime_error("Failed to stat file!");
+    }
+    _size = static_cast<size_t>(fileStat.st_size);
+    
+    if ((_size > 0) && (_size >= preadThreshold)) {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            _mapping = mapping;
+            _data = static_cast<const unsigned char*>(mapping);
+        }
+    }
+    
+    // Маленький файл или мапинг не удался - читаем в буффер
+    if ((_mapping == nullptr) && (_size > 0)) {
+        _buffer.resize(_size);
+        size_t readBytes = 0;
+        while (readBytes < _size) {
+            ssize_t result = pread(fd, _buffer.data() + readBytes, _size - readBytes, static_cast<off_t>(readBytes));
+            if ((result < 0) && (errno == EINTR)) {
+                continue;
+            }
+            if (result <= 0) {
+                break;
+            }
+            readBytes += static_cast<size_t>(result);
+        }
+        if (readBytes != _size) {
+            close(fd);
+            LOG("Failed to read file %s!\n", path.c_str());
+            throw std::runtime_error("Failed to read file!");
+        }
+        _data = _buffer.data();
+    }
+    close(fd);
+#else
+    _buffer = readFile(path);
+    _size = _buffer.size();
+    _data = _buffer.data();
+#endif
+}
+
+AssetFile::~AssetFile(){
+#ifndef _WIN32
+    if (_mapping) {
+        munmap(_mapping, _size);
+    }
+#endif
+}
+
+AssetFileView AssetFile::getView() const{
+    return AssetFileView(_data, _size);
+}
+
+const unsigned char* AssetFile::getData() const{
+    return _data;
+}
+
+size_t AssetFile::getSize() const{
+    return _size;
+}
+
+bool AssetFile::isMapped() const{
+    return _mapping != nullptr;
+}
+
+void AssetFile::prefetch(size_t offset, size_t size) const{
+#ifndef _WIN32
+    if ((_mapping == nullptr) || (offset >= _size)) {
+        return;
+    }
+    size = std::min(size, _size - offset);
+    
+    // madvise принимает только выровненный по странице адрес
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - (offset % pageSize);
+    madvise(static_cast<unsigned char*>(_mapping) + alignedOffset, size + (offset - alignedOffset), MADV_WILLNEED);
+#endif
+}
+
+void AssetFile::adviseSequential(size_t offset, size_t size) const{
+#ifndef _WIN32
+    if ((_mapping == nullptr) || (offset >= _size)) {
+        return;
+    }
+    size = std::min(size, _size - offset);
+    
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - (offset % pageSize);
+    madvise(static_cast<unsigned char*>(_mapping) + alignedOffset, size + (offset - alignedOffset), MADV_SEQUENTIAL);
+#endif
+}
+
+const std::string& AssetFile::getBasePath() const{
+    return _path;
+}
+
+AssetFilePtr AssetFile::tryOpen(const std::string& path, size_t preadThreshold){
+    try {
+        return std::make_shared<AssetFile>(path, preadThreshold);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+AssetFileStream::ViewBuffer::ViewBuffer(const AssetFileView& view){
+    // streambuf не пишет в область чтения, const_cast безопасен
+    char* begin = const_cast<char*>(reinterpret_cast<const char*>(view.data));
+    setg(begin, begin, begin + view.size);
+}
+
+AssetFileStream::ViewBuffer::pos_type AssetFileStream::ViewBuffer::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode){
+    if ((mode & std::ios_base::in) == 0) {
+        return pos_type(off_type(-1));
+    }
+    char* base = eback();
+    if (dir == std::ios_base::cur) {
+        offset += gptr() - base;
+    }else if (dir == std::ios_base::end) {
+        offset += egptr() - base;
+    }
+    if ((offset < 0) || (offset > egptr() - base)) {
+        return pos_type(off_type(-1));
+    }
+    setg(base, base + offset, egptr());
+    return pos_type(offset);
+}
+
+AssetFileStream::ViewBuffer::pos_type AssetFileStream::ViewBuffer::seekpos(pos_type pos, std::ios_base::openmode mode){
+    return seekoff(off_type(pos), std::ios_base::beg, mode);
+}
+
+AssetFileStream::AssetFileStream(const AssetFileView& view):
+    std::istream(nullptr),
+    _buffer(view){
+    rdbuf(&_buffer);
+}
@@ -0,0 +1,84 @@
+#ifndef ASSET_FILE_H
+#define ASSET_FILE_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <istream>
+#include <streambuf>
+
+
+// Кусок байт файла без копирования, действителен пока жив AssetFile
+struct AssetFileView {
+    const unsigned char* data;
+    size_t size;
+    
+    AssetFileView();
+    AssetFileView(const unsigned char* data, size_t size);
+    const unsigned char* begin() const;
+    const unsigned char* end() const;
+    bool empty() const;
+    // Обрезается по концу данных
+    AssetFileView subview(size_t offset, size_t count) const;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Файл ассета только на чтение.
+// Большие файлы мапятся в память, страницы подгружаются ядром при обращении.
+// Маленькие файлы (меньше preadThreshold) читаются одним pread в свой буффер - для них мапинг дороже самого чтения
+class AssetFile {
+public:
+    static const size_t DEFAULT_PREAD_THRESHOLD = 16 * 1024;
+    
+    // Нет файла - исключение, preadThreshold = 0 - мапим всегда
+    AssetFile(const std::string& path, size_t preadThreshold = DEFAULT_PREAD_THRESHOLD);
+    ~AssetFile();
+    AssetFileView getView() const;
+    const unsigned char* getData() const;
+    size_t getSize() const;
+    bool isMapped() const;
+    // Асинхронная подсказка ядру подгрузить страницы заранее (MADV_WILLNEED), вызов не ждет чтения
+    void prefetch(size_t offset = 0, size_t size = SIZE_MAX) const;
+    // Файл (или его диапазон) будет читаться подряд, ядро может читать страницы наперед крупнее
+    void adviseSequential(size_t offset = 0, size_t size = SIZE_MAX) const;
+    const std::string& getBasePath() const;
+    
+    // Без исключения: если файла нет - nullptr
+    static std::shared_ptr<AssetFile> tryOpen(const std::string& path, size_t preadThreshold = DEFAULT_PREAD_THRESHOLD);
+    
+private:
+    std::string _path;
+    const unsigned char* _data;
+    size_t _size;
+    void* _mapping;
+    std::vector<unsigned char> _buffer;     // Маленькие файлы и системы без mmap
+    
+private:
+    AssetFile(const AssetFile&);
+    AssetFile& operator=(const AssetFile&);
+};
+
+typedef std::shared_ptr<AssetFile> AssetFilePtr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// std::istream поверх AssetFileView без копирования, для парсеров, которые умеют только потоки
+class AssetFileStream: public std::istream {
+public:
+    AssetFileStream(const AssetFileView& view);
+    
+private:
+    class ViewBuffer: public std::streambuf {
+    public:
+        ViewBuffer(const AssetFileView& view);
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode mode);
+        pos_type seekpos(pos_type pos, std::ios_base::openmode mode);
+    };
+    
+    ViewBuffer _buffer;
+};
+
+#endif
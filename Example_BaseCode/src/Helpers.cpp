@@ -3,6 +3,8 @@
 #include <cstring>
 #include <stdexcept>
 #include <fstream>
+#include <algorithm>
+#include <functional>
 
 #ifdef _MSC_BUILD
 	#include <Windows.h>
@@ -10,6 +12,8 @@
     //#include <thread>
     #include <errno.h>
     #include <time.h>
+    #include <dirent.h>
+    #include <sys/stat.h>
 #endif 
 
 // Читаем побайтово файлик
@@ -35,6 +39,52 @@ std::vector<unsigned char> readFile(const std::string& filename) {
     return buffer;
 }
 
+std::vector<std::string> listDirectoryFiles(const std::string& path){
+    std::vector<std::string> result;
+#ifdef _MSC_BUILD
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((path + "\\*").c_str(), &findData);
+    if (findHandle == INVALID_HANDLE_VALUE) {
+        return result;
+    }
+    do {
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+            result.push_back(path + "/" + findData.cFileName);
+        }
+    } while (FindNextFileA(findHandle, &findData));
+    FindClose(findHandle);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return result;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string filePath = path + "/" + entry->d_name;
+        struct stat fileStat;
+        if ((stat(filePath.c_str(), &fileStat) == 0) && S_ISREG(fileStat.st_mode)) {
+            result.push_back(filePath);
+        }
+    }
+    closedir(dir);
+#endif
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool createDirectory(const std::string& path){
+#ifdef _MSC_BUILD
+    if (CreateDirectoryA(path.c_str(), NULL) == 0) {
+        return GetLastError() == ERROR_ALREADY_EXISTS;
+    }
+    return true;
+#else
+    if (mkdir(path.c_str(), 0755) != 0) {
+        return errno == EEXIST;
+    }
+    return true;
+#endif
+}
+
 std::chrono::high_resolution_clock::time_point timestampBegin(){
     return std::chrono::high_resolution_clock::now();
 }
@@ -67,6 +117,26 @@ void alignedFree(void* data) {
 #endif
 }
 
+void hashCombine(size_t& seed, uint64_t value) {
+    seed ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void hashValue(uint64_t& hash, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 1099511628211ULL;
+    }
+}
+
 #ifdef _MSVC_LANG
 int __cdecl LOG(const char *format, ...) {
 	char str[1024];
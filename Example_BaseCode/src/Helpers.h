@@ -4,11 +4,18 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <cstdint>
 
 
 // Читаем побайтово файлик
 std::vector<unsigned char> readFile(const std::string& filename);
 
+// Полные пути обычных файлов в папке без рекурсии, отсортированы по имени. Пустой список, если папки нет
+std::vector<std::string> listDirectoryFiles(const std::string& path);
+
+// Создаем папку без рекурсии, true - если папка создана или уже есть
+bool createDirectory(const std::string& path);
+
 std::chrono::high_resolution_clock::time_point timestampBegin();
 
 void timestampEndMicroSec(const std::chrono::high_resolution_clock::time_point& time1, const char* infoText);
@@ -18,6 +25,15 @@ void timestampEndMicroSec(const std::chrono::high_resolution_clock::time_point&
 void* alignedAlloc(size_t size, size_t alignment);
 void alignedFree(void* data);
 
+// Добавляем значение к хешу ключа кеша, как boost::hash_combine
+void hashCombine(size_t& seed, uint64_t value);
+
+// FNV-1a 64, хеш можно продолжать частями: для ключей кешей, путей архива и имен файлов кеша
+#define FNV1A_INITIAL_HASH 14695981039346656037ULL
+uint64_t hashBytes(const void* data, size_t size, uint64_t hash = FNV1A_INITIAL_HASH);
+// 8 байт значения от младшего к старшему, результат не зависит от порядка байт платформы
+void hashValue(uint64_t& hash, uint64_t value);
+
 #define TIME_BEGIN(NAME) std::chrono::high_resolution_clock::time_point NAME = timestampBegin();
 #define TIME_END_MICROSEC(NAME, INFO) timestampEndMicroSec(NAME, INFO)
 
@@ -44,8 +44,8 @@ VulkanBuffer::VulkanBuffer(VulkanLogicalDevicePtr logicalDevice, VkMemoryPropert
     allocInfo.allocationSize = memRequirements.size;
     allocInfo.memoryTypeIndex = memoryTypeIndex;
     
-    // Выделяем память для буффера
-    if (vkAllocateMemory(_logicalDevice->getDevice(), &allocInfo, nullptr, &_bufferMemory) != VK_SUCCESS) {
+    // Выделяем память для буффера, сверх dataSize - округление до требований драйвера
+    if (_logicalDevice->getMemoryStats()->allocateMemory(_logicalDevice->getDevice(), allocInfo, dataSize, &_bufferMemory) != VK_SUCCESS) {
         LOG("Failed to allocate vertex buffer memory!");
         throw std::runtime_error("Failed to allocate vertex buffer memory!");
     }
@@ -58,7 +58,7 @@ VulkanBuffer::VulkanBuffer(VulkanLogicalDevicePtr logicalDevice, VkMemoryPropert
 
 VulkanBuffer::~VulkanBuffer(){
     vkDestroyBuffer(_logicalDevice->getDevice(), _buffer, nullptr);
-    vkFreeMemory(_logicalDevice->getDevice(), _bufferMemory, nullptr);
+    _logicalDevice->getMemoryStats()->freeMemory(_logicalDevice->getDevice(), _bufferMemory);
 }
 
 void VulkanBuffer::uploadDataToBuffer(unsigned char* inputData, size_t dataSize, size_t offset){
@@ -28,7 +28,9 @@ VulkanImageBarrierInfo::VulkanImageBarrierInfo():
     levelsCount(0),
     aspectFlags(VK_IMAGE_ASPECT_COLOR_BIT),
     srcAccessBarrier(0),
-    dstAccessBarrier(0){
+    dstAccessBarrier(0),
+    srcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED),
+    dstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED){
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -37,7 +39,9 @@ VulkanBufferBarrierInfo::VulkanBufferBarrierInfo():
     srcAccessMask(0),
     dstAccessMask(0),
     offset(0),
-    size(0){
+    size(0),
+    srcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED),
+    dstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED){
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +180,10 @@ void VulkanCommandBuffer::cmdBeginRenderPass(const VulkanRenderPassBeginInfo& be
     vkCmdBeginRenderPass(_commandBuffer, &renderPassInfo, contentsType);
 }
 
+void VulkanCommandBuffer::cmdNextSubpass(VkSubpassContents contentsType){
+    vkCmdNextSubpass(_commandBuffer, contentsType);
+}
+
 void VulkanCommandBuffer::cmdEndRenderPass(){
     vkCmdEndRenderPass(_commandBuffer);
 }
@@ -276,6 +284,34 @@ void VulkanCommandBuffer::cmdBindDescriptorSets(const VkPipelineLayout& pipeline
                             offsets.size(), offsets.data());
 }
 
+void VulkanCommandBuffer::cmdBindComputePipeline(const VulkanComputePipelinePtr& pipeline){
+    _usedObjects.insert(pipeline);
+    vkCmdBindPipeline(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->getPipeline());
+}
+
+void VulkanCommandBuffer::cmdBindComputeDescriptorSet(const VkPipelineLayout& pipelineLayout,
+                                                      const VulkanDescriptorSetPtr& set){
+    _usedObjects.insert(set);
+    
+    VkDescriptorSet vkSet = set->getSet();
+    vkCmdBindDescriptorSets(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &vkSet, 0, nullptr);
+}
+
+void VulkanCommandBuffer::cmdBindComputeDescriptorSets(const VkPipelineLayout& pipelineLayout,
+                                                       const std::vector<VulkanDescriptorSetPtr>& sets){
+    _usedObjects.insert(sets.begin(), sets.end());
+    
+    std::vector<VkDescriptorSet> vkSets;
+    vkSets.reserve(sets.size());
+    for (const VulkanDescriptorSetPtr& set: sets) {
+        vkSets.push_back(set->getSet());
+    }
+    
+    vkCmdBindDescriptorSets(_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0,
+                            vkSets.size(), vkSets.data(),
+                            0, nullptr);
+}
+
 void VulkanCommandBuffer::cmdPushConstants(const VkPipelineLayout& pipelineLayout, VkShaderStageFlags stage, const void* data, uint32_t size, uint32_t offset){
     vkCmdPushConstants(_commandBuffer,
                        pipelineLayout,
@@ -293,6 +329,10 @@ void VulkanCommandBuffer::cmdDrawIndexed(uint32_t indexCount, uint32_t instanceC
     vkCmdDrawIndexed(_commandBuffer, indexCount, instanceCount, 0, 0, 0);
 }
 
+void VulkanCommandBuffer::cmdDispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ){
+    vkCmdDispatch(_commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
 void VulkanCommandBuffer::cmdCopyImage(const VulkanImagePtr& srcImage, const VulkanImagePtr& dstImage, VkImageAspectFlags aspectMask, uint32_t mipLevel){
     _usedObjects.insert(srcImage);
     _usedObjects.insert(dstImage);
@@ -358,8 +398,20 @@ void VulkanCommandBuffer::cmdCopyAllBuffer(const VulkanBufferPtr& srcBuffer, con
     vkCmdCopyBuffer(_commandBuffer, srcBuffer->getBuffer(), dstBuffer->getBuffer(), 1, &copyRegion);
 }
 
+void VulkanCommandBuffer::cmdCopyBufferToImage(const VulkanBufferPtr& srcBuffer, const VulkanImagePtr& dstImage, const std::vector<VkBufferImageCopy>& regions, VkImageLayout dstLayout){
+    if (regions.empty()) {
+        return;
+    }
+    
+    _usedObjects.insert(srcBuffer);
+    _usedObjects.insert(dstImage);
+    
+    vkCmdCopyBufferToImage(_commandBuffer, srcBuffer->getBuffer(), dstImage->getImage(), dstLayout,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+}
+
 
-void VulkanCommandBuffer::cmdPipelineBarrier(VkPipelineStageFlagBits srcStage, VkPipelineStageFlagBits dstStage,
+void VulkanCommandBuffer::cmdPipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
                                              VulkanImageBarrierInfo* imageInfo, uint32_t imageInfoCount,
                                              VulkanBufferBarrierInfo* bufferInfo, uint32_t bufferInfoCount,
                                              VulkanMemoryBarrierInfo* memoryInfo, uint32_t memoryInfoCount){
@@ -374,8 +426,8 @@ void VulkanCommandBuffer::cmdPipelineBarrier(VkPipelineStageFlagBits srcStage, V
         imageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         imageBarriers[i].oldLayout = imageInfo[i].oldLayout;  // Старый лаяут (способ использования)
         imageBarriers[i].newLayout = imageInfo[i].newLayout;  // Новый лаяут (способ использования)
-        imageBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;  // Очередь не меняется
-        imageBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;  // Очередь не меняется
+        imageBarriers[i].srcQueueFamilyIndex = imageInfo[i].srcQueueFamilyIndex;  // Если очередь не меняется - VK_QUEUE_FAMILY_IGNORED
+        imageBarriers[i].dstQueueFamilyIndex = imageInfo[i].dstQueueFamilyIndex;
         imageBarriers[i].image = imageInfo[i].image->getImage();  // Изображение, которое меняется
         imageBarriers[i].srcAccessMask = imageInfo[i].srcAccessBarrier;
         imageBarriers[i].dstAccessMask = imageInfo[i].dstAccessBarrier;
@@ -398,8 +450,8 @@ void VulkanCommandBuffer::cmdPipelineBarrier(VkPipelineStageFlagBits srcStage, V
         bufferBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
         bufferBarriers[i].srcAccessMask = bufferInfo[i].srcAccessMask;
         bufferBarriers[i].dstAccessMask = bufferInfo[i].dstAccessMask;
-        bufferBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        bufferBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarriers[i].srcQueueFamilyIndex = bufferInfo[i].srcQueueFamilyIndex;
+        bufferBarriers[i].dstQueueFamilyIndex = bufferInfo[i].dstQueueFamilyIndex;
         bufferBarriers[i].buffer = bufferInfo[i].buffer->getBuffer();
         bufferBarriers[i].offset = bufferInfo[i].offset;
         bufferBarriers[i].size = bufferInfo[i].size;
@@ -15,6 +15,7 @@
 #include "VulkanRenderPass.h"
 #include "VulkanFrameBuffer.h"
 #include "VulkanPipeline.h"
+#include "VulkanComputePipeline.h"
 #include "VulkanBuffer.h"
 #include "VulkanDescriptorSet.h"
 #include "VulkanQueryPool.h"
@@ -50,6 +51,8 @@ struct VulkanImageBarrierInfo{
     VkImageAspectFlags aspectFlags;
     VkAccessFlags srcAccessBarrier;
     VkAccessFlags dstAccessBarrier;
+    uint32_t srcQueueFamilyIndex;   // Для передачи владения между семействами очередей, иначе VK_QUEUE_FAMILY_IGNORED
+    uint32_t dstQueueFamilyIndex;
     
     VulkanImageBarrierInfo();
 };
@@ -60,6 +63,8 @@ struct VulkanBufferBarrierInfo{
     VkAccessFlags dstAccessMask;
     VkDeviceSize offset;
     VkDeviceSize size;
+    uint32_t srcQueueFamilyIndex;   // Для передачи владения между семействами очередей, иначе VK_QUEUE_FAMILY_IGNORED
+    uint32_t dstQueueFamilyIndex;
     
     VulkanBufferBarrierInfo();
 };
@@ -83,6 +88,7 @@ public:
     void reset(VkCommandBufferResetFlags flags);
     
     void cmdBeginRenderPass(const VulkanRenderPassBeginInfo& beginInfo , VkSubpassContents contentsType);
+    void cmdNextSubpass(VkSubpassContents contentsType);
     void cmdEndRenderPass();
     void cmdSetViewport(const VkRect2D& viewport);
     void cmdSetScissor(const VkRect2D& scissor);
@@ -94,14 +100,21 @@ public:
     void cmdBindDescriptorSet(const VkPipelineLayout& pipelineLayout, const VulkanDescriptorSetPtr& set, uint32_t offset);
     void cmdBindDescriptorSets(const VkPipelineLayout& pipelineLayout, const std::vector<VulkanDescriptorSetPtr>& sets);
     void cmdBindDescriptorSets(const VkPipelineLayout& pipelineLayout, const std::vector<VulkanDescriptorSetPtr>& sets, const std::vector<uint32_t>& offsets);
+    void cmdBindComputePipeline(const VulkanComputePipelinePtr& pipeline);
+    void cmdBindComputeDescriptorSet(const VkPipelineLayout& pipelineLayout, const VulkanDescriptorSetPtr& set);
+    void cmdBindComputeDescriptorSets(const VkPipelineLayout& pipelineLayout, const std::vector<VulkanDescriptorSetPtr>& sets);
     void cmdPushConstants(const VkPipelineLayout& pipelineLayout, VkShaderStageFlags stage, const void* data, uint32_t size, uint32_t offset = 0);
     void cmdDraw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
     void cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+    void cmdDispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
     void cmdCopyImage(const VulkanImagePtr& srcImage, const VulkanImagePtr& dstImage, VkImageAspectFlags aspectMask, uint32_t mipLevel = 0);
     void cmdBlitImage(const VkImageBlit& imageBlit, const VulkanImagePtr& srcImage, const VulkanImagePtr& dstImage);
     void cmdCopyBuffer(const VkBufferCopy& copyRegion, const VulkanBufferPtr& srcBuffer, const VulkanBufferPtr& dstBuffer);
     void cmdCopyAllBuffer(const VulkanBufferPtr& srcBuffer, const VulkanBufferPtr& dstBuffer);
-    void cmdPipelineBarrier(VkPipelineStageFlagBits srcStage, VkPipelineStageFlagBits dstStage,
+    // Все регионы одной командой, регионы могут покрывать любые уровни и слои картинки
+    void cmdCopyBufferToImage(const VulkanBufferPtr& srcBuffer, const VulkanImagePtr& dstImage, const std::vector<VkBufferImageCopy>& regions,
+                              VkImageLayout dstLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    void cmdPipelineBarrier(VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
                             VulkanImageBarrierInfo* imageInfo, uint32_t imageInfoCount,
                             VulkanBufferBarrierInfo* bufferInfo, uint32_t bufferInfoCount,
                             VulkanMemoryBarrierInfo* memoryInfo, uint32_t memoryInfoCount);
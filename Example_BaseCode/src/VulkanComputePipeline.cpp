@@ -0,0 +1,86 @@
+#include "VulkanComputePipeline.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+VulkanComputePipeline::VulkanComputePipeline(VulkanLogicalDevicePtr device,
+                                             VulkanShaderModulePtr computeShader,
+                                             VulkanPipelineLayoutPtr pipelineLayout,
+                                             VulkanPipelineCachePtr pipelineCache,
+                                             const VulkanPipelineSpecialization& specialization):
+    _device(device),
+    _computeShader(computeShader),
+    _pipelineLayout(pipelineLayout),
+    _pipelineCache(pipelineCache),
+    _specialization(specialization),
+    _pipeline(VK_NULL_HANDLE){
+    
+    createPipeline();
+}
+
+void VulkanComputePipeline::createPipeline(){
+    // Константы специализации шейдера
+    VkSpecializationInfo specializationInfo = {};
+    memset(&specializationInfo, 0, sizeof(VkSpecializationInfo));
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(_specialization.entries.size());
+    specializationInfo.pMapEntries = _specialization.entries.data();
+    specializationInfo.dataSize = _specialization.data.size();
+    specializationInfo.pData = _specialization.data.data();
+    
+    // Описание настроек вычислительного шейдера
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+    memset(&computeShaderStageInfo, 0, sizeof(VkPipelineShaderStageCreateInfo));
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = _computeShader->getModule();
+    computeShaderStageInfo.pName = "main";     // Входная функция
+    computeShaderStageInfo.pSpecializationInfo = _specialization.isEmpty() ? nullptr : &specializationInfo;
+    
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    memset(&pipelineInfo, 0, sizeof(VkComputePipelineCreateInfo));
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = _pipelineLayout->getLayout();
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+    
+    VkPipelineCache pipelineCache = _pipelineCache ? _pipelineCache->getCache() : VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(_device->getDevice(), pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
+        LOG("Failed to create compute pipeline!\n");
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+}
+
+VulkanComputePipeline::~VulkanComputePipeline(){
+    vkDestroyPipeline(_device->getDevice(), _pipeline, nullptr);
+}
+
+VkPipelineLayout VulkanComputePipeline::getLayout() const{
+    return _pipelineLayout->getLayout();
+}
+
+VkPipeline VulkanComputePipeline::getPipeline() const{
+    return _pipeline;
+}
+
+VulkanShaderModulePtr VulkanComputePipeline::getBaseComputeShader() const{
+    return _computeShader;
+}
+
+VulkanPipelineLayoutPtr VulkanComputePipeline::getBasePipelineLayout() const{
+    return _pipelineLayout;
+}
+
+VulkanPipelineCachePtr VulkanComputePipeline::getBasePipelineCache() const{
+    return _pipelineCache;
+}
+
+VulkanPipelineSpecialization VulkanComputePipeline::getBaseSpecialization() const{
+    return _specialization;
+}
+
+VulkanLogicalDevicePtr VulkanComputePipeline::getBaseDevice() const{
+    return _device;
+}
@@ -0,0 +1,51 @@
+#ifndef VULKAN_COMPUTE_PIPELINE_H
+#define VULKAN_COMPUTE_PIPELINE_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanShaderModule.h"
+#include "VulkanPipelineLayout.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanPipeline.h"
+#include "VulkanResource.h"
+
+
+// Вычислительный пайплайн из одного compute шейдера.
+// Привязывается к VK_PIPELINE_BIND_POINT_COMPUTE, может использоваться в любой очереди с VK_QUEUE_COMPUTE_BIT
+class VulkanComputePipeline: public VulkanResource {
+public:
+    VulkanComputePipeline(VulkanLogicalDevicePtr device,
+                          VulkanShaderModulePtr computeShader,
+                          VulkanPipelineLayoutPtr pipelineLayout,
+                          VulkanPipelineCachePtr pipelineCache = nullptr,
+                          const VulkanPipelineSpecialization& specialization = VulkanPipelineSpecialization());
+    ~VulkanComputePipeline();
+    VkPipelineLayout getLayout() const;
+    VkPipeline getPipeline() const;
+    VulkanShaderModulePtr getBaseComputeShader() const;
+    VulkanPipelineLayoutPtr getBasePipelineLayout() const;
+    VulkanPipelineCachePtr getBasePipelineCache() const;
+    VulkanPipelineSpecialization getBaseSpecialization() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    VulkanShaderModulePtr _computeShader;
+    VulkanPipelineLayoutPtr _pipelineLayout;
+    VulkanPipelineCachePtr _pipelineCache;
+    VulkanPipelineSpecialization _specialization;
+    VkPipeline _pipeline;
+    
+private:
+    void createPipeline();
+};
+
+typedef std::shared_ptr<VulkanComputePipeline> VulkanComputePipelinePtr;
+
+#endif
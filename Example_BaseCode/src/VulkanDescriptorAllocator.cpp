@@ -0,0 +1,161 @@
+#include "VulkanDescriptorAllocator.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+VulkanDescriptorAllocatorPoolRatio::VulkanDescriptorAllocatorPoolRatio():
+    type(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+    ratio(1.0f){
+}
+
+VulkanDescriptorAllocatorPoolRatio::VulkanDescriptorAllocatorPoolRatio(VkDescriptorType inType, float inRatio):
+    type(inType),
+    ratio(inRatio){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanDescriptorAllocatorConfig::VulkanDescriptorAllocatorConfig():
+    setsPerPool(64),
+    maxSetsPerPool(4096),
+    growFactor(2.0f),
+    poolFlags(0){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(VulkanLogicalDevicePtr logicalDevice, const VulkanDescriptorAllocatorConfig& config):
+    _logicalDevice(logicalDevice),
+    _config(config),
+    _nextPoolSetsCount(0),
+    _allocatedSetsCount(0){
+
+    // Стандартные пропорции дескрипторов на один набор
+    if (_config.ratios.empty()) {
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f));
+        _config.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f));
+    }
+    _config.setsPerPool = std::max(_config.setsPerPool, 1u);
+    _config.maxSetsPerPool = std::max(_config.maxSetsPerPool, _config.setsPerPool);
+    _config.growFactor = std::max(_config.growFactor, 1.0f);
+
+    _nextPoolSetsCount = _config.setsPerPool;
+}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator(){
+    _currentPool = nullptr;
+    _usedPools.clear();
+    _freePools.clear();
+}
+
+// Выделяем набор дескрипторов, при переполнении пула переходим к следующему
+VulkanDescriptorSetPtr VulkanDescriptorAllocator::allocateSet(VulkanDescriptorSetLayoutPtr layout){
+    if (!_currentPool) {
+        _currentPool = grabPool();
+        _usedPools.push_back(_currentPool);
+    }
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VkResult result = allocateFromPool(_currentPool, layout, &set);
+
+    // Пул закончился либо фрагментирован - берем новый и пробуем еще раз
+    if ((result == VK_ERROR_OUT_OF_POOL_MEMORY_KHR) || (result == VK_ERROR_FRAGMENTED_POOL)) {
+        _currentPool = grabPool();
+        _usedPools.push_back(_currentPool);
+
+        result = allocateFromPool(_currentPool, layout, &set);
+    }
+
+    if (result != VK_SUCCESS) {
+        LOG("Failed to allocate descriptor set from allocator!\n");
+        throw std::runtime_error("Failed to allocate descriptor set from allocator!");
+    }
+
+    _allocatedSetsCount++;
+
+    // Если пул поддерживает освобождение наборов - набор сам освободится при уничтожении
+    bool needFree = (_config.poolFlags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT) != 0;
+
+    VulkanDescriptorSetPtr descriptorSet = VulkanDescriptorSetPtr(new VulkanDescriptorSet(_logicalDevice, layout, _currentPool, set, needFree));
+    return descriptorSet;
+}
+
+// Сбрасываем все пулы разом вместо освобождения каждого набора по отдельности,
+// выделенные ранее наборы после этого использовать нельзя
+void VulkanDescriptorAllocator::reset(){
+    for (size_t i = 0; i < _usedPools.size(); i++) {
+        _usedPools[i]->reset();
+        _freePools.push_back(_usedPools[i]);
+    }
+    _usedPools.clear();
+    _currentPool = nullptr;
+    _allocatedSetsCount = 0;
+}
+
+uint32_t VulkanDescriptorAllocator::getPoolsCount() const{
+    return static_cast<uint32_t>(_usedPools.size() + _freePools.size());
+}
+
+uint32_t VulkanDescriptorAllocator::getAllocatedSetsCount() const{
+    return _allocatedSetsCount;
+}
+
+VulkanLogicalDevicePtr VulkanDescriptorAllocator::getBaseDevice() const{
+    return _logicalDevice;
+}
+
+VulkanDescriptorAllocatorConfig VulkanDescriptorAllocator::getBaseConfig() const{
+    return _config;
+}
+
+// Берем свободный сброшенный пул либо создаем новый, каждый следующий больше предыдущего
+VulkanDescriptorPoolPtr VulkanDescriptorAllocator::grabPool(){
+    if (_freePools.empty() == false) {
+        VulkanDescriptorPoolPtr pool = _freePools.back();
+        _freePools.pop_back();
+        return pool;
+    }
+
+    VulkanDescriptorPoolPtr pool = createPool(_nextPoolSetsCount);
+    _nextPoolSetsCount = std::min(static_cast<uint32_t>(_nextPoolSetsCount * _config.growFactor), _config.maxSetsPerPool);
+    return pool;
+}
+
+VulkanDescriptorPoolPtr VulkanDescriptorAllocator::createPool(uint32_t setsCount) const{
+    // Размеры пула по пропорциям на количество наборов
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(_config.ratios.size());
+    for (size_t i = 0; i < _config.ratios.size(); i++) {
+        VkDescriptorPoolSize size = {};
+        memset(&size, 0, sizeof(VkDescriptorPoolSize));
+        size.type = _config.ratios[i].type;
+        size.descriptorCount = std::max(static_cast<uint32_t>(_config.ratios[i].ratio * setsCount), 1u);
+        poolSizes.push_back(size);
+    }
+
+    // По умолчанию флаг FREE_DESCRIPTOR_SET_BIT не нужен, пул сбрасывается целиком
+    VulkanDescriptorPoolPtr pool = std::make_shared<VulkanDescriptorPool>(_logicalDevice, poolSizes, setsCount, _config.poolFlags);
+    return pool;
+}
+
+VkResult VulkanDescriptorAllocator::allocateFromPool(VulkanDescriptorPoolPtr pool, VulkanDescriptorSetLayoutPtr layout, VkDescriptorSet* set) const{
+    VkDescriptorSetLayout layouts[] = {layout->getLayout()};
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    memset(&allocInfo, 0, sizeof(VkDescriptorSetAllocateInfo));
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool->getPool();
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = layouts;
+
+    return vkAllocateDescriptorSets(_logicalDevice->getDevice(), &allocInfo, set);
+}
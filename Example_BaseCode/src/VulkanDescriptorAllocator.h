@@ -0,0 +1,67 @@
+#ifndef VULKAN_DESCRIPTOR_ALLOCATOR_H
+#define VULKAN_DESCRIPTOR_ALLOCATOR_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanDescriptorSetLayout.h"
+#include "VulkanDescriptorPool.h"
+#include "VulkanDescriptorSet.h"
+
+
+// Сколько дескрипторов данного типа выделять на один набор в пуле
+struct VulkanDescriptorAllocatorPoolRatio {
+    VkDescriptorType type;
+    float ratio;
+
+    VulkanDescriptorAllocatorPoolRatio();
+    VulkanDescriptorAllocatorPoolRatio(VkDescriptorType type, float ratio);
+};
+
+struct VulkanDescriptorAllocatorConfig {
+    std::vector<VulkanDescriptorAllocatorPoolRatio> ratios; // Если пусто - используются стандартные пропорции
+    uint32_t setsPerPool;       // Размер первого пула
+    uint32_t maxSetsPerPool;    // Предел роста размера нового пула
+    float growFactor;           // Во сколько раз увеличиваем следующий пул
+    VkDescriptorPoolCreateFlags poolFlags;  // С FREE_DESCRIPTOR_SET_BIT наборы освобождаются по одному и reset() вызывать нельзя
+
+    VulkanDescriptorAllocatorConfig();
+};
+
+// Аллокатор наборов дескрипторов из списка пулов.
+// Наборы по одному не освобождаются, вместо этого сбрасываются сразу все пулы через reset(),
+// поэтому отдельный аллокатор удобно заводить на каждый кадр либо на долгоживущие наборы (материалы)
+class VulkanDescriptorAllocator {
+public:
+    VulkanDescriptorAllocator(VulkanLogicalDevicePtr logicalDevice, const VulkanDescriptorAllocatorConfig& config = VulkanDescriptorAllocatorConfig());
+    ~VulkanDescriptorAllocator();
+    VulkanDescriptorSetPtr allocateSet(VulkanDescriptorSetLayoutPtr layout);
+    void reset();
+    uint32_t getPoolsCount() const;
+    uint32_t getAllocatedSetsCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VulkanDescriptorAllocatorConfig getBaseConfig() const;
+
+private:
+    VulkanLogicalDevicePtr _logicalDevice;
+    VulkanDescriptorAllocatorConfig _config;
+    VulkanDescriptorPoolPtr _currentPool;
+    std::vector<VulkanDescriptorPoolPtr> _usedPools;
+    std::vector<VulkanDescriptorPoolPtr> _freePools;
+    uint32_t _nextPoolSetsCount;
+    uint32_t _allocatedSetsCount;
+
+private:
+    VulkanDescriptorPoolPtr grabPool();
+    VulkanDescriptorPoolPtr createPool(uint32_t setsCount) const;
+    VkResult allocateFromPool(VulkanDescriptorPoolPtr pool, VulkanDescriptorSetLayoutPtr layout, VkDescriptorSet* set) const;
+};
+
+typedef std::shared_ptr<VulkanDescriptorAllocator> VulkanDescriptorAllocatorPtr;
+
+#endif
@@ -6,10 +6,12 @@
 #include "Helpers.h"
 
 
-VulkanDescriptorPool::VulkanDescriptorPool(VulkanLogicalDevicePtr logicalDevice, const std::vector<VkDescriptorPoolSize>& poolSize, uint32_t maxSets):
+VulkanDescriptorPool::VulkanDescriptorPool(VulkanLogicalDevicePtr logicalDevice, const std::vector<VkDescriptorPoolSize>& poolSize, uint32_t maxSets,
+                                           VkDescriptorPoolCreateFlags flags):
     _logicalDevice(logicalDevice),
     _poolSize(poolSize),
-    _maxSets(maxSets){
+    _maxSets(maxSets),
+    _flags(flags){
     
     // Создаем пул
     VkDescriptorPoolCreateInfo poolInfo = {};
@@ -18,7 +20,7 @@ VulkanDescriptorPool::VulkanDescriptorPool(VulkanLogicalDevicePtr logicalDevice,
     poolInfo.poolSizeCount = static_cast<uint32_t>(_poolSize.size());
     poolInfo.pPoolSizes = _poolSize.data();
     poolInfo.maxSets = _maxSets;
-	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.flags = _flags;  // Без FREE_DESCRIPTOR_SET_BIT наборы можно вернуть только сбросом всего пула
     
     if (vkCreateDescriptorPool(_logicalDevice->getDevice(), &poolInfo, nullptr, &_pool) != VK_SUCCESS) {
         LOG("Failed to create descriptor pool!\n");
@@ -30,6 +32,14 @@ VulkanDescriptorPool::~VulkanDescriptorPool(){
     vkDestroyDescriptorPool(_logicalDevice->getDevice(), _pool, nullptr);
 }
 
+// Сброс всего пула разом, все выделенные из него наборы становятся невалидными
+void VulkanDescriptorPool::reset(){
+    if (vkResetDescriptorPool(_logicalDevice->getDevice(), _pool, 0) != VK_SUCCESS) {
+        LOG("Failed to reset descriptor pool!\n");
+        throw std::runtime_error("Failed to reset descriptor pool!");
+    }
+}
+
 VulkanLogicalDevicePtr VulkanDescriptorPool::getBaseDevice() const{
     return _logicalDevice;
 }
@@ -42,6 +52,10 @@ uint32_t VulkanDescriptorPool::getBaseMaxSets() const{
     return _maxSets;
 }
 
+VkDescriptorPoolCreateFlags VulkanDescriptorPool::getBaseFlags() const{
+    return _flags;
+}
+
 VkDescriptorPool VulkanDescriptorPool::getPool() const{
     return _pool;
 }
@@ -12,17 +12,21 @@
 
 class VulkanDescriptorPool {
 public:
-    VulkanDescriptorPool(VulkanLogicalDevicePtr logicalDevice, const std::vector<VkDescriptorPoolSize>& poolSize, uint32_t maxSets);
+    VulkanDescriptorPool(VulkanLogicalDevicePtr logicalDevice, const std::vector<VkDescriptorPoolSize>& poolSize, uint32_t maxSets,
+                         VkDescriptorPoolCreateFlags flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
     ~VulkanDescriptorPool();
+    void reset();
     VkDescriptorPool getPool() const;
     std::vector<VkDescriptorPoolSize> getBasePoolSize() const;
     uint32_t getBaseMaxSets() const;
+    VkDescriptorPoolCreateFlags getBaseFlags() const;
     VulkanLogicalDevicePtr getBaseDevice() const;
     
 private:
     VulkanLogicalDevicePtr _logicalDevice;
     std::vector<VkDescriptorPoolSize> _poolSize;
     uint32_t _maxSets;
+    VkDescriptorPoolCreateFlags _flags;
     VkDescriptorPool _pool;
     
 private:
@@ -28,7 +28,8 @@ VulkanDescriptorSetUpdateConfig::VulkanDescriptorSetUpdateConfig():
 VulkanDescriptorSet::VulkanDescriptorSet(VulkanLogicalDevicePtr logicalDevice, VulkanDescriptorSetLayoutPtr layout, VulkanDescriptorPoolPtr pool):
     _logicalDevice(logicalDevice),
     _layout(layout),
-    _pool(pool){
+    _pool(pool),
+    _needFree(true){
 
     // Настройки аллокатора для дескрипторов ресурсов
     VkDescriptorSetLayout layouts[] = {_layout->getLayout()};
@@ -46,8 +47,18 @@ VulkanDescriptorSet::VulkanDescriptorSet(VulkanLogicalDevicePtr logicalDevice, V
     }
 }
 
+VulkanDescriptorSet::VulkanDescriptorSet(VulkanLogicalDevicePtr logicalDevice, VulkanDescriptorSetLayoutPtr layout, VulkanDescriptorPoolPtr pool, VkDescriptorSet set, bool needFree):
+    _logicalDevice(logicalDevice),
+    _layout(layout),
+    _pool(pool),
+    _set(set),
+    _needFree(needFree){
+}
+
 VulkanDescriptorSet::~VulkanDescriptorSet(){
-	vkFreeDescriptorSets(_logicalDevice->getDevice(), _pool->getPool(), 1, &_set);
+    if (_needFree) {
+        vkFreeDescriptorSets(_logicalDevice->getDevice(), _pool->getPool(), 1, &_set);
+    }
 }
 
 VkDescriptorSet VulkanDescriptorSet::getSet() const{
@@ -90,7 +101,9 @@ void VulkanDescriptorSet::updateDescriptorSet(const std::vector<VulkanDescriptor
         switch (config.type) {
             case VK_DESCRIPTOR_TYPE_SAMPLER:
             case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:{
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:{
                 VkDescriptorImageInfo imageInfo = {};
                 memset(&imageInfo, 0, sizeof(VkDescriptorImageInfo));
                 
@@ -113,7 +126,9 @@ void VulkanDescriptorSet::updateDescriptorSet(const std::vector<VulkanDescriptor
             }break;
                 
             case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:{
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:{
                 VkDescriptorBufferInfo bufferInfo = {};
                 memset(&bufferInfo, 0, sizeof(VkDescriptorBufferInfo));
                 
@@ -143,3 +158,10 @@ void VulkanDescriptorSet::updateDescriptorSet(const std::vector<VulkanDescriptor
     // Обновляем описание дескрипторов на устройстве
     vkUpdateDescriptorSets(_logicalDevice->getDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);    
 }
+
+// Обновление через шаблон из упакованных данных, ресурсы в данных должен удерживать вызывающий код
+void VulkanDescriptorSet::updateDescriptorSet(const VulkanDescriptorUpdateTemplatePtr& updateTemplate, const void* data){
+    _usedObjects.clear();
+    
+    updateTemplate->updateSet(_set, data);
+}
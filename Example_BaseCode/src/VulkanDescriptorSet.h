@@ -11,6 +11,7 @@
 #include "VulkanLogicalDevice.h"
 #include "VulkanDescriptorSetLayout.h"
 #include "VulkanDescriptorPool.h"
+#include "VulkanDescriptorUpdateTemplate.h"
 #include "VulkanSampler.h"
 #include "VulkanImageView.h"
 #include "VulkanBuffer.h"
@@ -42,22 +43,31 @@ struct VulkanDescriptorSetUpdateConfig {
     VulkanDescriptorSetUpdateConfig();
 };
 
+class VulkanDescriptorAllocator;
+
 class VulkanDescriptorSet: public VulkanResource {
+    friend VulkanDescriptorAllocator;
 public:
     VulkanDescriptorSet(VulkanLogicalDevicePtr logicalDevice, VulkanDescriptorSetLayoutPtr layout, VulkanDescriptorPoolPtr pool);
     ~VulkanDescriptorSet();
     void updateDescriptorSet(const std::vector<VulkanDescriptorSetUpdateConfig>& configs);
+    void updateDescriptorSet(const VulkanDescriptorUpdateTemplatePtr& updateTemplate, const void* data);
     VkDescriptorSet getSet() const;
     VulkanLogicalDevicePtr getBaseDevice() const;
     VulkanDescriptorSetLayoutPtr getBaseLayout() const;
     VulkanDescriptorPoolPtr getBasePool() const;
     
+protected:
+    // Набор уже выделен аллокатором, без needFree освобождается только сбросом пула
+    VulkanDescriptorSet(VulkanLogicalDevicePtr logicalDevice, VulkanDescriptorSetLayoutPtr layout, VulkanDescriptorPoolPtr pool, VkDescriptorSet set, bool needFree);
+    
 private:
     VulkanLogicalDevicePtr _logicalDevice;
     VulkanDescriptorSetLayoutPtr _layout;
     VulkanDescriptorPoolPtr _pool;
     std::set<VulkanResourcePtr> _usedObjects;
     VkDescriptorSet _set;
+    bool _needFree;
     
 private:
 };
@@ -0,0 +1,202 @@
+#include "VulkanDescriptorSetCache.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+VulkanDescriptorSetCacheBinding::VulkanDescriptorSetCacheBinding():
+    type(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+    binding(0),
+    sampler(VK_NULL_HANDLE),
+    imageView(VK_NULL_HANDLE),
+    imageLayout(VK_IMAGE_LAYOUT_UNDEFINED),
+    buffer(VK_NULL_HANDLE),
+    offset(0),
+    range(0){
+}
+
+bool VulkanDescriptorSetCacheBinding::operator==(const VulkanDescriptorSetCacheBinding& other) const{
+    return (type == other.type) &&
+           (binding == other.binding) &&
+           (sampler == other.sampler) &&
+           (imageView == other.imageView) &&
+           (imageLayout == other.imageLayout) &&
+           (buffer == other.buffer) &&
+           (offset == other.offset) &&
+           (range == other.range);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanDescriptorSetCacheKey::VulkanDescriptorSetCacheKey():
+    layout(VK_NULL_HANDLE),
+    hash(0){
+}
+
+bool VulkanDescriptorSetCacheKey::operator==(const VulkanDescriptorSetCacheKey& other) const{
+    return (hash == other.hash) &&
+           (layout == other.layout) &&
+           (bindings == other.bindings);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t VulkanDescriptorSetCacheKeyHash::operator()(const VulkanDescriptorSetCacheKey& key) const{
+    return key.hash;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanDescriptorSetCache::VulkanDescriptorSetCache(VulkanLogicalDevicePtr logicalDevice, uint32_t evictFramesCount,
+                                                   const VulkanDescriptorAllocatorConfig& allocatorConfig):
+    _logicalDevice(logicalDevice),
+    _evictFramesCount(evictFramesCount),
+    _frameIndex(0),
+    _requestsCount(0),
+    _hitsCount(0),
+    _updatesCount(0),
+    _evictedCount(0){
+
+    // Наборы удаляются из кеша по одному, поэтому пулы должны поддерживать освобождение
+    VulkanDescriptorAllocatorConfig config = allocatorConfig;
+    config.poolFlags |= VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    _allocator = std::make_shared<VulkanDescriptorAllocator>(_logicalDevice, config);
+}
+
+VulkanDescriptorSetCache::~VulkanDescriptorSetCache(){
+    clear();
+    _allocator = nullptr;
+}
+
+// Получаем набор дескрипторов с нужным содержимым, обновляем только при промахе
+VulkanDescriptorSetPtr VulkanDescriptorSetCache::getSet(VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorSetUpdateConfig>& configs){
+    _requestsCount++;
+
+    VulkanDescriptorSetCacheKey key = makeKey(layout, configs);
+
+    // Уже есть такой набор - переносим в начало списка
+    std::unordered_map<VulkanDescriptorSetCacheKey, EntriesList::iterator, VulkanDescriptorSetCacheKeyHash>::iterator found = _entriesMap.find(key);
+    if (found != _entriesMap.end()) {
+        _hitsCount++;
+
+        EntriesList::iterator entryIt = found->second;
+        entryIt->lastUsedFrame = _frameIndex;
+        _entries.splice(_entries.begin(), _entries, entryIt);
+        return entryIt->set;
+    }
+
+    // Создаем новый набор
+    VulkanDescriptorSetPtr set = _allocator->allocateSet(layout);
+    set->updateDescriptorSet(configs);
+    _updatesCount++;
+
+    Entry entry;
+    entry.key = key;
+    entry.set = set;
+    entry.lastUsedFrame = _frameIndex;
+    _entries.push_front(entry);
+    _entriesMap[key] = _entries.begin();
+
+    return set;
+}
+
+// Переходим к следующему кадру, удаляем давно не использованные наборы с конца списка.
+// Если набор еще используется коммандным буффером - он сам удержит его от удаления
+void VulkanDescriptorSetCache::nextFrame(){
+    _frameIndex++;
+
+    while (_entries.empty() == false) {
+        Entry& entry = _entries.back();
+        if ((_frameIndex - entry.lastUsedFrame) <= _evictFramesCount) {
+            break;
+        }
+
+        _entriesMap.erase(entry.key);
+        _entries.pop_back();
+        _evictedCount++;
+    }
+}
+
+void VulkanDescriptorSetCache::clear(){
+    _entriesMap.clear();
+    _entries.clear();
+}
+
+void VulkanDescriptorSetCache::printStats() const{
+    double hitRate = (_requestsCount > 0) ? (double(_hitsCount) / double(_requestsCount)) * 100.0 : 0.0;
+    LOG("Descriptor set cache: requests %llu, hit rate %.1f%%, vkUpdateDescriptorSets calls %llu, evicted %llu, alive sets %d, pools %d\n",
+        (unsigned long long)_requestsCount, hitRate, (unsigned long long)_updatesCount, (unsigned long long)_evictedCount,
+        (int)_entries.size(), (int)_allocator->getPoolsCount());
+}
+
+uint64_t VulkanDescriptorSetCache::getRequestsCount() const{
+    return _requestsCount;
+}
+
+uint64_t VulkanDescriptorSetCache::getHitsCount() const{
+    return _hitsCount;
+}
+
+uint64_t VulkanDescriptorSetCache::getUpdatesCount() const{
+    return _updatesCount;
+}
+
+uint64_t VulkanDescriptorSetCache::getEvictedCount() const{
+    return _evictedCount;
+}
+
+size_t VulkanDescriptorSetCache::getSetsCount() const{
+    return _entries.size();
+}
+
+VulkanLogicalDevicePtr VulkanDescriptorSetCache::getBaseDevice() const{
+    return _logicalDevice;
+}
+
+uint32_t VulkanDescriptorSetCache::getBaseEvictFramesCount() const{
+    return _evictFramesCount;
+}
+
+VulkanDescriptorSetCacheKey VulkanDescriptorSetCache::makeKey(VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorSetUpdateConfig>& configs){
+    VulkanDescriptorSetCacheKey key;
+    key.layout = layout->getLayout();
+    key.bindings.reserve(configs.size());
+
+    size_t hash = 0;
+    hashCombine(hash, (uint64_t)key.layout);
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        const VulkanDescriptorSetUpdateConfig& config = configs[i];
+
+        VulkanDescriptorSetCacheBinding binding;
+        binding.type = config.type;
+        binding.binding = config.binding;
+        if (config.imageInfo.sampler) {
+            binding.sampler = config.imageInfo.sampler->getSampler();
+        }
+        if (config.imageInfo.imageView) {
+            binding.imageView = config.imageInfo.imageView->getImageView();
+            binding.imageLayout = config.imageInfo.imageLayout;
+        }
+        if (config.bufferInfo.buffer) {
+            binding.buffer = config.bufferInfo.buffer->getBuffer();
+            binding.offset = config.bufferInfo.offset;
+            binding.range = config.bufferInfo.range;
+        }
+        key.bindings.push_back(binding);
+
+        hashCombine(hash, (uint64_t)binding.type);
+        hashCombine(hash, (uint64_t)binding.binding);
+        hashCombine(hash, (uint64_t)binding.sampler);
+        hashCombine(hash, (uint64_t)binding.imageView);
+        hashCombine(hash, (uint64_t)binding.imageLayout);
+        hashCombine(hash, (uint64_t)binding.buffer);
+        hashCombine(hash, (uint64_t)binding.offset);
+        hashCombine(hash, (uint64_t)binding.range);
+    }
+
+    key.hash = hash;
+    return key;
+}
@@ -0,0 +1,91 @@
+#ifndef VULKAN_DESCRIPTOR_SET_CACHE_H
+#define VULKAN_DESCRIPTOR_SET_CACHE_H
+
+#include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanDescriptorSetLayout.h"
+#include "VulkanDescriptorSet.h"
+#include "VulkanDescriptorAllocator.h"
+
+
+// Содержимое одного биндинга, по которому ищется набор
+struct VulkanDescriptorSetCacheBinding {
+    VkDescriptorType type;
+    uint32_t binding;
+    VkSampler sampler;
+    VkImageView imageView;
+    VkImageLayout imageLayout;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize range;
+
+    VulkanDescriptorSetCacheBinding();
+    bool operator==(const VulkanDescriptorSetCacheBinding& other) const;
+};
+
+struct VulkanDescriptorSetCacheKey {
+    VkDescriptorSetLayout layout;
+    std::vector<VulkanDescriptorSetCacheBinding> bindings;
+    size_t hash;
+
+    VulkanDescriptorSetCacheKey();
+    bool operator==(const VulkanDescriptorSetCacheKey& other) const;
+};
+
+struct VulkanDescriptorSetCacheKeyHash {
+    size_t operator()(const VulkanDescriptorSetCacheKey& key) const;
+};
+
+// Кеш наборов дескрипторов: одинаковый запрос (лэйаут + ресурсы) возвращает уже обновленный набор,
+// наборы, которые не использовались больше evictFramesCount кадров, удаляются (LRU)
+class VulkanDescriptorSetCache {
+public:
+    VulkanDescriptorSetCache(VulkanLogicalDevicePtr logicalDevice, uint32_t evictFramesCount = 8,
+                             const VulkanDescriptorAllocatorConfig& allocatorConfig = VulkanDescriptorAllocatorConfig());
+    ~VulkanDescriptorSetCache();
+    VulkanDescriptorSetPtr getSet(VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorSetUpdateConfig>& configs);
+    void nextFrame();
+    void clear();
+    void printStats() const;
+    uint64_t getRequestsCount() const;
+    uint64_t getHitsCount() const;
+    uint64_t getUpdatesCount() const;
+    uint64_t getEvictedCount() const;
+    size_t getSetsCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    uint32_t getBaseEvictFramesCount() const;
+
+private:
+    struct Entry {
+        VulkanDescriptorSetCacheKey key;
+        VulkanDescriptorSetPtr set;
+        uint64_t lastUsedFrame;
+    };
+    typedef std::list<Entry> EntriesList;
+
+    VulkanLogicalDevicePtr _logicalDevice;
+    uint32_t _evictFramesCount;
+    VulkanDescriptorAllocatorPtr _allocator;
+    EntriesList _entries;   // В начале недавно использованные
+    std::unordered_map<VulkanDescriptorSetCacheKey, EntriesList::iterator, VulkanDescriptorSetCacheKeyHash> _entriesMap;
+    uint64_t _frameIndex;
+    uint64_t _requestsCount;
+    uint64_t _hitsCount;
+    uint64_t _updatesCount;
+    uint64_t _evictedCount;
+
+private:
+    static VulkanDescriptorSetCacheKey makeKey(VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorSetUpdateConfig>& configs);
+};
+
+typedef std::shared_ptr<VulkanDescriptorSetCache> VulkanDescriptorSetCachePtr;
+
+#endif
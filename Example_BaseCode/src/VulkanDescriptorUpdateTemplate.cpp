@@ -0,0 +1,165 @@
+#include "VulkanDescriptorUpdateTemplate.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+VulkanDescriptorUpdateTemplateEntry::VulkanDescriptorUpdateTemplateEntry():
+    binding(0),
+    arrayElement(0),
+    descriptorsCount(1),
+    type(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+    offset(0),
+    stride(0){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanDescriptorUpdateTemplate::VulkanDescriptorUpdateTemplate(VulkanLogicalDevicePtr device, VulkanDescriptorSetLayoutPtr layout):
+    _device(device),
+    _layout(layout),
+    _dataSize(0),
+    _template(VK_NULL_HANDLE),
+    _destroyFunction(nullptr),
+    _updateFunction(nullptr){
+
+    // Описания дескрипторов идут подряд в порядке биндингов лэйаута
+    std::vector<VulkanDescriptorSetConfig> configs = _layout->getConfig();
+    size_t offset = 0;
+    for (size_t i = 0; i < configs.size(); i++) {
+        size_t infoSize = getDescriptorInfoSize(configs[i].desriptorType);
+
+        VulkanDescriptorUpdateTemplateEntry entry;
+        entry.binding = configs[i].binding;
+        entry.arrayElement = 0;
+        entry.descriptorsCount = std::max(configs[i].desriptorsCount, 1u);
+        entry.type = configs[i].desriptorType;
+        entry.offset = offset;
+        entry.stride = infoSize;
+        _entries.push_back(entry);
+
+        offset += infoSize * entry.descriptorsCount;
+    }
+    _dataSize = offset;
+
+    createTemplate();
+}
+
+VulkanDescriptorUpdateTemplate::VulkanDescriptorUpdateTemplate(VulkanLogicalDevicePtr device, VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorUpdateTemplateEntry>& entries):
+    _device(device),
+    _layout(layout),
+    _entries(entries),
+    _dataSize(0),
+    _template(VK_NULL_HANDLE),
+    _destroyFunction(nullptr),
+    _updateFunction(nullptr){
+
+    // Размер данных - до конца самого дальнего элемента
+    for (size_t i = 0; i < _entries.size(); i++) {
+        const VulkanDescriptorUpdateTemplateEntry& entry = _entries[i];
+        size_t end = entry.offset + entry.stride * (entry.descriptorsCount - 1) + getDescriptorInfoSize(entry.type);
+        _dataSize = std::max(_dataSize, end);
+    }
+
+    createTemplate();
+}
+
+VulkanDescriptorUpdateTemplate::~VulkanDescriptorUpdateTemplate(){
+    if (_destroyFunction && (_template != VK_NULL_HANDLE)) {
+        _destroyFunction(_device->getDevice(), _template, nullptr);
+    }
+}
+
+// К методам расширения может не быть прямого доступа, поэтому получаем адреса вручную
+void VulkanDescriptorUpdateTemplate::createTemplate(){
+    VkDevice device = _device->getDevice();
+    PFN_vkCreateDescriptorUpdateTemplateKHR createFunction = (PFN_vkCreateDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(device, "vkCreateDescriptorUpdateTemplateKHR");
+    _destroyFunction = (PFN_vkDestroyDescriptorUpdateTemplateKHR)vkGetDeviceProcAddr(device, "vkDestroyDescriptorUpdateTemplateKHR");
+    _updateFunction = (PFN_vkUpdateDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr(device, "vkUpdateDescriptorSetWithTemplateKHR");
+    if ((createFunction == nullptr) || (_destroyFunction == nullptr) || (_updateFunction == nullptr)) {
+        LOG("Descriptor update template extension is not enabled!\n");
+        throw std::runtime_error("Descriptor update template extension is not enabled!");
+    }
+
+    std::vector<VkDescriptorUpdateTemplateEntryKHR> vkEntries;
+    vkEntries.reserve(_entries.size());
+    for (size_t i = 0; i < _entries.size(); i++) {
+        VkDescriptorUpdateTemplateEntryKHR vkEntry = {};
+        memset(&vkEntry, 0, sizeof(VkDescriptorUpdateTemplateEntryKHR));
+        vkEntry.dstBinding = _entries[i].binding;
+        vkEntry.dstArrayElement = _entries[i].arrayElement;
+        vkEntry.descriptorCount = _entries[i].descriptorsCount;
+        vkEntry.descriptorType = _entries[i].type;
+        vkEntry.offset = _entries[i].offset;
+        vkEntry.stride = _entries[i].stride;
+        vkEntries.push_back(vkEntry);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfoKHR createInfo = {};
+    memset(&createInfo, 0, sizeof(VkDescriptorUpdateTemplateCreateInfoKHR));
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+    createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(vkEntries.size());
+    createInfo.pDescriptorUpdateEntries = vkEntries.data();
+    createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+    createInfo.descriptorSetLayout = _layout->getLayout();
+
+    if (createFunction(device, &createInfo, nullptr, &_template) != VK_SUCCESS) {
+        LOG("Failed to create descriptor update template!\n");
+        throw std::runtime_error("Failed to create descriptor update template!");
+    }
+}
+
+// Обновляем набор из упакованных данных, размер данных - getDataSize()
+void VulkanDescriptorUpdateTemplate::updateSet(VkDescriptorSet set, const void* data) const{
+    _updateFunction(_device->getDevice(), set, _template, data);
+}
+
+size_t VulkanDescriptorUpdateTemplate::getDescriptorInfoSize(VkDescriptorType type){
+    switch (type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            return sizeof(VkDescriptorImageInfo);
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            return sizeof(VkDescriptorBufferInfo);
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            return sizeof(VkBufferView);
+
+        default:
+            LOG("Invalid descriptor set type\n");
+            throw std::runtime_error("Invalid descriptor set type");
+            break;
+    }
+    return 0;
+}
+
+VkDescriptorUpdateTemplateKHR VulkanDescriptorUpdateTemplate::getTemplate() const{
+    return _template;
+}
+
+size_t VulkanDescriptorUpdateTemplate::getDataSize() const{
+    return _dataSize;
+}
+
+VulkanLogicalDevicePtr VulkanDescriptorUpdateTemplate::getBaseDevice() const{
+    return _device;
+}
+
+VulkanDescriptorSetLayoutPtr VulkanDescriptorUpdateTemplate::getBaseLayout() const{
+    return _layout;
+}
+
+std::vector<VulkanDescriptorUpdateTemplateEntry> VulkanDescriptorUpdateTemplate::getBaseEntries() const{
+    return _entries;
+}
@@ -0,0 +1,59 @@
+#ifndef VULKAN_DESCRIPTOR_UPDATE_TEMPLATE_H
+#define VULKAN_DESCRIPTOR_UPDATE_TEMPLATE_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanDescriptorSetLayout.h"
+
+
+struct VulkanDescriptorUpdateTemplateEntry {
+    uint32_t binding;
+    uint32_t arrayElement;
+    uint32_t descriptorsCount;
+    VkDescriptorType type;
+    size_t offset;  // Смещение VkDescriptorImageInfo/VkDescriptorBufferInfo в структуре данных
+    size_t stride;  // Шаг между элементами массива дескрипторов
+
+    VulkanDescriptorUpdateTemplateEntry();
+};
+
+// Шаблон обновления набора дескрипторов (VK_KHR_descriptor_update_template, расширение должно быть включено у устройства).
+// Создается один раз на лэйаут, затем набор обновляется одним вызовом из упакованной POD структуры
+class VulkanDescriptorUpdateTemplate {
+public:
+    // Записи строятся по лэйауту: биндинги идут подряд в порядке описания, без выравнивания
+    VulkanDescriptorUpdateTemplate(VulkanLogicalDevicePtr device, VulkanDescriptorSetLayoutPtr layout);
+    VulkanDescriptorUpdateTemplate(VulkanLogicalDevicePtr device, VulkanDescriptorSetLayoutPtr layout, const std::vector<VulkanDescriptorUpdateTemplateEntry>& entries);
+    ~VulkanDescriptorUpdateTemplate();
+    void updateSet(VkDescriptorSet set, const void* data) const;
+    VkDescriptorUpdateTemplateKHR getTemplate() const;
+    size_t getDataSize() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VulkanDescriptorSetLayoutPtr getBaseLayout() const;
+    std::vector<VulkanDescriptorUpdateTemplateEntry> getBaseEntries() const;
+
+    // Размер структуры описания одного дескриптора данного типа
+    static size_t getDescriptorInfoSize(VkDescriptorType type);
+
+private:
+    VulkanLogicalDevicePtr _device;
+    VulkanDescriptorSetLayoutPtr _layout;
+    std::vector<VulkanDescriptorUpdateTemplateEntry> _entries;
+    size_t _dataSize;
+    VkDescriptorUpdateTemplateKHR _template;
+    PFN_vkDestroyDescriptorUpdateTemplateKHR _destroyFunction;
+    PFN_vkUpdateDescriptorSetWithTemplateKHR _updateFunction;
+
+private:
+    void createTemplate();
+};
+
+typedef std::shared_ptr<VulkanDescriptorUpdateTemplate> VulkanDescriptorUpdateTemplatePtr;
+
+#endif
@@ -0,0 +1,68 @@
+#include "VulkanDeviceMemory.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "Helpers.h"
+
+
+VulkanDeviceMemory::VulkanDeviceMemory(VulkanLogicalDevicePtr device, VkDeviceSize size, uint32_t memoryTypeIndex):
+    _device(device),
+    _size(size),
+    _memoryTypeIndex(memoryTypeIndex),
+    _usedSize(0),
+    _memory(VK_NULL_HANDLE){
+    
+    VkMemoryAllocateInfo allocInfo = {};
+    memset(&allocInfo, 0, sizeof(VkMemoryAllocateInfo));
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = _size;
+    allocInfo.memoryTypeIndex = _memoryTypeIndex;
+    
+    // Пока ресурсы не привязаны, блок считается пустым
+    if (_device->getMemoryStats()->allocateMemory(_device->getDevice(), allocInfo, 0, &_memory) != VK_SUCCESS) {
+        LOG("Failed to allocate device memory!\n");
+        throw std::runtime_error("Failed to allocate device memory!");
+    }
+}
+
+VulkanDeviceMemory::~VulkanDeviceMemory(){
+    if (_memory != VK_NULL_HANDLE) {
+        _device->getMemoryStats()->freeMemory(_device->getDevice(), _memory);
+    }
+}
+
+VkDeviceMemory VulkanDeviceMemory::getMemory() const{
+    return _memory;
+}
+
+void VulkanDeviceMemory::addBoundRange(VkDeviceSize offset, VkDeviceSize size){
+    setUsedSize(std::max(_usedSize, offset + size));
+}
+
+void VulkanDeviceMemory::setUsedSize(VkDeviceSize usedSize){
+    _usedSize = std::min(usedSize, _size);
+    _device->getMemoryStats()->setUsedSize(_memory, _usedSize);
+}
+
+VkDeviceSize VulkanDeviceMemory::getCommitment() const{
+    VkDeviceSize committed = 0;
+    vkGetDeviceMemoryCommitment(_device->getDevice(), _memory, &committed);
+    return committed;
+}
+
+VulkanLogicalDevicePtr VulkanDeviceMemory::getBaseDevice() const{
+    return _device;
+}
+
+VkDeviceSize VulkanDeviceMemory::getBaseSize() const{
+    return _size;
+}
+
+uint32_t VulkanDeviceMemory::getBaseMemoryTypeIndex() const{
+    return _memoryTypeIndex;
+}
+
+VkDeviceSize VulkanDeviceMemory::getBaseUsedSize() const{
+    return _usedSize;
+}
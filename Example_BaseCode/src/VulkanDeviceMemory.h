@@ -0,0 +1,40 @@
+#ifndef VULKAN_DEVICE_MEMORY_H
+#define VULKAN_DEVICE_MEMORY_H
+
+#include <memory>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+
+
+// Блок памяти устройства, к которому можно привязать несколько ресурсов
+class VulkanDeviceMemory {
+public:
+    VulkanDeviceMemory(VulkanLogicalDevicePtr device, VkDeviceSize size, uint32_t memoryTypeIndex);
+    ~VulkanDeviceMemory();
+    VkDeviceMemory getMemory() const;
+    // Привязка ресурса: занятый объем блока - до конца самого дальнего ресурса
+    void addBoundRange(VkDeviceSize offset, VkDeviceSize size);
+    // Занятый объем задается явно, например для блоков с алиасингом ресурсов
+    void setUsedSize(VkDeviceSize usedSize);
+    // Реально выделенный объем для VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT памяти
+    VkDeviceSize getCommitment() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VkDeviceSize getBaseSize() const;
+    uint32_t getBaseMemoryTypeIndex() const;
+    VkDeviceSize getBaseUsedSize() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    VkDeviceSize _size;
+    uint32_t _memoryTypeIndex;
+    VkDeviceSize _usedSize;
+    VkDeviceMemory _memory;
+};
+
+typedef std::shared_ptr<VulkanDeviceMemory> VulkanDeviceMemoryPtr;
+
+#endif
@@ -4,11 +4,13 @@
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 
 // STB image
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "VulkanTextureLoader.h"
 #include "Helpers.h"
 
 
@@ -31,6 +33,20 @@ uint32_t findMemoryType(VkPhysicalDevice device, uint32_t typeFilter, VkMemoryPr
     throw std::runtime_error("Failed to find suitable memory type!");
 }
 
+// Тип lazily allocated памяти среди допустимых для ресурса, -1 - такой нет
+int32_t findLazyMemoryType(VkPhysicalDevice device, uint32_t typeFilter) {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memProperties);
+    
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        bool supported = (typeFilter & (1 << i)) != 0;
+        if (supported && (memProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
 
 // Подбираем формат текстуры в зависимости от доступных на устройстве
 VkFormat findSupportedFormat(VkPhysicalDevice device, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
@@ -93,16 +109,17 @@ void generateMipmapsForImage(VulkanCommandBufferPtr commandBuffer, VulkanImagePt
     // We copy down the whole mip chain doing a blit from mip-1 to mip
     // An alternative way would be to always blit from the first mip level and sample that one down
     
+    // Уровень 0 только что скопирован, из UNDEFINED его содержимое могло бы потеряться
 	transitionImageLayout(commandBuffer,
                           image,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                           0, 1,
                           VK_IMAGE_ASPECT_COLOR_BIT,
                           VK_PIPELINE_STAGE_TRANSFER_BIT,
                           VK_PIPELINE_STAGE_TRANSFER_BIT,
-                          VK_ACCESS_TRANSFER_READ_BIT,
-                          VK_ACCESS_TRANSFER_WRITE_BIT);
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_ACCESS_TRANSFER_READ_BIT);
 
     // Copy down mips from n-1 to n
     for (int32_t i = 1; i < static_cast<int32_t>(image->getBaseMipmapsCount()); i++){
@@ -206,24 +223,26 @@ VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr
     
     VkFormat imagesFormat = VK_FORMAT_R8G8B8A8_UNORM;
     
-    // VK_IMAGE_TILING_LINEAR - специально, для исходного изображения
-    // http://vulkanapi.ru/2016/12/17/vulkan-api-%D1%83%D1%80%D0%BE%D0%BA-45/
-    VulkanImagePtr staggingImage = std::make_shared<VulkanImage>(device,
-                                                                 VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)},
-                                                                 imagesFormat,           // Формат текстуры
-                                                                 VK_IMAGE_TILING_LINEAR,             // Тайлинг
-                                                                 VK_IMAGE_LAYOUT_PREINITIALIZED,     // Чтобы данные не уничтожились при первом использовании - используем PREINITIALIZED (must be VK_IMAGE_LAYOUT_UNDEFINED or VK_IMAGE_LAYOUT_PREINITIALIZED)
-                                                                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT,    // Используется для передачи в другую текстуру данных
-                                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // Настраиваем работу с памятью так, чтобы было доступно на CPU
-                                                                 1);
+    std::chrono::high_resolution_clock::time_point beginTime = std::chrono::high_resolution_clock::now();
+    
+    // Данные идут через staging буффер, а не через картинку с линейным тайлингом:
+    // у линейных картинок жесткие ограничения на размер и медленный map на многих драйверах
+    std::vector<VkBufferImageCopy> regions;
+    VkDeviceSize stagingSize = makePackedCopyRegions(imagesFormat, VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)}, 1, 1, regions);
+    VulkanBufferPtr staggingBuffer = std::make_shared<VulkanBuffer>(device,
+                                                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // Настраиваем работу с памятью так, чтобы было доступно на CPU
+                                                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,   // Используется для передачи в текстуру данных
+                                                                    stagingSize);
     
-    // Отгружаем данные во временную текстуру
-    staggingImage->uploadDataToImage(VK_IMAGE_ASPECT_COLOR_BIT, 0, static_cast<unsigned char*>(pixels), imageSize);
+    // Отгружаем данные во временный буффер
+    staggingBuffer->uploadDataToBuffer(static_cast<unsigned char*>(pixels), imageSize);
     
     // Учищаем буффер данных картинки
     stbi_image_free(pixels);
     pixels = nullptr;
     
+    std::chrono::high_resolution_clock::time_point copyTime = std::chrono::high_resolution_clock::now();
+    
     // Получим информацию об формате будущей картинки
     VkImageFormatProperties properties = {};
     vkGetPhysicalDeviceImageFormatProperties(device->getBasePhysicalDevice()->getDevice(),
@@ -250,22 +269,6 @@ VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr
     // Надо ли для группы операций с текстурами каждый раз создавать коммандный буффер?? Может быть можно все делать в одном?
     VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(device, pool);
     
-    // Конвертирование исходной буфферной текстуры с данными в формат копирования на GPU
-    {
-        //VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(device, pool);
-        transitionImageLayout(commandBuffer,
-                              staggingImage,
-                              VK_IMAGE_LAYOUT_PREINITIALIZED,
-                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                              0, staggingImage->getBaseMipmapsCount(),
-                              VK_IMAGE_ASPECT_COLOR_BIT,
-							  VK_PIPELINE_STAGE_HOST_BIT,
-							  VK_PIPELINE_STAGE_TRANSFER_BIT,
-                              VK_ACCESS_HOST_WRITE_BIT,
-                              VK_ACCESS_TRANSFER_READ_BIT);
-        //endAndQueueSingleTimeCommands(commandBuffer, queue);
-    }
-    
     // Конвертирование конечной буфферной текстуры в формат получателя
     {
         //VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(device, pool);
@@ -275,19 +278,15 @@ VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr
                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                               0, resultImage->getBaseMipmapsCount(),
                               VK_IMAGE_ASPECT_COLOR_BIT,
+							  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
 							  VK_PIPELINE_STAGE_TRANSFER_BIT,
-							  VK_PIPELINE_STAGE_TRANSFER_BIT,
-                              VK_ACCESS_TRANSFER_READ_BIT,
+                              0,
                               VK_ACCESS_TRANSFER_WRITE_BIT);
         //endAndQueueSingleTimeCommands(commandBuffer, queue);
     }
     
-    // Копируем данные в пределах GPU из временной текстуры в целевую
-    {
-        //VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(device, pool);
-        commandBuffer->cmdCopyImage(staggingImage, resultImage, VK_IMAGE_ASPECT_COLOR_BIT, 0);
-        //endAndQueueSingleTimeCommands(commandBuffer, queue);
-    }
+    // Копируем данные из временного буффера в нулевой уровень целевой картинки
+    commandBuffer->cmdCopyBufferToImage(staggingBuffer, resultImage, regions);
     
     // Генерируем мипмапы для текстуры
     if (mipmapLevels > 1){
@@ -314,7 +313,17 @@ VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr
     endAndQueueWaitSingleTimeCommands(commandBuffer, queue);
     
     // Удаляем временные объекты
-    staggingImage = nullptr;
+    staggingBuffer = nullptr;
+    
+    // Время копирования включает генерацию мипмапов
+    std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+    double fillSeconds = std::chrono::duration<double>(copyTime - beginTime).count();
+    double copySeconds = std::chrono::duration<double>(endTime - copyTime).count();
+    double megabytes = double(stagingSize) / (1024.0 * 1024.0);
+    LOG("Texture upload %s: %.2f MB, staging fill %.2f ms (%.0f MB/s), copy and mipmaps %.2f ms (%.0f MB/s)\n",
+        path.c_str(), megabytes,
+        fillSeconds * 1000.0, (fillSeconds > 0.0) ? megabytes / fillSeconds : 0.0,
+        copySeconds * 1000.0, (copySeconds > 0.0) ? megabytes / copySeconds : 0.0);
     
     
     return resultImage;
@@ -18,6 +18,9 @@
 // Подбираем тип памяти буффера вершин
 uint32_t findMemoryType(VkPhysicalDevice device, uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
+// Тип lazily allocated памяти среди допустимых для ресурса, -1 - такой нет
+int32_t findLazyMemoryType(VkPhysicalDevice device, uint32_t typeFilter);
+
 // Подбираем формат текстуры в зависимости от доступных на устройстве
 VkFormat findSupportedFormat(VkPhysicalDevice device, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
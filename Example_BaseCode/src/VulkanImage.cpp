@@ -11,6 +11,7 @@ VulkanImage::VulkanImage():
     _imageMemory(VK_NULL_HANDLE),
     _format(VK_FORMAT_UNDEFINED),
     _size(VkExtent2D{0, 0}),
+    _flags(0),
     _needDestroy(false){
 }
 
@@ -24,6 +25,7 @@ VulkanImage::VulkanImage(VkImage image, VkFormat format, VkExtent2D size):
     _usage(0),
     _properties(0),
     _mipmapsCount(1),
+    _flags(0),
     _needDestroy(false){
     // Удаляется извне
 }
@@ -39,6 +41,7 @@ VulkanImage::VulkanImage(VulkanLogicalDevicePtr device, VkImage image, VkFormat
     _usage(0),
     _properties(0),
     _mipmapsCount(1),
+    _flags(0),
     _needDestroy(needDestroy){
 }
 
@@ -50,7 +53,8 @@ VulkanImage::VulkanImage(VulkanLogicalDevicePtr logicDevice,
                          VkImageUsageFlags usage,
                          VkMemoryPropertyFlags properties,
                          uint32_t mipmapsCount,
-                         VkSampleCountFlagBits sampleCount):
+                         VkSampleCountFlagBits sampleCount,
+                         VkImageCreateFlags flags):
     _logicalDevice(logicDevice),
     _image(VK_NULL_HANDLE),
     _imageMemory(VK_NULL_HANDLE),
@@ -62,6 +66,7 @@ VulkanImage::VulkanImage(VulkanLogicalDevicePtr logicDevice,
     _properties(properties),
     _mipmapsCount(mipmapsCount),
     _sampleCount(sampleCount),
+    _flags(flags),
     _needDestroy(true){
         
     createImage(_size.width, _size.height,
@@ -71,7 +76,8 @@ VulkanImage::VulkanImage(VulkanLogicalDevicePtr logicDevice,
                 usage,
                 properties,
                 mipmapsCount,
-                sampleCount);
+                sampleCount,
+                flags);
 }
 
 VulkanImage::~VulkanImage(){
@@ -80,7 +86,7 @@ VulkanImage::~VulkanImage(){
             vkDestroyImage(_logicalDevice->getDevice(), _image, nullptr);
         }
         if (_imageMemory) {
-            vkFreeMemory(_logicalDevice->getDevice(), _imageMemory, nullptr);
+            _logicalDevice->getMemoryStats()->freeMemory(_logicalDevice->getDevice(), _imageMemory);
         }
     }
 }
@@ -90,9 +96,31 @@ VkImage VulkanImage::getImage() const{
 }
 
 VkDeviceMemory VulkanImage::getImageMemory() const{
+    if (_boundMemory) {
+        return _boundMemory->getMemory();
+    }
     return _imageMemory;
 }
 
+VkMemoryRequirements VulkanImage::getMemoryRequirements() const{
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(_logicalDevice->getDevice(), _image, &memRequirements);
+    return memRequirements;
+}
+
+void VulkanImage::bindMemory(VulkanDeviceMemoryPtr memory, VkDeviceSize offset){
+    if ((_imageMemory != VK_NULL_HANDLE) || _boundMemory) {
+        LOG("Image memory is already bound!\n");
+        throw std::runtime_error("Image memory is already bound!");
+    }
+    if (vkBindImageMemory(_logicalDevice->getDevice(), _image, memory->getMemory(), offset) != VK_SUCCESS) {
+        LOG("Failed to bind image memory!\n");
+        throw std::runtime_error("Failed to bind image memory!");
+    }
+    _boundMemory = memory;
+    memory->addBoundRange(offset, getMemoryRequirements().size);
+}
+
 VkFormat VulkanImage::getBaseFormat() const{
     return _format;
 }
@@ -129,6 +157,10 @@ VkSampleCountFlagBits VulkanImage::getBaseSampleCount() const{
     return _sampleCount;
 }
 
+VkImageCreateFlags VulkanImage::getBaseFlags() const{
+    return _flags;
+}
+
 void VulkanImage::setNewLayout(VkImageLayout layout){
     _layout = layout;
 }
@@ -141,7 +173,8 @@ void VulkanImage::createImage(uint32_t width, uint32_t height,
                               VkImageUsageFlags usage,
                               VkMemoryPropertyFlags properties,
                               uint32_t mipmapsCount,
-                              VkSampleCountFlagBits sampleCount) {
+                              VkSampleCountFlagBits sampleCount,
+                              VkImageCreateFlags flags) {
     
     // Для поля initialLayout есть только два возможных значения:
     // VK_IMAGE_LAYOUT_UNDEFINED: Не и используется GPU и первое изменение (transition) отбросит все тексели.
@@ -152,6 +185,7 @@ void VulkanImage::createImage(uint32_t width, uint32_t height,
     // Информация об изображении
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = flags;            // Например, вью с другим форматом
     imageInfo.imageType = VK_IMAGE_TYPE_2D; // 2D текстура
     imageInfo.extent.width = width;     // Ширина
     imageInfo.extent.height = height;   // Высота
@@ -171,6 +205,11 @@ void VulkanImage::createImage(uint32_t width, uint32_t height,
         throw std::runtime_error("Failed to create image!");
     }
     
+    // Память будет привязана позже
+    if (properties == 0) {
+        return;
+    }
+    
     // Запрашиваем информацию о требованиях памяти для текстуры
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(_logicalDevice->getDevice(), _image, &memRequirements);
@@ -183,7 +222,7 @@ void VulkanImage::createImage(uint32_t width, uint32_t height,
     allocInfo.allocationSize = memRequirements.size;    // Размер аллоцируемой памяти
     allocInfo.memoryTypeIndex = memoryType;             // Тип памяти
     
-    if (vkAllocateMemory(_logicalDevice->getDevice(), &allocInfo, nullptr, &_imageMemory) != VK_SUCCESS) {
+    if (_logicalDevice->getMemoryStats()->allocateMemory(_logicalDevice->getDevice(), allocInfo, memRequirements.size, &_imageMemory) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate image memory!");
     }
     
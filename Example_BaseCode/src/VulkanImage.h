@@ -10,7 +10,9 @@
 #include "VulkanPhysicalDevice.h"
 #include "VulkanLogicalDevice.h"
 #include "VulkanResource.h"
+#include "VulkanDeviceMemory.h"
 
+// properties == 0 - память не выделяется, ее нужно привязать через bindMemory()
 class VulkanImage: public VulkanResource {
 public:
     VulkanImage();
@@ -28,10 +30,14 @@ public:
                 VkImageUsageFlags usage,
                 VkMemoryPropertyFlags properties,
                 uint32_t mipmapsCount = 1,
-                VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT);
+                VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT,
+                VkImageCreateFlags flags = 0);
     ~VulkanImage();
     VkImage getImage() const;
     VkDeviceMemory getImageMemory() const;
+    VkMemoryRequirements getMemoryRequirements() const;
+    // Привязка к общему блоку памяти, блок может быть общим для картинок с непересекающимся временем жизни
+    void bindMemory(VulkanDeviceMemoryPtr memory, VkDeviceSize offset);
     VkSubresourceLayout getSubresourceLayout(VkImageAspectFlags aspect, uint32_t mipLevel) const; // Получаем лаяут картинки
     void uploadDataToImage(VkImageAspectFlags aspect, uint32_t mipLevel, unsigned char* imageSourceData, size_t dataSize); // Загружаем данные в картинку
     VulkanLogicalDevicePtr getBaseDevice() const;
@@ -43,12 +49,14 @@ public:
     VkMemoryPropertyFlags getBaseProperties() const;
     uint32_t getBaseMipmapsCount() const;
     VkSampleCountFlagBits getBaseSampleCount() const;
+    VkImageCreateFlags getBaseFlags() const;
     void setNewLayout(VkImageLayout layout);
     
 private:
     VulkanLogicalDevicePtr _logicalDevice;
     VkImage _image;
     VkDeviceMemory _imageMemory;
+    VulkanDeviceMemoryPtr _boundMemory;
     VkFormat _format;
     VkExtent2D _size;
     VkImageTiling _tiling;
@@ -57,6 +65,7 @@ private:
     VkMemoryPropertyFlags _properties;
     uint32_t _mipmapsCount;
     VkSampleCountFlagBits _sampleCount;
+    VkImageCreateFlags _flags;
     bool _needDestroy;
     
 private:
@@ -67,7 +76,8 @@ private:
                      VkImageUsageFlags usage,
                      VkMemoryPropertyFlags properties,
                      uint32_t mipmapsCount,
-                     VkSampleCountFlagBits sampleCount);
+                     VkSampleCountFlagBits sampleCount,
+                     VkImageCreateFlags flags);
 };
 
 typedef std::shared_ptr<VulkanImage> VulkanImagePtr;
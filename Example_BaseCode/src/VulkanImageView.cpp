@@ -9,22 +9,42 @@ VulkanImageView::VulkanImageView(VulkanLogicalDevicePtr device, VulkanImagePtr i
     _device(device),
     _image(image),
     _aspectFlags(aspectFlags),
+    _format(image->getBaseFormat()),
+    _baseMipLevel(0),
+    _levelsCount(image->getBaseMipmapsCount()),
     _imageView(VK_NULL_HANDLE){
     
+    createImageView();
+}
+
+VulkanImageView::VulkanImageView(VulkanLogicalDevicePtr device, VulkanImagePtr image, VkImageAspectFlags aspectFlags,
+                                 VkFormat format, uint32_t baseMipLevel, uint32_t levelsCount):
+    _device(device),
+    _image(image),
+    _aspectFlags(aspectFlags),
+    _format(format),
+    _baseMipLevel(baseMipLevel),
+    _levelsCount(levelsCount),
+    _imageView(VK_NULL_HANDLE){
+    
+    createImageView();
+}
+
+void VulkanImageView::createImageView(){
     // Описание вьюшки
     VkImageViewCreateInfo viewInfo = {};
     memset(&viewInfo, 0, sizeof(VkImageViewCreateInfo));
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = _image->getImage(); // Изображение
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D; // 2D
-    viewInfo.format = _image->getBaseFormat();   // Формат вьюшки
+    viewInfo.format = _format;   // Формат вьюшки
     viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;  // Маска по отдельным компонентам??
     viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;  // Маска по отдельным компонентам??
     viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;  // Маска по отдельным компонентам??
     viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;  // Маска по отдельным компонентам??
     viewInfo.subresourceRange.aspectMask = _aspectFlags; // Использование вью текстуры
-    viewInfo.subresourceRange.baseMipLevel = 0; // 0 мипмаплевел
-    viewInfo.subresourceRange.levelCount = image->getBaseMipmapsCount();
+    viewInfo.subresourceRange.baseMipLevel = _baseMipLevel;
+    viewInfo.subresourceRange.levelCount = _levelsCount;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
     
@@ -56,3 +76,14 @@ VkImageAspectFlags VulkanImageView::getBaseAspectFlags() const{
     return _aspectFlags;
 }
 
+VkFormat VulkanImageView::getBaseFormat() const{
+    return _format;
+}
+
+uint32_t VulkanImageView::getBaseMipLevel() const{
+    return _baseMipLevel;
+}
+
+uint32_t VulkanImageView::getBaseLevelsCount() const{
+    return _levelsCount;
+}
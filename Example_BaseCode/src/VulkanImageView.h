@@ -15,19 +15,29 @@
 class VulkanImageView: public VulkanResource {
 public:
     VulkanImageView(VulkanLogicalDevicePtr device, VulkanImagePtr image, VkImageAspectFlags aspectFlags);
+    // Вью части уровней, формат может отличаться от формата картинки, если она создана с VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT
+    VulkanImageView(VulkanLogicalDevicePtr device, VulkanImagePtr image, VkImageAspectFlags aspectFlags,
+                    VkFormat format, uint32_t baseMipLevel, uint32_t levelsCount);
     ~VulkanImageView();
     VkImageView getImageView() const;
     VulkanLogicalDevicePtr getBaseDevice() const;
     VulkanImagePtr getBaseImage() const;
     VkImageAspectFlags getBaseAspectFlags() const;
+    VkFormat getBaseFormat() const;
+    uint32_t getBaseMipLevel() const;
+    uint32_t getBaseLevelsCount() const;
     
 private:
     VulkanLogicalDevicePtr _device;
     VulkanImagePtr _image;
     VkImageAspectFlags _aspectFlags;
+    VkFormat _format;
+    uint32_t _baseMipLevel;
+    uint32_t _levelsCount;
     VkImageView _imageView;
     
 private:
+    void createImageView();
 };
 
 typedef std::shared_ptr<VulkanImageView> VulkanImageViewPtr;
@@ -35,6 +35,15 @@ std::vector<const char*> VulkanInstance::getInstanceExtensions(){
     return _instanceExtensions;
 }
 
+bool VulkanInstance::isExtensionEnabled(const char* name) const{
+    for (const char* extension: _instanceExtensions) {
+        if (strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Получаем все доступные слои валидации устройства
 std::vector<VkLayerProperties> VulkanInstance::getAllValidationLayers(){
     // Количество уровней валидации
@@ -189,6 +198,19 @@ std::vector<const char*> VulkanInstance::getRequiredInstanceExtentionNames(){
 	//LOG("Extention - Required MoltenVK extention name: %s\n", "VK_MVK_moltenvk");
 #endif
     
+    // Не обязательное: расширенный запрос свойств устройства, нужен для бюджета памяти (VK_EXT_memory_budget)
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+    for (const VkExtensionProperties& extension: availableExtensions) {
+        if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+            result.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            LOG("Extention - Optional extention name: %s\n", VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            break;
+        }
+    }
+    
 #ifdef VALIDATION_LAYERS_ENABLED
     result.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 	//result.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
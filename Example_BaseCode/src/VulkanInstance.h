@@ -19,6 +19,7 @@ public:
     ~VulkanInstance();
     std::vector<const char*> getValidationLayers();
     std::vector<const char*> getInstanceExtensions();
+    bool isExtensionEnabled(const char* name) const;
     VkInstance getInstance() const;
     
 private:
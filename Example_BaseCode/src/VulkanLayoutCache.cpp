@@ -0,0 +1,128 @@
+#include "VulkanLayoutCache.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "Helpers.h"
+
+
+VulkanLayoutCache::VulkanLayoutCache(VulkanLogicalDevicePtr device):
+    _device(device),
+    _requestsCount(0),
+    _hitsCount(0){
+}
+
+VulkanLayoutCache::~VulkanLayoutCache(){
+    clear();
+}
+
+VulkanDescriptorSetLayoutPtr VulkanLayoutCache::getDescriptorSetLayout(const std::vector<VulkanDescriptorSetConfig>& configs){
+    _requestsCount++;
+    
+    // Порядок описания биндингов не важен, приводим к порядку по номеру биндинга
+    std::vector<VulkanDescriptorSetConfig> sorted = sortedConfigs(configs);
+    
+    size_t hash = 0;
+    for (const VulkanDescriptorSetConfig& config: sorted) {
+        hashCombine(hash, config.binding);
+        hashCombine(hash, config.desriptorsCount);
+        hashCombine(hash, (uint64_t)config.desriptorType);
+        hashCombine(hash, (uint64_t)config.descriptorStageFlags);
+    }
+    
+    // Ищем среди лэйаутов с таким же хешем
+    typedef std::unordered_multimap<size_t, VulkanDescriptorSetLayoutPtr>::iterator Iterator;
+    std::pair<Iterator, Iterator> range = _descriptorSetLayouts.equal_range(hash);
+    for (Iterator it = range.first; it != range.second; ++it) {
+        if (isEqual(sortedConfigs(it->second->getConfig()), sorted)) {
+            _hitsCount++;
+            return it->second;
+        }
+    }
+    
+    VulkanDescriptorSetLayoutPtr layout = std::make_shared<VulkanDescriptorSetLayout>(_device, sorted);
+    _descriptorSetLayouts.insert(std::make_pair(hash, layout));
+    return layout;
+}
+
+VulkanPipelineLayoutPtr VulkanLayoutCache::getPipelineLayout(const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts,
+                                                             const std::vector<VkPushConstantRange>& pushConstants){
+    _requestsCount++;
+    
+    // Лэйауты наборов сами берутся из кеша, поэтому достаточно сравнивать их хендлы
+    size_t hash = 0;
+    for (const VulkanDescriptorSetLayoutPtr& layout: descriptorSetLayouts) {
+        hashCombine(hash, (uint64_t)layout->getLayout());
+    }
+    for (const VkPushConstantRange& range: pushConstants) {
+        hashCombine(hash, (uint64_t)range.stageFlags);
+        hashCombine(hash, range.offset);
+        hashCombine(hash, range.size);
+    }
+    
+    typedef std::unordered_multimap<size_t, VulkanPipelineLayoutPtr>::iterator Iterator;
+    std::pair<Iterator, Iterator> range = _pipelineLayouts.equal_range(hash);
+    for (Iterator it = range.first; it != range.second; ++it) {
+        std::vector<VulkanDescriptorSetLayoutPtr> cachedSetLayouts = it->second->getBaseDescriptorSetLayouts();
+        if ((cachedSetLayouts == descriptorSetLayouts) && isEqual(it->second->getBasePushConstants(), pushConstants)) {
+            _hitsCount++;
+            return it->second;
+        }
+    }
+    
+    VulkanPipelineLayoutPtr layout = std::make_shared<VulkanPipelineLayout>(_device, descriptorSetLayouts, pushConstants);
+    _pipelineLayouts.insert(std::make_pair(hash, layout));
+    return layout;
+}
+
+void VulkanLayoutCache::clear(){
+    _pipelineLayouts.clear();
+    _descriptorSetLayouts.clear();
+}
+
+void VulkanLayoutCache::printStats() const{
+    LOG("Layout cache: requests %llu, hits %llu, descriptor set layouts %d, pipeline layouts %d\n",
+        (unsigned long long)_requestsCount, (unsigned long long)_hitsCount,
+        (int)_descriptorSetLayouts.size(), (int)_pipelineLayouts.size());
+}
+
+VulkanLogicalDevicePtr VulkanLayoutCache::getBaseDevice() const{
+    return _device;
+}
+
+std::vector<VulkanDescriptorSetConfig> VulkanLayoutCache::sortedConfigs(const std::vector<VulkanDescriptorSetConfig>& configs){
+    std::vector<VulkanDescriptorSetConfig> sorted = configs;
+    std::sort(sorted.begin(), sorted.end(), [](const VulkanDescriptorSetConfig& a, const VulkanDescriptorSetConfig& b){
+        return a.binding < b.binding;
+    });
+    return sorted;
+}
+
+bool VulkanLayoutCache::isEqual(const std::vector<VulkanDescriptorSetConfig>& a, const std::vector<VulkanDescriptorSetConfig>& b){
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if ((a[i].binding != b[i].binding) ||
+            (a[i].desriptorsCount != b[i].desriptorsCount) ||
+            (a[i].desriptorType != b[i].desriptorType) ||
+            (a[i].descriptorStageFlags != b[i].descriptorStageFlags)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VulkanLayoutCache::isEqual(const std::vector<VkPushConstantRange>& a, const std::vector<VkPushConstantRange>& b){
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if ((a[i].stageFlags != b[i].stageFlags) ||
+            (a[i].offset != b[i].offset) ||
+            (a[i].size != b[i].size)) {
+            return false;
+        }
+    }
+    return true;
+}
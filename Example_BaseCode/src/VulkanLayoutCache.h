@@ -0,0 +1,46 @@
+#ifndef VULKAN_LAYOUT_CACHE_H
+#define VULKAN_LAYOUT_CACHE_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanDescriptorSetLayout.h"
+#include "VulkanPipelineLayout.h"
+
+
+// Кеш лэйаутов наборов дескрипторов и пайплайнов, один на логическое устройство.
+// Одинаковые описания возвращают один и тот же объект, поэтому наборы дескрипторов
+// остаются совместимыми при переключении пайплайнов и не требуют повторной привязки
+class VulkanLayoutCache {
+public:
+    VulkanLayoutCache(VulkanLogicalDevicePtr device);
+    ~VulkanLayoutCache();
+    VulkanDescriptorSetLayoutPtr getDescriptorSetLayout(const std::vector<VulkanDescriptorSetConfig>& configs);
+    VulkanPipelineLayoutPtr getPipelineLayout(const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts,
+                                              const std::vector<VkPushConstantRange>& pushConstants = std::vector<VkPushConstantRange>());
+    void clear();
+    void printStats() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    std::unordered_multimap<size_t, VulkanDescriptorSetLayoutPtr> _descriptorSetLayouts;
+    std::unordered_multimap<size_t, VulkanPipelineLayoutPtr> _pipelineLayouts;
+    uint64_t _requestsCount;
+    uint64_t _hitsCount;
+    
+private:
+    static std::vector<VulkanDescriptorSetConfig> sortedConfigs(const std::vector<VulkanDescriptorSetConfig>& configs);
+    static bool isEqual(const std::vector<VulkanDescriptorSetConfig>& a, const std::vector<VulkanDescriptorSetConfig>& b);
+    static bool isEqual(const std::vector<VkPushConstantRange>& a, const std::vector<VkPushConstantRange>& b);
+};
+
+typedef std::shared_ptr<VulkanLayoutCache> VulkanLayoutCachePtr;
+
+#endif
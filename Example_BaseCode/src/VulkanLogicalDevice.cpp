@@ -7,6 +7,8 @@
 #include "VulkanQueue.h"
 
 
+static const float ASYNC_QUEUES_PRIORITY = 0.5f;
+
 VulkanLogicalDevice::VulkanLogicalDevice(VulkanPhysicalDevicePtr physicalDevice,
                                          VulkanQueuesFamiliesIndexes queuesFamiliesIndexes,
                                          float presetQueuePriority,
@@ -26,6 +28,13 @@ VulkanLogicalDevice::VulkanLogicalDevice(VulkanPhysicalDevicePtr physicalDevice,
     _device(VK_NULL_HANDLE){
     
     // Отложенное создание в геттерах из-за shared_ptr
+    
+    bool budgetEnabled = false;
+    const char* budgetExtensionName = VulkanMemoryStats::getBudgetExtensionName();
+    for (const char* extension: _extensions) {
+        budgetEnabled = budgetEnabled || (budgetExtensionName && (strcmp(extension, budgetExtensionName) == 0));
+    }
+    _memoryStats = std::make_shared<VulkanMemoryStats>(_physicalDevice, budgetEnabled);
 }
 
 VulkanLogicalDevice::~VulkanLogicalDevice(){
@@ -70,6 +79,20 @@ std::shared_ptr<VulkanQueue> VulkanLogicalDevice::getPresentQueue() {
     return _presentQueue;
 }
 
+std::shared_ptr<VulkanQueue> VulkanLogicalDevice::getTransferQueue() {
+    createLogicalDeviceAndQueue();
+    return _transferQueue;
+}
+
+std::shared_ptr<VulkanQueue> VulkanLogicalDevice::getComputeQueue() {
+    createLogicalDeviceAndQueue();
+    return _computeQueue;
+}
+
+VulkanMemoryStatsPtr VulkanLogicalDevice::getMemoryStats() const{
+    return _memoryStats;
+}
+
 // Создаем логическое устройство для выбранного физического устройства + очередь отрисовки
 void VulkanLogicalDevice::createLogicalDeviceAndQueue() {
     if (_device == VK_NULL_HANDLE) {
@@ -141,11 +164,13 @@ void VulkanLogicalDevice::createLogicalDeviceAndQueue() {
             queueCreateInfo.pQueuePriorities = priorities.data();
             
             // Конфиг создания девайса
+            std::vector<VkDeviceQueueCreateInfo> createQueueInfos = {queueCreateInfo};
+            appendAsyncQueuesCreateInfos(createQueueInfos);
             VkDeviceCreateInfo createInfo = {};
             memset(&createInfo, 0, sizeof(VkDeviceCreateInfo));
             createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-            createInfo.queueCreateInfoCount = 1;
-            createInfo.pQueueCreateInfos = &queueCreateInfo; // Информация о создаваемых на девайсе очередях
+            createInfo.queueCreateInfoCount = static_cast<uint32_t>(createQueueInfos.size());
+            createInfo.pQueueCreateInfos = createQueueInfos.data(); // Информация о создаваемых на девайсе очередях
             createInfo.pEnabledFeatures = &_deviceFeatures;          // Информация о фичах устройства
             createInfo.enabledExtensionCount = static_cast<uint32_t>(_extensions.size());
             createInfo.ppEnabledExtensionNames = _extensions.data();     // Список требуемых расширений устройства
@@ -230,12 +255,13 @@ void VulkanLogicalDevice::createLogicalDeviceAndQueue() {
             renderQueueCreateInfo.pQueuePriorities = priorities.data();
             
             // Конфиг создания девайса
-            VkDeviceQueueCreateInfo createQueueInfo[2] = {presentQueueCreateInfo, renderQueueCreateInfo};
+            std::vector<VkDeviceQueueCreateInfo> createQueueInfos = {presentQueueCreateInfo, renderQueueCreateInfo};
+            appendAsyncQueuesCreateInfos(createQueueInfos);
             VkDeviceCreateInfo createInfo = {};
             memset(&createInfo, 0, sizeof(VkDeviceCreateInfo));
             createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-            createInfo.queueCreateInfoCount = 2;
-            createInfo.pQueueCreateInfos = createQueueInfo; // Информация о создаваемых на девайсе очередях
+            createInfo.queueCreateInfoCount = static_cast<uint32_t>(createQueueInfos.size());
+            createInfo.pQueueCreateInfos = createQueueInfos.data(); // Информация о создаваемых на девайсе очередях
             createInfo.pEnabledFeatures = &_deviceFeatures;          // Информация о фичах устройства
             createInfo.enabledExtensionCount = static_cast<uint32_t>(_extensions.size());
             createInfo.ppEnabledExtensionNames = _extensions.data();     // Список требуемых расширений устройства
@@ -262,6 +288,53 @@ void VulkanLogicalDevice::createLogicalDeviceAndQueue() {
                 _renderQueues.push_back(renderQueue);
             }
         }
+        
+        // Очереди копирования и асинхронных вычислений
+        createAsyncQueues();
+    }
+}
+
+// Семейство без графики можно использовать, только если на нем не висит отображение
+bool VulkanLogicalDevice::isAsyncQueueFamily(int32_t familyIndex) const{
+    return (familyIndex >= 0) &&
+           (familyIndex != _queuesFamiliesIndexes.renderQueuesFamilyIndex) &&
+           (familyIndex != _queuesFamiliesIndexes.presentQueuesFamilyIndex);
+}
+
+void VulkanLogicalDevice::appendAsyncQueuesCreateInfos(std::vector<VkDeviceQueueCreateInfo>& createInfos) const{
+    const int32_t families[2] = {_queuesFamiliesIndexes.transferQueuesFamilyIndex, _queuesFamiliesIndexes.computeQueuesFamilyIndex};
+    for (int i = 0; i < 2; i++) {
+        if (isAsyncQueueFamily(families[i]) == false) {
+            continue;
+        }
+        
+        VkDeviceQueueCreateInfo queueCreateInfo = {};
+        memset(&queueCreateInfo, 0, sizeof(VkDeviceQueueCreateInfo));
+        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex = families[i];
+        queueCreateInfo.queueCount = 1;
+        queueCreateInfo.pQueuePriorities = &ASYNC_QUEUES_PRIORITY;
+        createInfos.push_back(queueCreateInfo);
+    }
+}
+
+void VulkanLogicalDevice::createAsyncQueues(){
+    int32_t transferFamilyIndex = _queuesFamiliesIndexes.transferQueuesFamilyIndex;
+    if (isAsyncQueueFamily(transferFamilyIndex)) {
+        LOG("Dedicated transfer queue family %d\n", transferFamilyIndex);
+        
+        VkQueue vulkanTransferQueue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(_device, transferFamilyIndex, 0, &vulkanTransferQueue);
+        _transferQueue = VulkanQueuePtr(new VulkanQueue(shared_from_this(), transferFamilyIndex, 0, vulkanTransferQueue));
+    }
+    
+    int32_t computeFamilyIndex = _queuesFamiliesIndexes.computeQueuesFamilyIndex;
+    if (isAsyncQueueFamily(computeFamilyIndex)) {
+        LOG("Async compute queue family %d\n", computeFamilyIndex);
+        
+        VkQueue vulkanComputeQueue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(_device, computeFamilyIndex, 0, &vulkanComputeQueue);
+        _computeQueue = VulkanQueuePtr(new VulkanQueue(shared_from_this(), computeFamilyIndex, 0, vulkanComputeQueue));
     }
 }
 
@@ -2,6 +2,7 @@
 #define VULKAN_LOGICAL_DEVICE_H
 
 #include <memory>
+#include <vector>
 
 // GLFW include
 #define GLFW_INCLUDE_VULKAN
@@ -10,6 +11,7 @@
 #include "VulkanQueuesFamiliesIndexes.h"
 #include "VulkanSwapChainSupportDetails.h"
 #include "VulkanPhysicalDevice.h"
+#include "VulkanMemoryStats.h"
 
 class VulkanQueue;
 
@@ -33,6 +35,10 @@ public:
     VkDevice getDevice();
     std::vector<std::shared_ptr<VulkanQueue>> getRenderQueues();
     std::shared_ptr<VulkanQueue> getPresentQueue();
+    std::shared_ptr<VulkanQueue> getTransferQueue();   // nullptr, если нету выделенного семейства копирования
+    std::shared_ptr<VulkanQueue> getComputeQueue();    // nullptr, если нету семейства вычислений без графики
+    // Через нее идут все выделения памяти устройства, бюджет - если среди расширений есть VK_EXT_memory_budget
+    VulkanMemoryStatsPtr getMemoryStats() const;
     
 private:
     VulkanPhysicalDevicePtr _physicalDevice;
@@ -46,10 +52,18 @@ private:
     VkDevice _device;
     std::vector<std::shared_ptr<VulkanQueue>> _renderQueues;
     std::shared_ptr<VulkanQueue> _presentQueue;
+    std::shared_ptr<VulkanQueue> _transferQueue;
+    std::shared_ptr<VulkanQueue> _computeQueue;
+    VulkanMemoryStatsPtr _memoryStats;
     
 private:
     // Создаем логическое устройство для выбранного физического устройства + очередь отрисовки
     void createLogicalDeviceAndQueue();
+    // Добавляем описания очередей копирования и вычислений, если их семейства отличаются от отрисовки и отображения
+    void appendAsyncQueuesCreateInfos(std::vector<VkDeviceQueueCreateInfo>& createInfos) const;
+    // Получаем очереди копирования и вычислений у созданного устройства
+    void createAsyncQueues();
+    bool isAsyncQueueFamily(int32_t familyIndex) const;
 };
 
 typedef std::shared_ptr<VulkanLogicalDevice> VulkanLogicalDevicePtr;
@@ -0,0 +1,268 @@
+#include "VulkanMemoryStats.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "Helpers.h"
+
+
+static double toMegabytes(VkDeviceSize bytes){
+    return double(bytes) / (1024.0 * 1024.0);
+}
+
+static float getFragmentationRatio(VkDeviceSize allocatedBytes, VkDeviceSize usedBytes){
+    if (allocatedBytes == 0) {
+        return 0.0f;
+    }
+    return float(allocatedBytes - std::min(usedBytes, allocatedBytes)) / float(allocatedBytes);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMemoryHeapStats::VulkanMemoryHeapStats():
+    size(0),
+    flags(0),
+    allocatedBytes(0),
+    usedBytes(0),
+    peakBytes(0),
+    allocationsCount(0),
+    budgetBytes(0),
+    budgetUsageBytes(0){
+}
+
+float VulkanMemoryHeapStats::getFragmentation() const{
+    return getFragmentationRatio(allocatedBytes, usedBytes);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMemoryTypeStats::VulkanMemoryTypeStats():
+    flags(0),
+    heapIndex(0),
+    allocatedBytes(0),
+    usedBytes(0),
+    peakBytes(0),
+    allocationsCount(0){
+}
+
+float VulkanMemoryTypeStats::getFragmentation() const{
+    return getFragmentationRatio(allocatedBytes, usedBytes);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMemoryStatsInfo::VulkanMemoryStatsInfo():
+    allocationsCount(0),
+    peakAllocationsCount(0),
+    maxAllocationsCount(0),
+    totalAllocationsCount(0),
+    failedAllocationsCount(0),
+    budgetAvailable(false){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMemoryStats::VulkanMemoryStats(VulkanPhysicalDevicePtr physicalDevice, bool budgetEnabled):
+    _physicalDevice(physicalDevice),
+    _getMemoryProperties2(nullptr){
+    
+    vkGetPhysicalDeviceMemoryProperties(_physicalDevice->getDevice(), &_memoryProperties);
+    
+    _stats.heaps.resize(_memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; i++) {
+        _stats.heaps[i].size = _memoryProperties.memoryHeaps[i].size;
+        _stats.heaps[i].flags = _memoryProperties.memoryHeaps[i].flags;
+    }
+    _stats.types.resize(_memoryProperties.memoryTypeCount);
+    for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+        _stats.types[i].flags = _memoryProperties.memoryTypes[i].propertyFlags;
+        _stats.types[i].heapIndex = _memoryProperties.memoryTypes[i].heapIndex;
+    }
+    _stats.maxAllocationsCount = _physicalDevice->getDeviceProperties().limits.maxMemoryAllocationCount;
+    
+    // Функции расширений инстанса берем вручную, как и коллбек отладки
+    if (budgetEnabled) {
+        VkInstance instance = _physicalDevice->getBaseInstance()->getInstance();
+        _getMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+    }
+}
+
+VulkanMemoryStats::~VulkanMemoryStats(){
+    if (_allocations.empty() == false) {
+        LOG("Memory stats: %d device memory allocations were not freed!\n", (int)_allocations.size());
+    }
+}
+
+VkResult VulkanMemoryStats::allocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocInfo, VkDeviceSize usedSize, VkDeviceMemory* memory){
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, memory);
+    
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (allocInfo.memoryTypeIndex >= _stats.types.size()) {
+        return result;
+    }
+    VulkanMemoryTypeStats& type = _stats.types[allocInfo.memoryTypeIndex];
+    VulkanMemoryHeapStats& heap = _stats.heaps[type.heapIndex];
+    
+    if (result != VK_SUCCESS) {
+        _stats.failedAllocationsCount++;
+        LOG("Memory stats: failed to allocate %.2f MB of type %d (heap %d: %.1f MB live in %d allocations of %.1f MB, %d allocations total of %d), error %d\n",
+            toMegabytes(allocInfo.allocationSize), (int)allocInfo.memoryTypeIndex, (int)type.heapIndex,
+            toMegabytes(heap.allocatedBytes), (int)heap.allocationsCount, toMegabytes(heap.size),
+            (int)_stats.allocationsCount, (int)_stats.maxAllocationsCount, (int)result);
+        return result;
+    }
+    
+    Allocation allocation;
+    allocation.memoryTypeIndex = allocInfo.memoryTypeIndex;
+    allocation.size = allocInfo.allocationSize;
+    allocation.usedSize = std::min(usedSize, allocInfo.allocationSize);
+    _allocations[*memory] = allocation;
+    
+    type.allocatedBytes += allocation.size;
+    type.usedBytes += allocation.usedSize;
+    type.allocationsCount++;
+    type.peakBytes = std::max(type.peakBytes, type.allocatedBytes);
+    
+    heap.allocatedBytes += allocation.size;
+    heap.usedBytes += allocation.usedSize;
+    heap.allocationsCount++;
+    heap.peakBytes = std::max(heap.peakBytes, heap.allocatedBytes);
+    
+    _stats.allocationsCount++;
+    _stats.totalAllocationsCount++;
+    _stats.peakAllocationsCount = std::max(_stats.peakAllocationsCount, _stats.allocationsCount);
+    return result;
+}
+
+void VulkanMemoryStats::freeMemory(VkDevice device, VkDeviceMemory memory){
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+    vkFreeMemory(device, memory, nullptr);
+    
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::map<VkDeviceMemory, Allocation>::iterator it = _allocations.find(memory);
+    if (it == _allocations.end()) {
+        return;
+    }
+    const Allocation& allocation = it->second;
+    VulkanMemoryTypeStats& type = _stats.types[allocation.memoryTypeIndex];
+    VulkanMemoryHeapStats& heap = _stats.heaps[type.heapIndex];
+    type.allocatedBytes -= allocation.size;
+    type.usedBytes -= allocation.usedSize;
+    type.allocationsCount--;
+    heap.allocatedBytes -= allocation.size;
+    heap.usedBytes -= allocation.usedSize;
+    heap.allocationsCount--;
+    _stats.allocationsCount--;
+    _allocations.erase(it);
+}
+
+void VulkanMemoryStats::setUsedSize(VkDeviceMemory memory, VkDeviceSize usedSize){
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::map<VkDeviceMemory, Allocation>::iterator it = _allocations.find(memory);
+    if (it == _allocations.end()) {
+        return;
+    }
+    Allocation& allocation = it->second;
+    VulkanMemoryTypeStats& type = _stats.types[allocation.memoryTypeIndex];
+    VulkanMemoryHeapStats& heap = _stats.heaps[type.heapIndex];
+    type.usedBytes -= allocation.usedSize;
+    heap.usedBytes -= allocation.usedSize;
+    allocation.usedSize = std::min(usedSize, allocation.size);
+    type.usedBytes += allocation.usedSize;
+    heap.usedBytes += allocation.usedSize;
+}
+
+void VulkanMemoryStats::queryBudget(VulkanMemoryStatsInfo& stats) const{
+#ifdef VK_EXT_memory_budget
+    if (_getMemoryProperties2 == nullptr) {
+        return;
+    }
+    
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+    memset(&budget, 0, sizeof(VkPhysicalDeviceMemoryBudgetPropertiesEXT));
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    
+    VkPhysicalDeviceMemoryProperties2KHR properties = {};
+    memset(&properties, 0, sizeof(VkPhysicalDeviceMemoryProperties2KHR));
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    properties.pNext = &budget;
+    _getMemoryProperties2(_physicalDevice->getDevice(), &properties);
+    
+    for (size_t i = 0; i < stats.heaps.size(); i++) {
+        stats.heaps[i].budgetBytes = budget.heapBudget[i];
+        stats.heaps[i].budgetUsageBytes = budget.heapUsage[i];
+    }
+    stats.budgetAvailable = true;
+#else
+    (void)stats;
+#endif
+}
+
+VulkanMemoryStatsInfo VulkanMemoryStats::getStats() const{
+    VulkanMemoryStatsInfo stats;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        stats = _stats;
+    }
+    queryBudget(stats);
+    return stats;
+}
+
+void VulkanMemoryStats::printStats() const{
+    VulkanMemoryStatsInfo stats = getStats();
+    LOG("Device memory: %d allocations (peak %d, limit %d, total %llu, failed %llu)%s\n",
+        (int)stats.allocationsCount, (int)stats.peakAllocationsCount, (int)stats.maxAllocationsCount,
+        (unsigned long long)stats.totalAllocationsCount, (unsigned long long)stats.failedAllocationsCount,
+        stats.budgetAvailable ? "" : ", no budget info");
+    
+    for (size_t i = 0; i < stats.heaps.size(); i++) {
+        const VulkanMemoryHeapStats& heap = stats.heaps[i];
+        if ((heap.peakBytes == 0) && (heap.budgetUsageBytes == 0)) {
+            continue;
+        }
+        LOG("-> heap %d (%s, %.0f MB): live %.1f MB in %d allocations, peak %.1f MB, fragmentation %.1f%%",
+            (int)i, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "device" : "host", toMegabytes(heap.size),
+            toMegabytes(heap.allocatedBytes), (int)heap.allocationsCount, toMegabytes(heap.peakBytes), heap.getFragmentation() * 100.0f);
+        if (stats.budgetAvailable) {
+            LOG(", process usage %.1f MB of budget %.1f MB", toMegabytes(heap.budgetUsageBytes), toMegabytes(heap.budgetBytes));
+        }
+        LOG("\n");
+        
+        for (size_t j = 0; j < stats.types.size(); j++) {
+            const VulkanMemoryTypeStats& type = stats.types[j];
+            if ((type.heapIndex != i) || (type.peakBytes == 0)) {
+                continue;
+            }
+            LOG("   type %d (flags 0x%x): live %.1f MB in %d allocations, peak %.1f MB, fragmentation %.1f%%\n",
+                (int)j, (unsigned int)type.flags, toMegabytes(type.allocatedBytes), (int)type.allocationsCount,
+                toMegabytes(type.peakBytes), type.getFragmentation() * 100.0f);
+        }
+    }
+}
+
+bool VulkanMemoryStats::isBudgetEnabled() const{
+    return _getMemoryProperties2 != nullptr;
+}
+
+VulkanPhysicalDevicePtr VulkanMemoryStats::getBasePhysicalDevice() const{
+    return _physicalDevice;
+}
+
+bool VulkanMemoryStats::isBudgetSupported(const VulkanPhysicalDevicePtr& physicalDevice){
+    const char* extensionName = getBudgetExtensionName();
+    if (extensionName == nullptr) {
+        return false;
+    }
+    return physicalDevice->getBaseInstance()->isExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) &&
+           physicalDevice->isExtensionSupported(extensionName);
+}
+
+const char* VulkanMemoryStats::getBudgetExtensionName(){
+#ifdef VK_EXT_memory_budget
+    return VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+#else
+    return nullptr;
+#endif
+}
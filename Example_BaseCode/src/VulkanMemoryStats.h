@@ -0,0 +1,107 @@
+#ifndef VULKAN_MEMORY_STATS_H
+#define VULKAN_MEMORY_STATS_H
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <mutex>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanPhysicalDevice.h"
+
+
+// Статистика одной кучи памяти
+struct VulkanMemoryHeapStats {
+    VkDeviceSize size;
+    VkMemoryHeapFlags flags;
+    VkDeviceSize allocatedBytes;    // Живые vkAllocateMemory
+    VkDeviceSize usedBytes;         // Из них занято ресурсами, остальное - округление до требований и простой блоков с алиасингом
+    VkDeviceSize peakBytes;
+    uint32_t allocationsCount;
+    VkDeviceSize budgetBytes;       // VK_EXT_memory_budget: сколько процесс может занять без вытеснения, 0 - нет данных
+    VkDeviceSize budgetUsageBytes;  // VK_EXT_memory_budget: занято процессом по данным драйвера, с чужими аллокациями
+    
+    VulkanMemoryHeapStats();
+    // Доля выделенной памяти, не занятая ресурсами
+    float getFragmentation() const;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Статистика одного типа памяти
+struct VulkanMemoryTypeStats {
+    VkMemoryPropertyFlags flags;
+    uint32_t heapIndex;
+    VkDeviceSize allocatedBytes;
+    VkDeviceSize usedBytes;
+    VkDeviceSize peakBytes;
+    uint32_t allocationsCount;
+    
+    VulkanMemoryTypeStats();
+    float getFragmentation() const;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+struct VulkanMemoryStatsInfo {
+    std::vector<VulkanMemoryHeapStats> heaps;
+    std::vector<VulkanMemoryTypeStats> types;
+    uint32_t allocationsCount;
+    uint32_t peakAllocationsCount;
+    uint32_t maxAllocationsCount;       // limits.maxMemoryAllocationCount
+    uint64_t totalAllocationsCount;     // За все время
+    uint64_t failedAllocationsCount;
+    bool budgetAvailable;
+    
+    VulkanMemoryStatsInfo();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+// Учет памяти устройства: все vkAllocateMemory/vkFreeMemory оберток идут через этот объект логического устройства.
+// Живые байты, пики и количество аллокаций по кучам и типам памяти, плюс бюджет драйвера через VK_EXT_memory_budget,
+// если расширение включено у устройства. Можно вызывать из любых потоков
+class VulkanMemoryStats {
+public:
+    VulkanMemoryStats(VulkanPhysicalDevicePtr physicalDevice, bool budgetEnabled);
+    ~VulkanMemoryStats();
+    // vkAllocateMemory с учетом, usedSize - сколько из allocationSize займут ресурсы. Ошибка возвращается как есть
+    VkResult allocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocInfo, VkDeviceSize usedSize, VkDeviceMemory* memory);
+    void freeMemory(VkDevice device, VkDeviceMemory memory);
+    // Занятый объем блока, к которому ресурсы привязываются после выделения
+    void setUsedSize(VkDeviceMemory memory, VkDeviceSize usedSize);
+    // Бюджет драйвера запрашивается при каждом вызове
+    VulkanMemoryStatsInfo getStats() const;
+    void printStats() const;
+    bool isBudgetEnabled() const;
+    VulkanPhysicalDevicePtr getBasePhysicalDevice() const;
+    
+    // Можно ли включать VK_EXT_memory_budget: нужно расширение устройства и запрос properties2 у инстанса
+    static bool isBudgetSupported(const VulkanPhysicalDevicePtr& physicalDevice);
+    // nullptr, если заголовки Vulkan не знают про расширение
+    static const char* getBudgetExtensionName();
+    
+private:
+    struct Allocation {
+        uint32_t memoryTypeIndex;
+        VkDeviceSize size;
+        VkDeviceSize usedSize;
+    };
+    
+    VulkanPhysicalDevicePtr _physicalDevice;
+    VkPhysicalDeviceMemoryProperties _memoryProperties;
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR _getMemoryProperties2;     // nullptr - бюджета нет
+    mutable std::mutex _mutex;
+    std::map<VkDeviceMemory, Allocation> _allocations;
+    VulkanMemoryStatsInfo _stats;
+    
+private:
+    void queryBudget(VulkanMemoryStatsInfo& stats) const;
+};
+
+typedef std::shared_ptr<VulkanMemoryStats> VulkanMemoryStatsPtr;
+
+#endif
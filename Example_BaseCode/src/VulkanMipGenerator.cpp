@@ -0,0 +1,306 @@
+#include "VulkanMipGenerator.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "VulkanHelpers.h"
+#include "VulkanImageView.h"
+#include "VulkanDescriptorSet.h"
+#include "Helpers.h"
+#include "AssetFile.h"
+
+
+static const uint32_t MIP_TILE_SIZE = 32;           // Квадрат первого генерируемого уровня на группу
+static const uint32_t MIP_LAST_GROUP_MAX_SIZE = 64; // Уровень 6, который целиком сворачивает последняя группа
+static const uint32_t MIP_COUNTER_BINDING = 13;
+// Блиты остаются запасным вариантом
+static const VkImageUsageFlags MIP_BLIT_IMAGE_USAGE = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+// Флаги картинки для записи через UNORM вью
+static VkImageCreateFlags getComputeImageFlags(VkFormat format){
+    return (format != VK_FORMAT_R8G8B8A8_UNORM) ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
+}
+
+const uint32_t VulkanMipGenerator::MAX_MIPS_PER_DISPATCH;
+
+VulkanMipGenerator::VulkanMipGenerator(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, const std::string& shaderPath):
+    _device(device),
+    _queue(queue),
+    _computeAvailable(false){
+
+    // Очередь, в которую пишутся команды генерации, должна уметь compute
+    VkPhysicalDevice physicalDevice = _device->getBasePhysicalDevice()->getDevice();
+    uint32_t familiesCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familiesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familiesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familiesCount, families.data());
+    uint32_t familyIndex = _queue->getFamilyIndex();
+    if ((familyIndex >= familiesCount) || ((families[familyIndex].queueFlags & VK_QUEUE_COMPUTE_BIT) == 0)) {
+        LOG("Mip generator: queue family %d has no compute, mipmaps will be blitted\n", (int)familyIndex);
+        return;
+    }
+
+    AssetFilePtr shaderFile = AssetFile::tryOpen(shaderPath);
+    if (shaderFile == nullptr) {
+        LOG("Mip generator: shader %s not found, mipmaps will be blitted\n", shaderPath.c_str());
+        return;
+    }
+    _shader = std::make_shared<VulkanShaderModule>(_device, shaderFile->getView());
+
+    // Исходный уровень читается билинейно в центрах текселей нового уровня
+    _sampler = std::make_shared<VulkanSampler>(_device,
+                                               VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+                                               VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                               1);
+
+    _counterBuffer = std::make_shared<VulkanBuffer>(_device,
+                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                    sizeof(uint32_t));
+
+    // 0 - исходный уровень, 1..12 - генерируемые уровни, 13 - счетчик групп
+    std::vector<VulkanDescriptorSetConfig> configs;
+    VulkanDescriptorSetConfig srcConfig;
+    srcConfig.binding = 0;
+    srcConfig.desriptorsCount = 1;
+    srcConfig.desriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    srcConfig.descriptorStageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    configs.push_back(srcConfig);
+    for (uint32_t i = 1; i <= MAX_MIPS_PER_DISPATCH; i++) {
+        VulkanDescriptorSetConfig mipConfig;
+        mipConfig.binding = i;
+        mipConfig.desriptorsCount = 1;
+        mipConfig.desriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        mipConfig.descriptorStageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        configs.push_back(mipConfig);
+    }
+    VulkanDescriptorSetConfig counterConfig;
+    counterConfig.binding = MIP_COUNTER_BINDING;
+    counterConfig.desriptorsCount = 1;
+    counterConfig.desriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    counterConfig.descriptorStageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    configs.push_back(counterConfig);
+    _descriptorSetLayout = std::make_shared<VulkanDescriptorSetLayout>(_device, configs);
+
+    // Наборы живут, пока их держат коммандные буфферы, поэтому освобождаются по одному
+    VulkanDescriptorAllocatorConfig allocatorConfig;
+    allocatorConfig.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.0f));
+    allocatorConfig.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, (float)MAX_MIPS_PER_DISPATCH));
+    allocatorConfig.ratios.push_back(VulkanDescriptorAllocatorPoolRatio(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f));
+    allocatorConfig.setsPerPool = 16;
+    allocatorConfig.poolFlags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    _descriptorAllocator = std::make_shared<VulkanDescriptorAllocator>(_device, allocatorConfig);
+
+    VkPushConstantRange pushConstantRange = {};
+    memset(&pushConstantRange, 0, sizeof(VkPushConstantRange));
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+    std::vector<VulkanDescriptorSetLayoutPtr> setLayouts = {_descriptorSetLayout};
+    std::vector<VkPushConstantRange> pushConstants = {pushConstantRange};
+    _pipelineLayout = std::make_shared<VulkanPipelineLayout>(_device, setLayouts, pushConstants);
+
+    _pipeline = std::make_shared<VulkanComputePipeline>(_device, _shader, _pipelineLayout);
+    _computeAvailable = true;
+}
+
+VulkanMipGenerator::~VulkanMipGenerator(){
+}
+
+bool VulkanMipGenerator::generateMips(VulkanCommandBufferPtr commandBuffer, VulkanImagePtr image){
+    if (isComputeSupported(image) == false) {
+        generateMipmapsForImage(commandBuffer, image);
+        return false;
+    }
+
+    uint32_t levelsCount = image->getBaseMipmapsCount();
+    VkPipelineStageFlags readStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    // Уровень 0 читается шейдером, остальные пишутся как storage картинки
+    std::vector<VulkanImageBarrierInfo> barriers(2);
+    barriers[0].image = image;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[0].startMipmapLevel = 0;
+    barriers[0].levelsCount = 1;
+    barriers[0].aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    barriers[0].srcAccessBarrier = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[0].dstAccessBarrier = VK_ACCESS_SHADER_READ_BIT;
+    barriers[1].image = image;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barriers[1].startMipmapLevel = 1;
+    barriers[1].levelsCount = levelsCount - 1;
+    barriers[1].aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    barriers[1].srcAccessBarrier = 0;
+    barriers[1].dstAccessBarrier = VK_ACCESS_SHADER_WRITE_BIT;
+    commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, readStages,
+                                      barriers.data(), (levelsCount > 1) ? 2 : 1, nullptr, 0, nullptr, 0);
+
+    uint32_t baseLevel = 0;
+    while ((baseLevel + 1) < levelsCount) {
+        // Вторая половина уровней идет в той же группе, только если уровень 6 помещается в одну группу
+        uint32_t mipsCount = std::min(levelsCount - 1 - baseLevel, MAX_MIPS_PER_DISPATCH);
+        if (mipsCount > 6) {
+            VkExtent2D size = image->getBaseSize();
+            uint32_t mip6Size = std::max(size.width >> (baseLevel + 6), size.height >> (baseLevel + 6));
+            if (mip6Size > MIP_LAST_GROUP_MAX_SIZE) {
+                mipsCount = 6;
+            }
+        }
+
+        dispatchLevels(commandBuffer, image, baseLevel, mipsCount);
+
+        // Готовые уровни читаются следующим dispatch и при отрисовке
+        VulkanImageBarrierInfo barrier;
+        barrier.image = image;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.startMipmapLevel = baseLevel + 1;
+        barrier.levelsCount = mipsCount;
+        barrier.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.srcAccessBarrier = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessBarrier = VK_ACCESS_SHADER_READ_BIT;
+        commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readStages,
+                                          &barrier, 1, nullptr, 0, nullptr, 0);
+
+        baseLevel += mipsCount;
+    }
+
+    return true;
+}
+
+bool VulkanMipGenerator::isComputeSupported(VkFormat format) const{
+    if (_computeAvailable == false) {
+        return false;
+    }
+    if ((format != VK_FORMAT_R8G8B8A8_UNORM) && (format != VK_FORMAT_R8G8B8A8_SRGB)) {
+        return false;
+    }
+
+    // Пишем всегда через UNORM вью, читаем через вью формата картинки с билинейной фильтрацией
+    VkPhysicalDevice physicalDevice = _device->getBasePhysicalDevice()->getDevice();
+    VkFormatProperties storageProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &storageProperties);
+    VkFormatProperties sampledProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &sampledProperties);
+    if (((storageProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) == 0) ||
+        ((sampledProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) == 0)) {
+        return false;
+    }
+    
+    // STORAGE проверяется для формата самой картинки: без VK_IMAGE_CREATE_EXTENDED_USAGE_BIT (maintenance2)
+    // sRGB картинка со storage использованием на большинстве GPU не создается, тогда остаются блиты
+    VkImageFormatProperties imageProperties;
+    VkResult result = vkGetPhysicalDeviceImageFormatProperties(physicalDevice, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                                                               MIP_BLIT_IMAGE_USAGE | VK_IMAGE_USAGE_STORAGE_BIT,
+                                                               getComputeImageFlags(format), &imageProperties);
+    return result == VK_SUCCESS;
+}
+
+bool VulkanMipGenerator::isComputeSupported(VulkanImagePtr image) const{
+    if (isComputeSupported(image->getBaseFormat()) == false) {
+        return false;
+    }
+    VkImageUsageFlags usage = image->getBaseUsage();
+    if (((usage & VK_IMAGE_USAGE_STORAGE_BIT) == 0) || ((usage & VK_IMAGE_USAGE_SAMPLED_BIT) == 0)) {
+        return false;
+    }
+    if ((image->getBaseFormat() != VK_FORMAT_R8G8B8A8_UNORM) && ((image->getBaseFlags() & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT) == 0)) {
+        return false;
+    }
+    return true;
+}
+
+bool VulkanMipGenerator::isComputeAvailable() const{
+    return _computeAvailable;
+}
+
+VkImageUsageFlags VulkanMipGenerator::getImageUsage(VkFormat format) const{
+    VkImageUsageFlags usage = MIP_BLIT_IMAGE_USAGE;
+    if (isComputeSupported(format)) {
+        usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+    return usage;
+}
+
+VkImageCreateFlags VulkanMipGenerator::getImageFlags(VkFormat format) const{
+    if (isComputeSupported(format)) {
+        return getComputeImageFlags(format);
+    }
+    return 0;
+}
+
+VulkanLogicalDevicePtr VulkanMipGenerator::getBaseDevice() const{
+    return _device;
+}
+
+void VulkanMipGenerator::dispatchLevels(VulkanCommandBufferPtr commandBuffer, VulkanImagePtr image, uint32_t baseLevel, uint32_t mipsCount){
+    // Вью исходного уровня в формате картинки, для sRGB чтение сразу дает линейные значения
+    VulkanImageViewPtr srcView = std::make_shared<VulkanImageView>(_device, image, VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                   image->getBaseFormat(), baseLevel, 1);
+
+    std::vector<VulkanDescriptorSetUpdateConfig> configs;
+    VulkanDescriptorSetUpdateConfig srcConfig;
+    srcConfig.binding = 0;
+    srcConfig.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    srcConfig.imageInfo.sampler = _sampler;
+    srcConfig.imageInfo.imageView = srcView;
+    srcConfig.imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    configs.push_back(srcConfig);
+
+    // Неиспользуемые биндинги смотрят на последний уровень, шейдер в них не пишет
+    for (uint32_t i = 1; i <= MAX_MIPS_PER_DISPATCH; i++) {
+        uint32_t level = baseLevel + std::min(i, mipsCount);
+        VulkanDescriptorSetUpdateConfig mipConfig;
+        mipConfig.binding = i;
+        mipConfig.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        mipConfig.imageInfo.imageView = std::make_shared<VulkanImageView>(_device, image, VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                          VK_FORMAT_R8G8B8A8_UNORM, level, 1);
+        mipConfig.imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        configs.push_back(mipConfig);
+    }
+
+    VulkanDescriptorSetUpdateConfig counterConfig;
+    counterConfig.binding = MIP_COUNTER_BINDING;
+    counterConfig.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    counterConfig.bufferInfo.buffer = _counterBuffer;
+    counterConfig.bufferInfo.offset = 0;
+    counterConfig.bufferInfo.range = sizeof(uint32_t);
+    configs.push_back(counterConfig);
+
+    VulkanDescriptorSetPtr descriptorSet = _descriptorAllocator->allocateSet(_descriptorSetLayout);
+    descriptorSet->updateDescriptorSet(configs);
+
+    // Счетчик сбрасывает последняя группа, но после прошлого dispatch его нужно обнулить явно
+    VulkanBufferBarrierInfo counterBarrier;
+    counterBarrier.buffer = _counterBuffer;
+    counterBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    counterBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    counterBarrier.offset = 0;
+    counterBarrier.size = VK_WHOLE_SIZE;
+    commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      nullptr, 0, &counterBarrier, 1, nullptr, 0);
+    uint32_t zero = 0;
+    commandBuffer->cmdUpdateBuffer(_counterBuffer, (unsigned char*)&zero, sizeof(uint32_t));
+    counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      nullptr, 0, &counterBarrier, 1, nullptr, 0);
+
+    VkExtent2D size = image->getBaseSize();
+    PushConstants constants;
+    memset(&constants, 0, sizeof(PushConstants));
+    constants.mip1Width = (int32_t)std::max(size.width >> (baseLevel + 1), 1u);
+    constants.mip1Height = (int32_t)std::max(size.height >> (baseLevel + 1), 1u);
+    constants.mipsCount = (int32_t)mipsCount;
+    uint32_t groupsX = (constants.mip1Width + MIP_TILE_SIZE - 1) / MIP_TILE_SIZE;
+    uint32_t groupsY = (constants.mip1Height + MIP_TILE_SIZE - 1) / MIP_TILE_SIZE;
+    constants.groupsCount = (int32_t)(groupsX * groupsY);
+    constants.srgb = (image->getBaseFormat() == VK_FORMAT_R8G8B8A8_SRGB) ? 1 : 0;
+
+    commandBuffer->cmdBindComputePipeline(_pipeline);
+    commandBuffer->cmdBindComputeDescriptorSet(_pipeline->getLayout(), descriptorSet);
+    commandBuffer->cmdPushConstants(_pipeline->getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, (void*)&constants, sizeof(PushConstants));
+    commandBuffer->cmdDispatch(groupsX, groupsY);
+}
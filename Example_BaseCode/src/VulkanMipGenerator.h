@@ -0,0 +1,74 @@
+#ifndef VULKAN_MIP_GENERATOR_H
+#define VULKAN_MIP_GENERATOR_H
+
+#include <memory>
+#include <string>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanBuffer.h"
+#include "VulkanSampler.h"
+#include "VulkanShaderModule.h"
+#include "VulkanDescriptorSetLayout.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanPipelineLayout.h"
+#include "VulkanComputePipeline.h"
+
+
+// Генерация мипмапов compute шейдером: до 12 уровней одним dispatch, промежуточные уровни в разделяемой памяти группы.
+// Поддерживаются RGBA8 UNORM/SRGB картинки любого размера, sRGB фильтруется в линейном пространстве.
+// Картинка должна быть создана с getImageUsage()/getImageFlags(), иначе, как и без поддержки compute в очереди
+// или без скомпилированного шейдера, используется цепочка блитов generateMipmapsForImage
+class VulkanMipGenerator {
+public:
+    static const uint32_t MAX_MIPS_PER_DISPATCH = 12;
+
+    // shaderPath - SPIR-V mip_downsample.comp, если файла нет - остаются только блиты
+    VulkanMipGenerator(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, const std::string& shaderPath);
+    ~VulkanMipGenerator();
+    // Уровень 0 в VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL после копирования, в конце все уровни в SHADER_READ_ONLY_OPTIMAL,
+    // как у generateMipmapsForImage. Возвращает true, если мипмапы посчитаны compute шейдером
+    bool generateMips(VulkanCommandBufferPtr commandBuffer, VulkanImagePtr image);
+    // Можно ли генерировать мипмапы картинки этого формата без блитов, с проверкой картинки с getImageUsage()/getImageFlags()
+    bool isComputeSupported(VkFormat format) const;
+    bool isComputeSupported(VulkanImagePtr image) const;
+    bool isComputeAvailable() const;
+    // Использование и флаги, с которыми нужно создавать картинку для генерации в compute (блиты тоже останутся доступны)
+    VkImageUsageFlags getImageUsage(VkFormat format) const;
+    VkImageCreateFlags getImageFlags(VkFormat format) const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+
+private:
+    // Совпадает с push константами mip_downsample.comp
+    struct PushConstants {
+        int32_t mip1Width;
+        int32_t mip1Height;
+        int32_t mipsCount;
+        int32_t groupsCount;
+        int32_t srgb;
+    };
+
+    VulkanLogicalDevicePtr _device;
+    VulkanQueuePtr _queue;
+    bool _computeAvailable;
+    VulkanSamplerPtr _sampler;
+    VulkanBufferPtr _counterBuffer;     // Счетчик завершенных групп
+    VulkanShaderModulePtr _shader;
+    VulkanDescriptorSetLayoutPtr _descriptorSetLayout;
+    VulkanDescriptorAllocatorPtr _descriptorAllocator;
+    VulkanPipelineLayoutPtr _pipelineLayout;
+    VulkanComputePipelinePtr _pipeline;
+
+private:
+    void dispatchLevels(VulkanCommandBufferPtr commandBuffer, VulkanImagePtr image, uint32_t baseLevel, uint32_t mipsCount);
+};
+
+typedef std::shared_ptr<VulkanMipGenerator> VulkanMipGeneratorPtr;
+
+#endif
@@ -118,6 +118,19 @@ std::vector<const char*> VulkanPhysicalDevice::getBaseExtentions() const{
     return _vulkanExtensions;
 }
 
+bool VulkanPhysicalDevice::isExtensionSupported(const char* name) const{
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(_device, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(_device, nullptr, &extensionCount, availableExtensions.data());
+    for (const VkExtensionProperties& extension: availableExtensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 VulkanSurfacePtr VulkanPhysicalDevice::getBaseSurface() const{
     return _vulkanSurface;
 }
@@ -241,29 +254,42 @@ VulkanQueuesFamiliesIndexes VulkanPhysicalDevice::findQueueFamiliesIndexInDevice
     
     VulkanQueuesFamiliesIndexes result;
     
-    // Подбираем информацию об очередях
+    // Подбираем информацию об очередях, семейства копирования и вычислений ищем по всему списку
     int i = 0;
     for (const VkQueueFamilyProperties& queueFamily: queueFamilies) {
-
-        // Для группы очередей отрисовки проверяем, что там есть очереди + есть очередь отрисовки
-        if ((queueFamily.queueCount > 0) && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
-            result.renderQueuesFamilyIndex = i;
-            result.renderQueuesFamilyQueuesCount = queueFamily.queueCount;
-            result.renderQueuesTimeStampValidBits = queueFamily.timestampValidBits;
+        if (result.isComplete() == false) {
+            // Для группы очередей отрисовки проверяем, что там есть очереди + есть очередь отрисовки
+            if ((queueFamily.queueCount > 0) && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                result.renderQueuesFamilyIndex = i;
+                result.renderQueuesFamilyQueuesCount = queueFamily.queueCount;
+                result.renderQueuesTimeStampValidBits = queueFamily.timestampValidBits;
+            }
+            
+            // Провеяем, может является ли данная очередь - очередью отображения
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _vulkanSurface->getSurface(), &presentSupport);
+            if ((queueFamily.queueCount > 0) && presentSupport) {
+                result.presentQueuesFamilyIndex = i;
+                result.presentQueuesFamilyQueuesCount = queueFamily.queueCount;
+                result.presentQueuesTimeStampValidBits = queueFamily.timestampValidBits;
+            }
         }
         
-        // Провеяем, может является ли данная очередь - очередью отображения
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _vulkanSurface->getSurface(), &presentSupport);
-        if ((queueFamily.queueCount > 0) && presentSupport) {
-            result.presentQueuesFamilyIndex = i;
-            result.presentQueuesFamilyQueuesCount = queueFamily.queueCount;
-            result.presentQueuesTimeStampValidBits = queueFamily.timestampValidBits;
+        // Выделенное семейство копирования - только TRANSFER, без графики и вычислений (DMA движок)
+        bool transferOnly = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+                            ((queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0);
+        if ((queueFamily.queueCount > 0) && transferOnly && (result.transferQueuesFamilyIndex < 0)) {
+            result.transferQueuesFamilyIndex = i;
+            result.transferQueuesFamilyQueuesCount = queueFamily.queueCount;
+            result.transferQueuesTimeStampValidBits = queueFamily.timestampValidBits;
         }
         
-        // Нашли очереди
-        if (result.isComplete()) {
-            return result;
+        // Асинхронные вычисления - семейство с COMPUTE, но без графики
+        bool computeOnly = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0);
+        if ((queueFamily.queueCount > 0) && computeOnly && (result.computeQueuesFamilyIndex < 0)) {
+            result.computeQueuesFamilyIndex = i;
+            result.computeQueuesFamilyQueuesCount = queueFamily.queueCount;
+            result.computeQueuesTimeStampValidBits = queueFamily.timestampValidBits;
         }
         
         i++;
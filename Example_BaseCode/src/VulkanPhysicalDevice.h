@@ -29,6 +29,8 @@ public:
     VulkanSwapChainSupportDetails getSwapChainSupportDetails() const;
     VulkanInstancePtr getBaseInstance() const;
     std::vector<const char*> getBaseExtentions() const;
+    // Для не обязательных расширений, которые включаются только при наличии
+    bool isExtensionSupported(const char* name) const;
     VulkanSurfacePtr getBaseSurface() const;
     
 private:
@@ -24,6 +24,63 @@ VulkanPipelineBlendConfig::VulkanPipelineBlendConfig():
     blendOp(VK_BLEND_OP_ADD){
 }
 
+VulkanPipelineSpecialization::VulkanPipelineSpecialization(){
+}
+
+void VulkanPipelineSpecialization::addConstant(uint32_t constantId, const void* value, size_t size){
+    VkSpecializationMapEntry entry = {};
+    memset(&entry, 0, sizeof(VkSpecializationMapEntry));
+    entry.constantID = constantId;
+    entry.offset = static_cast<uint32_t>(data.size());
+    entry.size = size;
+    entries.push_back(entry);
+    
+    const unsigned char* bytes = (const unsigned char*)value;
+    data.insert(data.end(), bytes, bytes + size);
+}
+
+void VulkanPipelineSpecialization::addInt(uint32_t constantId, int32_t value){
+    addConstant(constantId, &value, sizeof(int32_t));
+}
+
+void VulkanPipelineSpecialization::addUInt(uint32_t constantId, uint32_t value){
+    addConstant(constantId, &value, sizeof(uint32_t));
+}
+
+void VulkanPipelineSpecialization::addFloat(uint32_t constantId, float value){
+    addConstant(constantId, &value, sizeof(float));
+}
+
+// bool в SPIR-V константах занимает 4 байта
+void VulkanPipelineSpecialization::addBool(uint32_t constantId, bool value){
+    VkBool32 boolValue = value ? VK_TRUE : VK_FALSE;
+    addConstant(constantId, &boolValue, sizeof(VkBool32));
+}
+
+bool VulkanPipelineSpecialization::isEmpty() const{
+    return entries.empty();
+}
+
+bool VulkanPipelineSpecialization::operator==(const VulkanPipelineSpecialization& other) const{
+    if ((entries.size() != other.entries.size()) || (data != other.data)) {
+        return false;
+    }
+    for (size_t i = 0; i < entries.size(); i++) {
+        if ((entries[i].constantID != other.entries[i].constantID) ||
+            (entries[i].offset != other.entries[i].offset) ||
+            (entries[i].size != other.entries[i].size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VulkanPipelineSpecialization::operator!=(const VulkanPipelineSpecialization& other) const{
+    return !(*this == other);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
                                VulkanShaderModulePtr vertexShader, VulkanShaderModulePtr fragmentShader,
                                VulkanPipelineDepthConfig depthConfig,
@@ -52,14 +109,80 @@ VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
     _scissor(scissor),
     _cullingConfig(cullingConfig),
     _blendConfig(blendConfig),
-    _descriptorSetLayouts(descriptorSetLayouts),
     _renderPass(renderPass),
-    _pushConstants(pushConstants),
     _dynamicStates(dynamicStates),
     _sampleCount(sampleCount),
     _sampleShading(sampleShading),
-    _minSampleShading(minSampleShading){
-        
+    _minSampleShading(minSampleShading),
+    _subpass(0){
+    
+    // Собственный лаяут пайплайна
+    _pipelineLayout = std::make_shared<VulkanPipelineLayout>(_device, descriptorSetLayouts, pushConstants);
+    
+    createPipeline();
+}
+
+VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
+                               VulkanShaderModulePtr vertexShader, VulkanShaderModulePtr fragmentShader,
+                               VulkanPipelineDepthConfig depthConfig,
+                               VkVertexInputBindingDescription vertexBindingDescription,
+                               std::vector<VkVertexInputAttributeDescription> vertexAttributesDescriptions,
+                               VkPrimitiveTopology primitivesTypes,
+                               VkViewport viewport,
+                               VkRect2D scissor,
+                               VulkanPipelineCullingConfig cullingConfig,
+                               VulkanPipelineBlendConfig blendConfig,
+                               VulkanPipelineLayoutPtr pipelineLayout,
+                               VulkanRenderPassPtr renderPass,
+                               const std::vector<VkDynamicState>& dynamicStates,
+                               VkSampleCountFlagBits sampleCount,
+                               bool sampleShading,
+                               float minSampleShading,
+                               VulkanPipelineCachePtr pipelineCache,
+                               const VulkanPipelineSpecialization& vertexSpecialization,
+                               const VulkanPipelineSpecialization& fragmentSpecialization,
+                               uint32_t subpass):
+    _device(device),
+    _vertexShader(vertexShader),
+    _fragmentShader(fragmentShader),
+    _depthConfig(depthConfig),
+    _vertexBindingDescription(vertexBindingDescription),
+    _vertexAttributesDescriptions(vertexAttributesDescriptions),
+    _primitivesTypes(primitivesTypes),
+    _viewport(viewport),
+    _scissor(scissor),
+    _cullingConfig(cullingConfig),
+    _blendConfig(blendConfig),
+    _pipelineLayout(pipelineLayout),
+    _renderPass(renderPass),
+    _dynamicStates(dynamicStates),
+    _sampleCount(sampleCount),
+    _sampleShading(sampleShading),
+    _minSampleShading(minSampleShading),
+    _pipelineCache(pipelineCache),
+    _vertexSpecialization(vertexSpecialization),
+    _fragmentSpecialization(fragmentSpecialization),
+    _subpass(subpass){
+    
+    createPipeline();
+}
+
+void VulkanPipeline::createPipeline(){
+    // Константы специализации шейдеров
+    VkSpecializationInfo vertexSpecializationInfo = {};
+    memset(&vertexSpecializationInfo, 0, sizeof(VkSpecializationInfo));
+    vertexSpecializationInfo.mapEntryCount = static_cast<uint32_t>(_vertexSpecialization.entries.size());
+    vertexSpecializationInfo.pMapEntries = _vertexSpecialization.entries.data();
+    vertexSpecializationInfo.dataSize = _vertexSpecialization.data.size();
+    vertexSpecializationInfo.pData = _vertexSpecialization.data.data();
+    
+    VkSpecializationInfo fragmentSpecializationInfo = {};
+    memset(&fragmentSpecializationInfo, 0, sizeof(VkSpecializationInfo));
+    fragmentSpecializationInfo.mapEntryCount = static_cast<uint32_t>(_fragmentSpecialization.entries.size());
+    fragmentSpecializationInfo.pMapEntries = _fragmentSpecialization.entries.data();
+    fragmentSpecializationInfo.dataSize = _fragmentSpecialization.data.size();
+    fragmentSpecializationInfo.pData = _fragmentSpecialization.data.data();
+    
     // Описание настроек вершинного шейдера
     VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
     memset(&vertShaderStageInfo, 0, sizeof(VkPipelineShaderStageCreateInfo));
@@ -67,6 +190,7 @@ VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT; // Вершинный шейдер
     vertShaderStageInfo.module = _vertexShader->getModule();    // Модуль
     vertShaderStageInfo.pName = "main";     // Входная функция
+    vertShaderStageInfo.pSpecializationInfo = _vertexSpecialization.isEmpty() ? nullptr : &vertexSpecializationInfo;
     
     // Описание настроек фрагментного шейдера
     VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
@@ -75,6 +199,7 @@ VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT; // Фрагментный шейдер
     fragShaderStageInfo.module = _fragmentShader->getModule();  // Модуль
     fragShaderStageInfo.pName = "main";     // Входная функция
+    fragShaderStageInfo.pSpecializationInfo = _fragmentSpecialization.isEmpty() ? nullptr : &fragmentSpecializationInfo;
         
     // Описание настроек глубины и трафарета у пайплайна
     // Поля depthBoundsTestEnable, minDepthBounds и maxDepthBounds используют для дополнительного теста связанной глубины.
@@ -166,25 +291,6 @@ VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
     dynamicInfo.dynamicStateCount = static_cast<uint32_t>(_dynamicStates.size());
     dynamicInfo.pDynamicStates = _dynamicStates.data();
     
-    // Лаяут пайплайна
-    std::vector<VkDescriptorSetLayout> setLayouts;
-    setLayouts.reserve(_descriptorSetLayouts.size());
-    for(const VulkanDescriptorSetLayoutPtr& layout: _descriptorSetLayouts){
-        setLayouts.push_back(layout->getLayout());
-    }
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    memset(&pipelineLayoutInfo, 0, sizeof(VkPipelineLayoutCreateInfo));
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
-    pipelineLayoutInfo.pSetLayouts = setLayouts.data(); // Устанавливаем лаяут
-    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(_pushConstants.size());
-    pipelineLayoutInfo.pPushConstantRanges = (_pushConstants.size() > 0) ? _pushConstants.data() : nullptr; // Пуш константы нужны для того, чтобы передавать данные в отрисовку, как альтернатива юниформам
-    
-    if (vkCreatePipelineLayout(_device->getDevice(), &pipelineLayoutInfo, nullptr, &_layout) != VK_SUCCESS) {
-        LOG("Failed to create pipeline layout!\n");
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
-    
     // Настройка антиаллиасинга с помощью мультисемплинга
     VkPipelineMultisampleStateCreateInfo multisampling = {};
     memset(&multisampling, 0, sizeof(VkPipelineMultisampleStateCreateInfo));
@@ -213,27 +319,50 @@ VulkanPipeline::VulkanPipeline(VulkanLogicalDevicePtr device,
     pipelineInfo.pMultisampleState = &multisampling;    // Настройки семплирования для антиалиассинга
     pipelineInfo.pColorBlendState = &colorBlending;     // Настройка смешивания цветов
     pipelineInfo.pDynamicState = (dynamicInfo.dynamicStateCount > 0) ? &dynamicInfo : nullptr;               // Динамическое состояние отрисовки
-    pipelineInfo.layout = _layout;                      // Лаяут пайплайна (Описание буфферов юниформов и семплеров)
+    pipelineInfo.layout = _pipelineLayout->getLayout();                      // Лаяут пайплайна (Описание буфферов юниформов и семплеров)
     pipelineInfo.renderPass = _renderPass->getPass();         // Рендер-проход
-    pipelineInfo.subpass = 0;   // Для какого
+    pipelineInfo.subpass = _subpass;   // Для какого подпрохода
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;   // Родительский пайплайн
     
-    if (vkCreateGraphicsPipelines(_device->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
+    VkPipelineCache pipelineCache = _pipelineCache ? _pipelineCache->getCache() : VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(_device->getDevice(), pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
         LOG("Failed to create graphics pipeline!\n");
         throw std::runtime_error("Failed to create graphics pipeline!");
     }
 }
 
 VulkanPipeline::~VulkanPipeline(){
-    vkDestroyPipelineLayout(_device->getDevice(), _layout, nullptr);
     vkDestroyPipeline(_device->getDevice(), _pipeline, nullptr);
 }
 
 VkPipelineLayout VulkanPipeline::getLayout() const{
-    return _layout;
+    return _pipelineLayout->getLayout();
 }
 
 VkPipeline VulkanPipeline::getPipeline() const{
     return _pipeline;
 }
 
+VulkanPipelineLayoutPtr VulkanPipeline::getBasePipelineLayout() const{
+    return _pipelineLayout;
+}
+
+VulkanPipelineCachePtr VulkanPipeline::getBasePipelineCache() const{
+    return _pipelineCache;
+}
+
+VulkanPipelineSpecialization VulkanPipeline::getBaseVertexSpecialization() const{
+    return _vertexSpecialization;
+}
+
+VulkanPipelineSpecialization VulkanPipeline::getBaseFragmentSpecialization() const{
+    return _fragmentSpecialization;
+}
+
+uint32_t VulkanPipeline::getBaseSubpass() const{
+    return _subpass;
+}
+
+VulkanLogicalDevicePtr VulkanPipeline::getBaseDevice() const{
+    return _device;
+}
@@ -2,6 +2,7 @@
 #define VULKAN_PIPELINE_H
 
 #include <memory>
+#include <vector>
 
 // GLFW include
 #define GLFW_INCLUDE_VULKAN
@@ -10,6 +11,8 @@
 #include "VulkanLogicalDevice.h"
 #include "VulkanShaderModule.h"
 #include "VulkanDescriptorSetLayout.h"
+#include "VulkanPipelineLayout.h"
+#include "VulkanPipelineCache.h"
 #include "VulkanRenderPass.h"
 #include "VulkanResource.h"
 
@@ -38,6 +41,23 @@ struct VulkanPipelineBlendConfig{
     VulkanPipelineBlendConfig();
 };
 
+// Константы специализации одной стадии шейдера (layout(constant_id = N) const ...).
+// Ветки по таким константам драйвер убирает при компиляции пайплайна
+struct VulkanPipelineSpecialization{
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<unsigned char> data;
+    
+    VulkanPipelineSpecialization();
+    void addConstant(uint32_t constantId, const void* value, size_t size);
+    void addInt(uint32_t constantId, int32_t value);
+    void addUInt(uint32_t constantId, uint32_t value);
+    void addFloat(uint32_t constantId, float value);
+    void addBool(uint32_t constantId, bool value);
+    bool isEmpty() const;
+    bool operator==(const VulkanPipelineSpecialization& other) const;
+    bool operator!=(const VulkanPipelineSpecialization& other) const;
+};
+
 class VulkanPipeline: public VulkanResource {
 public:
     VulkanPipeline(VulkanLogicalDevicePtr device,
@@ -57,9 +77,36 @@ public:
                    VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT,
                    bool sampleShading = false,
                    float minSampleShading = 0.0f);
+    // Лэйаут пайплайна общий, например полученный из VulkanLayoutCache.
+    // С кешем пайплайнов конструктор можно вызывать из рабочего потока (VulkanPipelineCompiler)
+    VulkanPipeline(VulkanLogicalDevicePtr device,
+                   VulkanShaderModulePtr vertexShader, VulkanShaderModulePtr fragmentShader,
+                   VulkanPipelineDepthConfig depthConfig,
+                   VkVertexInputBindingDescription vertexBindingDescription,
+                   std::vector<VkVertexInputAttributeDescription> vertexAttributesDescriptions,
+                   VkPrimitiveTopology primitivesTypes,
+                   VkViewport viewport,
+                   VkRect2D scissor,
+                   VulkanPipelineCullingConfig cullingConfig,
+                   VulkanPipelineBlendConfig blendConfig,
+                   VulkanPipelineLayoutPtr pipelineLayout,
+                   VulkanRenderPassPtr renderPass,
+                   const std::vector<VkDynamicState>& dynamicStates = std::vector<VkDynamicState>(),
+                   VkSampleCountFlagBits sampleCount = VK_SAMPLE_COUNT_1_BIT,
+                   bool sampleShading = false,
+                   float minSampleShading = 0.0f,
+                   VulkanPipelineCachePtr pipelineCache = nullptr,
+                   const VulkanPipelineSpecialization& vertexSpecialization = VulkanPipelineSpecialization(),
+                   const VulkanPipelineSpecialization& fragmentSpecialization = VulkanPipelineSpecialization(),
+                   uint32_t subpass = 0);
     ~VulkanPipeline();
     VkPipelineLayout getLayout() const;
     VkPipeline getPipeline() const;
+    VulkanPipelineLayoutPtr getBasePipelineLayout() const;
+    VulkanPipelineCachePtr getBasePipelineCache() const;
+    VulkanPipelineSpecialization getBaseVertexSpecialization() const;
+    VulkanPipelineSpecialization getBaseFragmentSpecialization() const;
+    uint32_t getBaseSubpass() const;
     VulkanLogicalDevicePtr getBaseDevice() const;
     
 private:
@@ -74,18 +121,21 @@ private:
     VkRect2D _scissor;
     VulkanPipelineCullingConfig _cullingConfig;
     VulkanPipelineBlendConfig _blendConfig;
-    std::vector<VulkanDescriptorSetLayoutPtr> _descriptorSetLayouts;
+    VulkanPipelineLayoutPtr _pipelineLayout;
     VulkanRenderPassPtr _renderPass;
-    std::vector<VkPushConstantRange> _pushConstants;
     std::vector<VkDynamicState> _dynamicStates;
     VkSampleCountFlagBits _sampleCount;
     bool _sampleShading;
     float _minSampleShading;
+    VulkanPipelineCachePtr _pipelineCache;
+    VulkanPipelineSpecialization _vertexSpecialization;
+    VulkanPipelineSpecialization _fragmentSpecialization;
+    uint32_t _subpass;
     
-    VkPipelineLayout _layout;
     VkPipeline _pipeline;
     
 private:
+    void createPipeline();
 };
 
 typedef std::shared_ptr<VulkanPipeline> VulkanPipelinePtr;
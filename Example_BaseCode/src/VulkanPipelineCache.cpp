@@ -0,0 +1,53 @@
+#include "VulkanPipelineCache.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+VulkanPipelineCache::VulkanPipelineCache(VulkanLogicalDevicePtr device, const std::vector<unsigned char>& initialData):
+    _device(device),
+    _cache(VK_NULL_HANDLE){
+    
+    VkPipelineCacheCreateInfo createInfo = {};
+    memset(&createInfo, 0, sizeof(VkPipelineCacheCreateInfo));
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = (initialData.size() > 0) ? initialData.data() : nullptr;
+    
+    if (vkCreatePipelineCache(_device->getDevice(), &createInfo, nullptr, &_cache) != VK_SUCCESS) {
+        LOG("Failed to create pipeline cache!\n");
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+}
+
+VulkanPipelineCache::~VulkanPipelineCache(){
+    vkDestroyPipelineCache(_device->getDevice(), _cache, nullptr);
+}
+
+// Данные кеша для сохранения на диск
+std::vector<unsigned char> VulkanPipelineCache::getData() const{
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(_device->getDevice(), _cache, &dataSize, nullptr) != VK_SUCCESS) {
+        LOG("Failed to get pipeline cache data size!\n");
+        throw std::runtime_error("Failed to get pipeline cache data size!");
+    }
+    
+    std::vector<unsigned char> data(dataSize);
+    if (dataSize > 0) {
+        if (vkGetPipelineCacheData(_device->getDevice(), _cache, &dataSize, data.data()) != VK_SUCCESS) {
+            LOG("Failed to get pipeline cache data!\n");
+            throw std::runtime_error("Failed to get pipeline cache data!");
+        }
+        data.resize(dataSize);
+    }
+    return data;
+}
+
+VkPipelineCache VulkanPipelineCache::getCache() const{
+    return _cache;
+}
+
+VulkanLogicalDevicePtr VulkanPipelineCache::getBaseDevice() const{
+    return _device;
+}
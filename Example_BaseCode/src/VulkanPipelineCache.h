@@ -0,0 +1,33 @@
+#ifndef VULKAN_PIPELINE_CACHE_H
+#define VULKAN_PIPELINE_CACHE_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+
+
+// Кеш скомпилированных пайплайнов драйвера, можно использовать из нескольких потоков одновременно
+class VulkanPipelineCache {
+public:
+    // initialData - ранее сохраненные getData() данные, при несовпадении устройства драйвер их просто проигнорирует
+    VulkanPipelineCache(VulkanLogicalDevicePtr device, const std::vector<unsigned char>& initialData = std::vector<unsigned char>());
+    ~VulkanPipelineCache();
+    std::vector<unsigned char> getData() const;
+    VkPipelineCache getCache() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    VkPipelineCache _cache;
+    
+private:
+};
+
+typedef std::shared_ptr<VulkanPipelineCache> VulkanPipelineCachePtr;
+
+#endif
@@ -0,0 +1,130 @@
+#include "VulkanPipelineCompiler.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
+#include "Helpers.h"
+
+
+VulkanPipelineCompiler::VulkanPipelineCompiler(VulkanLogicalDevicePtr device, uint32_t threadsCount, VulkanPipelineCachePtr pipelineCache):
+    _device(device),
+    _pipelineCache(pipelineCache),
+    _pendingCount(0),
+    _compiledCount(0),
+    _stop(false){
+    
+    // Общий кеш нужен, чтобы одинаковые шейдеры в разных пайплайнах компилировались один раз
+    if (_pipelineCache == nullptr) {
+        _pipelineCache = std::make_shared<VulkanPipelineCache>(_device);
+    }
+    
+    if (threadsCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadsCount = (hardwareThreads > 1) ? (hardwareThreads - 1) : 1;
+    }
+    
+    _threads.reserve(threadsCount);
+    for (uint32_t i = 0; i < threadsCount; i++) {
+        _threads.push_back(std::thread(&VulkanPipelineCompiler::workerThread, this));
+    }
+}
+
+VulkanPipelineCompiler::~VulkanPipelineCompiler(){
+    // Задачи, которые еще не начали выполняться, отбрасываем - их future получат broken_promise
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+        _pendingCount -= static_cast<uint32_t>(_tasks.size());
+        _tasks.clear();
+    }
+    _tasksCondition.notify_all();
+    
+    for (std::thread& thread: _threads) {
+        thread.join();
+    }
+}
+
+// Ставим создание пайплайна в очередь, результат можно проверять каждый кадр через getIfReady
+VulkanPipelineFuture VulkanPipelineCompiler::compile(const VulkanPipelineCreateFunction& createFunction){
+    VulkanPipelineCachePtr pipelineCache = _pipelineCache;
+    TaskPtr task = std::make_shared<Task>([createFunction, pipelineCache](){
+        return createFunction(pipelineCache);
+    });
+    VulkanPipelineFuture future = task->get_future().share();
+    
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _tasks.push_back(task);
+        _pendingCount++;
+    }
+    _tasksCondition.notify_one();
+    
+    return future;
+}
+
+// Ждем завершения всех поставленных задач (синхронный режим или выход)
+void VulkanPipelineCompiler::waitAll(){
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondition.wait(lock, [this](){
+        return _pendingCount == 0;
+    });
+}
+
+void VulkanPipelineCompiler::workerThread(){
+    while (true) {
+        TaskPtr task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tasksCondition.wait(lock, [this](){
+                return _stop || (_tasks.empty() == false);
+            });
+            if (_tasks.empty()) {
+                return;
+            }
+            task = _tasks.front();
+            _tasks.pop_front();
+        }
+        
+        // Исключение создания сохранится в future
+        (*task)();
+        
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _pendingCount--;
+            _compiledCount++;
+        }
+        _doneCondition.notify_all();
+    }
+}
+
+uint32_t VulkanPipelineCompiler::getPendingCount() const{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _pendingCount;
+}
+
+uint32_t VulkanPipelineCompiler::getCompiledCount() const{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _compiledCount;
+}
+
+uint32_t VulkanPipelineCompiler::getThreadsCount() const{
+    return static_cast<uint32_t>(_threads.size());
+}
+
+VulkanPipelineCachePtr VulkanPipelineCompiler::getPipelineCache() const{
+    return _pipelineCache;
+}
+
+VulkanLogicalDevicePtr VulkanPipelineCompiler::getBaseDevice() const{
+    return _device;
+}
+
+VulkanPipelinePtr VulkanPipelineCompiler::getIfReady(const VulkanPipelineFuture& future){
+    if (future.valid() == false) {
+        return nullptr;
+    }
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return nullptr;
+    }
+    return future.get();
+}
@@ -0,0 +1,66 @@
+#ifndef VULKAN_PIPELINE_COMPILER_H
+#define VULKAN_PIPELINE_COMPILER_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanPipeline.h"
+#include "VulkanPipelineCache.h"
+
+
+// Функция создания пайплайна, вызывается в рабочем потоке с общим кешем пайплайнов.
+// Все нужные объекты (лэйаут, шейдеры, рендер проход) должны быть получены заранее и захвачены по значению
+typedef std::function<VulkanPipelinePtr(VulkanPipelineCachePtr)> VulkanPipelineCreateFunction;
+typedef std::shared_future<VulkanPipelinePtr> VulkanPipelineFuture;
+
+// Фоновая компиляция пайплайнов в рабочих потоках с общим кешем пайплайнов.
+// Ошибки создания пробрасываются исключением при получении пайплайна из future
+class VulkanPipelineCompiler {
+public:
+    // threadsCount == 0 - число ядер минус один (главный поток)
+    VulkanPipelineCompiler(VulkanLogicalDevicePtr device, uint32_t threadsCount = 0, VulkanPipelineCachePtr pipelineCache = nullptr);
+    ~VulkanPipelineCompiler();
+    VulkanPipelineFuture compile(const VulkanPipelineCreateFunction& createFunction);
+    void waitAll();
+    uint32_t getPendingCount() const;
+    uint32_t getCompiledCount() const;
+    uint32_t getThreadsCount() const;
+    VulkanPipelineCachePtr getPipelineCache() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    
+    // Пайплайн, если он уже готов, иначе nullptr - отрисовку можно пропустить в этом кадре
+    static VulkanPipelinePtr getIfReady(const VulkanPipelineFuture& future);
+    
+private:
+    typedef std::packaged_task<VulkanPipelinePtr()> Task;
+    typedef std::shared_ptr<Task> TaskPtr;
+    
+    VulkanLogicalDevicePtr _device;
+    VulkanPipelineCachePtr _pipelineCache;
+    std::vector<std::thread> _threads;
+    std::deque<TaskPtr> _tasks;
+    mutable std::mutex _mutex;
+    std::condition_variable _tasksCondition;
+    std::condition_variable _doneCondition;
+    uint32_t _pendingCount;     // В очереди + компилируются сейчас
+    uint32_t _compiledCount;
+    bool _stop;
+    
+private:
+    void workerThread();
+};
+
+typedef std::shared_ptr<VulkanPipelineCompiler> VulkanPipelineCompilerPtr;
+
+#endif
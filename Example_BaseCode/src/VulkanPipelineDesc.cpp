@@ -0,0 +1,203 @@
+#include "VulkanPipelineDesc.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+static uint64_t floatBits(float value){
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(float));
+    return bits;
+}
+
+static void hashSpecialization(uint64_t& hash, const VulkanPipelineSpecialization& specialization){
+    hashValue(hash, specialization.entries.size());
+    for (const VkSpecializationMapEntry& entry: specialization.entries) {
+        hashValue(hash, entry.constantID);
+        hashValue(hash, entry.offset);
+        hashValue(hash, entry.size);
+    }
+    for (unsigned char value: specialization.data) {
+        hashValue(hash, value);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanPipelineDesc::VulkanPipelineDesc():
+    primitivesTypes(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST),
+    subpass(0),
+    sampleCount(VK_SAMPLE_COUNT_1_BIT),
+    sampleShading(false),
+    minSampleShading(0.0f){
+    
+    memset(&vertexBindingDescription, 0, sizeof(VkVertexInputBindingDescription));
+    memset(&viewport, 0, sizeof(VkViewport));
+    memset(&scissor, 0, sizeof(VkRect2D));
+}
+
+size_t VulkanPipelineDesc::getHash() const{
+    uint64_t hash = FNV1A_INITIAL_HASH;
+    
+    hashValue(hash, vertexShader ? (uint64_t)vertexShader->getModule() : 0);
+    hashValue(hash, fragmentShader ? (uint64_t)fragmentShader->getModule() : 0);
+    
+    hashValue(hash, depthConfig.depthTestEnabled);
+    hashValue(hash, depthConfig.depthWriteEnabled);
+    hashValue(hash, (uint64_t)depthConfig.depthFunc);
+    
+    hashValue(hash, vertexBindingDescription.binding);
+    hashValue(hash, vertexBindingDescription.stride);
+    hashValue(hash, (uint64_t)vertexBindingDescription.inputRate);
+    for (const VkVertexInputAttributeDescription& attribute: vertexAttributesDescriptions) {
+        hashValue(hash, attribute.location);
+        hashValue(hash, attribute.binding);
+        hashValue(hash, (uint64_t)attribute.format);
+        hashValue(hash, attribute.offset);
+    }
+    
+    hashValue(hash, (uint64_t)primitivesTypes);
+    
+    // Динамические вьюпорт и сциссор в ключ не входят
+    if (hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT) == false) {
+        hashValue(hash, floatBits(viewport.x));
+        hashValue(hash, floatBits(viewport.y));
+        hashValue(hash, floatBits(viewport.width));
+        hashValue(hash, floatBits(viewport.height));
+        hashValue(hash, floatBits(viewport.minDepth));
+        hashValue(hash, floatBits(viewport.maxDepth));
+    }
+    if (hasDynamicState(VK_DYNAMIC_STATE_SCISSOR) == false) {
+        hashValue(hash, (uint32_t)scissor.offset.x);
+        hashValue(hash, (uint32_t)scissor.offset.y);
+        hashValue(hash, scissor.extent.width);
+        hashValue(hash, scissor.extent.height);
+    }
+    
+    hashValue(hash, (uint64_t)cullingConfig.cullMode);
+    hashValue(hash, (uint64_t)cullingConfig.frontFace);
+    hashValue(hash, blendConfig.enabled);
+    hashValue(hash, (uint64_t)blendConfig.srcFactor);
+    hashValue(hash, (uint64_t)blendConfig.dstFactor);
+    hashValue(hash, (uint64_t)blendConfig.blendOp);
+    
+    hashValue(hash, pipelineLayout ? (uint64_t)pipelineLayout->getLayout() : 0);
+    if (renderPass) {
+        for (uint32_t value: renderPass->getCompatibilityKey()) {
+            hashValue(hash, value);
+        }
+    }
+    hashValue(hash, subpass);
+    for (VkDynamicState state: dynamicStates) {
+        hashValue(hash, (uint64_t)state);
+    }
+    hashValue(hash, (uint64_t)sampleCount);
+    hashValue(hash, sampleShading ? 1 : 0);
+    hashValue(hash, floatBits(minSampleShading));
+    
+    // Варианты шейдеров по константам специализации - разные пайплайны
+    hashSpecialization(hash, vertexSpecialization);
+    hashSpecialization(hash, fragmentSpecialization);
+    
+    return (size_t)hash;
+}
+
+bool VulkanPipelineDesc::operator==(const VulkanPipelineDesc& other) const{
+    if ((vertexShader != other.vertexShader) || (fragmentShader != other.fragmentShader)) {
+        return false;
+    }
+    if ((depthConfig.depthTestEnabled != other.depthConfig.depthTestEnabled) ||
+        (depthConfig.depthWriteEnabled != other.depthConfig.depthWriteEnabled) ||
+        (depthConfig.depthFunc != other.depthConfig.depthFunc)) {
+        return false;
+    }
+    if ((vertexBindingDescription.binding != other.vertexBindingDescription.binding) ||
+        (vertexBindingDescription.stride != other.vertexBindingDescription.stride) ||
+        (vertexBindingDescription.inputRate != other.vertexBindingDescription.inputRate)) {
+        return false;
+    }
+    if (vertexAttributesDescriptions.size() != other.vertexAttributesDescriptions.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < vertexAttributesDescriptions.size(); i++) {
+        const VkVertexInputAttributeDescription& a = vertexAttributesDescriptions[i];
+        const VkVertexInputAttributeDescription& b = other.vertexAttributesDescriptions[i];
+        if ((a.location != b.location) || (a.binding != b.binding) || (a.format != b.format) || (a.offset != b.offset)) {
+            return false;
+        }
+    }
+    if (primitivesTypes != other.primitivesTypes) {
+        return false;
+    }
+    if (dynamicStates != other.dynamicStates) {
+        return false;
+    }
+    if ((hasDynamicState(VK_DYNAMIC_STATE_VIEWPORT) == false) &&
+        ((viewport.x != other.viewport.x) || (viewport.y != other.viewport.y) ||
+        (viewport.width != other.viewport.width) || (viewport.height != other.viewport.height) ||
+        (viewport.minDepth != other.viewport.minDepth) || (viewport.maxDepth != other.viewport.maxDepth))) {
+        return false;
+    }
+    if ((hasDynamicState(VK_DYNAMIC_STATE_SCISSOR) == false) &&
+        ((scissor.offset.x != other.scissor.offset.x) || (scissor.offset.y != other.scissor.offset.y) ||
+         (scissor.extent.width != other.scissor.extent.width) || (scissor.extent.height != other.scissor.extent.height))) {
+        return false;
+    }
+    if ((cullingConfig.cullMode != other.cullingConfig.cullMode) || (cullingConfig.frontFace != other.cullingConfig.frontFace)) {
+        return false;
+    }
+    if ((blendConfig.enabled != other.blendConfig.enabled) ||
+        (blendConfig.srcFactor != other.blendConfig.srcFactor) ||
+        (blendConfig.dstFactor != other.blendConfig.dstFactor) ||
+        (blendConfig.blendOp != other.blendConfig.blendOp)) {
+        return false;
+    }
+    if (pipelineLayout != other.pipelineLayout) {
+        return false;
+    }
+    // Совместимые проходы взаимозаменяемы
+    if ((renderPass != other.renderPass) && ((renderPass == nullptr) || (renderPass->isCompatible(other.renderPass) == false))) {
+        return false;
+    }
+    if (subpass != other.subpass) {
+        return false;
+    }
+    return (sampleCount == other.sampleCount) &&
+           (sampleShading == other.sampleShading) &&
+           (minSampleShading == other.minSampleShading) &&
+           (vertexSpecialization == other.vertexSpecialization) &&
+           (fragmentSpecialization == other.fragmentSpecialization);
+}
+
+bool VulkanPipelineDesc::hasDynamicState(VkDynamicState state) const{
+    for (VkDynamicState dynamicState: dynamicStates) {
+        if (dynamicState == state) {
+            return true;
+        }
+    }
+    return false;
+}
+
+VulkanPipelinePtr VulkanPipelineDesc::createPipeline(VulkanLogicalDevicePtr device, VulkanPipelineCachePtr pipelineCache) const{
+    return std::make_shared<VulkanPipeline>(device,
+                                            vertexShader, fragmentShader,
+                                            depthConfig,
+                                            vertexBindingDescription,
+                                            vertexAttributesDescriptions,
+                                            primitivesTypes,
+                                            viewport,
+                                            scissor,
+                                            cullingConfig,
+                                            blendConfig,
+                                            pipelineLayout,
+                                            renderPass,
+                                            dynamicStates,
+                                            sampleCount,
+                                            sampleShading,
+                                            minSampleShading,
+                                            pipelineCache,
+                                            vertexSpecialization,
+                                            fragmentSpecialization,
+                                            subpass);
+}
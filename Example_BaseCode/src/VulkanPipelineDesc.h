@@ -0,0 +1,50 @@
+#ifndef VULKAN_PIPELINE_DESC_H
+#define VULKAN_PIPELINE_DESC_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanShaderModule.h"
+#include "VulkanPipelineLayout.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanRenderPass.h"
+#include "VulkanPipeline.h"
+
+
+// Полное описание графического пайплайна, ключ для VulkanPipelineVariantCache.
+// Рендер проход сравнивается по совместимости, а не по хендлу
+struct VulkanPipelineDesc {
+    VulkanShaderModulePtr vertexShader;
+    VulkanShaderModulePtr fragmentShader;
+    VulkanPipelineDepthConfig depthConfig;
+    VkVertexInputBindingDescription vertexBindingDescription;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributesDescriptions;
+    VkPrimitiveTopology primitivesTypes;
+    VkViewport viewport;
+    VkRect2D scissor;
+    VulkanPipelineCullingConfig cullingConfig;
+    VulkanPipelineBlendConfig blendConfig;
+    VulkanPipelineLayoutPtr pipelineLayout;
+    VulkanRenderPassPtr renderPass;
+    uint32_t subpass;
+    std::vector<VkDynamicState> dynamicStates;
+    VkSampleCountFlagBits sampleCount;
+    bool sampleShading;
+    float minSampleShading;
+    VulkanPipelineSpecialization vertexSpecialization;
+    VulkanPipelineSpecialization fragmentSpecialization;
+    
+    VulkanPipelineDesc();
+    size_t getHash() const;
+    bool operator==(const VulkanPipelineDesc& other) const;
+    bool hasDynamicState(VkDynamicState state) const;
+    // Создание пайплайна по описанию, можно вызывать из рабочего потока
+    VulkanPipelinePtr createPipeline(VulkanLogicalDevicePtr device, VulkanPipelineCachePtr pipelineCache = nullptr) const;
+};
+
+#endif
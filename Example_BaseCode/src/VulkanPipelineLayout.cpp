@@ -0,0 +1,53 @@
+#include "VulkanPipelineLayout.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+VulkanPipelineLayout::VulkanPipelineLayout(VulkanLogicalDevicePtr device,
+                                           const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts,
+                                           const std::vector<VkPushConstantRange>& pushConstants):
+    _device(device),
+    _descriptorSetLayouts(descriptorSetLayouts),
+    _pushConstants(pushConstants){
+    
+    // Лаяут пайплайна
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    setLayouts.reserve(_descriptorSetLayouts.size());
+    for(const VulkanDescriptorSetLayoutPtr& layout: _descriptorSetLayouts){
+        setLayouts.push_back(layout->getLayout());
+    }
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    memset(&pipelineLayoutInfo, 0, sizeof(VkPipelineLayoutCreateInfo));
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data(); // Устанавливаем лаяут
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(_pushConstants.size());
+    pipelineLayoutInfo.pPushConstantRanges = (_pushConstants.size() > 0) ? _pushConstants.data() : nullptr; // Пуш константы нужны для того, чтобы передавать данные в отрисовку, как альтернатива юниформам
+    
+    if (vkCreatePipelineLayout(_device->getDevice(), &pipelineLayoutInfo, nullptr, &_layout) != VK_SUCCESS) {
+        LOG("Failed to create pipeline layout!\n");
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+}
+
+VulkanPipelineLayout::~VulkanPipelineLayout(){
+    vkDestroyPipelineLayout(_device->getDevice(), _layout, nullptr);
+}
+
+VkPipelineLayout VulkanPipelineLayout::getLayout() const{
+    return _layout;
+}
+
+VulkanLogicalDevicePtr VulkanPipelineLayout::getBaseDevice() const{
+    return _device;
+}
+
+std::vector<VulkanDescriptorSetLayoutPtr> VulkanPipelineLayout::getBaseDescriptorSetLayouts() const{
+    return _descriptorSetLayouts;
+}
+
+std::vector<VkPushConstantRange> VulkanPipelineLayout::getBasePushConstants() const{
+    return _pushConstants;
+}
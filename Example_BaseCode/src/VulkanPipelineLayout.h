@@ -0,0 +1,37 @@
+#ifndef VULKAN_PIPELINE_LAYOUT_H
+#define VULKAN_PIPELINE_LAYOUT_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanDescriptorSetLayout.h"
+
+
+class VulkanPipelineLayout {
+public:
+    VulkanPipelineLayout(VulkanLogicalDevicePtr device,
+                         const std::vector<VulkanDescriptorSetLayoutPtr>& descriptorSetLayouts,
+                         const std::vector<VkPushConstantRange>& pushConstants = std::vector<VkPushConstantRange>());
+    ~VulkanPipelineLayout();
+    VkPipelineLayout getLayout() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    std::vector<VulkanDescriptorSetLayoutPtr> getBaseDescriptorSetLayouts() const;
+    std::vector<VkPushConstantRange> getBasePushConstants() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    std::vector<VulkanDescriptorSetLayoutPtr> _descriptorSetLayouts;
+    std::vector<VkPushConstantRange> _pushConstants;
+    VkPipelineLayout _layout;
+    
+private:
+};
+
+typedef std::shared_ptr<VulkanPipelineLayout> VulkanPipelineLayoutPtr;
+
+#endif
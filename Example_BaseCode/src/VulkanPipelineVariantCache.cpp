@@ -0,0 +1,162 @@
+#include "VulkanPipelineVariantCache.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include "Helpers.h"
+
+
+VulkanPipelineVariantCache::VulkanPipelineVariantCache(VulkanLogicalDevicePtr device, VulkanPipelineCachePtr pipelineCache, uint32_t maxPipelinesCount):
+    _device(device),
+    _pipelineCache(pipelineCache),
+    _maxPipelinesCount(std::max(maxPipelinesCount, 1u)),
+    _requestsCount(0),
+    _hitsCount(0),
+    _evictedCount(0),
+    _failedCount(0){
+}
+
+VulkanPipelineVariantCache::~VulkanPipelineVariantCache(){
+    clear();
+}
+
+VulkanPipelinePtr VulkanPipelineVariantCache::getPipeline(const VulkanPipelineDesc& desc){
+    _requestsCount++;
+    
+    size_t hash = desc.getHash();
+    VulkanPipelineFuture found;
+    if (find(desc, hash, found)) {
+        _hitsCount++;
+        return found.get();
+    }
+    
+    VulkanPipelinePtr pipeline = desc.createPipeline(_device, _pipelineCache);
+    
+    // Готовый пайплайн храним так же, как и компилируемые в фоне
+    std::promise<VulkanPipelinePtr> promise;
+    promise.set_value(pipeline);
+    insert(desc, hash, promise.get_future().share());
+    
+    return pipeline;
+}
+
+VulkanPipelineFuture VulkanPipelineVariantCache::getPipelineAsync(const VulkanPipelineDesc& desc, VulkanPipelineCompilerPtr compiler){
+    _requestsCount++;
+    
+    size_t hash = desc.getHash();
+    VulkanPipelineFuture found;
+    if (find(desc, hash, found)) {
+        _hitsCount++;
+        return found;
+    }
+    
+    // Собственный кеш пайплайнов важнее кеша компилятора
+    VulkanLogicalDevicePtr device = _device;
+    VulkanPipelineCachePtr ownCache = _pipelineCache;
+    VulkanPipelineFuture future = compiler->compile([desc, device, ownCache](VulkanPipelineCachePtr compilerCache){
+        return desc.createPipeline(device, ownCache ? ownCache : compilerCache);
+    });
+    
+    insert(desc, hash, future);
+    
+    return future;
+}
+
+bool VulkanPipelineVariantCache::find(const VulkanPipelineDesc& desc, size_t hash, VulkanPipelineFuture& result){
+    typedef std::unordered_multimap<size_t, Entry>::iterator Iterator;
+    std::pair<Iterator, Iterator> range = _entries.equal_range(hash);
+    for (Iterator it = range.first; it != range.second; ++it) {
+        if ((it->second.desc == desc) == false) {
+            continue;
+        }
+        
+        // Исключение компиляции не кешируем - следующий запрос попробует собрать пайплайн заново
+        const VulkanPipelineFuture& pipeline = it->second.pipeline;
+        if (pipeline.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            try {
+                pipeline.get();
+            } catch (...) {
+                _failedCount++;
+                _entries.erase(it);
+                return false;
+            }
+        }
+        
+        it->second.lastUsedRequest = _requestsCount;
+        result = it->second.pipeline;
+        return true;
+    }
+    return false;
+}
+
+void VulkanPipelineVariantCache::insert(const VulkanPipelineDesc& desc, size_t hash, const VulkanPipelineFuture& pipeline){
+    while (_entries.size() >= _maxPipelinesCount) {
+        evictLeastRecentlyUsed();
+    }
+    
+    Entry entry;
+    entry.desc = desc;
+    entry.pipeline = pipeline;
+    entry.lastUsedRequest = _requestsCount;
+    _entries.insert(std::make_pair(hash, entry));
+}
+
+// Пайплайн остается жив, пока используется снаружи - удаляется только запись кеша
+void VulkanPipelineVariantCache::evictLeastRecentlyUsed(){
+    typedef std::unordered_multimap<size_t, Entry>::iterator Iterator;
+    Iterator oldest = _entries.begin();
+    for (Iterator it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->second.lastUsedRequest < oldest->second.lastUsedRequest) {
+            oldest = it;
+        }
+    }
+    if (oldest != _entries.end()) {
+        _entries.erase(oldest);
+        _evictedCount++;
+    }
+}
+
+void VulkanPipelineVariantCache::clear(){
+    _entries.clear();
+}
+
+void VulkanPipelineVariantCache::printStats() const{
+    double hitRate = (_requestsCount > 0) ? (double(_hitsCount) / double(_requestsCount)) * 100.0 : 0.0;
+    LOG("Pipeline variant cache: requests %llu, hit rate %.1f%%, pipelines %d (max %d), evicted %llu, failed %llu\n",
+        (unsigned long long)_requestsCount, hitRate, (int)_entries.size(), (int)_maxPipelinesCount,
+        (unsigned long long)_evictedCount, (unsigned long long)_failedCount);
+}
+
+uint64_t VulkanPipelineVariantCache::getRequestsCount() const{
+    return _requestsCount;
+}
+
+uint64_t VulkanPipelineVariantCache::getHitsCount() const{
+    return _hitsCount;
+}
+
+uint64_t VulkanPipelineVariantCache::getEvictedCount() const{
+    return _evictedCount;
+}
+
+uint64_t VulkanPipelineVariantCache::getFailedCount() const{
+    return _failedCount;
+}
+
+size_t VulkanPipelineVariantCache::getPipelinesCount() const{
+    return _entries.size();
+}
+
+uint32_t VulkanPipelineVariantCache::getBaseMaxPipelinesCount() const{
+    return _maxPipelinesCount;
+}
+
+VulkanLogicalDevicePtr VulkanPipelineVariantCache::getBaseDevice() const{
+    return _device;
+}
+
+VulkanPipelineCachePtr VulkanPipelineVariantCache::getBasePipelineCache() const{
+    return _pipelineCache;
+}
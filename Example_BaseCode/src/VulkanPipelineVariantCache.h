@@ -0,0 +1,65 @@
+#ifndef VULKAN_PIPELINE_VARIANT_CACHE_H
+#define VULKAN_PIPELINE_VARIANT_CACHE_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanPipeline.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanPipelineCompiler.h"
+#include "VulkanPipelineDesc.h"
+
+
+// Кеш пайплайнов по полному описанию состояния, один на логическое устройство.
+// Материалы с одинаковым состоянием получают один и тот же пайплайн, компиляция происходит один раз.
+// Сверх maxPipelinesCount удаляются давно не запрашиваемые пайплайны (LRU), неудачная компиляция не кешируется
+class VulkanPipelineVariantCache {
+public:
+    VulkanPipelineVariantCache(VulkanLogicalDevicePtr device, VulkanPipelineCachePtr pipelineCache = nullptr, uint32_t maxPipelinesCount = 256);
+    ~VulkanPipelineVariantCache();
+    // Синхронное получение, при промахе пайплайн создается сразу
+    VulkanPipelinePtr getPipeline(const VulkanPipelineDesc& desc);
+    // При промахе пайплайн компилируется в фоне, повторный запрос вернет ту же future
+    VulkanPipelineFuture getPipelineAsync(const VulkanPipelineDesc& desc, VulkanPipelineCompilerPtr compiler);
+    void clear();
+    void printStats() const;
+    uint64_t getRequestsCount() const;
+    uint64_t getHitsCount() const;
+    uint64_t getEvictedCount() const;
+    uint64_t getFailedCount() const;
+    size_t getPipelinesCount() const;
+    uint32_t getBaseMaxPipelinesCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VulkanPipelineCachePtr getBasePipelineCache() const;
+    
+private:
+    struct Entry {
+        VulkanPipelineDesc desc;
+        VulkanPipelineFuture pipeline;
+        uint64_t lastUsedRequest;
+    };
+    
+    VulkanLogicalDevicePtr _device;
+    VulkanPipelineCachePtr _pipelineCache;
+    uint32_t _maxPipelinesCount;
+    std::unordered_multimap<size_t, Entry> _entries;
+    uint64_t _requestsCount;
+    uint64_t _hitsCount;
+    uint64_t _evictedCount;
+    uint64_t _failedCount;
+    
+private:
+    bool find(const VulkanPipelineDesc& desc, size_t hash, VulkanPipelineFuture& result);
+    void insert(const VulkanPipelineDesc& desc, size_t hash, const VulkanPipelineFuture& pipeline);
+    void evictLeastRecentlyUsed();
+};
+
+typedef std::shared_ptr<VulkanPipelineVariantCache> VulkanPipelineVariantCachePtr;
+
+#endif
@@ -102,6 +102,11 @@ void VulkanQueryPool::resetPool(const VulkanCommandBufferPtr& buffer){
     }
 }
 
+// Сброс части запросов, когда разные диапазоны пула пишутся из разных очередей
+void VulkanQueryPool::resetPool(const VulkanCommandBufferPtr& buffer, uint32_t firstQuery, uint32_t queriesCount){
+    vkCmdResetQueryPool(buffer->getBuffer(), _pool, firstQuery, queriesCount);
+}
+
 void VulkanQueryPool::beginPool(const VulkanCommandBufferPtr& buffer, VkQueryControlFlags flags, uint32_t index){
     _usedResources.insert(buffer);
 
@@ -43,6 +43,7 @@ public:
     ~VulkanQueryPool();
     VkQueryPool getPool() const;
     void resetPool(const std::shared_ptr<VulkanCommandBuffer>& buffer);
+    void resetPool(const std::shared_ptr<VulkanCommandBuffer>& buffer, uint32_t firstQuery, uint32_t queriesCount);
     void beginPool(const std::shared_ptr<VulkanCommandBuffer>& buffer, VkQueryControlFlags flags, uint32_t index = 0);
     void endPool(const std::shared_ptr<VulkanCommandBuffer>& buffer, uint32_t index = 0);
     std::map<VkQueryPipelineStatisticFlags, uint64_t> getPoolStatResults(VkQueryResultFlagBits flags = VK_QUERY_RESULT_WAIT_BIT); // Получение результатов запросов
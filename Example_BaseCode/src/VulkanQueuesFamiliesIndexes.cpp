@@ -8,8 +8,22 @@ VulkanQueuesFamiliesIndexes::VulkanQueuesFamiliesIndexes(){
     presentQueuesFamilyIndex = -1;
     presentQueuesFamilyQueuesCount = 0;
     presentQueuesTimeStampValidBits = 0;
+    transferQueuesFamilyIndex = -1;
+    transferQueuesFamilyQueuesCount = 0;
+    transferQueuesTimeStampValidBits = 0;
+    computeQueuesFamilyIndex = -1;
+    computeQueuesFamilyQueuesCount = 0;
+    computeQueuesTimeStampValidBits = 0;
 }
 
 bool VulkanQueuesFamiliesIndexes::isComplete() const{
     return (renderQueuesFamilyIndex >= 0) && (presentQueuesFamilyIndex >= 0);
 }
+
+bool VulkanQueuesFamiliesIndexes::hasDedicatedTransfer() const{
+    return transferQueuesFamilyIndex >= 0;
+}
+
+bool VulkanQueuesFamiliesIndexes::hasAsyncCompute() const{
+    return computeQueuesFamilyIndex >= 0;
+}
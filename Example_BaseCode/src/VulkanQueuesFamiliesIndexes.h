@@ -11,9 +11,17 @@ struct VulkanQueuesFamiliesIndexes {
     int32_t presentQueuesFamilyIndex;          // Индекс семейства очередей отображения
     uint32_t presentQueuesFamilyQueuesCount;    // Количество очередей в семействе
     uint32_t presentQueuesTimeStampValidBits;   // Сколько бит в таймстемпе валидны
+    int32_t transferQueuesFamilyIndex;         // Выделенное семейство только для копирования (DMA), -1 если нету
+    uint32_t transferQueuesFamilyQueuesCount;   // Количество очередей в семействе
+    uint32_t transferQueuesTimeStampValidBits;  // Сколько бит в таймстемпе валидны
+    int32_t computeQueuesFamilyIndex;          // Семейство вычислений без графики (async compute), -1 если нету
+    uint32_t computeQueuesFamilyQueuesCount;    // Количество очередей в семействе
+    uint32_t computeQueuesTimeStampValidBits;   // Сколько бит в таймстемпе валидны
     
     VulkanQueuesFamiliesIndexes();
     bool isComplete() const; 
+    bool hasDedicatedTransfer() const;
+    bool hasAsyncCompute() const;
 };
 
 #endif
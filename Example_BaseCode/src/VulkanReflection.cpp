@@ -4,6 +4,8 @@
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
+#include <fstream>
+#include <map>
 
 // SPIRV Cross
 #include <spirv.hpp>
@@ -262,3 +264,329 @@ void reflectShaderUsingSPIRVReflect(const std::vector<unsigned char>& data){
     // Destroy the reflection data when no longer required.
     spvReflectDestroyShaderModule(&module);
 }
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define REFLECTION_CACHE_MAGIC 0x46524B56    // VKRF
+#define REFLECTION_CACHE_VERSION 1
+
+VulkanShadersReflectionInfo::VulkanShadersReflectionInfo(){
+    memset(&vertexBinding, 0, sizeof(VkVertexInputBindingDescription));
+    vertexBinding.binding = 0;
+    vertexBinding.stride = 0;
+    vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+}
+
+// FNV-1a хеш байт-кода всех модулей
+static uint64_t hashShadersData(const std::vector<std::vector<unsigned char>>& modulesData){
+    uint64_t hash = FNV1A_INITIAL_HASH;
+    for (const std::vector<unsigned char>& data: modulesData) {
+        hashValue(hash, data.size());
+        hash = hashBytes(data.data(), data.size(), hash);
+    }
+    return hash;
+}
+
+static std::string reflectionCachePath(const std::string& cacheFolder, uint64_t hash){
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.reflection", (unsigned long long)hash);
+    return cacheFolder + "/" + name;
+}
+
+static void writeCacheValue(std::ofstream& file, uint32_t value){
+    file.write((const char*)&value, sizeof(value));
+}
+
+static bool readCacheValue(std::ifstream& file, uint32_t& value){
+    file.read((char*)&value, sizeof(value));
+    return file.good();
+}
+
+static void saveReflectionToCache(const std::string& path, const VulkanShadersReflectionInfo& info){
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG("Failed to write reflection cache file %s\n", path.c_str());
+        return;
+    }
+    
+    writeCacheValue(file, REFLECTION_CACHE_MAGIC);
+    writeCacheValue(file, REFLECTION_CACHE_VERSION);
+    
+    writeCacheValue(file, (uint32_t)info.descriptorSets.size());
+    for (const std::vector<VulkanDescriptorSetConfig>& set: info.descriptorSets) {
+        writeCacheValue(file, (uint32_t)set.size());
+        for (const VulkanDescriptorSetConfig& config: set) {
+            writeCacheValue(file, config.binding);
+            writeCacheValue(file, config.desriptorsCount);
+            writeCacheValue(file, (uint32_t)config.desriptorType);
+            writeCacheValue(file, (uint32_t)config.descriptorStageFlags);
+        }
+    }
+    
+    writeCacheValue(file, (uint32_t)info.pushConstantRanges.size());
+    for (const VkPushConstantRange& range: info.pushConstantRanges) {
+        writeCacheValue(file, (uint32_t)range.stageFlags);
+        writeCacheValue(file, range.offset);
+        writeCacheValue(file, range.size);
+    }
+    
+    writeCacheValue(file, info.vertexBinding.binding);
+    writeCacheValue(file, info.vertexBinding.stride);
+    writeCacheValue(file, (uint32_t)info.vertexBinding.inputRate);
+    
+    writeCacheValue(file, (uint32_t)info.vertexAttributes.size());
+    for (const VkVertexInputAttributeDescription& attribute: info.vertexAttributes) {
+        writeCacheValue(file, attribute.location);
+        writeCacheValue(file, attribute.binding);
+        writeCacheValue(file, (uint32_t)attribute.format);
+        writeCacheValue(file, attribute.offset);
+    }
+}
+
+static bool loadReflectionFromCache(const std::string& path, VulkanShadersReflectionInfo& info){
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    uint32_t magic = 0, version = 0;
+    if (!readCacheValue(file, magic) || !readCacheValue(file, version) ||
+        (magic != REFLECTION_CACHE_MAGIC) || (version != REFLECTION_CACHE_VERSION)) {
+        return false;
+    }
+    
+    uint32_t setsCount = 0;
+    if (!readCacheValue(file, setsCount)) {
+        return false;
+    }
+    info.descriptorSets.resize(setsCount);
+    for (uint32_t i = 0; i < setsCount; i++) {
+        uint32_t bindingsCount = 0;
+        if (!readCacheValue(file, bindingsCount)) {
+            return false;
+        }
+        info.descriptorSets[i].resize(bindingsCount);
+        for (uint32_t j = 0; j < bindingsCount; j++) {
+            VulkanDescriptorSetConfig& config = info.descriptorSets[i][j];
+            uint32_t type = 0, stages = 0;
+            if (!readCacheValue(file, config.binding) || !readCacheValue(file, config.desriptorsCount) ||
+                !readCacheValue(file, type) || !readCacheValue(file, stages)) {
+                return false;
+            }
+            config.desriptorType = (VkDescriptorType)type;
+            config.descriptorStageFlags = (VkShaderStageFlags)stages;
+        }
+    }
+    
+    uint32_t rangesCount = 0;
+    if (!readCacheValue(file, rangesCount)) {
+        return false;
+    }
+    info.pushConstantRanges.resize(rangesCount);
+    for (uint32_t i = 0; i < rangesCount; i++) {
+        VkPushConstantRange& range = info.pushConstantRanges[i];
+        uint32_t stages = 0;
+        if (!readCacheValue(file, stages) || !readCacheValue(file, range.offset) || !readCacheValue(file, range.size)) {
+            return false;
+        }
+        range.stageFlags = (VkShaderStageFlags)stages;
+    }
+    
+    uint32_t inputRate = 0;
+    if (!readCacheValue(file, info.vertexBinding.binding) || !readCacheValue(file, info.vertexBinding.stride) || !readCacheValue(file, inputRate)) {
+        return false;
+    }
+    info.vertexBinding.inputRate = (VkVertexInputRate)inputRate;
+    
+    uint32_t attributesCount = 0;
+    if (!readCacheValue(file, attributesCount)) {
+        return false;
+    }
+    info.vertexAttributes.resize(attributesCount);
+    for (uint32_t i = 0; i < attributesCount; i++) {
+        VkVertexInputAttributeDescription& attribute = info.vertexAttributes[i];
+        uint32_t format = 0;
+        if (!readCacheValue(file, attribute.location) || !readCacheValue(file, attribute.binding) ||
+            !readCacheValue(file, format) || !readCacheValue(file, attribute.offset)) {
+            return false;
+        }
+        attribute.format = (VkFormat)format;
+    }
+    
+    return true;
+}
+
+// Рефлексия модулей с объединением стадий
+static VulkanShadersReflectionInfo reflectShadersUsingSPIRVReflect(const std::vector<std::vector<unsigned char>>& modulesData){
+    VulkanShadersReflectionInfo info;
+    
+    std::map<uint32_t, std::map<uint32_t, VulkanDescriptorSetConfig>> setsMap;  // Набор -> биндинг -> описание
+    std::map<VkShaderStageFlags, VkPushConstantRange> stagesPushRanges;         // Один диапазон на стадию
+    
+    for (const std::vector<unsigned char>& data: modulesData) {
+        SpvReflectShaderModule module;
+        if (spvReflectCreateShaderModule(data.size(), data.data(), &module) != SPV_REFLECT_RESULT_SUCCESS) {
+            LOG("Failed to reflect shader module!\n");
+            throw std::runtime_error("Failed to reflect shader module!");
+        }
+        
+        // Значения стадий и типов SPIRV-Reflect совпадают с Vulkan
+        VkShaderStageFlags stage = (VkShaderStageFlags)module.shader_stage;
+        
+        // Дескрипторы - одинаковые биндинги из разных стадий объединяются
+        uint32_t setsCount = 0;
+        spvReflectEnumerateDescriptorSets(&module, &setsCount, nullptr);
+        std::vector<SpvReflectDescriptorSet*> sets(setsCount);
+        spvReflectEnumerateDescriptorSets(&module, &setsCount, sets.data());
+        for (SpvReflectDescriptorSet* setInfo: sets) {
+            for (uint32_t i = 0; i < setInfo->binding_count; i++) {
+                SpvReflectDescriptorBinding* binding = setInfo->bindings[i];
+                
+                uint32_t count = 1;
+                for (uint32_t d = 0; d < binding->array.dims_count; d++) {
+                    count *= binding->array.dims[d];
+                }
+                
+                std::map<uint32_t, VulkanDescriptorSetConfig>& setBindings = setsMap[setInfo->set];
+                std::map<uint32_t, VulkanDescriptorSetConfig>::iterator found = setBindings.find(binding->binding);
+                if (found == setBindings.end()) {
+                    VulkanDescriptorSetConfig config;
+                    config.binding = binding->binding;
+                    config.desriptorsCount = count;
+                    config.desriptorType = (VkDescriptorType)binding->descriptor_type;
+                    config.descriptorStageFlags = stage;
+                    setBindings[binding->binding] = config;
+                } else {
+                    if (found->second.desriptorType != (VkDescriptorType)binding->descriptor_type) {
+                        spvReflectDestroyShaderModule(&module);
+                        LOG("Descriptor type mismatch between shader stages at set %d binding %d!\n", setInfo->set, binding->binding);
+                        throw std::runtime_error("Descriptor type mismatch between shader stages!");
+                    }
+                    found->second.desriptorsCount = std::max(found->second.desriptorsCount, count);
+                    found->second.descriptorStageFlags |= stage;
+                }
+            }
+        }
+        
+        // Push константы - диапазон стадии охватывает все ее блоки
+        uint32_t pushCount = 0;
+        spvReflectEnumeratePushConstantBlocks(&module, &pushCount, nullptr);
+        std::vector<SpvReflectBlockVariable*> pushConsts(pushCount);
+        spvReflectEnumeratePushConstantBlocks(&module, &pushCount, pushConsts.data());
+        for (SpvReflectBlockVariable* pushConstant: pushConsts) {
+            // Смещение блока - смещение его первого члена
+            uint32_t begin = pushConstant->offset;
+            for (uint32_t j = 0; j < pushConstant->member_count; j++) {
+                begin = (j == 0) ? pushConstant->members[j].offset : std::min(begin, pushConstant->members[j].offset);
+            }
+            uint32_t end = pushConstant->offset + pushConstant->size;
+            
+            std::map<VkShaderStageFlags, VkPushConstantRange>::iterator found = stagesPushRanges.find(stage);
+            if (found == stagesPushRanges.end()) {
+                VkPushConstantRange range = {};
+                memset(&range, 0, sizeof(VkPushConstantRange));
+                range.stageFlags = stage;
+                range.offset = begin;
+                range.size = end - begin;
+                stagesPushRanges[stage] = range;
+            } else {
+                uint32_t rangeEnd = std::max(found->second.offset + found->second.size, end);
+                found->second.offset = std::min(found->second.offset, begin);
+                found->second.size = rangeEnd - found->second.offset;
+            }
+        }
+        
+        // Входные атрибуты вершинного шейдера, подряд по порядку location
+        if (stage == VK_SHADER_STAGE_VERTEX_BIT) {
+            uint32_t variablesCount = 0;
+            spvReflectEnumerateInputVariables(&module, &variablesCount, nullptr);
+            std::vector<SpvReflectInterfaceVariable*> variables(variablesCount);
+            spvReflectEnumerateInputVariables(&module, &variablesCount, variables.data());
+            
+            std::sort(variables.begin(), variables.end(), [](const SpvReflectInterfaceVariable* a, const SpvReflectInterfaceVariable* b){
+                return a->location < b->location;
+            });
+            
+            uint32_t offset = 0;
+            for (SpvReflectInterfaceVariable* variable: variables) {
+                // Встроенные переменные (gl_VertexIndex и тд) не являются атрибутами
+                if (variable->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN) {
+                    continue;
+                }
+                
+                VkVertexInputAttributeDescription attribute = {};
+                memset(&attribute, 0, sizeof(VkVertexInputAttributeDescription));
+                attribute.binding = 0;
+                attribute.location = variable->location;
+                attribute.format = (VkFormat)variable->format;
+                attribute.offset = offset;
+                info.vertexAttributes.push_back(attribute);
+                
+                uint32_t componentsCount = std::max(variable->numeric.vector.component_count, 1u);
+                offset += (variable->numeric.scalar.width / 8) * componentsCount;
+            }
+            info.vertexBinding.stride = offset;
+        }
+        
+        spvReflectDestroyShaderModule(&module);
+    }
+    
+    // Наборы по порядку, пропущенные номера остаются пустыми
+    if (setsMap.empty() == false) {
+        info.descriptorSets.resize(setsMap.rbegin()->first + 1);
+        for (const std::pair<const uint32_t, std::map<uint32_t, VulkanDescriptorSetConfig>>& set: setsMap) {
+            for (const std::pair<const uint32_t, VulkanDescriptorSetConfig>& binding: set.second) {
+                info.descriptorSets[set.first].push_back(binding.second);
+            }
+        }
+    }
+    
+    // Одинаковые диапазоны разных стадий объединяем в один
+    for (const std::pair<const VkShaderStageFlags, VkPushConstantRange>& stageRange: stagesPushRanges) {
+        bool merged = false;
+        for (VkPushConstantRange& range: info.pushConstantRanges) {
+            if ((range.offset == stageRange.second.offset) && (range.size == stageRange.second.size)) {
+                range.stageFlags |= stageRange.second.stageFlags;
+                merged = true;
+                break;
+            }
+        }
+        if (merged == false) {
+            info.pushConstantRanges.push_back(stageRange.second);
+        }
+    }
+    
+    return info;
+}
+
+VulkanShadersReflectionInfo reflectShaders(const std::vector<std::vector<unsigned char>>& modulesData, const std::string& cacheFolder, bool* loadedFromCache){
+    if (loadedFromCache) {
+        *loadedFromCache = false;
+    }
+    
+    // Пробуем прочитать ранее сохраненный результат
+    std::string cachePath;
+    if (cacheFolder.empty() == false) {
+        cachePath = reflectionCachePath(cacheFolder, hashShadersData(modulesData));
+        
+        VulkanShadersReflectionInfo cachedInfo;
+        if (loadReflectionFromCache(cachePath, cachedInfo)) {
+            if (loadedFromCache) {
+                *loadedFromCache = true;
+            }
+            return cachedInfo;
+        }
+    }
+    
+    VulkanShadersReflectionInfo info = reflectShadersUsingSPIRVReflect(modulesData);
+    
+    if (cachePath.empty() == false) {
+        if (createDirectory(cacheFolder)) {
+            saveReflectionToCache(cachePath, info);
+        }else{
+            LOG("Failed to create reflection cache folder %s\n", cacheFolder.c_str());
+        }
+    }
+    
+    return info;
+}
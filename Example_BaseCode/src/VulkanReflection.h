@@ -2,14 +2,33 @@
 #define VULKAN_REFLECTION_H
 
 #include <vector>
+#include <string>
 
 // GLFW include
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "VulkanDescriptorSetLayout.h"
+
+
+// Описание ресурсов набора шейдеров, полученное рефлексией
+struct VulkanShadersReflectionInfo {
+    std::vector<std::vector<VulkanDescriptorSetConfig>> descriptorSets;  // Индекс - номер набора в шейдере
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    VkVertexInputBindingDescription vertexBinding;  // Все атрибуты вершины подряд в 0м буффере
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    
+    VulkanShadersReflectionInfo();
+};
+
 // Запускаем рефлексию шейдера
 void reflectShaderUsingSPIRVCross(const std::vector<unsigned char>& data);
 
 void reflectShaderUsingSPIRVReflect(const std::vector<unsigned char>& data);
 
+// Рефлексия модулей с объединением стадий (вершинный + фрагментный и тд).
+// Если указана папка кеша - результат сохраняется в ней по хешу SPIR-V и при следующих запусках читается с диска,
+// папка создается при необходимости. В loadedFromCache пишется, был ли результат взят из кеша
+VulkanShadersReflectionInfo reflectShaders(const std::vector<std::vector<unsigned char>>& modulesData, const std::string& cacheFolder = std::string(), bool* loadedFromCache = nullptr);
+
 #endif
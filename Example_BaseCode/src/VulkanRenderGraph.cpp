@@ -0,0 +1,666 @@
+#include "VulkanRenderGraph.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <set>
+#include <algorithm>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+VulkanRenderGraphUsageInfo::VulkanRenderGraphUsageInfo():
+    stages(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+    readAccess(0),
+    writeAccess(0),
+    layout(VK_IMAGE_LAYOUT_UNDEFINED){
+}
+
+VulkanRenderGraphUsageInfo VulkanRenderGraphUsageInfo::fromUsage(VulkanRenderGraphUsage usage){
+    VulkanRenderGraphUsageInfo info;
+    switch (usage) {
+        case VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT:
+            info.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            info.readAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+            info.writeAccess = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            info.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            break;
+        case VULKAN_RENDER_GRAPH_DEPTH_ATTACHMENT:
+            // Тест глубины читает буффер и при записи
+            info.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            info.readAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+            info.writeAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            info.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            break;
+        case VULKAN_RENDER_GRAPH_SAMPLED_FRAGMENT:
+            info.stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            info.readAccess = VK_ACCESS_SHADER_READ_BIT;
+            info.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            break;
+        case VULKAN_RENDER_GRAPH_SAMPLED_COMPUTE:
+            info.stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            info.readAccess = VK_ACCESS_SHADER_READ_BIT;
+            info.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            break;
+        case VULKAN_RENDER_GRAPH_STORAGE_COMPUTE:
+            info.stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            info.readAccess = VK_ACCESS_SHADER_READ_BIT;
+            info.writeAccess = VK_ACCESS_SHADER_WRITE_BIT;
+            info.layout = VK_IMAGE_LAYOUT_GENERAL;
+            break;
+        case VULKAN_RENDER_GRAPH_TRANSFER_SRC:
+            info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            info.readAccess = VK_ACCESS_TRANSFER_READ_BIT;
+            info.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            break;
+        case VULKAN_RENDER_GRAPH_TRANSFER_DST:
+            info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            info.writeAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+            info.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            break;
+        default:
+            LOG("Invalid render graph usage!\n");
+            throw std::runtime_error("Invalid render graph usage!");
+            break;
+    }
+    return info;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderGraphImageState::VulkanRenderGraphImageState():
+    layout(VK_IMAGE_LAYOUT_UNDEFINED),
+    writeStages(0),
+    writeAccess(0),
+    readStages(0),
+    visibleStages(0),
+    visibleAccess(0){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderGraphImageDesc::VulkanRenderGraphImageDesc():
+    size(VkExtent2D{0, 0}),
+    format(VK_FORMAT_UNDEFINED),
+    usage(0),
+    aspectFlags(VK_IMAGE_ASPECT_COLOR_BIT){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderGraphPass::VulkanRenderGraphPass(const std::string& name):
+    _name(name),
+    _sideEffects(false){
+}
+
+VulkanRenderGraphPass::~VulkanRenderGraphPass(){
+}
+
+void VulkanRenderGraphPass::read(const std::string& resource, VulkanRenderGraphUsage usage){
+    addAccess(resource, usage, true, false);
+}
+
+void VulkanRenderGraphPass::write(const std::string& resource, VulkanRenderGraphUsage usage){
+    addAccess(resource, usage, false, true);
+}
+
+// Чтение и запись одного ресурса объединяются, лаяут в пределах прохода должен быть один
+void VulkanRenderGraphPass::addAccess(const std::string& resource, VulkanRenderGraphUsage usage, bool read, bool write){
+    for (size_t i = 0; i < _accesses.size(); i++) {
+        Access& access = _accesses[i];
+        if (access.resource != resource) {
+            continue;
+        }
+        
+        VulkanRenderGraphUsageInfo oldInfo = VulkanRenderGraphUsageInfo::fromUsage(access.usage);
+        VulkanRenderGraphUsageInfo newInfo = VulkanRenderGraphUsageInfo::fromUsage(usage);
+        if (oldInfo.layout != newInfo.layout) {
+            LOG("Render graph pass %s uses resource %s in different layouts!\n", _name.c_str(), resource.c_str());
+            throw std::runtime_error("Render graph pass uses resource in different layouts!");
+        }
+        access.read = access.read || read;
+        access.write = access.write || write;
+        return;
+    }
+    
+    Access access;
+    access.resource = resource;
+    access.resourceIndex = 0;
+    access.usage = usage;
+    access.read = read;
+    access.write = write;
+    _accesses.push_back(access);
+}
+
+void VulkanRenderGraphPass::setExecute(const VulkanRenderGraphExecuteFunction& function){
+    _execute = function;
+}
+
+void VulkanRenderGraphPass::setSideEffects(bool sideEffects){
+    _sideEffects = sideEffects;
+}
+
+std::string VulkanRenderGraphPass::getName() const{
+    return _name;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderGraph::VulkanRenderGraph():
+    _compiled(false),
+    _framesCount(0),
+    _lastFrameBarriersCount(0),
+    _lastFrameImageBarriersCount(0),
+    _lastFrameTransitionsCount(0),
+    _separateMemorySize(0){
+}
+
+VulkanRenderGraph::~VulkanRenderGraph(){
+    _activePasses.clear();
+    _passes.clear();
+    _resources.clear();
+    _memoryBlocks.clear();
+}
+
+uint32_t VulkanRenderGraph::getResourceIndex(const std::string& name){
+    std::map<std::string, uint32_t>::iterator found = _resourcesIndexes.find(name);
+    if (found != _resourcesIndexes.end()) {
+        return found->second;
+    }
+    
+    Resource resource;
+    resource.name = name;
+    resource.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    resource.output = false;
+    resource.hasFinalLayout = false;
+    resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resource.finalStages = 0;
+    resource.finalAccess = 0;
+    resource.owned = false;
+    resource.memoryBlock = -1;
+    _resources.push_back(resource);
+    
+    uint32_t index = static_cast<uint32_t>(_resources.size() - 1);
+    _resourcesIndexes[name] = index;
+    return index;
+}
+
+void VulkanRenderGraph::setImage(const std::string& name, VulkanImagePtr image, VkImageAspectFlags aspectFlags){
+    Resource& resource = _resources[getResourceIndex(name)];
+    
+    // Новая картинка - прошлое состояние к ней не относится
+    if (resource.image != image) {
+        resource.state = VulkanRenderGraphImageState();
+    }
+    resource.image = image;
+    resource.aspectFlags = aspectFlags;
+}
+
+void VulkanRenderGraph::addImage(const std::string& name, const VulkanRenderGraphImageDesc& desc){
+    Resource& resource = _resources[getResourceIndex(name)];
+    resource.owned = true;
+    resource.desc = desc;
+    resource.aspectFlags = desc.aspectFlags;
+}
+
+// Время жизни картинки - от первого до последнего использующего ее прохода.
+// Картинка может делить память с другими, если в кадре сначала пишется целиком и не нужна после кадра.
+// Если при этом используется одним проходом только как аттачмент - содержимое может жить только в памяти тайла
+void VulkanRenderGraph::allocate(VulkanLogicalDevicePtr device){
+    if (_compiled == false) {
+        compile();
+    }
+    
+    // Старые картинки и память
+    for (Resource& resource: _resources) {
+        if (resource.owned) {
+            resource.image = nullptr;
+            resource.state = VulkanRenderGraphImageState();
+            resource.memoryBlock = -1;
+        }
+    }
+    _memoryBlocks.clear();
+    _separateMemorySize = 0;
+    
+    std::vector<int32_t> firstPass(_resources.size(), -1);
+    std::vector<int32_t> lastPass(_resources.size(), -1);
+    std::vector<bool> firstWriteOnly(_resources.size(), false);
+    for (size_t i = 0; i < _activePasses.size(); i++) {
+        for (const VulkanRenderGraphPass::Access& access: _activePasses[i]->_accesses) {
+            if (firstPass[access.resourceIndex] < 0) {
+                firstPass[access.resourceIndex] = static_cast<int32_t>(i);
+                firstWriteOnly[access.resourceIndex] = access.write && (access.read == false);
+            }
+            lastPass[access.resourceIndex] = static_cast<int32_t>(i);
+        }
+    }
+    
+    VkPhysicalDevice physicalDevice = device->getBasePhysicalDevice()->getDevice();
+    
+    struct Candidate {
+        uint32_t resourceIndex;
+        VkMemoryRequirements requirements;
+        bool aliasable;
+        int32_t lazyMemoryType;
+    };
+    std::vector<Candidate> candidates;
+    
+    const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    for (size_t i = 0; i < _resources.size(); i++) {
+        Resource& resource = _resources[i];
+        if (resource.owned == false) {
+            continue;
+        }
+        
+        bool aliasable = (firstPass[i] >= 0) && firstWriteOnly[i] && (resource.output == false) && (resource.hasFinalLayout == false);
+        bool transient = aliasable && (firstPass[i] == lastPass[i]) && ((resource.desc.usage & ~attachmentUsage) == 0);
+        
+        VkImageUsageFlags usage = resource.desc.usage;
+        if (transient) {
+            usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+        resource.image = std::make_shared<VulkanImage>(device,
+                                                       resource.desc.size,
+                                                       resource.desc.format,
+                                                       VK_IMAGE_TILING_OPTIMAL,
+                                                       VK_IMAGE_LAYOUT_UNDEFINED,
+                                                       usage,
+                                                       0);      // Память привязываем сами
+        
+        Candidate candidate;
+        candidate.resourceIndex = static_cast<uint32_t>(i);
+        candidate.requirements = resource.image->getMemoryRequirements();
+        candidate.aliasable = aliasable;
+        candidate.lazyMemoryType = -1;
+        if (transient) {
+            candidate.lazyMemoryType = findLazyMemoryType(physicalDevice, candidate.requirements.memoryTypeBits);
+        }
+        candidates.push_back(candidate);
+        
+        _separateMemorySize += candidate.requirements.size;
+    }
+    
+    // Большие картинки раскладываем первыми
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b){
+        return a.requirements.size > b.requirements.size;
+    });
+    
+    for (const Candidate& candidate: candidates) {
+        bool lazy = (candidate.lazyMemoryType >= 0);
+        uint32_t memoryType = lazy ? static_cast<uint32_t>(candidate.lazyMemoryType) :
+                                     findMemoryType(physicalDevice, candidate.requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        
+        // Ищем блок, картинки которого не живут одновременно с нашей
+        int32_t blockIndex = -1;
+        if (candidate.aliasable && (lazy == false)) {
+            for (size_t i = 0; (i < _memoryBlocks.size()) && (blockIndex < 0); i++) {
+                const MemoryBlock& block = _memoryBlocks[i];
+                if ((block.aliasable == false) || (block.memoryTypeIndex != memoryType)) {
+                    continue;
+                }
+                bool overlap = false;
+                for (uint32_t other: block.resources) {
+                    if ((lastPass[candidate.resourceIndex] >= firstPass[other]) && (lastPass[other] >= firstPass[candidate.resourceIndex])) {
+                        overlap = true;
+                    }
+                }
+                if (overlap == false) {
+                    blockIndex = static_cast<int32_t>(i);
+                }
+            }
+        }
+        
+        if (blockIndex < 0) {
+            MemoryBlock block;
+            block.size = 0;
+            block.memoryTypeIndex = memoryType;
+            block.lazy = lazy;
+            block.aliasable = candidate.aliasable && (lazy == false);
+            block.lastResource = -1;
+            _memoryBlocks.push_back(block);
+            blockIndex = static_cast<int32_t>(_memoryBlocks.size() - 1);
+        }
+        
+        // Все картинки блока лежат с нулевого смещения
+        MemoryBlock& block = _memoryBlocks[blockIndex];
+        block.size = std::max(block.size, candidate.requirements.size);
+        block.resources.push_back(candidate.resourceIndex);
+        _resources[candidate.resourceIndex].memoryBlock = blockIndex;
+    }
+    
+    for (MemoryBlock& block: _memoryBlocks) {
+        block.memory = std::make_shared<VulkanDeviceMemory>(device, block.size, block.memoryTypeIndex);
+        VkDeviceSize usedPassBytes = 0;
+        VkDeviceSize usedPasses = 0;
+        for (uint32_t resourceIndex: block.resources) {
+            _resources[resourceIndex].image->bindMemory(block.memory, 0);
+            
+            VkDeviceSize passes = static_cast<VkDeviceSize>(std::max(lastPass[resourceIndex] - firstPass[resourceIndex] + 1, 1));
+            usedPassBytes += _resources[resourceIndex].image->getMemoryRequirements().size * passes;
+            usedPasses += passes;
+        }
+        
+        // В блоке с алиасингом меньшая картинка на время своих проходов оставляет остаток блока пустым,
+        // занятый объем - средний по проходам, в которых блок занят
+        if ((block.resources.size() > 1) && (usedPasses > 0)) {
+            block.memory->setUsedSize(usedPassBytes / usedPasses);
+        }
+    }
+}
+
+VulkanImagePtr VulkanRenderGraph::getImage(const std::string& name) const{
+    std::map<std::string, uint32_t>::const_iterator found = _resourcesIndexes.find(name);
+    if ((found == _resourcesIndexes.end()) || (_resources[found->second].image == nullptr)) {
+        LOG("Render graph resource %s has no image!\n", name.c_str());
+        throw std::runtime_error("Render graph resource has no image!");
+    }
+    return _resources[found->second].image;
+}
+
+void VulkanRenderGraph::setImageState(const std::string& name, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access){
+    Resource& resource = _resources[getResourceIndex(name)];
+    resource.state = VulkanRenderGraphImageState();
+    resource.state.layout = layout;
+    resource.state.writeStages = stages;
+    resource.state.writeAccess = access;
+}
+
+void VulkanRenderGraph::setFinalLayout(const std::string& name, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access){
+    Resource& resource = _resources[getResourceIndex(name)];
+    resource.hasFinalLayout = true;
+    resource.finalLayout = layout;
+    resource.finalStages = stages;
+    resource.finalAccess = access;
+}
+
+void VulkanRenderGraph::markOutput(const std::string& name){
+    _resources[getResourceIndex(name)].output = true;
+    _compiled = false;
+}
+
+VulkanRenderGraphPassPtr VulkanRenderGraph::addPass(const std::string& name){
+    VulkanRenderGraphPassPtr pass = std::make_shared<VulkanRenderGraphPass>(name);
+    _passes.push_back(pass);
+    _compiled = false;
+    return pass;
+}
+
+// Идем от последнего прохода к первому: проход нужен, если пишет в нужный дальше ресурс.
+// Полная перезапись ресурса делает ненужными его предыдущие записи, чтения делают ресурс нужным
+void VulkanRenderGraph::compile(){
+    std::set<uint32_t> neededResources;
+    for (size_t i = 0; i < _passes.size(); i++) {
+        std::vector<VulkanRenderGraphPass::Access>& accesses = _passes[i]->_accesses;
+        for (size_t j = 0; j < accesses.size(); j++) {
+            accesses[j].resourceIndex = getResourceIndex(accesses[j].resource);
+        }
+    }
+    for (size_t i = 0; i < _resources.size(); i++) {
+        if (_resources[i].output) {
+            neededResources.insert(static_cast<uint32_t>(i));
+        }
+    }
+    
+    std::vector<bool> alivePasses(_passes.size(), false);
+    for (size_t i = _passes.size(); i > 0; i--) {
+        const VulkanRenderGraphPassPtr& pass = _passes[i-1];
+        
+        bool alive = pass->_sideEffects;
+        for (const VulkanRenderGraphPass::Access& access: pass->_accesses) {
+            if (access.write && (neededResources.count(access.resourceIndex) > 0)) {
+                alive = true;
+            }
+        }
+        if (alive == false) {
+            continue;
+        }
+        alivePasses[i-1] = true;
+        
+        for (const VulkanRenderGraphPass::Access& access: pass->_accesses) {
+            if (access.write && (access.read == false)) {
+                neededResources.erase(access.resourceIndex);
+            }
+        }
+        for (const VulkanRenderGraphPass::Access& access: pass->_accesses) {
+            if (access.read) {
+                neededResources.insert(access.resourceIndex);
+            }
+        }
+    }
+    
+    _activePasses.clear();
+    for (size_t i = 0; i < _passes.size(); i++) {
+        if (alivePasses[i]) {
+            _activePasses.push_back(_passes[i]);
+        }
+    }
+    _compiled = true;
+}
+
+void VulkanRenderGraph::flushBarriers(const VulkanCommandBufferPtr& buffer, std::vector<VulkanImageBarrierInfo>& barriers,
+                                      VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages){
+    if (barriers.empty()) {
+        return;
+    }
+    
+    if (srcStages == 0) {
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+    if (dstStages == 0) {
+        dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    }
+    buffer->cmdPipelineBarrier(srcStages, dstStages,
+                               barriers.data(), static_cast<uint32_t>(barriers.size()),
+                               nullptr, 0,
+                               nullptr, 0);
+    
+    _lastFrameBarriersCount++;
+    _lastFrameImageBarriersCount += static_cast<uint32_t>(barriers.size());
+    barriers.clear();
+}
+
+// Барьеры всех ресурсов прохода собираются в один vkCmdPipelineBarrier.
+// Барьер нужен при смене лаяута, при записи после чтений или записи и при первом чтении после записи.
+// Чтение после чтения в том же лаяуте барьера не требует
+void VulkanRenderGraph::execute(const VulkanCommandBufferPtr& buffer){
+    if (_compiled == false) {
+        compile();
+    }
+    
+    _lastFrameBarriersCount = 0;
+    _lastFrameImageBarriersCount = 0;
+    _lastFrameTransitionsCount = 0;
+    
+    std::vector<VulkanImageBarrierInfo> barriers;
+    for (const VulkanRenderGraphPassPtr& pass: _activePasses) {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        
+        for (const VulkanRenderGraphPass::Access& access: pass->_accesses) {
+            Resource& resource = _resources[access.resourceIndex];
+            if (resource.image == nullptr) {
+                LOG("Render graph resource %s has no image!\n", resource.name.c_str());
+                throw std::runtime_error("Render graph resource has no image!");
+            }
+            
+            VulkanRenderGraphUsageInfo info = VulkanRenderGraphUsageInfo::fromUsage(access.usage);
+            VulkanRenderGraphImageState& state = resource.state;
+            VkAccessFlags dstAccess = (access.read ? info.readAccess : 0) | (access.write ? info.writeAccess : 0);
+            bool layoutChanged = (state.layout != info.layout);
+            
+            // Память до этого использовала другая картинка: ждем ее и отбрасываем содержимое
+            bool aliasSwitch = false;
+            VkPipelineStageFlags aliasStages = 0;
+            VkAccessFlags aliasAccess = 0;
+            if (resource.memoryBlock >= 0) {
+                MemoryBlock& block = _memoryBlocks[resource.memoryBlock];
+                int32_t resourceIndex = static_cast<int32_t>(access.resourceIndex);
+                if (block.lastResource != resourceIndex) {
+                    if (block.lastResource >= 0) {
+                        const VulkanRenderGraphImageState& aliasState = _resources[block.lastResource].state;
+                        aliasSwitch = true;
+                        aliasStages = aliasState.writeStages | aliasState.readStages;
+                        aliasAccess = aliasState.writeAccess;
+                    }
+                    block.lastResource = resourceIndex;
+                }
+            }
+            
+            bool needBarrier = false;
+            VkPipelineStageFlags barrierSrcStages = 0;
+            VkAccessFlags barrierSrcAccess = 0;
+            if (layoutChanged || access.write) {
+                // Переход лаяута и запись ждут все предыдущие чтения и записи
+                barrierSrcStages = state.writeStages | state.readStages;
+                barrierSrcAccess = state.writeAccess;
+                needBarrier = layoutChanged || (barrierSrcStages != 0);
+            }else if (state.writeAccess != 0) {
+                // Чтение: последняя запись должна стать видимой для наших стадий
+                bool visible = ((state.visibleStages & info.stages) == info.stages) && ((state.visibleAccess & dstAccess) == dstAccess);
+                if (visible == false) {
+                    barrierSrcStages = state.writeStages;
+                    barrierSrcAccess = state.writeAccess;
+                    needBarrier = true;
+                }
+            }
+            if (aliasSwitch) {
+                barrierSrcStages |= aliasStages;
+                barrierSrcAccess |= aliasAccess;
+                needBarrier = true;
+            }
+            
+            if (needBarrier) {
+                VulkanImageBarrierInfo barrierInfo;
+                barrierInfo.image = resource.image;
+                // Если старое содержимое не читаем - его можно не сохранять
+                barrierInfo.oldLayout = (aliasSwitch || (layoutChanged && (access.read == false))) ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+                barrierInfo.newLayout = info.layout;
+                barrierInfo.startMipmapLevel = 0;
+                barrierInfo.levelsCount = resource.image->getBaseMipmapsCount();
+                barrierInfo.aspectFlags = resource.aspectFlags;
+                barrierInfo.srcAccessBarrier = barrierSrcAccess;
+                barrierInfo.dstAccessBarrier = dstAccess;
+                barriers.push_back(barrierInfo);
+                
+                srcStages |= barrierSrcStages;
+                dstStages |= info.stages;
+                if (layoutChanged || aliasSwitch) {
+                    _lastFrameTransitionsCount++;
+                }
+            }
+            
+            // Обновляем состояние
+            state.layout = info.layout;
+            if (access.write) {
+                state.writeStages = info.stages;
+                state.writeAccess = info.writeAccess;
+                state.readStages = 0;
+                state.visibleStages = 0;
+                state.visibleAccess = 0;
+            }else{
+                state.readStages |= info.stages;
+                if (needBarrier) {
+                    state.visibleStages |= info.stages;
+                    state.visibleAccess |= dstAccess;
+                }
+            }
+        }
+        
+        flushBarriers(buffer, barriers, srcStages, dstStages);
+        
+        if (pass->_execute) {
+            pass->_execute(buffer);
+        }
+    }
+    
+    // Финальные переходы, например в PRESENT_SRC для свопчейна
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    for (Resource& resource: _resources) {
+        if ((resource.hasFinalLayout == false) || (resource.image == nullptr) || (resource.state.layout == resource.finalLayout)) {
+            continue;
+        }
+        
+        VulkanImageBarrierInfo barrierInfo;
+        barrierInfo.image = resource.image;
+        barrierInfo.oldLayout = resource.state.layout;
+        barrierInfo.newLayout = resource.finalLayout;
+        barrierInfo.startMipmapLevel = 0;
+        barrierInfo.levelsCount = resource.image->getBaseMipmapsCount();
+        barrierInfo.aspectFlags = resource.aspectFlags;
+        barrierInfo.srcAccessBarrier = resource.state.writeAccess;
+        barrierInfo.dstAccessBarrier = resource.finalAccess;
+        barriers.push_back(barrierInfo);
+        
+        srcStages |= resource.state.writeStages | resource.state.readStages;
+        dstStages |= resource.finalStages;
+        _lastFrameTransitionsCount++;
+        
+        resource.state = VulkanRenderGraphImageState();
+        resource.state.layout = resource.finalLayout;
+        resource.state.writeStages = resource.finalStages;
+    }
+    flushBarriers(buffer, barriers, srcStages, dstStages);
+    
+    _framesCount++;
+}
+
+void VulkanRenderGraph::printStats() const{
+    LOG("Render graph: passes %d active / %d culled, per frame %d barrier calls, %d image barriers, %d layout transitions\n",
+        (int)getActivePassesCount(), (int)getCulledPassesCount(),
+        (int)_lastFrameBarriersCount, (int)_lastFrameImageBarriersCount, (int)_lastFrameTransitionsCount);
+    for (const VulkanRenderGraphPassPtr& pass: _passes) {
+        bool active = false;
+        for (const VulkanRenderGraphPassPtr& activePass: _activePasses) {
+            active = active || (activePass == pass);
+        }
+        LOG("-> pass %s%s\n", pass->getName().c_str(), active ? "" : " (culled)");
+    }
+    
+    if (_memoryBlocks.empty() == false) {
+        VkDeviceSize lazySize = 0;
+        VkDeviceSize lazyCommitted = 0;
+        VkDeviceSize unusedSize = 0;
+        for (const MemoryBlock& block: _memoryBlocks) {
+            if (block.lazy) {
+                lazySize += block.size;
+                lazyCommitted += block.memory->getCommitment();
+            }
+            unusedSize += block.size - block.memory->getBaseUsedSize();
+        }
+        const double mb = 1024.0 * 1024.0;
+        LOG("Render graph memory: %.1fMB without aliasing, %.1fMB in %d blocks (%.1fMB lazily allocated, %.1fMB committed, %.1fMB unused on average)\n",
+            _separateMemorySize / mb, getAllocatedMemorySize() / mb, (int)_memoryBlocks.size(), lazySize / mb, lazyCommitted / mb, unusedSize / mb);
+        for (const Resource& resource: _resources) {
+            if (resource.memoryBlock >= 0) {
+                const MemoryBlock& block = _memoryBlocks[resource.memoryBlock];
+                LOG("-> image %s: block %d%s, %.1fMB\n", resource.name.c_str(), resource.memoryBlock,
+                    block.lazy ? " (transient)" : "", resource.image->getMemoryRequirements().size / mb);
+            }
+        }
+    }
+}
+
+uint32_t VulkanRenderGraph::getActivePassesCount() const{
+    return static_cast<uint32_t>(_activePasses.size());
+}
+
+uint32_t VulkanRenderGraph::getCulledPassesCount() const{
+    return static_cast<uint32_t>(_passes.size() - _activePasses.size());
+}
+
+uint32_t VulkanRenderGraph::getLastFrameBarriersCount() const{
+    return _lastFrameBarriersCount;
+}
+
+VkDeviceSize VulkanRenderGraph::getSeparateMemorySize() const{
+    return _separateMemorySize;
+}
+
+// Выделенная память без учета ленивого выделения
+VkDeviceSize VulkanRenderGraph::getAllocatedMemorySize() const{
+    VkDeviceSize size = 0;
+    for (const MemoryBlock& block: _memoryBlocks) {
+        size += block.size;
+    }
+    return size;
+}
@@ -0,0 +1,180 @@
+#ifndef VULKAN_RENDER_GRAPH_H
+#define VULKAN_RENDER_GRAPH_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanImage.h"
+#include "VulkanDeviceMemory.h"
+#include "VulkanCommandBuffer.h"
+
+
+// Способ использования картинки проходом, из него выводятся стадии, доступ и лаяут
+enum VulkanRenderGraphUsage {
+    VULKAN_RENDER_GRAPH_COLOR_ATTACHMENT,
+    VULKAN_RENDER_GRAPH_DEPTH_ATTACHMENT,
+    VULKAN_RENDER_GRAPH_SAMPLED_FRAGMENT,
+    VULKAN_RENDER_GRAPH_SAMPLED_COMPUTE,
+    VULKAN_RENDER_GRAPH_STORAGE_COMPUTE,
+    VULKAN_RENDER_GRAPH_TRANSFER_SRC,
+    VULKAN_RENDER_GRAPH_TRANSFER_DST
+};
+
+struct VulkanRenderGraphUsageInfo {
+    VkPipelineStageFlags stages;
+    VkAccessFlags readAccess;
+    VkAccessFlags writeAccess;
+    VkImageLayout layout;
+    
+    VulkanRenderGraphUsageInfo();
+    static VulkanRenderGraphUsageInfo fromUsage(VulkanRenderGraphUsage usage);
+};
+
+// Отслеживаемое состояние картинки между проходами и кадрами
+struct VulkanRenderGraphImageState {
+    VkImageLayout layout;
+    VkPipelineStageFlags writeStages;   // Стадии последней записи
+    VkAccessFlags writeAccess;          // Доступ последней записи
+    VkPipelineStageFlags readStages;    // Стадии чтений после последней записи
+    VkPipelineStageFlags visibleStages; // Стадии, которым запись уже видна
+    VkAccessFlags visibleAccess;        // Доступы, которым запись уже видна
+    
+    VulkanRenderGraphImageState();
+};
+
+// Описание картинки, которую создает сам граф
+struct VulkanRenderGraphImageDesc {
+    VkExtent2D size;
+    VkFormat format;
+    VkImageUsageFlags usage;
+    VkImageAspectFlags aspectFlags;
+    
+    VulkanRenderGraphImageDesc();
+};
+
+typedef std::function<void(const VulkanCommandBufferPtr&)> VulkanRenderGraphExecuteFunction;
+
+// Проход графа: объявляет чтения/записи именованных ресурсов и записывает свои команды
+class VulkanRenderGraphPass {
+    friend class VulkanRenderGraph;
+public:
+    VulkanRenderGraphPass(const std::string& name);
+    ~VulkanRenderGraphPass();
+    void read(const std::string& resource, VulkanRenderGraphUsage usage);
+    void write(const std::string& resource, VulkanRenderGraphUsage usage);
+    void setExecute(const VulkanRenderGraphExecuteFunction& function);
+    // Проход не отбрасывается, даже если его результаты никто не читает
+    void setSideEffects(bool sideEffects);
+    std::string getName() const;
+    
+private:
+    struct Access {
+        std::string resource;
+        uint32_t resourceIndex;
+        VulkanRenderGraphUsage usage;
+        bool read;
+        bool write;
+    };
+    
+    std::string _name;
+    std::vector<Access> _accesses;
+    VulkanRenderGraphExecuteFunction _execute;
+    bool _sideEffects;
+    
+private:
+    void addAccess(const std::string& resource, VulkanRenderGraphUsage usage, bool read, bool write);
+};
+
+typedef std::shared_ptr<VulkanRenderGraphPass> VulkanRenderGraphPassPtr;
+
+
+// Граф кадра для одной очереди. Проходы выполняются в порядке добавления в один коммандный буффер,
+// барьеры и переходы лаяутов выводятся из объявленных доступов, проходы без вклада в выходные ресурсы отбрасываются.
+// Внутри рендер проходов графа лаяуты не меняются: initLayout == finalLayout == лаяут аттачмента.
+// Картинки графа (addImage) с непересекающимся временем жизни в кадре делят одну память,
+// аттачменты одного прохода создаются с VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT в lazily allocated памяти
+class VulkanRenderGraph {
+public:
+    VulkanRenderGraph();
+    ~VulkanRenderGraph();
+    // Картинка ресурса, картинку свопчейна обновляем каждый кадр
+    void setImage(const std::string& name, VulkanImagePtr image, VkImageAspectFlags aspectFlags);
+    // Картинка создается графом в allocate(), содержимое между кадрами не сохраняется
+    void addImage(const std::string& name, const VulkanRenderGraphImageDesc& desc);
+    // Создание картинок графа после compile(), устройство не должно использовать старые картинки
+    void allocate(VulkanLogicalDevicePtr device);
+    VulkanImagePtr getImage(const std::string& name) const;
+    // Состояние картинки перед графом, например после получения картинки свопчейна
+    void setImageState(const std::string& name, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access);
+    // Перевод картинки после всех проходов, например в PRESENT_SRC
+    void setFinalLayout(const std::string& name, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access);
+    // Результат графа, проходы без вклада в выходные ресурсы не выполняются
+    void markOutput(const std::string& name);
+    VulkanRenderGraphPassPtr addPass(const std::string& name);
+    // Отбрасывание ненужных проходов, вызывать после изменения проходов или выходов
+    void compile();
+    // Запись барьеров и команд проходов
+    void execute(const VulkanCommandBufferPtr& buffer);
+    void printStats() const;
+    uint32_t getActivePassesCount() const;
+    uint32_t getCulledPassesCount() const;
+    uint32_t getLastFrameBarriersCount() const;
+    VkDeviceSize getSeparateMemorySize() const;
+    VkDeviceSize getAllocatedMemorySize() const;
+    
+private:
+    struct Resource {
+        std::string name;
+        VulkanImagePtr image;
+        VkImageAspectFlags aspectFlags;
+        VulkanRenderGraphImageState state;
+        bool output;
+        bool hasFinalLayout;
+        VkImageLayout finalLayout;
+        VkPipelineStageFlags finalStages;
+        VkAccessFlags finalAccess;
+        bool owned;                         // Картинка создается графом
+        VulkanRenderGraphImageDesc desc;
+        int32_t memoryBlock;                // Индекс блока памяти для картинок графа
+    };
+    
+    // Память, которую делят картинки графа
+    struct MemoryBlock {
+        VulkanDeviceMemoryPtr memory;
+        VkDeviceSize size;
+        uint32_t memoryTypeIndex;
+        bool lazy;
+        bool aliasable;
+        std::vector<uint32_t> resources;
+        int32_t lastResource;               // Картинка, последней использовавшая память
+    };
+    
+    std::vector<Resource> _resources;
+    std::map<std::string, uint32_t> _resourcesIndexes;
+    std::vector<VulkanRenderGraphPassPtr> _passes;
+    std::vector<VulkanRenderGraphPassPtr> _activePasses;
+    bool _compiled;
+    uint64_t _framesCount;
+    uint32_t _lastFrameBarriersCount;     // Вызовов vkCmdPipelineBarrier за кадр
+    uint32_t _lastFrameImageBarriersCount; // Барьеров картинок за кадр
+    uint32_t _lastFrameTransitionsCount;  // Из них со сменой лаяута
+    std::vector<MemoryBlock> _memoryBlocks;
+    VkDeviceSize _separateMemorySize;     // Память картинок графа без совмещения
+    
+private:
+    uint32_t getResourceIndex(const std::string& name);
+    void flushBarriers(const VulkanCommandBufferPtr& buffer, std::vector<VulkanImageBarrierInfo>& barriers,
+                       VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages);
+};
+
+typedef std::shared_ptr<VulkanRenderGraph> VulkanRenderGraphPtr;
+
+#endif
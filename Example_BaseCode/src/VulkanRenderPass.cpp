@@ -17,8 +17,11 @@ VulkanRenderPassConfig::VulkanRenderPassConfig():
 
 VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device, const VkRenderPassCreateInfo& customPassInfo):
     _device(device),
+    _subpassesCount(customPassInfo.subpassCount),
     _isCustom(true){
         
+    makeCompatibilityKey(customPassInfo);
+    
     // Создаем рендер-проход
     if (vkCreateRenderPass(_device->getDevice(), &customPassInfo, nullptr, &_renderPass) != VK_SUCCESS) {
         LOG("Failed to create render pass!");
@@ -32,6 +35,7 @@ VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
     _device(device),
     _imageConfig(imageConfig),
     _depthConfig(depthConfig),
+    _subpassesCount(1),
     _isCustom(false){
         
     // Описание подсоединенного буффера цвета
@@ -99,6 +103,8 @@ VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
     renderPassInfo.dependencyCount = 0;
     renderPassInfo.pDependencies = nullptr;
     
+    makeCompatibilityKey(renderPassInfo);
+    
     // Создаем рендер-проход
     if (vkCreateRenderPass(_device->getDevice(), &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS) {
         LOG("Failed to create render pass!");
@@ -110,6 +116,7 @@ VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
                                    const VulkanRenderPassConfig& imageConfig):
     _device(device),
     _imageConfig(imageConfig),
+    _subpassesCount(1),
     _isCustom(false){
     
     // Описание подсоединенного буффера цвета
@@ -151,6 +158,8 @@ VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
     renderPassInfo.dependencyCount = 0;
     renderPassInfo.pDependencies = nullptr;
     
+    makeCompatibilityKey(renderPassInfo);
+    
     // Создаем рендер-проход
     if (vkCreateRenderPass(_device->getDevice(), &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS) {
         LOG("Failed to create render pass!");
@@ -158,6 +167,203 @@ VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
     }
 }
 
+VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device,
+                                   const VulkanRenderPassConfig& imageConfig,
+                                   const VulkanRenderPassConfig& inputConfig,
+                                   const VulkanRenderPassConfig& depthConfig):
+    _device(device),
+    _imageConfig(imageConfig),
+    _depthConfig(depthConfig),
+    _inputConfig(inputConfig),
+    _subpassesCount(2),
+    _isCustom(false){
+    
+    // Аттачменты: 0 - результат, 1 - промежуточный цвет, 2 - глубина
+    const VulkanRenderPassConfig* configs[3] = {&_imageConfig, &_inputConfig, &_depthConfig};
+    for (size_t i = 0; i < 3; i++) {
+        VulkanRenderPassAttachmentDesc attachment;
+        attachment.format = configs[i]->format;
+        attachment.loadOp = configs[i]->loadOp;
+        attachment.storeOp = configs[i]->storeOp;
+        attachment.initLayout = configs[i]->initLayout;
+        attachment.finalLayout = configs[i]->finalLayout;
+        _desc.addAttachment(attachment);
+    }
+    
+    VulkanRenderPassSubpassDesc scene;
+    scene.colorAttachments.push_back(VulkanRenderPassDesc::makeReference(1, _inputConfig.refLayout));
+    scene.depthAttachment = VulkanRenderPassDesc::makeReference(2, _depthConfig.refLayout);
+    _desc.addSubpass(scene);
+    
+    // Во втором подпроходе промежуточный цвет только читается
+    VulkanRenderPassSubpassDesc post;
+    post.inputAttachments.push_back(VulkanRenderPassDesc::makeReference(1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+    post.colorAttachments.push_back(VulkanRenderPassDesc::makeReference(0, _imageConfig.refLayout));
+    _desc.addSubpass(post);
+    
+    // Пост эффект читает только свой пиксель, поэтому зависимость по региону:
+    // на тайловых GPU промежуточный цвет не покидает память тайла
+    _desc.addDependency(0, 1,
+                        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+    
+    createFromDesc();
+}
+
+VulkanRenderPass::VulkanRenderPass(VulkanLogicalDevicePtr device, const VulkanRenderPassDesc& desc):
+    _device(device),
+    _desc(desc),
+    _subpassesCount(static_cast<uint32_t>(desc.subpasses.size())),
+    _isCustom(false){
+    
+    createFromDesc();
+}
+
+// Создание прохода по _desc, ссылки проверяем заранее - драйвер на ошибки может просто упасть
+void VulkanRenderPass::createFromDesc(){
+    const uint32_t attachmentsCount = static_cast<uint32_t>(_desc.attachments.size());
+    
+    struct Helper {
+        static bool isValid(const VkAttachmentReference& reference, uint32_t attachmentsCount){
+            return (reference.attachment == VK_ATTACHMENT_UNUSED) || (reference.attachment < attachmentsCount);
+        }
+        static bool isValid(const std::vector<VkAttachmentReference>& references, uint32_t attachmentsCount){
+            for (const VkAttachmentReference& reference: references) {
+                if (isValid(reference, attachmentsCount) == false) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+    
+    if (_desc.subpasses.empty()) {
+        LOG("Render pass must have at least one subpass!\n");
+        throw std::runtime_error("Render pass must have at least one subpass!");
+    }
+    
+    std::vector<VkAttachmentDescription> attachments;
+    attachments.resize(_desc.attachments.size());
+    for (size_t i = 0; i < _desc.attachments.size(); i++) {
+        const VulkanRenderPassAttachmentDesc& config = _desc.attachments[i];
+        VkAttachmentDescription& attachment = attachments[i];
+        memset(&attachment, 0, sizeof(VkAttachmentDescription));
+        attachment.format = config.format;
+        attachment.samples = config.samples;
+        attachment.loadOp = config.loadOp;
+        attachment.storeOp = config.storeOp;
+        attachment.stencilLoadOp = config.stencilLoadOp;
+        attachment.stencilStoreOp = config.stencilStoreOp;
+        attachment.initialLayout = config.initLayout;
+        attachment.finalLayout = config.finalLayout;
+    }
+    
+    // Указатели ссылаются на векторы внутри _desc, поэтому описание не должно меняться до создания прохода
+    std::vector<VkSubpassDescription> subpasses;
+    subpasses.resize(_desc.subpasses.size());
+    for (size_t i = 0; i < _desc.subpasses.size(); i++) {
+        const VulkanRenderPassSubpassDesc& config = _desc.subpasses[i];
+        
+        bool valid = Helper::isValid(config.inputAttachments, attachmentsCount) &&
+                     Helper::isValid(config.colorAttachments, attachmentsCount) &&
+                     Helper::isValid(config.resolveAttachments, attachmentsCount) &&
+                     Helper::isValid(config.depthAttachment, attachmentsCount);
+        for (uint32_t index: config.preserveAttachments) {
+            valid = valid && (index < attachmentsCount);
+        }
+        if (valid == false) {
+            LOG("Invalid attachment reference in subpass %d!\n", (int)i);
+            throw std::runtime_error("Invalid attachment reference in subpass!");
+        }
+        if ((config.resolveAttachments.empty() == false) && (config.resolveAttachments.size() != config.colorAttachments.size())) {
+            LOG("Resolve attachments count must match color attachments count in subpass %d!\n", (int)i);
+            throw std::runtime_error("Resolve attachments count must match color attachments count!");
+        }
+        
+        VkSubpassDescription& subpass = subpasses[i];
+        memset(&subpass, 0, sizeof(VkSubpassDescription));
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.inputAttachmentCount = static_cast<uint32_t>(config.inputAttachments.size());
+        subpass.pInputAttachments = config.inputAttachments.empty() ? nullptr : config.inputAttachments.data();
+        subpass.colorAttachmentCount = static_cast<uint32_t>(config.colorAttachments.size());
+        subpass.pColorAttachments = config.colorAttachments.empty() ? nullptr : config.colorAttachments.data();
+        subpass.pResolveAttachments = config.resolveAttachments.empty() ? nullptr : config.resolveAttachments.data();
+        subpass.pDepthStencilAttachment = (config.depthAttachment.attachment != VK_ATTACHMENT_UNUSED) ? &config.depthAttachment : nullptr;
+        subpass.preserveAttachmentCount = static_cast<uint32_t>(config.preserveAttachments.size());
+        subpass.pPreserveAttachments = config.preserveAttachments.empty() ? nullptr : config.preserveAttachments.data();
+    }
+    
+    VkRenderPassCreateInfo renderPassInfo = {};
+    memset(&renderPassInfo, 0, sizeof(VkRenderPassCreateInfo));
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = attachmentsCount;
+    renderPassInfo.pAttachments = attachments.empty() ? nullptr : attachments.data();
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(_desc.dependencies.size());
+    renderPassInfo.pDependencies = _desc.dependencies.empty() ? nullptr : _desc.dependencies.data();
+    
+    makeCompatibilityKey(renderPassInfo);
+    
+    if (vkCreateRenderPass(_device->getDevice(), &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS) {
+        LOG("Failed to create render pass!");
+        throw std::runtime_error("Failed to create render pass!");
+    }
+}
+
+// Совместимость проходов: ссылки на аттачменты должны совпадать по формату и количеству семплов,
+// для нескольких подпроходов еще и зависимости. Операции загрузки/сохранения и лэйауты не важны
+void VulkanRenderPass::makeCompatibilityKey(const VkRenderPassCreateInfo& info){
+    _compatibilityKey.clear();
+    
+    struct Helper {
+        static void pushReference(std::vector<uint32_t>& key, const VkRenderPassCreateInfo& info, uint32_t attachment){
+            if ((attachment == VK_ATTACHMENT_UNUSED) || (attachment >= info.attachmentCount)) {
+                key.push_back(VK_ATTACHMENT_UNUSED);
+                key.push_back(0);
+                return;
+            }
+            key.push_back((uint32_t)info.pAttachments[attachment].format);
+            key.push_back((uint32_t)info.pAttachments[attachment].samples);
+        }
+    };
+    
+    _compatibilityKey.push_back(info.subpassCount);
+    for (uint32_t i = 0; i < info.subpassCount; i++) {
+        const VkSubpassDescription& subpass = info.pSubpasses[i];
+        _compatibilityKey.push_back((uint32_t)subpass.pipelineBindPoint);
+        
+        _compatibilityKey.push_back(subpass.inputAttachmentCount);
+        for (uint32_t j = 0; j < subpass.inputAttachmentCount; j++) {
+            Helper::pushReference(_compatibilityKey, info, subpass.pInputAttachments[j].attachment);
+        }
+        
+        _compatibilityKey.push_back(subpass.colorAttachmentCount);
+        for (uint32_t j = 0; j < subpass.colorAttachmentCount; j++) {
+            Helper::pushReference(_compatibilityKey, info, subpass.pColorAttachments[j].attachment);
+            uint32_t resolve = subpass.pResolveAttachments ? subpass.pResolveAttachments[j].attachment : VK_ATTACHMENT_UNUSED;
+            Helper::pushReference(_compatibilityKey, info, resolve);
+        }
+        
+        uint32_t depth = subpass.pDepthStencilAttachment ? subpass.pDepthStencilAttachment->attachment : VK_ATTACHMENT_UNUSED;
+        Helper::pushReference(_compatibilityKey, info, depth);
+    }
+    
+    if (info.subpassCount > 1) {
+        _compatibilityKey.push_back(info.dependencyCount);
+        for (uint32_t i = 0; i < info.dependencyCount; i++) {
+            const VkSubpassDependency& dependency = info.pDependencies[i];
+            _compatibilityKey.push_back(dependency.srcSubpass);
+            _compatibilityKey.push_back(dependency.dstSubpass);
+            _compatibilityKey.push_back(dependency.srcStageMask);
+            _compatibilityKey.push_back(dependency.dstStageMask);
+            _compatibilityKey.push_back(dependency.srcAccessMask);
+            _compatibilityKey.push_back(dependency.dstAccessMask);
+            _compatibilityKey.push_back(dependency.dependencyFlags);
+        }
+    }
+}
+
 VulkanRenderPass::~VulkanRenderPass(){
     vkDestroyRenderPass(_device->getDevice(), _renderPass, nullptr);
 }
@@ -171,6 +377,18 @@ VulkanRenderPassConfig VulkanRenderPass::getBaseDepthConfig() const{
     return _depthConfig;
 }
 
+VulkanRenderPassConfig VulkanRenderPass::getBaseInputConfig() const{
+    return _inputConfig;
+}
+
+const VulkanRenderPassDesc& VulkanRenderPass::getBaseDesc() const{
+    return _desc;
+}
+
+uint32_t VulkanRenderPass::getSubpassesCount() const{
+    return _subpassesCount;
+}
+
 VkRenderPass VulkanRenderPass::getPass() const{
     return _renderPass;
 }
@@ -178,3 +396,11 @@ VkRenderPass VulkanRenderPass::getPass() const{
 bool VulkanRenderPass::isCustom() const{
     return _isCustom;
 }
+
+const std::vector<uint32_t>& VulkanRenderPass::getCompatibilityKey() const{
+    return _compatibilityKey;
+}
+
+bool VulkanRenderPass::isCompatible(const std::shared_ptr<VulkanRenderPass>& other) const{
+    return other && (_compatibilityKey == other->getCompatibilityKey());
+}
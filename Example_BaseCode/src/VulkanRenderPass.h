@@ -2,6 +2,7 @@
 #define VULKAN_RENDER_PASS_H
 
 #include <memory>
+#include <vector>
 
 // GLFW include
 #define GLFW_INCLUDE_VULKAN
@@ -9,6 +10,7 @@
 
 #include "VulkanLogicalDevice.h"
 #include "VulkanResource.h"
+#include "VulkanRenderPassDesc.h"
 
 struct VulkanRenderPassConfig{
     VkFormat format;
@@ -30,20 +32,42 @@ public:
                      const VulkanRenderPassConfig& depthConfig);
     VulkanRenderPass(VulkanLogicalDevicePtr device,
                      const VulkanRenderPassConfig& imageConfig);
+    // Пост эффект подпроходом: подпроход 0 рисует в inputConfig (аттачмент 1) с глубиной (аттачмент 2),
+    // подпроход 1 читает его как input attachment и пишет в imageConfig (аттачмент 0)
+    VulkanRenderPass(VulkanLogicalDevicePtr device,
+                     const VulkanRenderPassConfig& imageConfig,
+                     const VulkanRenderPassConfig& inputConfig,
+                     const VulkanRenderPassConfig& depthConfig);
+    // Произвольное число аттачментов и подпроходов, обычно создается через VulkanRenderPassCache
+    VulkanRenderPass(VulkanLogicalDevicePtr device,
+                     const VulkanRenderPassDesc& desc);
     ~VulkanRenderPass();
     VkRenderPass getPass() const;
     VulkanRenderPassConfig getBaseImageConfig() const;
     VulkanRenderPassConfig getBaseDepthConfig() const;
+    VulkanRenderPassConfig getBaseInputConfig() const;
+    // Описание заполнено только у проходов, созданных по описанию
+    const VulkanRenderPassDesc& getBaseDesc() const;
+    uint32_t getSubpassesCount() const;
     bool isCustom() const;
+    // Пайплайн, созданный для одного прохода, можно использовать с любым совместимым
+    const std::vector<uint32_t>& getCompatibilityKey() const;
+    bool isCompatible(const std::shared_ptr<VulkanRenderPass>& other) const;
     
 private:
     VulkanLogicalDevicePtr _device;
     VulkanRenderPassConfig  _imageConfig;
     VulkanRenderPassConfig  _depthConfig;
+    VulkanRenderPassConfig  _inputConfig;
+    VulkanRenderPassDesc _desc;
+    uint32_t _subpassesCount;
     bool _isCustom;
     VkRenderPass _renderPass;
+    std::vector<uint32_t> _compatibilityKey;
     
 private:
+    void makeCompatibilityKey(const VkRenderPassCreateInfo& info);
+    void createFromDesc();
 };
 
 typedef std::shared_ptr<VulkanRenderPass> VulkanRenderPassPtr;
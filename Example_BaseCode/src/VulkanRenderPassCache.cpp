@@ -0,0 +1,52 @@
+#include "VulkanRenderPassCache.h"
+#include <cstdio>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+VulkanRenderPassCache::VulkanRenderPassCache(VulkanLogicalDevicePtr device):
+    _device(device),
+    _requestsCount(0),
+    _hitsCount(0){
+}
+
+VulkanRenderPassCache::~VulkanRenderPassCache(){
+    clear();
+}
+
+VulkanRenderPassPtr VulkanRenderPassCache::getRenderPass(const VulkanRenderPassDesc& desc){
+    _requestsCount++;
+    
+    size_t hash = desc.getHash();
+    
+    // Ищем среди проходов с таким же хешем
+    typedef std::unordered_multimap<size_t, VulkanRenderPassPtr>::iterator Iterator;
+    std::pair<Iterator, Iterator> range = _renderPasses.equal_range(hash);
+    for (Iterator it = range.first; it != range.second; ++it) {
+        if (it->second->getBaseDesc() == desc) {
+            _hitsCount++;
+            return it->second;
+        }
+    }
+    
+    VulkanRenderPassPtr renderPass = std::make_shared<VulkanRenderPass>(_device, desc);
+    _renderPasses.insert(std::make_pair(hash, renderPass));
+    return renderPass;
+}
+
+void VulkanRenderPassCache::clear(){
+    _renderPasses.clear();
+}
+
+void VulkanRenderPassCache::printStats() const{
+    LOG("Render pass cache: requests %llu, hits %llu, render passes %d\n",
+        (unsigned long long)_requestsCount, (unsigned long long)_hitsCount, (int)_renderPasses.size());
+}
+
+size_t VulkanRenderPassCache::getRenderPassesCount() const{
+    return _renderPasses.size();
+}
+
+VulkanLogicalDevicePtr VulkanRenderPassCache::getBaseDevice() const{
+    return _device;
+}
@@ -0,0 +1,39 @@
+#ifndef VULKAN_RENDER_PASS_CACHE_H
+#define VULKAN_RENDER_PASS_CACHE_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanRenderPassDesc.h"
+#include "VulkanRenderPass.h"
+
+
+// Кеш рендер проходов по полному описанию, один на логическое устройство.
+// Одинаковые описания возвращают один и тот же проход, поэтому пайплайны и фреймбуфферы
+// можно переиспользовать между местами, которые создают проход независимо
+class VulkanRenderPassCache {
+public:
+    VulkanRenderPassCache(VulkanLogicalDevicePtr device);
+    ~VulkanRenderPassCache();
+    VulkanRenderPassPtr getRenderPass(const VulkanRenderPassDesc& desc);
+    void clear();
+    void printStats() const;
+    size_t getRenderPassesCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    std::unordered_multimap<size_t, VulkanRenderPassPtr> _renderPasses;
+    uint64_t _requestsCount;
+    uint64_t _hitsCount;
+};
+
+typedef std::shared_ptr<VulkanRenderPassCache> VulkanRenderPassCachePtr;
+
+#endif
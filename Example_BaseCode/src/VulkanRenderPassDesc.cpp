@@ -0,0 +1,175 @@
+#include "VulkanRenderPassDesc.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+static void hashReferences(uint64_t& hash, const std::vector<VkAttachmentReference>& references){
+    hashValue(hash, references.size());
+    for (const VkAttachmentReference& reference: references) {
+        hashValue(hash, reference.attachment);
+        hashValue(hash, (uint64_t)reference.layout);
+    }
+}
+
+static bool isEqual(const VkAttachmentReference& a, const VkAttachmentReference& b){
+    return (a.attachment == b.attachment) && (a.layout == b.layout);
+}
+
+static bool isEqual(const std::vector<VkAttachmentReference>& a, const std::vector<VkAttachmentReference>& b){
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (isEqual(a[i], b[i]) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isEqual(const VkSubpassDependency& a, const VkSubpassDependency& b){
+    return (a.srcSubpass == b.srcSubpass) &&
+           (a.dstSubpass == b.dstSubpass) &&
+           (a.srcStageMask == b.srcStageMask) &&
+           (a.dstStageMask == b.dstStageMask) &&
+           (a.srcAccessMask == b.srcAccessMask) &&
+           (a.dstAccessMask == b.dstAccessMask) &&
+           (a.dependencyFlags == b.dependencyFlags);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderPassAttachmentDesc::VulkanRenderPassAttachmentDesc():
+    format(VK_FORMAT_UNDEFINED),
+    samples(VK_SAMPLE_COUNT_1_BIT),
+    loadOp(VK_ATTACHMENT_LOAD_OP_DONT_CARE),
+    storeOp(VK_ATTACHMENT_STORE_OP_DONT_CARE),
+    stencilLoadOp(VK_ATTACHMENT_LOAD_OP_DONT_CARE),
+    stencilStoreOp(VK_ATTACHMENT_STORE_OP_DONT_CARE),
+    initLayout(VK_IMAGE_LAYOUT_UNDEFINED),
+    finalLayout(VK_IMAGE_LAYOUT_UNDEFINED){
+}
+
+bool VulkanRenderPassAttachmentDesc::operator==(const VulkanRenderPassAttachmentDesc& other) const{
+    return (format == other.format) &&
+           (samples == other.samples) &&
+           (loadOp == other.loadOp) &&
+           (storeOp == other.storeOp) &&
+           (stencilLoadOp == other.stencilLoadOp) &&
+           (stencilStoreOp == other.stencilStoreOp) &&
+           (initLayout == other.initLayout) &&
+           (finalLayout == other.finalLayout);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderPassSubpassDesc::VulkanRenderPassSubpassDesc(){
+    depthAttachment.attachment = VK_ATTACHMENT_UNUSED;
+    depthAttachment.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+bool VulkanRenderPassSubpassDesc::operator==(const VulkanRenderPassSubpassDesc& other) const{
+    return isEqual(inputAttachments, other.inputAttachments) &&
+           isEqual(colorAttachments, other.colorAttachments) &&
+           isEqual(resolveAttachments, other.resolveAttachments) &&
+           isEqual(depthAttachment, other.depthAttachment) &&
+           (preserveAttachments == other.preserveAttachments);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanRenderPassDesc::VulkanRenderPassDesc(){
+}
+
+size_t VulkanRenderPassDesc::getHash() const{
+    uint64_t hash = FNV1A_INITIAL_HASH;
+    
+    hashValue(hash, attachments.size());
+    for (const VulkanRenderPassAttachmentDesc& attachment: attachments) {
+        hashValue(hash, (uint64_t)attachment.format);
+        hashValue(hash, (uint64_t)attachment.samples);
+        hashValue(hash, (uint64_t)attachment.loadOp);
+        hashValue(hash, (uint64_t)attachment.storeOp);
+        hashValue(hash, (uint64_t)attachment.stencilLoadOp);
+        hashValue(hash, (uint64_t)attachment.stencilStoreOp);
+        hashValue(hash, (uint64_t)attachment.initLayout);
+        hashValue(hash, (uint64_t)attachment.finalLayout);
+    }
+    
+    hashValue(hash, subpasses.size());
+    for (const VulkanRenderPassSubpassDesc& subpass: subpasses) {
+        hashReferences(hash, subpass.inputAttachments);
+        hashReferences(hash, subpass.colorAttachments);
+        hashReferences(hash, subpass.resolveAttachments);
+        hashValue(hash, subpass.depthAttachment.attachment);
+        hashValue(hash, (uint64_t)subpass.depthAttachment.layout);
+        hashValue(hash, subpass.preserveAttachments.size());
+        for (uint32_t index: subpass.preserveAttachments) {
+            hashValue(hash, index);
+        }
+    }
+    
+    hashValue(hash, dependencies.size());
+    for (const VkSubpassDependency& dependency: dependencies) {
+        hashValue(hash, dependency.srcSubpass);
+        hashValue(hash, dependency.dstSubpass);
+        hashValue(hash, dependency.srcStageMask);
+        hashValue(hash, dependency.dstStageMask);
+        hashValue(hash, dependency.srcAccessMask);
+        hashValue(hash, dependency.dstAccessMask);
+        hashValue(hash, dependency.dependencyFlags);
+    }
+    
+    return (size_t)hash;
+}
+
+bool VulkanRenderPassDesc::operator==(const VulkanRenderPassDesc& other) const{
+    if ((attachments != other.attachments) || (subpasses != other.subpasses)) {
+        return false;
+    }
+    if (dependencies.size() != other.dependencies.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < dependencies.size(); i++) {
+        if (isEqual(dependencies[i], other.dependencies[i]) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t VulkanRenderPassDesc::addAttachment(const VulkanRenderPassAttachmentDesc& attachment){
+    attachments.push_back(attachment);
+    return static_cast<uint32_t>(attachments.size() - 1);
+}
+
+uint32_t VulkanRenderPassDesc::addSubpass(const VulkanRenderPassSubpassDesc& subpass){
+    subpasses.push_back(subpass);
+    return static_cast<uint32_t>(subpasses.size() - 1);
+}
+
+void VulkanRenderPassDesc::addDependency(uint32_t srcSubpass, uint32_t dstSubpass,
+                                         VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages,
+                                         VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                         VkDependencyFlags flags){
+    VkSubpassDependency dependency = {};
+    memset(&dependency, 0, sizeof(VkSubpassDependency));
+    dependency.srcSubpass = srcSubpass;
+    dependency.dstSubpass = dstSubpass;
+    dependency.srcStageMask = srcStages;
+    dependency.dstStageMask = dstStages;
+    dependency.srcAccessMask = srcAccess;
+    dependency.dstAccessMask = dstAccess;
+    dependency.dependencyFlags = flags;
+    dependencies.push_back(dependency);
+}
+
+VkAttachmentReference VulkanRenderPassDesc::makeReference(uint32_t attachment, VkImageLayout layout){
+    VkAttachmentReference reference = {};
+    memset(&reference, 0, sizeof(VkAttachmentReference));
+    reference.attachment = attachment;
+    reference.layout = layout;
+    return reference;
+}
@@ -0,0 +1,61 @@
+#ifndef VULKAN_RENDER_PASS_DESC_H
+#define VULKAN_RENDER_PASS_DESC_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+
+// Описание аттачмента рендер прохода
+struct VulkanRenderPassAttachmentDesc {
+    VkFormat format;
+    VkSampleCountFlagBits samples;
+    VkAttachmentLoadOp loadOp;
+    VkAttachmentStoreOp storeOp;
+    VkAttachmentLoadOp stencilLoadOp;
+    VkAttachmentStoreOp stencilStoreOp;
+    VkImageLayout initLayout;
+    VkImageLayout finalLayout;
+    
+    VulkanRenderPassAttachmentDesc();
+    bool operator==(const VulkanRenderPassAttachmentDesc& other) const;
+};
+
+// Описание подпрохода: ссылки на аттачменты по индексу в VulkanRenderPassDesc::attachments.
+// resolveAttachments либо пустой, либо по одному на каждый аттачмент цвета (VK_ATTACHMENT_UNUSED - без резолва)
+struct VulkanRenderPassSubpassDesc {
+    std::vector<VkAttachmentReference> inputAttachments;
+    std::vector<VkAttachmentReference> colorAttachments;
+    std::vector<VkAttachmentReference> resolveAttachments;
+    VkAttachmentReference depthAttachment;  // attachment == VK_ATTACHMENT_UNUSED - без глубины
+    std::vector<uint32_t> preserveAttachments;
+    
+    VulkanRenderPassSubpassDesc();
+    bool operator==(const VulkanRenderPassSubpassDesc& other) const;
+};
+
+// Полное описание рендер прохода: N аттачментов, M подпроходов и явные зависимости между ними.
+// Ключ для VulkanRenderPassCache
+struct VulkanRenderPassDesc {
+    std::vector<VulkanRenderPassAttachmentDesc> attachments;
+    std::vector<VulkanRenderPassSubpassDesc> subpasses;
+    std::vector<VkSubpassDependency> dependencies;
+    
+    VulkanRenderPassDesc();
+    size_t getHash() const;
+    bool operator==(const VulkanRenderPassDesc& other) const;
+    
+    // Вспомогательные методы для заполнения, возвращают индекс
+    uint32_t addAttachment(const VulkanRenderPassAttachmentDesc& attachment);
+    uint32_t addSubpass(const VulkanRenderPassSubpassDesc& subpass);
+    void addDependency(uint32_t srcSubpass, uint32_t dstSubpass,
+                       VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages,
+                       VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                       VkDependencyFlags flags = VK_DEPENDENCY_BY_REGION_BIT);
+    static VkAttachmentReference makeReference(uint32_t attachment, VkImageLayout layout);
+};
+
+#endif
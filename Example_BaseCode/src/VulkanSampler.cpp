@@ -2,18 +2,22 @@
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 #include "Helpers.h"
 
 
 VulkanSampler::VulkanSampler(VulkanLogicalDevicePtr device,
                              VkFilter minFiler, VkFilter magFilter,
                              VkSamplerAddressMode mode,
-                             uint32_t maxMipLevels, uint32_t minMipLevel, float mipLevelBias):
+                             uint32_t maxMipLevels, uint32_t minMipLevel, float mipLevelBias, float maxAnisotropy):
     _device(device),
     _minFiler(minFiler),
     _magFilter(magFilter),
     _mode(mode),
-    _maxMipLevels(maxMipLevels){
+    _maxMipLevels(maxMipLevels),
+    _minMipLevel(minMipLevel),
+    _mipLevelBias(mipLevelBias),
+    _maxAnisotropy(getSupportedAnisotropy(device, maxAnisotropy)){
         
     // Описание семплирования для текстуры
     VkSamplerCreateInfo samplerInfo = {};
@@ -24,15 +28,15 @@ VulkanSampler::VulkanSampler(VulkanLogicalDevicePtr device,
     samplerInfo.addressModeU = _mode;   // Ограничение по границе
     samplerInfo.addressModeV = _mode;   // Ограничение по границе
     samplerInfo.addressModeW = _mode;   // Ограничение по границе
-    samplerInfo.anisotropyEnable = VK_FALSE;    // Анизотропная фильтрация
-    samplerInfo.maxAnisotropy = 1;
+    samplerInfo.anisotropyEnable = (_maxAnisotropy > 1.0f) ? VK_TRUE : VK_FALSE;    // Анизотропная фильтрация
+    samplerInfo.maxAnisotropy = _maxAnisotropy;
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = mipLevelBias;
-    samplerInfo.minLod = static_cast<float>(minMipLevel);
+    samplerInfo.minLod = static_cast<float>(_minMipLevel);
     samplerInfo.maxLod = static_cast<float>(_maxMipLevels);
     
     // Создаем семплер
@@ -69,3 +73,24 @@ VkSamplerAddressMode VulkanSampler::getBaseMode() const{
 uint32_t VulkanSampler::getBaseMaxMipLevel() const{
     return _maxMipLevels;
 }
+
+uint32_t VulkanSampler::getBaseMinMipLevel() const{
+    return _minMipLevel;
+}
+
+float VulkanSampler::getBaseMipLevelBias() const{
+    return _mipLevelBias;
+}
+
+float VulkanSampler::getBaseMaxAnisotropy() const{
+    return _maxAnisotropy;
+}
+
+float VulkanSampler::getSupportedAnisotropy(VulkanLogicalDevicePtr device, float maxAnisotropy){
+    // Без включенной фичи устройства анизотропию использовать нельзя
+    if ((maxAnisotropy <= 1.0f) || (device->getBaseFeatures().samplerAnisotropy == VK_FALSE)) {
+        return 1.0f;
+    }
+    float deviceLimit = device->getBasePhysicalDevice()->getDeviceProperties().limits.maxSamplerAnisotropy;
+    return std::max(1.0f, std::min(maxAnisotropy, deviceLimit));
+}
@@ -11,12 +11,14 @@
 #include "VulkanResource.h"
 
 
+// maxAnisotropy > 1 включает анизотропную фильтрацию, если у логического устройства включена фича samplerAnisotropy,
+// значение ограничивается лимитом устройства
 class VulkanSampler: public VulkanResource {
 public:
     VulkanSampler(VulkanLogicalDevicePtr device,
                   VkFilter minFiler, VkFilter magFilter,
                   VkSamplerAddressMode mode,
-                  uint32_t maxMipLevels, uint32_t minMipLevel = 0, float mipLevelBias = 0.0f);
+                  uint32_t maxMipLevels, uint32_t minMipLevel = 0, float mipLevelBias = 0.0f, float maxAnisotropy = 1.0f);
     ~VulkanSampler();
     VkSampler getSampler() const;
     VulkanLogicalDevicePtr getBaseDevice() const;
@@ -24,6 +26,12 @@ public:
     VkFilter getBaseMagFilter() const;
     VkSamplerAddressMode getBaseMode() const;
     uint32_t getBaseMaxMipLevel() const;
+    uint32_t getBaseMinMipLevel() const;
+    float getBaseMipLevelBias() const;
+    float getBaseMaxAnisotropy() const;
+    
+    // Анизотропия, которая реально будет у семплера на этом устройстве, 1 - выключена
+    static float getSupportedAnisotropy(VulkanLogicalDevicePtr device, float maxAnisotropy);
     
 private:
     VulkanLogicalDevicePtr _device;
@@ -31,6 +39,9 @@ private:
     VkFilter _magFilter;
     VkSamplerAddressMode _mode;
     uint32_t _maxMipLevels;
+    uint32_t _minMipLevel;
+    float _mipLevelBias;
+    float _maxAnisotropy;
     VkSampler _sampler;
     
 private:
@@ -0,0 +1,91 @@
+#include "VulkanSamplerCache.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "Helpers.h"
+
+
+static uint64_t floatBits(float value){
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(uint32_t));
+    return bits;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanSamplerCache::VulkanSamplerCache(VulkanLogicalDevicePtr device, float maxAnisotropy):
+    _device(device),
+    _maxAnisotropy(maxAnisotropy),
+    _requestsCount(0),
+    _hitsCount(0){
+    
+    float supported = VulkanSampler::getSupportedAnisotropy(_device, _maxAnisotropy);
+    LOG("Sampler cache: anisotropy %.0fx%s\n", supported, (supported > 1.0f) ? "" : " (disabled, no samplerAnisotropy feature)");
+}
+
+VulkanSamplerCache::~VulkanSamplerCache(){
+    clear();
+}
+
+VulkanSamplerPtr VulkanSamplerCache::getSampler(VkFilter minFilter, VkFilter magFilter,
+                                                VkSamplerAddressMode mode,
+                                                uint32_t maxMipLevels, uint32_t minMipLevel, float mipLevelBias, float maxAnisotropy){
+    _requestsCount++;
+    
+    // Разные запрошенные значения могут дать одну и ту же анизотропию на устройстве
+    if (maxAnisotropy < 0.0f) {
+        maxAnisotropy = _maxAnisotropy;
+    }
+    maxAnisotropy = VulkanSampler::getSupportedAnisotropy(_device, maxAnisotropy);
+    
+    size_t hash = 0;
+    hashCombine(hash, (uint64_t)minFilter);
+    hashCombine(hash, (uint64_t)magFilter);
+    hashCombine(hash, (uint64_t)mode);
+    hashCombine(hash, maxMipLevels);
+    hashCombine(hash, minMipLevel);
+    hashCombine(hash, floatBits(mipLevelBias));
+    hashCombine(hash, floatBits(maxAnisotropy));
+    
+    typedef std::unordered_multimap<size_t, VulkanSamplerPtr>::iterator Iterator;
+    std::pair<Iterator, Iterator> range = _samplers.equal_range(hash);
+    for (Iterator it = range.first; it != range.second; ++it) {
+        const VulkanSamplerPtr& sampler = it->second;
+        if ((sampler->getBaseMinFiler() == minFilter) &&
+            (sampler->getBaseMagFilter() == magFilter) &&
+            (sampler->getBaseMode() == mode) &&
+            (sampler->getBaseMaxMipLevel() == maxMipLevels) &&
+            (sampler->getBaseMinMipLevel() == minMipLevel) &&
+            (sampler->getBaseMipLevelBias() == mipLevelBias) &&
+            (sampler->getBaseMaxAnisotropy() == maxAnisotropy)) {
+            _hitsCount++;
+            return sampler;
+        }
+    }
+    
+    VulkanSamplerPtr sampler = std::make_shared<VulkanSampler>(_device, minFilter, magFilter, mode, maxMipLevels, minMipLevel, mipLevelBias, maxAnisotropy);
+    _samplers.insert(std::make_pair(hash, sampler));
+    return sampler;
+}
+
+void VulkanSamplerCache::clear(){
+    _samplers.clear();
+}
+
+void VulkanSamplerCache::printStats() const{
+    LOG("Sampler cache: requests %llu, hits %llu, samplers %d of %d allowed\n",
+        (unsigned long long)_requestsCount, (unsigned long long)_hitsCount,
+        (int)_samplers.size(), (int)_device->getBasePhysicalDevice()->getDeviceProperties().limits.maxSamplerAllocationCount);
+}
+
+size_t VulkanSamplerCache::getSamplersCount() const{
+    return _samplers.size();
+}
+
+VulkanLogicalDevicePtr VulkanSamplerCache::getBaseDevice() const{
+    return _device;
+}
+
+float VulkanSamplerCache::getBaseMaxAnisotropy() const{
+    return _maxAnisotropy;
+}
@@ -0,0 +1,44 @@
+#ifndef VULKAN_SAMPLER_CACHE_H
+#define VULKAN_SAMPLER_CACHE_H
+
+#include <memory>
+#include <unordered_map>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanSampler.h"
+
+
+// Кеш семплеров, один на логическое устройство.
+// Число семплеров у драйвера ограничено (maxSamplerAllocationCount), поэтому текстуры с одинаковыми
+// параметрами семплирования получают один и тот же объект. Ключ - фильтры, режим адресации, диапазон LOD и анизотропия.
+// Анизотропия приводится к тому, что поддерживает устройство, до поиска в кеше
+class VulkanSamplerCache {
+public:
+    // maxAnisotropy - значение по умолчанию для getSampler, работает при включенной фиче samplerAnisotropy
+    VulkanSamplerCache(VulkanLogicalDevicePtr device, float maxAnisotropy = 16.0f);
+    ~VulkanSamplerCache();
+    // maxAnisotropy < 0 - значение кеша по умолчанию
+    VulkanSamplerPtr getSampler(VkFilter minFilter, VkFilter magFilter,
+                                VkSamplerAddressMode mode,
+                                uint32_t maxMipLevels, uint32_t minMipLevel = 0, float mipLevelBias = 0.0f, float maxAnisotropy = -1.0f);
+    void clear();
+    void printStats() const;
+    size_t getSamplersCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    float getBaseMaxAnisotropy() const;
+    
+private:
+    VulkanLogicalDevicePtr _device;
+    float _maxAnisotropy;
+    std::unordered_multimap<size_t, VulkanSamplerPtr> _samplers;
+    uint64_t _requestsCount;
+    uint64_t _hitsCount;
+};
+
+typedef std::shared_ptr<VulkanSamplerCache> VulkanSamplerCachePtr;
+
+#endif
@@ -6,22 +6,37 @@
 
 VulkanShaderModule::VulkanShaderModule(VulkanLogicalDevicePtr device, const std::vector<unsigned char>& code):
     _device(device){
-        
+    
+    createModule(code.data(), code.size());
+}
+
+VulkanShaderModule::VulkanShaderModule(VulkanLogicalDevicePtr device, const AssetFileView& code):
+    _device(device){
+    
+    createModule(code.data, code.size);
+}
+
+VulkanShaderModule::~VulkanShaderModule(){
+    vkDestroyShaderModule(_device->getDevice(), _module, nullptr);
+}
+
+void VulkanShaderModule::createModule(const unsigned char* code, size_t size){
+    // pCode читается словами: буффер и начало мапинга всегда выровнены, размер SPIR-V кратен 4
+    if ((size % sizeof(uint32_t)) != 0) {
+        throw std::runtime_error("failed to create shader module: wrong SPIR-V size!");
+    }
+    
     VkShaderModuleCreateInfo createInfo = {};
     memset(&createInfo, 0, sizeof(VkShaderModuleCreateInfo));
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = static_cast<uint32_t>(code.size());
-    createInfo.pCode = (uint32_t*)code.data();
+    createInfo.codeSize = size;
+    createInfo.pCode = (const uint32_t*)code;
     
     if (vkCreateShaderModule(_device->getDevice(), &createInfo, nullptr, &_module) != VK_SUCCESS) {
         throw std::runtime_error("failed to create shader module!");
     }
 }
 
-VulkanShaderModule::~VulkanShaderModule(){
-    vkDestroyShaderModule(_device->getDevice(), _module, nullptr);
-}
-
 VkShaderModule VulkanShaderModule::getModule() const{
     return _module;
 }
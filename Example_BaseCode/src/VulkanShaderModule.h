@@ -10,11 +10,14 @@
 #include <GLFW/glfw3.h>
 
 #include "VulkanLogicalDevice.h"
+#include "AssetFile.h"
 
 
 class VulkanShaderModule {
 public:
     VulkanShaderModule(VulkanLogicalDevicePtr device, const std::vector<unsigned char>& code);
+    // SPIR-V прямо из замапленного файла, без копирования
+    VulkanShaderModule(VulkanLogicalDevicePtr device, const AssetFileView& code);
     ~VulkanShaderModule();
     VkShaderModule getModule() const;
     
@@ -23,6 +26,7 @@ private:
     VkShaderModule _module;
     
 private:
+    void createModule(const unsigned char* code, size_t size);
 };
 
 typedef std::shared_ptr<VulkanShaderModule> VulkanShaderModulePtr;
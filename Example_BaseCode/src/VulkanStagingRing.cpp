@@ -0,0 +1,375 @@
+#include "VulkanStagingRing.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include "Helpers.h"
+
+
+VulkanStagingRing::VulkanStagingRing(VulkanLogicalDevicePtr device, VulkanQueuePtr transferQueue, VulkanQueuePtr renderQueue, size_t ringSize):
+    _device(device),
+    _transferQueue(transferQueue),
+    _renderQueue(renderQueue),
+    _ringSize(ringSize),
+    _ownershipTransfer(false),
+    _ringData(nullptr),
+    _alignment(16),
+    _ringHead(0),
+    _ringUsed(0),
+    _uploadedBytes(0),
+    _submitsCount(0),
+    _stallsCount(0),
+    _stallsTime(0.0){
+
+    _currentAcquire.dstStages = 0;
+
+    // Без выделенной очереди копируем в очереди отрисовки, передача владения не нужна
+    _copyQueue = _transferQueue ? _transferQueue : _renderQueue;
+    _ownershipTransfer = (_copyQueue->getFamilyIndex() != _renderQueue->getFamilyIndex());
+
+    // Пул комманд в семействе очереди копирования
+    _commandPool = std::make_shared<VulkanCommandPool>(_device, _copyQueue->getFamilyIndex());
+
+    // Буффер кольца мапится один раз на все время жизни
+    _ringBuffer = std::make_shared<VulkanBuffer>(_device,
+                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                 _ringSize);
+    _ringData = _ringBuffer->map(_ringSize, 0);
+    if (_ringData == nullptr) {
+        LOG("Failed to map staging ring buffer!\n");
+        throw std::runtime_error("Failed to map staging ring buffer!");
+    }
+
+    // Смещение в буффере при копировании в картинку должно быть кратно размеру текселя
+    VkDeviceSize optimalAlignment = _device->getBasePhysicalDevice()->getDeviceProperties().limits.optimalBufferCopyOffsetAlignment;
+    _alignment = std::max(_alignment, optimalAlignment);
+}
+
+VulkanStagingRing::~VulkanStagingRing(){
+    waitIdle();
+
+    _pendingAcquires.clear();
+    _freeBatches.clear();
+    _currentBatch = nullptr;
+    _ringBuffer->unmap();
+    _ringBuffer = nullptr;
+    _commandPool = nullptr;
+}
+
+// Копирование в буффер, большие данные режутся на куски по размеру кольца
+void VulkanStagingRing::uploadBuffer(VulkanBufferPtr dstBuffer, const void* data, size_t dataSize, VkDeviceSize dstOffset,
+                                     VkAccessFlags dstAccess, VkPipelineStageFlags dstStage){
+    if (dataSize == 0) {
+        return;
+    }
+
+    const char* srcData = static_cast<const char*>(data);
+    VkDeviceSize copiedSize = 0;
+    while (copiedSize < dataSize) {
+        VkDeviceSize chunkSize = std::min(static_cast<VkDeviceSize>(dataSize) - copiedSize, static_cast<VkDeviceSize>(_ringSize));
+        VkDeviceSize ringOffset = allocate(chunkSize);
+        memcpy(_ringData + ringOffset, srcData + copiedSize, chunkSize);
+
+        VkBufferCopy copyRegion = {};
+        memset(&copyRegion, 0, sizeof(VkBufferCopy));
+        copyRegion.srcOffset = ringOffset;
+        copyRegion.dstOffset = dstOffset + copiedSize;
+        copyRegion.size = chunkSize;
+        _currentBatch->commandBuffer->cmdCopyBuffer(copyRegion, _ringBuffer, dstBuffer);
+
+        copiedSize += chunkSize;
+    }
+    _uploadedBytes += dataSize;
+
+    // Барьер на весь диапазон, куски из предыдущих пачек идут раньше в той же очереди
+    VulkanBufferBarrierInfo barrier;
+    barrier.buffer = dstBuffer;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.offset = dstOffset;
+    barrier.size = dataSize;
+    if (_ownershipTransfer) {
+        // Освобождение в очереди копирования, доступ на приемной стороне указывает захват
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = _copyQueue->getFamilyIndex();
+        barrier.dstQueueFamilyIndex = _renderQueue->getFamilyIndex();
+        _currentBatch->commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                                         nullptr, 0, &barrier, 1, nullptr, 0);
+
+        VulkanBufferBarrierInfo acquire = barrier;
+        acquire.srcAccessMask = 0;
+        acquire.dstAccessMask = dstAccess;
+        _currentAcquire.buffers.push_back(acquire);
+        _currentAcquire.dstStages |= dstStage;
+    }else{
+        barrier.dstAccessMask = dstAccess;
+        _currentBatch->commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage,
+                                                         nullptr, 0, &barrier, 1, nullptr, 0);
+    }
+}
+
+// Копирование в уровень мипмапа цветной картинки, данные уровня должны целиком влезать в кольцо
+void VulkanStagingRing::uploadImage(VulkanImagePtr dstImage, const void* data, size_t dataSize, uint32_t mipLevel, VkImageLayout finalLayout,
+                                    VkAccessFlags dstAccess, VkPipelineStageFlags dstStage){
+    if (dataSize > _ringSize) {
+        LOG("Image data is bigger than staging ring!\n");
+        throw std::runtime_error("Image data is bigger than staging ring!");
+    }
+
+    VkDeviceSize ringOffset = allocate(dataSize);
+    memcpy(_ringData + ringOffset, data, dataSize);
+    _uploadedBytes += dataSize;
+
+    VulkanCommandBufferPtr commandBuffer = _currentBatch->commandBuffer;
+
+    // Старое содержимое уровня не нужно
+    VulkanImageBarrierInfo toTransfer;
+    toTransfer.image = dstImage;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.startMipmapLevel = mipLevel;
+    toTransfer.levelsCount = 1;
+    toTransfer.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    toTransfer.srcAccessBarrier = 0;
+    toTransfer.dstAccessBarrier = VK_ACCESS_TRANSFER_WRITE_BIT;
+    commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      &toTransfer, 1, nullptr, 0, nullptr, 0);
+
+    VkExtent2D size = dstImage->getBaseSize();
+    std::vector<VkBufferImageCopy> regions(1);
+    VkBufferImageCopy& region = regions[0];
+    memset(&region, 0, sizeof(VkBufferImageCopy));
+    region.bufferOffset = ringOffset;
+    region.bufferRowLength = 0;     // Данные идут плотно
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = mipLevel;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {std::max(size.width >> mipLevel, 1u), std::max(size.height >> mipLevel, 1u), 1};
+    commandBuffer->cmdCopyBufferToImage(_ringBuffer, dstImage, regions);
+
+    VulkanImageBarrierInfo barrier;
+    barrier.image = dstImage;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = finalLayout;
+    barrier.startMipmapLevel = mipLevel;
+    barrier.levelsCount = 1;
+    barrier.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.srcAccessBarrier = VK_ACCESS_TRANSFER_WRITE_BIT;
+    if (_ownershipTransfer) {
+        // Смена лаяута описывается одинаково в обоих барьерах
+        barrier.dstAccessBarrier = 0;
+        barrier.srcQueueFamilyIndex = _copyQueue->getFamilyIndex();
+        barrier.dstQueueFamilyIndex = _renderQueue->getFamilyIndex();
+        commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                          &barrier, 1, nullptr, 0, nullptr, 0);
+
+        VulkanImageBarrierInfo acquire = barrier;
+        acquire.srcAccessBarrier = 0;
+        acquire.dstAccessBarrier = dstAccess;
+        _currentAcquire.images.push_back(acquire);
+        _currentAcquire.dstStages |= dstStage;
+    }else{
+        barrier.dstAccessBarrier = dstAccess;
+        commandBuffer->cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage,
+                                          &barrier, 1, nullptr, 0, nullptr, 0);
+    }
+}
+
+// Отправка накопленных копирований, при передаче владения пачка сигналит свой семафор
+void VulkanStagingRing::flush(){
+    if ((_currentBatch == nullptr) || (_currentBatch->recording == false)) {
+        return;
+    }
+
+    _currentBatch->commandBuffer->end();
+    _currentBatch->recording = false;
+
+    // Семафор каждый раз новый: старый может еще ждать коммандный буффер отрисовки
+    VulkanSemaforePtr semaphore;
+    if (_ownershipTransfer) {
+        semaphore = std::make_shared<VulkanSemafore>(_device);
+    }
+
+    VkCommandBuffer commandBuffer = _currentBatch->commandBuffer->getBuffer();
+    VkSemaphore signalSemaphore = semaphore ? semaphore->getSemafore() : VK_NULL_HANDLE;
+    VkSubmitInfo submitInfo = {};
+    memset(&submitInfo, 0, sizeof(VkSubmitInfo));
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = semaphore ? 1 : 0;
+    submitInfo.pSignalSemaphores = semaphore ? &signalSemaphore : nullptr;
+
+    if (vkQueueSubmit(_copyQueue->getQueue(), 1, &submitInfo, _currentBatch->fence->getFence()) != VK_SUCCESS) {
+        LOG("Failed to submit staging ring command buffer!\n");
+        throw std::runtime_error("Failed to submit staging ring command buffer!");
+    }
+    _submitsCount++;
+
+    _inFlightBatches.push_back(_currentBatch);
+    _currentBatch = nullptr;
+
+    if (_ownershipTransfer) {
+        _currentAcquire.semaphore = semaphore;
+        _pendingAcquires.push_back(_currentAcquire);
+
+        _currentAcquire = PendingAcquire();
+        _currentAcquire.dstStages = 0;
+    }
+}
+
+// Захват владения в семействе отрисовки, ожидание семафора блокирует только стадии использования ресурсов
+void VulkanStagingRing::acquireUploaded(VulkanCommandBufferPtr renderBuffer, std::vector<VulkanSemaforePtr>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages){
+    for (size_t i = 0; i < _pendingAcquires.size(); i++) {
+        PendingAcquire& acquire = _pendingAcquires[i];
+        VkPipelineStageFlags stages = (acquire.dstStages != 0) ? acquire.dstStages : (VkPipelineStageFlags)VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        if ((acquire.buffers.empty() == false) || (acquire.images.empty() == false)) {
+            renderBuffer->cmdPipelineBarrier(stages, stages,
+                                             acquire.images.empty() ? nullptr : acquire.images.data(), static_cast<uint32_t>(acquire.images.size()),
+                                             acquire.buffers.empty() ? nullptr : acquire.buffers.data(), static_cast<uint32_t>(acquire.buffers.size()),
+                                             nullptr, 0);
+        }
+
+        waitSemaphores.push_back(acquire.semaphore);
+        waitStages.push_back(stages);
+    }
+    _pendingAcquires.clear();
+}
+
+// Освобождаем место от завершенных копирований без ожидания
+void VulkanStagingRing::update(){
+    while (_inFlightBatches.empty() == false) {
+        VkResult status = vkGetFenceStatus(_device->getDevice(), _inFlightBatches.front()->fence->getFence());
+        if (status != VK_SUCCESS) {
+            break;
+        }
+        retireBatch(false);
+    }
+}
+
+void VulkanStagingRing::waitIdle(){
+    flush();
+    while (_inFlightBatches.empty() == false) {
+        retireBatch(true);
+    }
+}
+
+void VulkanStagingRing::printStats() const{
+    LOG("Staging ring: %s, copy queue family %d, uploaded %.1fMB, submits %llu, ring stalls %llu (%.1fms), in flight batches %d\n",
+        _ownershipTransfer ? "dedicated transfer queue" : "render queue", (int)_copyQueue->getFamilyIndex(),
+        (double)_uploadedBytes / (1024.0 * 1024.0), (unsigned long long)_submitsCount,
+        (unsigned long long)_stallsCount, _stallsTime, (int)_inFlightBatches.size());
+}
+
+bool VulkanStagingRing::isOwnershipTransfer() const{
+    return _ownershipTransfer;
+}
+
+uint64_t VulkanStagingRing::getUploadedBytes() const{
+    return _uploadedBytes;
+}
+
+uint64_t VulkanStagingRing::getSubmitsCount() const{
+    return _submitsCount;
+}
+
+uint64_t VulkanStagingRing::getStallsCount() const{
+    return _stallsCount;
+}
+
+VulkanLogicalDevicePtr VulkanStagingRing::getBaseDevice() const{
+    return _device;
+}
+
+VulkanQueuePtr VulkanStagingRing::getBaseTransferQueue() const{
+    return _transferQueue;
+}
+
+VulkanQueuePtr VulkanStagingRing::getBaseRenderQueue() const{
+    return _renderQueue;
+}
+
+size_t VulkanStagingRing::getBaseRingSize() const{
+    return _ringSize;
+}
+
+// Выделяем место в кольце, если его нету - отправляем текущую пачку и ждем самую старую
+VkDeviceSize VulkanStagingRing::allocate(VkDeviceSize size){
+    while (true) {
+        VkDeviceSize offset = ((_ringHead + _alignment - 1) / _alignment) * _alignment;
+        VkDeviceSize padding = offset - _ringHead;
+        if ((offset + size) > _ringSize) {
+            // Хвост кольца пропускаем
+            padding = _ringSize - _ringHead;
+            offset = 0;
+        }
+
+        if ((_ringUsed + padding + size) <= _ringSize) {
+            Batch& batch = beginBatch();
+            batch.ringBytes += padding + size;
+            _ringUsed += padding + size;
+            _ringHead = offset + size;
+            return offset;
+        }
+
+        std::chrono::high_resolution_clock::time_point stallBegin = std::chrono::high_resolution_clock::now();
+
+        flush();
+        retireBatch(true);
+
+        _stallsCount++;
+        _stallsTime += (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - stallBegin).count() / 1000.0;
+    }
+    return 0;
+}
+
+VulkanStagingRing::Batch& VulkanStagingRing::beginBatch(){
+    if (_currentBatch == nullptr) {
+        if (_freeBatches.empty()) {
+            _currentBatch = std::make_shared<Batch>();
+            _currentBatch->commandBuffer = std::make_shared<VulkanCommandBuffer>(_device, _commandPool);
+            _currentBatch->fence = std::make_shared<VulkanFence>(_device, false);
+        }else{
+            _currentBatch = _freeBatches.back();
+            _freeBatches.pop_back();
+        }
+        _currentBatch->ringBytes = 0;
+        _currentBatch->recording = false;
+    }
+
+    if (_currentBatch->recording == false) {
+        _currentBatch->commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        _currentBatch->recording = true;
+    }
+
+    return *_currentBatch;
+}
+
+// Пачки завершаются в порядке отправки, поэтому место в кольце освобождается с хвоста
+void VulkanStagingRing::retireBatch(bool wait){
+    if (_inFlightBatches.empty()) {
+        return;
+    }
+
+    BatchPtr batch = _inFlightBatches.front();
+    if (wait) {
+        batch->fence->waitAndReset();
+    }else{
+        VkFence fence = batch->fence->getFence();
+        vkResetFences(_device->getDevice(), 1, &fence);
+    }
+    _inFlightBatches.pop_front();
+
+    _ringUsed -= batch->ringBytes;
+    batch->ringBytes = 0;
+    if (_ringUsed == 0) {
+        _ringHead = 0;
+    }
+
+    _freeBatches.push_back(batch);
+}
@@ -0,0 +1,103 @@
+#ifndef VULKAN_STAGING_RING_H
+#define VULKAN_STAGING_RING_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandPool.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanFence.h"
+#include "VulkanSemafore.h"
+
+
+// Кольцевой staging буффер для потоковой загрузки данных на GPU.
+// Приемники не должны читаться отрисовкой, пока в них идет копирование.
+// Если есть выделенная очередь копирования - копирование идет в ней, владение ресурсами передается в семейство отрисовки:
+// барьер освобождения пишется в буффер копирования, барьер захвата - в коммандный буффер отрисовки через acquireUploaded().
+// Без выделенной очереди копирование отправляется в очередь отрисовки перед кадром
+class VulkanStagingRing {
+public:
+    // transferQueue == nullptr - копируем в очереди отрисовки
+    VulkanStagingRing(VulkanLogicalDevicePtr device, VulkanQueuePtr transferQueue, VulkanQueuePtr renderQueue, size_t ringSize = 64 * 1024 * 1024);
+    ~VulkanStagingRing();
+    // Копирование в буффер, большие данные режутся на куски по размеру кольца
+    void uploadBuffer(VulkanBufferPtr dstBuffer, const void* data, size_t dataSize, VkDeviceSize dstOffset,
+                      VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+    // Копирование в уровень мипмапа картинки, после загрузки картинка будет в лаяуте finalLayout
+    void uploadImage(VulkanImagePtr dstImage, const void* data, size_t dataSize, uint32_t mipLevel, VkImageLayout finalLayout,
+                     VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+    // Отправка накопленных копирований
+    void flush();
+    // Записываем в коммандный буффер отрисовки захват владения отправленными ресурсами,
+    // этот буффер нужно отправлять с ожиданием семафоров waitSemaphores на стадиях waitStages
+    void acquireUploaded(VulkanCommandBufferPtr renderBuffer, std::vector<VulkanSemaforePtr>& waitSemaphores, std::vector<VkPipelineStageFlags>& waitStages);
+    // Освобождаем место от завершенных копирований без ожидания
+    void update();
+    void waitIdle();
+    void printStats() const;
+    bool isOwnershipTransfer() const;
+    uint64_t getUploadedBytes() const;
+    uint64_t getSubmitsCount() const;
+    uint64_t getStallsCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VulkanQueuePtr getBaseTransferQueue() const;
+    VulkanQueuePtr getBaseRenderQueue() const;
+    size_t getBaseRingSize() const;
+
+private:
+    struct Batch {
+        VulkanCommandBufferPtr commandBuffer;
+        VulkanFencePtr fence;
+        VkDeviceSize ringBytes;     // Занятое пачкой место в кольце вместе с выравниванием
+        bool recording;
+    };
+    typedef std::shared_ptr<Batch> BatchPtr;
+
+    // Захват владения, который еще не записан в буффер отрисовки
+    struct PendingAcquire {
+        VulkanSemaforePtr semaphore;
+        std::vector<VulkanBufferBarrierInfo> buffers;
+        std::vector<VulkanImageBarrierInfo> images;
+        VkPipelineStageFlags dstStages;
+    };
+
+    VulkanLogicalDevicePtr _device;
+    VulkanQueuePtr _transferQueue;
+    VulkanQueuePtr _renderQueue;
+    size_t _ringSize;
+    VulkanQueuePtr _copyQueue;      // Очередь, в которой реально идет копирование
+    bool _ownershipTransfer;
+    VulkanCommandPoolPtr _commandPool;
+    VulkanBufferPtr _ringBuffer;
+    char* _ringData;
+    VkDeviceSize _alignment;
+    VkDeviceSize _ringHead;
+    VkDeviceSize _ringUsed;
+    BatchPtr _currentBatch;
+    PendingAcquire _currentAcquire;
+    std::deque<BatchPtr> _inFlightBatches;
+    std::vector<BatchPtr> _freeBatches;
+    std::vector<PendingAcquire> _pendingAcquires;
+    uint64_t _uploadedBytes;
+    uint64_t _submitsCount;
+    uint64_t _stallsCount;
+    double _stallsTime;
+
+private:
+    VkDeviceSize allocate(VkDeviceSize size);
+    Batch& beginBatch();
+    void retireBatch(bool wait);
+};
+
+typedef std::shared_ptr<VulkanStagingRing> VulkanStagingRingPtr;
+
+#endif
@@ -0,0 +1,457 @@
+#include "VulkanTextureBatchLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stb_image.h>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+typedef std::chrono::high_resolution_clock BatchClock;
+
+static double getSecondsSince(const BatchClock::time_point& begin){
+    return std::chrono::duration<double>(BatchClock::now() - begin).count();
+}
+
+static bool hasPathExtension(const std::string& path, const char* extension){
+    size_t length = strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    std::string pathExtension = path.substr(path.size() - length);
+    std::transform(pathExtension.begin(), pathExtension.end(), pathExtension.begin(), ::tolower);
+    return pathExtension == extension;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureBatchStats::VulkanTextureBatchStats():
+    texturesCount(0),
+    threadsCount(0),
+    flushesCount(0),
+    inputBytes(0),
+    decodedBytes(0),
+    decodeTime(0.0),
+    stallTime(0.0),
+    uploadTime(0.0),
+    totalTime(0.0){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureBatchLoader::VulkanTextureBatchLoader(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool,
+                                                   uint32_t threadsCount, size_t stagingSize):
+    _device(device),
+    _queue(queue),
+    _pool(pool),
+    _threadsCount(threadsCount),
+    _stagingSize(stagingSize),
+    _stagingData(nullptr),
+    _alignment(16),
+    _paths(nullptr),
+    _stagingHead(0),
+    _writingCount(0),
+    _waitingCount(0),
+    _finishedCount(0),
+    _readFinished(false),
+    _flushing(false),
+    _failed(false){
+
+    if (_threadsCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        _threadsCount = (hardwareThreads > 1) ? (hardwareThreads - 1) : 1;
+    }
+
+    // Буффер мапится один раз, потоки декодирования пишут в него напрямую
+    _stagingBuffer = std::make_shared<VulkanBuffer>(_device,
+                                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                    _stagingSize);
+    _stagingData = _stagingBuffer->map(_stagingSize, 0);
+    if (_stagingData == nullptr) {
+        LOG("Failed to map texture staging buffer!\n");
+        throw std::runtime_error("Failed to map texture staging buffer!");
+    }
+
+    VkDeviceSize optimalAlignment = _device->getBasePhysicalDevice()->getDeviceProperties().limits.optimalBufferCopyOffsetAlignment;
+    _alignment = std::max(_alignment, optimalAlignment);
+}
+
+VulkanTextureBatchLoader::~VulkanTextureBatchLoader(){
+    _stagingBuffer->unmap();
+    _stagingBuffer = nullptr;
+}
+
+std::vector<VulkanImagePtr> VulkanTextureBatchLoader::loadTextures(const std::vector<std::string>& paths){
+    BatchClock::time_point beginTime = BatchClock::now();
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _paths = &paths;
+        _tasks.clear();
+        _decoded.clear();
+        _stagingHead = 0;
+        _writingCount = 0;
+        _waitingCount = 0;
+        _finishedCount = 0;
+        _readFinished = false;
+        _flushing = false;
+        _failed = false;
+        _errorText.clear();
+        _stats = VulkanTextureBatchStats();
+        _stats.texturesCount = static_cast<uint32_t>(paths.size());
+        _stats.threadsCount = _threadsCount;
+    }
+
+    std::vector<VulkanImagePtr> images(paths.size());
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread(&VulkanTextureBatchLoader::readThread, this));
+    for (uint32_t i = 0; i < _threadsCount; i++) {
+        threads.push_back(std::thread(&VulkanTextureBatchLoader::decodeThread, this));
+    }
+
+    // Отправляем копирование, когда потокам не хватает места в буффере или все декодировано.
+    // Буффер переиспользуется только когда в него никто не пишет
+    while (true) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _mainCondition.wait(lock, [this, &paths](){
+            bool allFinished = (_finishedCount == paths.size());
+            bool stagingFull = (_waitingCount > 0) && (_writingCount == 0) && (_decoded.empty() == false);
+            return _failed || allFinished || stagingFull;
+        });
+        if (_failed) {
+            break;
+        }
+        bool allFinished = (_finishedCount == paths.size());
+
+        // Пока идет отправка, новые куски буффера не выделяются
+        std::vector<DecodedTexture> decoded;
+        decoded.swap(_decoded);
+        _flushing = true;
+        lock.unlock();
+
+        flushDecoded(decoded, images);
+
+        lock.lock();
+        _stagingHead = 0;
+        _flushing = false;
+        lock.unlock();
+        _stagingCondition.notify_all();
+
+        if (allFinished) {
+            break;
+        }
+    }
+
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+    _paths = nullptr;
+
+    if (_failed) {
+        _decoded.clear();
+        LOG("Texture batch loading failed: %s\n", _errorText.c_str());
+        throw std::runtime_error("Texture batch loading failed: " + _errorText);
+    }
+
+    _stats.totalTime = getSecondsSince(beginTime);
+    return images;
+}
+
+// Поток чтения: держим в очереди не больше двух файлов на поток декодирования, чтобы не мапить сразу всю папку
+void VulkanTextureBatchLoader::readThread(){
+    size_t maxQueued = _threadsCount * 2;
+    for (size_t i = 0; i < _paths->size(); i++) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _readCondition.wait(lock, [this, maxQueued](){
+                return _failed || (_tasks.size() < maxQueued);
+            });
+            if (_failed) {
+                break;
+            }
+        }
+
+        AssetFilePtr file = mapFile((*_paths)[i]);
+        if (file == nullptr) {
+            fail("Failed to read " + (*_paths)[i]);
+            break;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            DecodeTask task;
+            task.index = i;
+            task.file = file;
+            _tasks.push_back(task);
+            _stats.inputBytes += file->getSize();
+        }
+        _tasksCondition.notify_one();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _readFinished = true;
+    }
+    _tasksCondition.notify_all();
+}
+
+void VulkanTextureBatchLoader::decodeThread(){
+    while (true) {
+        DecodeTask task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tasksCondition.wait(lock, [this](){
+                return _failed || _readFinished || (_tasks.empty() == false);
+            });
+            if (_failed || _tasks.empty()) {
+                return;
+            }
+            task = _tasks.front();
+            _tasks.pop_front();
+        }
+        _readCondition.notify_one();
+
+        // Декодирование без блокировки
+        BatchClock::time_point decodeBegin = BatchClock::now();
+        VulkanTextureData textureData;
+        unsigned char* pixels = nullptr;
+        DecodedTexture decoded;
+        decoded.index = task.index;
+        VkDeviceSize dataSize = 0;
+        try {
+            decodeTexture(task, textureData, pixels);
+            decoded.format = textureData.format;
+            decoded.size = textureData.size;
+            decoded.generateMips = (pixels != nullptr);
+            dataSize = makePackedCopyRegions(decoded.format, decoded.size, static_cast<uint32_t>(textureData.levels.size()), 1, decoded.regions);
+            
+            // Текстура больше всего staging буффера - временный буффер только для нее
+            if (dataSize > _stagingSize) {
+                decoded.ownBuffer = std::make_shared<VulkanBuffer>(_device,
+                                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                   dataSize);
+            }
+        } catch (const std::exception& e) {
+            if (pixels) {
+                stbi_image_free(pixels);
+            }
+            fail((*_paths)[task.index] + ": " + e.what());
+            return;
+        }
+        task.file = nullptr;
+        double decodeTime = getSecondsSince(decodeBegin);
+        uint32_t levelsCount = static_cast<uint32_t>(textureData.levels.size());
+
+        // Место в staging буффере, при нехватке ждем отправки накопленного
+        char* dstData = nullptr;
+        VkDeviceSize stagingOffset = 0;
+        double stallTime = 0.0;
+        if (decoded.ownBuffer) {
+            dstData = decoded.ownBuffer->map(dataSize, 0);
+        } else {
+            std::unique_lock<std::mutex> lock(_mutex);
+            VkDeviceSize offset = (_stagingHead + _alignment - 1) / _alignment * _alignment;
+            if (_flushing || (offset + dataSize > _stagingSize)) {
+                BatchClock::time_point stallBegin = BatchClock::now();
+                _waitingCount++;
+                _mainCondition.notify_one();
+                _stagingCondition.wait(lock, [this, &offset, dataSize](){
+                    offset = (_stagingHead + _alignment - 1) / _alignment * _alignment;
+                    return _failed || ((_flushing == false) && (offset + dataSize <= _stagingSize));
+                });
+                _waitingCount--;
+                stallTime = getSecondsSince(stallBegin);
+                if (_failed) {
+                    if (pixels) {
+                        stbi_image_free(pixels);
+                    }
+                    return;
+                }
+            }
+            _stagingHead = offset + dataSize;
+            _writingCount++;
+            stagingOffset = offset;
+            dstData = _stagingData + offset;
+        }
+
+        // Запись в буффер тоже идет параллельно, смещения регионов пока относительно начала куска
+        for (uint32_t i = 0; i < levelsCount; i++) {
+            const unsigned char* srcData = pixels ? pixels : textureData.data.data() + textureData.levels[i].offset;
+            size_t copySize = std::min(textureData.levels[i].size, getTextureLevelSize(decoded.format, textureData.levels[i].extent));
+            memcpy(dstData + decoded.regions[i].bufferOffset, srcData, copySize);
+            decoded.regions[i].bufferOffset += stagingOffset;
+        }
+        if (pixels) {
+            stbi_image_free(pixels);
+        }
+        if (decoded.ownBuffer) {
+            decoded.ownBuffer->unmap();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (decoded.ownBuffer == nullptr) {
+                _writingCount--;
+            }
+            _stats.decodedBytes += dataSize;
+            _stats.decodeTime += decodeTime;
+            _stats.stallTime += stallTime;
+            _decoded.push_back(decoded);
+            _finishedCount++;
+        }
+        _mainCondition.notify_one();
+    }
+}
+
+void VulkanTextureBatchLoader::decodeTexture(const DecodeTask& task, VulkanTextureData& textureData, unsigned char*& pixels){
+    const std::string& path = (*_paths)[task.index];
+    AssetFileView file = task.file->getView();
+
+    // Контейнеры уже содержат все уровни в формате GPU
+    if (hasPathExtension(path, ".ktx2")) {
+        parseKTX2(file.data, file.size, textureData);
+        return;
+    }
+    if (hasPathExtension(path, ".dds")) {
+        parseDDS(file.data, file.size, textureData);
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    pixels = stbi_load_from_memory(file.data, static_cast<int>(file.size), &width, &height, &channels, STBI_rgb_alpha);
+    if (pixels == nullptr) {
+        throw std::runtime_error("Failed to decode image");
+    }
+
+    VulkanTextureDataLevel level;
+    level.offset = 0;
+    level.extent = VkExtent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    level.size = static_cast<size_t>(width) * height * 4;
+    textureData.format = VK_FORMAT_R8G8B8A8_UNORM;
+    textureData.size = level.extent;
+    textureData.levels.push_back(level);
+}
+
+void VulkanTextureBatchLoader::fail(const std::string& text){
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_failed == false) {
+            _failed = true;
+            _errorText = text;
+        }
+    }
+    _tasksCondition.notify_all();
+    _readCondition.notify_all();
+    _stagingCondition.notify_all();
+    _mainCondition.notify_all();
+}
+
+// Все готовые текстуры одним коммандным буффером: создание картинок, копирование и мипмапы
+void VulkanTextureBatchLoader::flushDecoded(const std::vector<DecodedTexture>& decoded, std::vector<VulkanImagePtr>& images){
+    if (decoded.empty()) {
+        return;
+    }
+
+    BatchClock::time_point uploadBegin = BatchClock::now();
+
+    VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(_device, _pool);
+    for (const DecodedTexture& texture: decoded) {
+        uint32_t mipmapLevels = static_cast<uint32_t>(texture.regions.size());
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (texture.generateMips) {
+            mipmapLevels = (uint32_t)floor(log2(std::max(texture.size.width, texture.size.height))) + 1;
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
+        VulkanImagePtr image = std::make_shared<VulkanImage>(_device,
+                                                             texture.size,
+                                                             texture.format,
+                                                             VK_IMAGE_TILING_OPTIMAL,
+                                                             VK_IMAGE_LAYOUT_UNDEFINED,
+                                                             usage,
+                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                             mipmapLevels);
+
+        transitionImageLayout(commandBuffer,
+                              image,
+                              VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              0, mipmapLevels,
+                              VK_IMAGE_ASPECT_COLOR_BIT,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              0,
+                              VK_ACCESS_TRANSFER_WRITE_BIT);
+        commandBuffer->cmdCopyBufferToImage(texture.ownBuffer ? texture.ownBuffer : _stagingBuffer, image, texture.regions);
+
+        if (texture.generateMips && (mipmapLevels > 1)) {
+            generateMipmapsForImage(commandBuffer, image);
+        } else {
+            transitionImageLayout(commandBuffer,
+                                  image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  0, mipmapLevels,
+                                  VK_IMAGE_ASPECT_COLOR_BIT,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  VK_ACCESS_SHADER_READ_BIT);
+        }
+
+        images[texture.index] = image;
+    }
+    endAndQueueWaitSingleTimeCommands(commandBuffer, _queue);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stats.flushesCount++;
+    _stats.uploadTime += getSecondsSince(uploadBegin);
+}
+
+// Файл мапится только на чтение, чтение страниц идет уже в потоке декодирования
+AssetFilePtr VulkanTextureBatchLoader::mapFile(const std::string& path){
+    // Текстуры мапим всегда, даже маленькие: поток чтения не должен ждать диск
+    AssetFilePtr file = AssetFile::tryOpen(path, 0);
+    if (file) {
+        // Файл читается целиком и по порядку, заранее просим ядро подгрузить страницы
+        file->adviseSequential();
+        file->prefetch();
+    }
+    return file;
+}
+
+VulkanTextureBatchStats VulkanTextureBatchLoader::getLastStats() const{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void VulkanTextureBatchLoader::printStats() const{
+    VulkanTextureBatchStats stats = getLastStats();
+    double inputMegabytes = double(stats.inputBytes) / (1024.0 * 1024.0);
+    double decodedMegabytes = double(stats.decodedBytes) / (1024.0 * 1024.0);
+    LOG("Texture batch: %d textures, %d threads, files %.1f MB, decoded %.1f MB in %.1f ms (%.0f MB/s decoded), "
+        "decode CPU time %.1f ms, staging stalls %.1f ms, upload %.1f ms in %d flushes\n",
+        (int)stats.texturesCount, (int)stats.threadsCount, inputMegabytes, decodedMegabytes,
+        stats.totalTime * 1000.0, (stats.totalTime > 0.0) ? decodedMegabytes / stats.totalTime : 0.0,
+        stats.decodeTime * 1000.0, stats.stallTime * 1000.0, stats.uploadTime * 1000.0, (int)stats.flushesCount);
+}
+
+uint32_t VulkanTextureBatchLoader::getThreadsCount() const{
+    return _threadsCount;
+}
+
+VulkanLogicalDevicePtr VulkanTextureBatchLoader::getBaseDevice() const{
+    return _device;
+}
+
+size_t VulkanTextureBatchLoader::getBaseStagingSize() const{
+    return _stagingSize;
+}
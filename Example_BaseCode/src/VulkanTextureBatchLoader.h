@@ -0,0 +1,114 @@
+#ifndef VULKAN_TEXTURE_BATCH_LOADER_H
+#define VULKAN_TEXTURE_BATCH_LOADER_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandPool.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanTextureLoader.h"
+#include "AssetFile.h"
+
+
+// Статистика последней загрузки
+struct VulkanTextureBatchStats {
+    uint32_t texturesCount;
+    uint32_t threadsCount;
+    uint32_t flushesCount;      // Отправок копирования на GPU
+    uint64_t inputBytes;        // Размер файлов
+    uint64_t decodedBytes;      // Размер данных для GPU после декодирования
+    double decodeTime;          // Суммарное время декодирования во всех потоках
+    double stallTime;           // Ожидание потоками места в staging буффере
+    double uploadTime;          // Запись копирований и ожидание GPU в вызывающем потоке
+    double totalTime;
+
+    VulkanTextureBatchStats();
+};
+
+// Параллельная загрузка пачки текстур:
+// поток чтения мапит файлы -> потоки декодирования (stb_image, KTX2/DDS) пишут результат сразу в свой кусок
+// замапленного staging буффера -> вызывающий поток одной командой на текстуру копирует все готовые текстуры,
+// когда буффер заполнился или файлы кончились. Картинки из stb_image получают мипмапы блитом, как в createTextureImage
+class VulkanTextureBatchLoader {
+public:
+    // threadsCount == 0 - число ядер минус один (вызывающий поток занят отправкой копирований)
+    VulkanTextureBatchLoader(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool,
+                             uint32_t threadsCount = 0, size_t stagingSize = 64 * 1024 * 1024);
+    ~VulkanTextureBatchLoader();
+    // Текстуры в порядке путей, готовы к чтению в шейдере. Ошибка чтения или декодирования - исключение
+    std::vector<VulkanImagePtr> loadTextures(const std::vector<std::string>& paths);
+    VulkanTextureBatchStats getLastStats() const;
+    void printStats() const;
+    uint32_t getThreadsCount() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    size_t getBaseStagingSize() const;
+
+private:
+    struct DecodeTask {
+        size_t index;
+        AssetFilePtr file;      // Замаплен потоком чтения
+    };
+
+    // Декодированная текстура, данные уже лежат в staging буффере
+    struct DecodedTexture {
+        size_t index;
+        VkFormat format;
+        VkExtent2D size;
+        bool generateMips;
+        std::vector<VkBufferImageCopy> regions;     // Смещения уже с учетом места в буффере
+        VulkanBufferPtr ownBuffer;                  // Текстура больше staging буффера - свой временный буффер
+    };
+
+    VulkanLogicalDevicePtr _device;
+    VulkanQueuePtr _queue;
+    VulkanCommandPoolPtr _pool;
+    uint32_t _threadsCount;
+    size_t _stagingSize;
+    VulkanBufferPtr _stagingBuffer;
+    char* _stagingData;
+    VkDeviceSize _alignment;
+
+    // Состояние текущей загрузки, защищено _mutex
+    mutable std::mutex _mutex;
+    std::condition_variable _tasksCondition;    // Появились задачи декодирования или закончилось чтение
+    std::condition_variable _readCondition;     // Освободилось место в очереди декодирования
+    std::condition_variable _stagingCondition;  // Staging буффер отправлен и освобожден
+    std::condition_variable _mainCondition;     // Есть работа для вызывающего потока
+    const std::vector<std::string>* _paths;
+    std::deque<DecodeTask> _tasks;
+    std::vector<DecodedTexture> _decoded;
+    VkDeviceSize _stagingHead;
+    uint32_t _writingCount;     // Потоки, которые сейчас пишут в staging буффер
+    uint32_t _waitingCount;     // Потоки, которым не хватило места
+    size_t _finishedCount;
+    bool _readFinished;
+    bool _flushing;             // Вызывающий поток отправляет копирование из staging буффера
+    bool _failed;
+    std::string _errorText;
+    VulkanTextureBatchStats _stats;
+
+private:
+    void readThread();
+    void decodeThread();
+    // Уровни для контейнеров попадают в textureData.data, картинка stb_image - в pixels (освобождается через stbi_image_free)
+    void decodeTexture(const DecodeTask& task, VulkanTextureData& textureData, unsigned char*& pixels);
+    void fail(const std::string& text);
+    void flushDecoded(const std::vector<DecodedTexture>& decoded, std::vector<VulkanImagePtr>& images);
+    static AssetFilePtr mapFile(const std::string& path);
+};
+
+typedef std::shared_ptr<VulkanTextureBatchLoader> VulkanTextureBatchLoaderPtr;
+
+#endif
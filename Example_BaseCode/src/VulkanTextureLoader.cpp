@@ -0,0 +1,613 @@
+#include "VulkanTextureLoader.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <stb_image.h>
+#include "VulkanHelpers.h"
+#include "VulkanBuffer.h"
+#include "Helpers.h"
+#include "AssetFile.h"
+
+
+// Значения из заголовков форматов, данные в файлах всегда little-endian
+static const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const size_t KTX2_HEADER_SIZE = 80;              // Идентификатор + заголовок + индекс
+static const size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;   // byteOffset, byteLength, uncompressedByteLength
+static const uint32_t DDS_MAGIC = 0x20534444;           // "DDS "
+static const size_t DDS_HEADER_SIZE = 4 + 124;
+static const size_t DDS_HEADER_DX10_SIZE = 20;
+static const uint32_t DDS_PIXELFORMAT_FOURCC = 0x4;
+static const size_t TEXTURE_PEEK_SIZE = 256;            // Хватает для заголовков обоих контейнеров
+
+static uint32_t makeFourCC(char a, char b, char c, char d){
+    return (uint32_t)(unsigned char)a | ((uint32_t)(unsigned char)b << 8) | ((uint32_t)(unsigned char)c << 16) | ((uint32_t)(unsigned char)d << 24);
+}
+
+static uint32_t readUint32(const unsigned char* bytes, size_t offset){
+    uint32_t value = 0;
+    memcpy(&value, bytes + offset, sizeof(uint32_t));
+    return value;
+}
+
+static uint64_t readUint64(const unsigned char* bytes, size_t offset){
+    uint64_t value = 0;
+    memcpy(&value, bytes + offset, sizeof(uint64_t));
+    return value;
+}
+
+// Полная цепочка мипмапов, больше уровней в файле быть не может
+static uint32_t getMaxLevelsCount(uint32_t width, uint32_t height){
+    return (uint32_t)floor(log2(std::max(width, height))) + 1;
+}
+
+static bool hasExtension(const std::string& path, const std::string& extension){
+    if (path.size() < extension.size()) {
+        return false;
+    }
+    std::string end = path.substr(path.size() - extension.size());
+    std::transform(end.begin(), end.end(), end.begin(), ::tolower);
+    return end == extension;
+}
+
+// Формат из DXGI_FORMAT заголовка DX10, поддерживаются только BC и RGBA8
+static VkFormat dxgiToVkFormat(uint32_t dxgiFormat){
+    switch (dxgiFormat) {
+        case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+        case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+        case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+        case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+        case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+        case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+        case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+        case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+        case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+        case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+        case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+        default: return VK_FORMAT_UNDEFINED;
+    }
+}
+
+// Старые DDS без заголовка DX10
+static VkFormat fourCCToVkFormat(uint32_t fourCC){
+    if (fourCC == makeFourCC('D', 'X', 'T', '1')) return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    if (fourCC == makeFourCC('D', 'X', 'T', '3')) return VK_FORMAT_BC2_UNORM_BLOCK;
+    if (fourCC == makeFourCC('D', 'X', 'T', '5')) return VK_FORMAT_BC3_UNORM_BLOCK;
+    if (fourCC == makeFourCC('A', 'T', 'I', '1')) return VK_FORMAT_BC4_UNORM_BLOCK;
+    if (fourCC == makeFourCC('B', 'C', '4', 'U')) return VK_FORMAT_BC4_UNORM_BLOCK;
+    if (fourCC == makeFourCC('A', 'T', 'I', '2')) return VK_FORMAT_BC5_UNORM_BLOCK;
+    if (fourCC == makeFourCC('B', 'C', '5', 'U')) return VK_FORMAT_BC5_UNORM_BLOCK;
+    return VK_FORMAT_UNDEFINED;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureDataLevel::VulkanTextureDataLevel():
+    offset(0),
+    size(0),
+    extent(VkExtent2D{0, 0}){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureData::VulkanTextureData():
+    format(VK_FORMAT_UNDEFINED),
+    size(VkExtent2D{0, 0}){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool getTextureFormatBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes){
+    blockWidth = 1;
+    blockHeight = 1;
+    blockBytes = 0;
+    
+    // ASTC: блок всегда 16 байт, размеры идут парами UNORM/SRGB
+    if ((format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK) && (format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)) {
+        static const uint32_t astcBlocks[14][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6},
+                                                   {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+        uint32_t index = (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2;
+        blockWidth = astcBlocks[index][0];
+        blockHeight = astcBlocks[index][1];
+        blockBytes = 16;
+        return true;
+    }
+    
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            blockWidth = 4;
+            blockHeight = 4;
+            blockBytes = 8;
+            return true;
+            
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+            blockWidth = 4;
+            blockHeight = 4;
+            blockBytes = 16;
+            return true;
+            
+        case VK_FORMAT_R8_UNORM:
+            blockBytes = 1;
+            return true;
+        case VK_FORMAT_R8G8_UNORM:
+            blockBytes = 2;
+            return true;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            blockBytes = 4;
+            return true;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            blockBytes = 8;
+            return true;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            blockBytes = 16;
+            return true;
+            
+        default:
+            return false;
+    }
+}
+
+size_t getTextureLevelSize(VkFormat format, VkExtent2D size){
+    uint32_t blockWidth = 1;
+    uint32_t blockHeight = 1;
+    uint32_t blockBytes = 0;
+    if (getTextureFormatBlockInfo(format, blockWidth, blockHeight, blockBytes) == false) {
+        LOG("Unknown texture format %d!\n", (int)format);
+        throw std::runtime_error("Unknown texture format!");
+    }
+    size_t blocksX = (size.width + blockWidth - 1) / blockWidth;
+    size_t blocksY = (size.height + blockHeight - 1) / blockHeight;
+    return std::max(blocksX, (size_t)1) * std::max(blocksY, (size_t)1) * blockBytes;
+}
+
+VkDeviceSize makePackedCopyRegions(VkFormat format, VkExtent2D size, uint32_t levelsCount, uint32_t layersCount, std::vector<VkBufferImageCopy>& regions){
+    uint32_t blockWidth = 1;
+    uint32_t blockHeight = 1;
+    uint32_t blockBytes = 0;
+    if (getTextureFormatBlockInfo(format, blockWidth, blockHeight, blockBytes) == false) {
+        LOG("Unknown texture format %d!\n", (int)format);
+        throw std::runtime_error("Unknown texture format!");
+    }
+    // Все поддерживаемые размеры блоков - степени двойки, поэтому НОК с 4 - просто максимум
+    VkDeviceSize alignment = std::max(blockBytes, 4u);
+    
+    regions.clear();
+    regions.reserve(levelsCount);
+    VkDeviceSize offset = 0;
+    for (uint32_t i = 0; i < levelsCount; i++) {
+        VkExtent2D levelSize = VkExtent2D{std::max(size.width >> i, 1u), std::max(size.height >> i, 1u)};
+        offset = (offset + alignment - 1) / alignment * alignment;
+        
+        VkBufferImageCopy region = {};
+        memset(&region, 0, sizeof(VkBufferImageCopy));
+        region.bufferOffset = offset;
+        region.bufferRowLength = 0;     // Блоки идут плотно
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = layersCount;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {levelSize.width, levelSize.height, 1};
+        regions.push_back(region);
+        
+        offset += getTextureLevelSize(format, levelSize) * layersCount;
+    }
+    return offset;
+}
+
+bool isTextureFormatSupported(VkPhysicalDevice device, VkFormat format){
+    if (format == VK_FORMAT_UNDEFINED) {
+        return false;
+    }
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(device, format, &properties);
+    return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+void parseKTX2(const unsigned char* bytes, size_t bytesCount, VulkanTextureData& result, bool headerOnly){
+    if ((bytesCount < KTX2_HEADER_SIZE) || (memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)) {
+        LOG("Invalid KTX2 header!\n");
+        throw std::runtime_error("Invalid KTX2 header!");
+    }
+    
+    uint32_t vkFormat = readUint32(bytes, 12);
+    uint32_t pixelWidth = readUint32(bytes, 20);
+    uint32_t pixelHeight = readUint32(bytes, 24);
+    uint32_t pixelDepth = readUint32(bytes, 28);
+    uint32_t layerCount = readUint32(bytes, 32);
+    uint32_t faceCount = readUint32(bytes, 36);
+    uint32_t levelCount = std::max(readUint32(bytes, 40), 1u);  // 0 - мипмапы нужно генерировать, есть только базовый уровень
+    uint32_t supercompressionScheme = readUint32(bytes, 44);
+    
+    // Basis Universal и суперкомпрессия требуют транскодера, здесь только форматы, которые понимает GPU
+    if ((vkFormat == VK_FORMAT_UNDEFINED) || (supercompressionScheme != 0)) {
+        LOG("KTX2 supercompression or basis formats are not supported!\n");
+        throw std::runtime_error("KTX2 supercompression or basis formats are not supported!");
+    }
+    if ((pixelHeight == 0) || (pixelDepth > 1) || (layerCount > 1) || (faceCount != 1)) {
+        LOG("Only 2D KTX2 textures are supported!\n");
+        throw std::runtime_error("Only 2D KTX2 textures are supported!");
+    }
+    if (pixelWidth == 0) {
+        LOG("Invalid KTX2 texture size!\n");
+        throw std::runtime_error("Invalid KTX2 texture size!");
+    }
+    levelCount = std::min(levelCount, getMaxLevelsCount(pixelWidth, pixelHeight));
+    
+    result.format = static_cast<VkFormat>(vkFormat);
+    result.size = VkExtent2D{pixelWidth, pixelHeight};
+    result.levels.clear();
+    result.data.clear();
+    if (headerOnly) {
+        return;
+    }
+    
+    if (bytesCount < KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_INDEX_ENTRY_SIZE) {
+        LOG("Invalid KTX2 level index!\n");
+        throw std::runtime_error("Invalid KTX2 level index!");
+    }
+    
+    // Уровни в файле могут лежать в любом порядке, копируем плотно начиная с самого большого
+    size_t totalSize = 0;
+    for (uint32_t i = 0; i < levelCount; i++) {
+        size_t entryOffset = KTX2_HEADER_SIZE + i * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        uint64_t byteOffset = readUint64(bytes, entryOffset);
+        uint64_t byteLength = readUint64(bytes, entryOffset + 8);
+        // Уровень короче своего размера в блоках формата - файл обрезан или поврежден
+        VkExtent2D extent = VkExtent2D{std::max(pixelWidth >> i, 1u), std::max(pixelHeight >> i, 1u)};
+        if ((byteOffset > bytesCount) || (byteLength > bytesCount - byteOffset) || (byteLength < getTextureLevelSize(result.format, extent))) {
+            LOG("Invalid KTX2 level %d!\n", (int)i);
+            throw std::runtime_error("Invalid KTX2 level!");
+        }
+        
+        VulkanTextureDataLevel level;
+        level.offset = totalSize;
+        level.size = (size_t)byteLength;
+        level.extent = extent;
+        result.levels.push_back(level);
+        totalSize += level.size;
+    }
+    
+    result.data.resize(totalSize);
+    for (uint32_t i = 0; i < levelCount; i++) {
+        uint64_t byteOffset = readUint64(bytes, KTX2_HEADER_SIZE + i * KTX2_LEVEL_INDEX_ENTRY_SIZE);
+        memcpy(result.data.data() + result.levels[i].offset, bytes + byteOffset, result.levels[i].size);
+    }
+}
+
+void parseDDS(const unsigned char* bytes, size_t bytesCount, VulkanTextureData& result, bool headerOnly){
+    if ((bytesCount < DDS_HEADER_SIZE) || (readUint32(bytes, 0) != DDS_MAGIC) || (readUint32(bytes, 4) != 124)) {
+        LOG("Invalid DDS header!\n");
+        throw std::runtime_error("Invalid DDS header!");
+    }
+    
+    uint32_t height = readUint32(bytes, 12);
+    uint32_t width = readUint32(bytes, 16);
+    uint32_t mipMapCount = std::max(readUint32(bytes, 28), 1u);
+    uint32_t pixelFormatFlags = readUint32(bytes, 80);
+    uint32_t fourCC = readUint32(bytes, 84);
+    if ((width == 0) || (height == 0)) {
+        LOG("Invalid DDS texture size!\n");
+        throw std::runtime_error("Invalid DDS texture size!");
+    }
+    mipMapCount = std::min(mipMapCount, getMaxLevelsCount(width, height));
+    
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    size_t dataOffset = DDS_HEADER_SIZE;
+    if ((pixelFormatFlags & DDS_PIXELFORMAT_FOURCC) && (fourCC == makeFourCC('D', 'X', '1', '0'))) {
+        if (bytesCount < DDS_HEADER_SIZE + DDS_HEADER_DX10_SIZE) {
+            LOG("Invalid DDS DX10 header!\n");
+            throw std::runtime_error("Invalid DDS DX10 header!");
+        }
+        uint32_t arraySize = readUint32(bytes, DDS_HEADER_SIZE + 12);
+        if (arraySize > 1) {
+            LOG("DDS texture arrays are not supported!\n");
+            throw std::runtime_error("DDS texture arrays are not supported!");
+        }
+        format = dxgiToVkFormat(readUint32(bytes, DDS_HEADER_SIZE));
+        dataOffset += DDS_HEADER_DX10_SIZE;
+    }else if (pixelFormatFlags & DDS_PIXELFORMAT_FOURCC) {
+        format = fourCCToVkFormat(fourCC);
+    }
+    
+    if (format == VK_FORMAT_UNDEFINED) {
+        LOG("Unsupported DDS pixel format!\n");
+        throw std::runtime_error("Unsupported DDS pixel format!");
+    }
+    
+    result.format = format;
+    result.size = VkExtent2D{width, height};
+    result.levels.clear();
+    result.data.clear();
+    if (headerOnly) {
+        return;
+    }
+    
+    // В DDS уровни лежат подряд от самого большого, размер считаем по формату
+    size_t totalSize = 0;
+    for (uint32_t i = 0; i < mipMapCount; i++) {
+        VulkanTextureDataLevel level;
+        level.offset = totalSize;
+        level.extent = VkExtent2D{std::max(width >> i, 1u), std::max(height >> i, 1u)};
+        level.size = getTextureLevelSize(format, level.extent);
+        result.levels.push_back(level);
+        totalSize += level.size;
+    }
+    if ((dataOffset > bytesCount) || (totalSize > bytesCount - dataOffset)) {
+        LOG("DDS file is truncated!\n");
+        throw std::runtime_error("DDS file is truncated!");
+    }
+    result.data.assign(bytes + dataOffset, bytes + dataOffset + totalSize);
+}
+
+VulkanTextureData loadTextureData(const std::string& path){
+    AssetFile file(path);
+    file.adviseSequential();
+    AssetFileView bytes = file.getView();
+    
+    VulkanTextureData result;
+    if (hasExtension(path, ".ktx2")) {
+        parseKTX2(bytes.data, bytes.size, result);
+    }else if (hasExtension(path, ".dds")) {
+        parseDDS(bytes.data, bytes.size, result);
+    }else{
+        LOG("Unknown texture container %s!\n", path.c_str());
+        throw std::runtime_error("Unknown texture container!");
+    }
+    return result;
+}
+
+bool peekTextureData(const std::string& path, VulkanTextureData& result){
+    bool isKTX2 = hasExtension(path, ".ktx2");
+    bool isDDS = hasExtension(path, ".dds");
+    if ((isKTX2 == false) && (isDDS == false)) {
+        return false;
+    }
+    
+    // Большой файл только мапится, с диска читаются лишь страницы заголовка
+    AssetFilePtr file = AssetFile::tryOpen(path);
+    if (file == nullptr) {
+        return false;
+    }
+    AssetFileView bytes = file->getView().subview(0, TEXTURE_PEEK_SIZE);
+    
+    if (isKTX2) {
+        parseKTX2(bytes.data, bytes.size, result, true);
+    }else{
+        parseDDS(bytes.data, bytes.size, result, true);
+    }
+    return true;
+}
+
+VulkanTextureData loadImageTextureData(const std::string& path){
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    AssetFile file(path);
+    stbi_uc* pixels = stbi_load_from_memory(file.getData(), static_cast<int>(file.getSize()), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        LOG("Failed to load texture image %s!\n", path.c_str());
+        throw std::runtime_error("Failed to load texture image!");
+    }
+    
+    VulkanTextureData result;
+    result.format = VK_FORMAT_R8G8B8A8_UNORM;
+    result.size = VkExtent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    
+    // Размеры и смещения всех уровней до 1x1
+    VkExtent2D extent = result.size;
+    size_t totalSize = 0;
+    while (true) {
+        VulkanTextureDataLevel level;
+        level.offset = totalSize;
+        level.size = static_cast<size_t>(extent.width) * extent.height * 4;
+        level.extent = extent;
+        result.levels.push_back(level);
+        totalSize += level.size;
+        if ((extent.width == 1) && (extent.height == 1)) {
+            break;
+        }
+        extent.width = std::max(extent.width / 2, 1u);
+        extent.height = std::max(extent.height / 2, 1u);
+    }
+    result.data.resize(totalSize);
+    memcpy(result.data.data(), pixels, result.levels[0].size);
+    stbi_image_free(pixels);
+    
+    // Каждый уровень из предыдущего, у нечетных размеров последний столбец/строка просто отбрасываются
+    for (size_t i = 1; i < result.levels.size(); i++) {
+        const VulkanTextureDataLevel& src = result.levels[i - 1];
+        const VulkanTextureDataLevel& dst = result.levels[i];
+        const unsigned char* srcData = result.data.data() + src.offset;
+        unsigned char* dstData = result.data.data() + dst.offset;
+        for (uint32_t y = 0; y < dst.extent.height; y++) {
+            uint32_t y0 = std::min(y * 2, src.extent.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, src.extent.height - 1);
+            for (uint32_t x = 0; x < dst.extent.width; x++) {
+                uint32_t x0 = std::min(x * 2, src.extent.width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, src.extent.width - 1);
+                for (uint32_t c = 0; c < 4; c++) {
+                    uint32_t sum = srcData[(y0 * src.extent.width + x0) * 4 + c] + srcData[(y0 * src.extent.width + x1) * 4 + c] +
+                                   srcData[(y1 * src.extent.width + x0) * 4 + c] + srcData[(y1 * src.extent.width + x1) * 4 + c];
+                    dstData[(y * dst.extent.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+    
+    return result;
+}
+
+VulkanTextureData loadTextureDataFromCandidates(VkPhysicalDevice device, const std::vector<std::string>& paths){
+    for (const std::string& path: paths) {
+        bool isContainer = hasExtension(path, ".ktx2") || hasExtension(path, ".dds");
+        if (isContainer) {
+            VulkanTextureData header;
+            if (peekTextureData(path, header) == false) {
+                continue;
+            }
+            if (isTextureFormatSupported(device, header.format) == false) {
+                LOG("Texture %s skipped: format %d is not supported\n", path.c_str(), (int)header.format);
+                continue;
+            }
+            return loadTextureData(path);
+        }
+        
+        std::ifstream file(path, std::ios::binary);
+        if (file.is_open()) {
+            file.close();
+            return loadImageTextureData(path);
+        }
+    }
+    
+    LOG("No suitable texture found!\n");
+    throw std::runtime_error("No suitable texture found!");
+}
+
+VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool, const VulkanTextureData& textureData){
+    if (textureData.levels.empty()) {
+        LOG("Texture data has no levels!\n");
+        throw std::runtime_error("Texture data has no levels!");
+    }
+    
+    std::chrono::high_resolution_clock::time_point beginTime = std::chrono::high_resolution_clock::now();
+    
+    // Все уровни одним буффером с выравниванием смещений, сжатые данные копируются как есть
+    uint32_t levelsCount = static_cast<uint32_t>(textureData.levels.size());
+    std::vector<VkBufferImageCopy> regions;
+    VkDeviceSize stagingSize = makePackedCopyRegions(textureData.format, textureData.size, levelsCount, 1, regions);
+    
+    VulkanBufferPtr stagingBuffer = std::make_shared<VulkanBuffer>(device,
+                                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                   stagingSize);
+    char* stagingData = stagingBuffer->map(stagingSize);
+    for (uint32_t i = 0; i < levelsCount; i++) {
+        const VulkanTextureDataLevel& level = textureData.levels[i];
+        size_t copySize = getTextureLevelSize(textureData.format, level.extent);
+        if (level.size < copySize) {
+            stagingBuffer->unmap();
+            LOG("Texture level %d is smaller than its format size!\n", (int)i);
+            throw std::runtime_error("Texture level is smaller than its format size!");
+        }
+        memcpy(stagingData + regions[i].bufferOffset, textureData.data.data() + level.offset, copySize);
+    }
+    stagingBuffer->unmap();
+    
+    VulkanImagePtr resultImage = std::make_shared<VulkanImage>(device,
+                                                               textureData.size,
+                                                               textureData.format,
+                                                               VK_IMAGE_TILING_OPTIMAL,
+                                                               VK_IMAGE_LAYOUT_UNDEFINED,
+                                                               VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                               levelsCount);
+    
+    std::chrono::high_resolution_clock::time_point copyTime = std::chrono::high_resolution_clock::now();
+    
+    VulkanCommandBufferPtr commandBuffer = beginSingleTimeCommands(device, pool);
+    transitionImageLayout(commandBuffer,
+                          resultImage,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          0, levelsCount,
+                          VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          0,
+                          VK_ACCESS_TRANSFER_WRITE_BIT);
+    commandBuffer->cmdCopyBufferToImage(stagingBuffer, resultImage, regions);
+    transitionImageLayout(commandBuffer,
+                          resultImage,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          0, levelsCount,
+                          VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_ACCESS_SHADER_READ_BIT);
+    endAndQueueWaitSingleTimeCommands(commandBuffer, queue);
+    
+    // Заполнение staging буффера на CPU и копирование на GPU с ожиданием отдельно
+    std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+    double fillSeconds = std::chrono::duration<double>(copyTime - beginTime).count();
+    double copySeconds = std::chrono::duration<double>(endTime - copyTime).count();
+    double megabytes = double(stagingSize) / (1024.0 * 1024.0);
+    LOG("Texture upload: %.2f MB, %d levels, staging fill %.2f ms (%.0f MB/s), buffer to image copy %.2f ms (%.0f MB/s)\n",
+        megabytes, (int)levelsCount,
+        fillSeconds * 1000.0, (fillSeconds > 0.0) ? megabytes / fillSeconds : 0.0,
+        copySeconds * 1000.0, (copySeconds > 0.0) ? megabytes / copySeconds : 0.0);
+    
+    return resultImage;
+}
+
+VulkanImagePtr createTextureImageFromCandidates(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool, const std::vector<std::string>& paths){
+    VkPhysicalDevice physicalDevice = device->getBasePhysicalDevice()->getDevice();
+    
+    for (const std::string& path: paths) {
+        bool isContainer = hasExtension(path, ".ktx2") || hasExtension(path, ".dds");
+        if (isContainer) {
+            VulkanTextureData header;
+            if (peekTextureData(path, header) == false) {
+                continue;
+            }
+            if (isTextureFormatSupported(physicalDevice, header.format) == false) {
+                LOG("Texture %s skipped: format %d is not supported\n", path.c_str(), (int)header.format);
+                continue;
+            }
+            
+            VulkanTextureData textureData = loadTextureData(path);
+            LOG("Texture %s loaded: format %d, %dx%d, %d levels, %.1f KB\n", path.c_str(), (int)textureData.format,
+                (int)textureData.size.width, (int)textureData.size.height, (int)textureData.levels.size(), textureData.data.size() / 1024.0);
+            return createTextureImage(device, queue, pool, textureData);
+        }
+        
+        // Обычная картинка - декодирование на CPU и генерация мипмапов
+        std::ifstream file(path, std::ios::binary);
+        if (file.is_open()) {
+            file.close();
+            LOG("Texture %s loaded as uncompressed RGBA8\n", path.c_str());
+            return createTextureImage(device, queue, pool, path);
+        }
+    }
+    
+    LOG("No suitable texture found!\n");
+    throw std::runtime_error("No suitable texture found!");
+}
@@ -0,0 +1,71 @@
+#ifndef VULKAN_TEXTURE_LOADER_H
+#define VULKAN_TEXTURE_LOADER_H
+
+#include <vector>
+#include <string>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanCommandPool.h"
+#include "VulkanQueue.h"
+#include "VulkanImage.h"
+
+
+// Уровень мипмапа внутри данных текстуры
+struct VulkanTextureDataLevel {
+    size_t offset;
+    size_t size;
+    VkExtent2D extent;
+    
+    VulkanTextureDataLevel();
+};
+
+// Содержимое контейнера KTX2/DDS: формат как есть (в том числе BC/ETC2/ASTC) и все уровни мипмапов, начиная с самого большого
+struct VulkanTextureData {
+    VkFormat format;
+    VkExtent2D size;
+    std::vector<VulkanTextureDataLevel> levels;
+    std::vector<unsigned char> data;
+    
+    VulkanTextureData();
+};
+
+// Размер блока формата в текселях и байтах, для несжатых форматов блок 1x1.
+// Возвращает false для неизвестных форматов
+bool getTextureFormatBlockInfo(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes);
+
+// Размер уровня в байтах при плотной упаковке блоков
+size_t getTextureLevelSize(VkFormat format, VkExtent2D size);
+
+// Регионы копирования буффер -> картинка для всех уровней и слоев, один регион на уровень.
+// Уровни идут подряд, слои уровня лежат плотно друг за другом. Смещения уровней выровнены по размеру блока и 4 байтам,
+// как требует vkCmdCopyBufferToImage. Возвращает нужный размер буффера
+VkDeviceSize makePackedCopyRegions(VkFormat format, VkExtent2D size, uint32_t levelsCount, uint32_t layersCount, std::vector<VkBufferImageCopy>& regions);
+
+// Можно ли семплировать формат из текстуры с оптимальным тайлингом
+bool isTextureFormatSupported(VkPhysicalDevice device, VkFormat format);
+
+// Разбор контейнеров, при headerOnly заполняются только формат и размер
+void parseKTX2(const unsigned char* bytes, size_t bytesCount, VulkanTextureData& result, bool headerOnly = false);
+void parseDDS(const unsigned char* bytes, size_t bytesCount, VulkanTextureData& result, bool headerOnly = false);
+
+// Загрузка контейнера с диска, тип выбирается по расширению (.ktx2, .dds)
+VulkanTextureData loadTextureData(const std::string& path);
+// Только формат и размер, без чтения всего файла. false - файла нет или это не KTX2/DDS
+bool peekTextureData(const std::string& path, VulkanTextureData& result);
+// Обычная картинка через stb_image в RGBA8, мипмапы считаются на CPU усреднением 2x2
+VulkanTextureData loadImageTextureData(const std::string& path);
+// Данные первого подходящего кандидата, правила выбора как у createTextureImageFromCandidates
+VulkanTextureData loadTextureDataFromCandidates(VkPhysicalDevice device, const std::vector<std::string>& paths);
+
+// Создание текстуры из готовых уровней: все мипмапы одной командой копирования из staging буффера
+VulkanImagePtr createTextureImage(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool, const VulkanTextureData& textureData);
+
+// Берется первый существующий файл, формат которого поддерживается устройством.
+// Пути кроме .ktx2/.dds грузятся через stb_image с генерацией мипмапов, поэтому их стоит ставить последними
+VulkanImagePtr createTextureImageFromCandidates(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VulkanCommandPoolPtr pool, const std::vector<std::string>& paths);
+
+#endif
@@ -0,0 +1,403 @@
+#include "VulkanTextureStreamer.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include "VulkanHelpers.h"
+#include "Helpers.h"
+
+
+VulkanStreamedTexture::VulkanStreamedTexture():
+    _residentLevel(0),
+    _requestedLevel(0),
+    _tailLevel(0),
+    _lastUsedFrame(0),
+    _residentBytes(0){
+}
+
+VulkanImagePtr VulkanStreamedTexture::getImage() const{
+    return _image;
+}
+
+VulkanImageViewPtr VulkanStreamedTexture::getImageView() const{
+    return _imageView;
+}
+
+uint32_t VulkanStreamedTexture::getResidentLevel() const{
+    return _residentLevel;
+}
+
+uint32_t VulkanStreamedTexture::getRequestedLevel() const{
+    return _requestedLevel;
+}
+
+uint32_t VulkanStreamedTexture::getTailLevel() const{
+    return _tailLevel;
+}
+
+uint32_t VulkanStreamedTexture::getLevelsCount() const{
+    return static_cast<uint32_t>(_data.levels.size());
+}
+
+VkDeviceSize VulkanStreamedTexture::getResidentBytes() const{
+    return _residentBytes;
+}
+
+VkExtent2D VulkanStreamedTexture::getBaseSize() const{
+    return _data.size;
+}
+
+VkFormat VulkanStreamedTexture::getBaseFormat() const{
+    return _data.format;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureStreamerStats::VulkanTextureStreamerStats():
+    uploadsCount(0),
+    evictionsCount(0),
+    uploadedBytes(0),
+    budgetLimitedCount(0){
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanTextureStreamer::VulkanTextureStreamer(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VkDeviceSize memoryBudget,
+                                             uint32_t tailSize, VkDeviceSize frameUploadLimit):
+    _device(device),
+    _queue(queue),
+    _memoryBudget(memoryBudget),
+    _tailSize(tailSize),
+    _frameUploadLimit(frameUploadLimit),
+    _frameIndex(0),
+    _residentBytes(0),
+    _uploadingBytes(0){
+
+    // Свой пул: коммандные буфферы загрузок живут до срабатывания забора, а не до конца кадра
+    _pool = std::make_shared<VulkanCommandPool>(_device, _queue->getFamilyIndex());
+}
+
+VulkanTextureStreamer::~VulkanTextureStreamer(){
+    waitIdle();
+}
+
+VulkanStreamedTexturePtr VulkanTextureStreamer::addTexture(const VulkanTextureData& data){
+    if (data.levels.empty()) {
+        LOG("Streamed texture data has no levels!\n");
+        throw std::runtime_error("Streamed texture data has no levels!");
+    }
+
+    VulkanStreamedTexturePtr texture = std::make_shared<VulkanStreamedTexture>();
+    texture->_data = data;
+
+    // Хвост - первый уровень, который целиком влезает в tailSize
+    uint32_t levelsCount = texture->getLevelsCount();
+    texture->_tailLevel = levelsCount - 1;
+    for (uint32_t i = 0; i < levelsCount; i++) {
+        VkExtent2D extent = data.levels[i].extent;
+        if (std::max(extent.width, extent.height) <= _tailSize) {
+            texture->_tailLevel = i;
+            break;
+        }
+    }
+    texture->_residentLevel = texture->_tailLevel;
+    texture->_requestedLevel = texture->_tailLevel;
+    texture->_lastUsedFrame = _frameIndex;
+
+    // Хвост нужен до первого кадра, ждем сразу
+    texture->_upload = startUpload(texture, texture->_tailLevel);
+    texture->_upload->fence->waitAndReset();
+    finishUpload(texture);
+
+    _textures.push_back(texture);
+    return texture;
+}
+
+void VulkanTextureStreamer::removeTexture(const VulkanStreamedTexturePtr& texture){
+    std::vector<VulkanStreamedTexturePtr>::iterator it = std::find(_textures.begin(), _textures.end(), texture);
+    if (it == _textures.end()) {
+        return;
+    }
+
+    if (texture->_upload) {
+        texture->_upload->fence->waitAndReset();
+        _uploadingBytes -= texture->_upload->bytes;
+        texture->_upload = nullptr;
+    }
+    _residentBytes -= texture->_residentBytes;
+    _textures.erase(it);
+}
+
+void VulkanTextureStreamer::requestLevel(const VulkanStreamedTexturePtr& texture, uint32_t level){
+    level = std::min(level, texture->_tailLevel);
+    if (texture->_lastUsedFrame != _frameIndex) {
+        texture->_requestedLevel = level;
+        texture->_lastUsedFrame = _frameIndex;
+    }else{
+        texture->_requestedLevel = std::min(texture->_requestedLevel, level);
+    }
+}
+
+void VulkanTextureStreamer::update(){
+    // Подхватываем завершенные загрузки
+    for (const VulkanStreamedTexturePtr& texture: _textures) {
+        if (texture->_upload) {
+            VkResult status = vkGetFenceStatus(_device->getDevice(), texture->_upload->fence->getFence());
+            if (status == VK_SUCCESS) {
+                finishUpload(texture);
+            }
+        }
+    }
+
+    // Кандидаты на повышение - текстуры, запрошенные в этом кадре детальнее, чем загружены
+    std::vector<VulkanStreamedTexturePtr> upgrades;
+    for (const VulkanStreamedTexturePtr& texture: _textures) {
+        if ((texture->_upload == nullptr) && (texture->_lastUsedFrame == _frameIndex) && (texture->_requestedLevel < texture->_residentLevel)) {
+            upgrades.push_back(texture);
+        }
+    }
+
+    // Сначала те, у кого разница с нужным уровнем больше всего
+    std::sort(upgrades.begin(), upgrades.end(), [](const VulkanStreamedTexturePtr& a, const VulkanStreamedTexturePtr& b){
+        return (a->_residentLevel - a->_requestedLevel) > (b->_residentLevel - b->_requestedLevel);
+    });
+
+    VkDeviceSize frameBytes = 0;
+    for (const VulkanStreamedTexturePtr& texture: upgrades) {
+        // Уровень, который влезает в лимит загрузки за кадр. Одна загрузка за кадр проходит всегда
+        uint32_t level = texture->_requestedLevel;
+        VkDeviceSize bytes = getLevelsBytes(texture, level);
+        while ((frameBytes > 0) && (level < texture->_residentLevel) && ((frameBytes + bytes) > _frameUploadLimit)) {
+            level++;
+            bytes = getLevelsBytes(texture, level);
+        }
+        if (level >= texture->_residentLevel) {
+            break;
+        }
+
+        // Старая картинка живет до конца загрузки, поэтому новая учитывается целиком
+        VkDeviceSize available = getAvailableBytes();
+        if (bytes > available) {
+            evictForBytes(bytes - available, texture);
+            // Вытеснение само запускает загрузки уменьшенных картинок, память освободится только после их подмены
+            available = getAvailableBytes();
+            while ((level < texture->_residentLevel) && (bytes > available)) {
+                level++;
+                bytes = getLevelsBytes(texture, level);
+            }
+            _stats.budgetLimitedCount++;
+            if (level >= texture->_residentLevel) {
+                continue;
+            }
+        }
+
+        texture->_upload = startUpload(texture, level);
+        frameBytes += texture->_upload->bytes;
+    }
+
+    _frameIndex++;
+}
+
+void VulkanTextureStreamer::waitIdle(){
+    for (const VulkanStreamedTexturePtr& texture: _textures) {
+        if (texture->_upload) {
+            texture->_upload->fence->waitAndReset();
+            finishUpload(texture);
+        }
+    }
+}
+
+void VulkanTextureStreamer::printStats() const{
+    uint32_t fullCount = 0;
+    for (const VulkanStreamedTexturePtr& texture: _textures) {
+        if (texture->_residentLevel == 0) {
+            fullCount++;
+        }
+    }
+    LOG("Texture streaming: %d textures (%d fully resident), %.2f MB of %.2f MB budget, %d uploads (%.2f MB), %d evictions, %d budget limited\n",
+        (int)_textures.size(), (int)fullCount,
+        _residentBytes / (1024.0 * 1024.0), _memoryBudget / (1024.0 * 1024.0),
+        (int)_stats.uploadsCount, _stats.uploadedBytes / (1024.0 * 1024.0),
+        (int)_stats.evictionsCount, (int)_stats.budgetLimitedCount);
+}
+
+VulkanTextureStreamerStats VulkanTextureStreamer::getStats() const{
+    return _stats;
+}
+
+VkDeviceSize VulkanTextureStreamer::getResidentBytes() const{
+    return _residentBytes;
+}
+
+VulkanLogicalDevicePtr VulkanTextureStreamer::getBaseDevice() const{
+    return _device;
+}
+
+VkDeviceSize VulkanTextureStreamer::getBaseMemoryBudget() const{
+    return _memoryBudget;
+}
+
+uint32_t VulkanTextureStreamer::computeDesiredLevel(VkExtent2D textureSize, float objectSize, float distance, float fovY, uint32_t screenHeight){
+    if (distance <= 0.0f) {
+        return 0;
+    }
+
+    // Размер объекта на экране в пикселях
+    float screenPixels = objectSize / (2.0f * distance * tanf(fovY * 0.5f)) * static_cast<float>(screenHeight);
+    float texels = static_cast<float>(std::max(textureSize.width, textureSize.height));
+    if (screenPixels >= texels) {
+        return 0;
+    }
+    if (screenPixels < 1.0f) {
+        screenPixels = 1.0f;
+    }
+    return static_cast<uint32_t>(floorf(log2f(texels / screenPixels)));
+}
+
+// Оценка по плотной упаковке, реальный размер картинки известен только после создания
+VkDeviceSize VulkanTextureStreamer::getLevelsBytes(const VulkanStreamedTexturePtr& texture, uint32_t level) const{
+    VkDeviceSize bytes = 0;
+    for (size_t i = level; i < texture->_data.levels.size(); i++) {
+        bytes += getTextureLevelSize(texture->_data.format, texture->_data.levels[i].extent);
+    }
+    return bytes;
+}
+
+VkDeviceSize VulkanTextureStreamer::getAvailableBytes() const{
+    VkDeviceSize usedBytes = _residentBytes + _uploadingBytes;
+    return (_memoryBudget > usedBytes) ? (_memoryBudget - usedBytes) : 0;
+}
+
+VulkanStreamedTexture::UploadPtr VulkanTextureStreamer::startUpload(const VulkanStreamedTexturePtr& texture, uint32_t level){
+    const VulkanTextureData& data = texture->_data;
+    uint32_t levelsCount = texture->getLevelsCount() - level;
+    VkExtent2D size = data.levels[level].extent;
+
+    // Уровни [level, end) одним буффером, уровень level становится нулевым у новой картинки
+    std::vector<VkBufferImageCopy> regions;
+    VkDeviceSize stagingSize = makePackedCopyRegions(data.format, size, levelsCount, 1, regions);
+
+    VulkanStreamedTexture::UploadPtr upload = std::make_shared<VulkanStreamedTexture::Upload>();
+    upload->level = level;
+    upload->stagingBuffer = std::make_shared<VulkanBuffer>(_device,
+                                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                                           VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                           stagingSize);
+    char* stagingData = upload->stagingBuffer->map(stagingSize);
+    for (uint32_t i = 0; i < levelsCount; i++) {
+        const VulkanTextureDataLevel& dataLevel = data.levels[level + i];
+        size_t copySize = std::min(dataLevel.size, getTextureLevelSize(data.format, dataLevel.extent));
+        memcpy(stagingData + regions[i].bufferOffset, data.data.data() + dataLevel.offset, copySize);
+    }
+    upload->stagingBuffer->unmap();
+
+    upload->image = std::make_shared<VulkanImage>(_device,
+                                                  size,
+                                                  data.format,
+                                                  VK_IMAGE_TILING_OPTIMAL,
+                                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                  levelsCount);
+    upload->bytes = upload->image->getMemoryRequirements().size;
+
+    upload->commandBuffer = std::make_shared<VulkanCommandBuffer>(_device, _pool);
+    upload->commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    transitionImageLayout(upload->commandBuffer,
+                          upload->image,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          0, levelsCount,
+                          VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          0,
+                          VK_ACCESS_TRANSFER_WRITE_BIT);
+    upload->commandBuffer->cmdCopyBufferToImage(upload->stagingBuffer, upload->image, regions);
+    transitionImageLayout(upload->commandBuffer,
+                          upload->image,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          0, levelsCount,
+                          VK_IMAGE_ASPECT_COLOR_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                          VK_ACCESS_TRANSFER_WRITE_BIT,
+                          VK_ACCESS_SHADER_READ_BIT);
+    upload->commandBuffer->end();
+
+    // Без ожидания, готовность проверяется забором в update()
+    upload->fence = std::make_shared<VulkanFence>(_device, false);
+    VkCommandBuffer commandBuffer = upload->commandBuffer->getBuffer();
+    VkSubmitInfo submitInfo = {};
+    memset(&submitInfo, 0, sizeof(VkSubmitInfo));
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if (vkQueueSubmit(_queue->getQueue(), 1, &submitInfo, upload->fence->getFence()) != VK_SUCCESS) {
+        LOG("Failed to submit texture streaming command buffer!\n");
+        throw std::runtime_error("Failed to submit texture streaming command buffer!");
+    }
+
+    _uploadingBytes += upload->bytes;
+    _stats.uploadsCount++;
+    _stats.uploadedBytes += stagingSize;
+    return upload;
+}
+
+void VulkanTextureStreamer::finishUpload(const VulkanStreamedTexturePtr& texture){
+    VulkanStreamedTexture::UploadPtr upload = texture->_upload;
+    texture->_upload = nullptr;
+
+    // Старая картинка освободится вместе с последним кадром, который ее использует.
+    // Новая считается резидентной только с момента подмены
+    _uploadingBytes -= upload->bytes;
+    _residentBytes -= texture->_residentBytes;
+    _residentBytes += upload->bytes;
+    texture->_image = upload->image;
+    texture->_imageView = std::make_shared<VulkanImageView>(_device, upload->image, VK_IMAGE_ASPECT_COLOR_BIT);
+    texture->_residentLevel = upload->level;
+    texture->_residentBytes = upload->bytes;
+}
+
+// Опускаем к хвосту давно не запрошенные текстуры, пока не наберется bytes памяти.
+// Память освобождается после завершения загрузок уменьшенных картинок, поэтому уже идущие уменьшения тоже учитываются
+bool VulkanTextureStreamer::evictForBytes(VkDeviceSize bytes, const VulkanStreamedTexturePtr& except){
+    VkDeviceSize pendingBytes = 0;
+    std::vector<VulkanStreamedTexturePtr> candidates;
+    for (const VulkanStreamedTexturePtr& texture: _textures) {
+        if (texture->_upload) {
+            if (texture->_upload->level > texture->_residentLevel) {
+                pendingBytes += texture->_residentBytes - std::min(texture->_residentBytes, texture->_upload->bytes);
+            }
+            continue;
+        }
+        if (texture == except) {
+            continue;
+        }
+
+        // Запрошенные в этом кадре текстуры не опускаются ниже запроса
+        uint32_t floorLevel = (texture->_lastUsedFrame == _frameIndex) ? texture->_requestedLevel : texture->_tailLevel;
+        if (texture->_residentLevel < floorLevel) {
+            candidates.push_back(texture);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const VulkanStreamedTexturePtr& a, const VulkanStreamedTexturePtr& b){
+        return a->_lastUsedFrame < b->_lastUsedFrame;
+    });
+
+    for (const VulkanStreamedTexturePtr& texture: candidates) {
+        if (pendingBytes >= bytes) {
+            break;
+        }
+        uint32_t floorLevel = (texture->_lastUsedFrame == _frameIndex) ? texture->_requestedLevel : texture->_tailLevel;
+        VkDeviceSize oldBytes = texture->_residentBytes;
+        texture->_upload = startUpload(texture, floorLevel);
+        pendingBytes += oldBytes - std::min(oldBytes, texture->_upload->bytes);
+        _stats.evictionsCount++;
+    }
+
+    return pendingBytes >= bytes;
+}
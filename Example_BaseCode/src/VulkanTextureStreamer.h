@@ -0,0 +1,127 @@
+#ifndef VULKAN_TEXTURE_STREAMER_H
+#define VULKAN_TEXTURE_STREAMER_H
+
+#include <memory>
+#include <vector>
+
+// GLFW include
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "VulkanLogicalDevice.h"
+#include "VulkanQueue.h"
+#include "VulkanCommandPool.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanImageView.h"
+#include "VulkanFence.h"
+#include "VulkanTextureLoader.h"
+
+
+// Текстура с частично загруженной цепочкой мипмапов.
+// На GPU лежит картинка только с уровнями [residentLevel, levelsCount), размером уровня residentLevel.
+// Семплер, рассчитанный на полную цепочку, работает с любой резидентностью: LOD ограничивается числом уровней картинки
+class VulkanStreamedTexture {
+    friend class VulkanTextureStreamer;
+public:
+    VulkanStreamedTexture();
+    // Картинка и вью меняются при смене резидентности, их нужно брать заново каждый кадр
+    VulkanImagePtr getImage() const;
+    VulkanImageViewPtr getImageView() const;
+    uint32_t getResidentLevel() const;
+    uint32_t getRequestedLevel() const;
+    uint32_t getTailLevel() const;
+    uint32_t getLevelsCount() const;
+    VkDeviceSize getResidentBytes() const;
+    VkExtent2D getBaseSize() const;
+    VkFormat getBaseFormat() const;
+
+private:
+    // Загрузка новой картинки, после срабатывания забора подменяет текущую
+    struct Upload {
+        uint32_t level;
+        VulkanImagePtr image;
+        VulkanBufferPtr stagingBuffer;
+        VulkanCommandBufferPtr commandBuffer;
+        VulkanFencePtr fence;
+        VkDeviceSize bytes;
+    };
+    typedef std::shared_ptr<Upload> UploadPtr;
+
+    VulkanTextureData _data;
+    VulkanImagePtr _image;
+    VulkanImageViewPtr _imageView;
+    uint32_t _residentLevel;
+    uint32_t _requestedLevel;   // Минимум из запросов за кадр
+    uint32_t _tailLevel;        // Хвост цепочки не выгружается никогда
+    uint64_t _lastUsedFrame;
+    VkDeviceSize _residentBytes;
+    UploadPtr _upload;
+};
+
+typedef std::shared_ptr<VulkanStreamedTexture> VulkanStreamedTexturePtr;
+
+// Статистика стриминга
+struct VulkanTextureStreamerStats {
+    uint64_t uploadsCount;
+    uint64_t evictionsCount;
+    uint64_t uploadedBytes;
+    uint64_t budgetLimitedCount;    // Сколько раз повышение уровня урезалось бюджетом
+
+    VulkanTextureStreamerStats();
+};
+
+// Потоковая подгрузка мипмапов текстур.
+// Текстура стартует с хвоста цепочки (уровни не больше tailSize), старшие уровни грузятся по запросам requestLevel():
+// запросы считаются на CPU по размеру объекта на экране (computeDesiredLevel) или берутся из буффера обратной связи GPU.
+// Резидентные данные всех текстур держатся в рамках бюджета памяти: давно не запрошенные текстуры опускаются обратно к хвосту.
+// Смена уровня - новая картинка нужного размера, данные копируются из staging буффера асинхронно, подмена - после забора.
+// Старая картинка живет, пока на нее ссылаются коммандные буфферы и наборы дескрипторов кадров в полете
+class VulkanTextureStreamer {
+public:
+    VulkanTextureStreamer(VulkanLogicalDevicePtr device, VulkanQueuePtr queue, VkDeviceSize memoryBudget,
+                          uint32_t tailSize = 128, VkDeviceSize frameUploadLimit = 16 * 1024 * 1024);
+    ~VulkanTextureStreamer();
+    // Хвост цепочки загружается сразу с ожиданием
+    VulkanStreamedTexturePtr addTexture(const VulkanTextureData& data);
+    void removeTexture(const VulkanStreamedTexturePtr& texture);
+    // Нужный текстуре уровень в этом кадре, несколько запросов за кадр - берется самый детальный
+    void requestLevel(const VulkanStreamedTexturePtr& texture, uint32_t level);
+    // Раз в кадр: подхватываем завершенные загрузки, вытесняем лишнее, запускаем новые загрузки
+    void update();
+    void waitIdle();
+    void printStats() const;
+    VulkanTextureStreamerStats getStats() const;
+    VkDeviceSize getResidentBytes() const;
+    VulkanLogicalDevicePtr getBaseDevice() const;
+    VkDeviceSize getBaseMemoryBudget() const;
+
+    // Уровень, при котором тексель примерно равен пикселю: objectSize - размер объекта в мире,
+    // distance - расстояние до камеры, fovY - вертикальный угол обзора в радианах
+    static uint32_t computeDesiredLevel(VkExtent2D textureSize, float objectSize, float distance, float fovY, uint32_t screenHeight);
+
+private:
+    VulkanLogicalDevicePtr _device;
+    VulkanQueuePtr _queue;
+    VulkanCommandPoolPtr _pool;
+    VkDeviceSize _memoryBudget;
+    uint32_t _tailSize;
+    VkDeviceSize _frameUploadLimit;
+    std::vector<VulkanStreamedTexturePtr> _textures;
+    uint64_t _frameIndex;
+    VkDeviceSize _residentBytes;    // Картинки, уже подмененные у текстур
+    VkDeviceSize _uploadingBytes;   // Картинки загрузок в полете, память под них уже выделена
+    VulkanTextureStreamerStats _stats;
+
+private:
+    VkDeviceSize getLevelsBytes(const VulkanStreamedTexturePtr& texture, uint32_t level) const;
+    VkDeviceSize getAvailableBytes() const;
+    VulkanStreamedTexture::UploadPtr startUpload(const VulkanStreamedTexturePtr& texture, uint32_t level);
+    void finishUpload(const VulkanStreamedTexturePtr& texture);
+    bool evictForBytes(VkDeviceSize bytes, const VulkanStreamedTexturePtr& except);
+};
+
+typedef std::shared_ptr<VulkanTextureStreamer> VulkanTextureStreamerPtr;
+
+#endif
@@ -0,0 +1,300 @@
+// Сборка ассетов в один архив для AssetArchive: заголовок, индекс по хешам путей и данные с границы 4 KB.
+// Запускается из папки примера, пути в архиве - как их передает код: res/shaders/model_shader_vert.spv
+//
+// AssetPacker [-o assets.pak] [--lz4] [--min-ratio 0.9] [--ext .spv,.obj] inputs...
+//
+// Входы - файлы или папки (рекурсивно). С --lz4 запись сжимается, только если сжатая версия
+// не больше min-ratio от исходной - иначе распаковка при загрузке не окупается
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <algorithm>
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+#include "AssetArchiveFormat.h"
+
+
+struct PackSettings {
+    std::string outputPath;
+    bool lz4;
+    double minRatio;
+    std::vector<std::string> extensions;    // Пустой - берем все файлы
+    
+    PackSettings():
+        outputPath("assets.pak"),
+        lz4(false),
+        minRatio(0.9){
+    }
+};
+
+struct PackEntry {
+    std::string path;
+    AssetArchiveEntry entry;
+    std::vector<unsigned char> data;    // Уже в том виде, в каком ляжет в архив
+};
+
+static void printUsage(){
+    printf("Usage: AssetPacker [-o output] [--lz4] [--min-ratio value] [--ext .a,.b] inputs...\n");
+    printf("    -o            output archive, assets.pak by default\n");
+    printf("    --lz4         compress entries with LZ4 where it pays off\n");
+    printf("    --min-ratio   max compressed/original size to keep compression, 0.9 by default\n");
+    printf("    --ext         comma separated list of file extensions to pack, all files by default\n");
+}
+
+static bool hasAnyExtension(const std::string& path, const std::vector<std::string>& extensions){
+    if (extensions.empty()) {
+        return true;
+    }
+    for (const std::string& extension: extensions) {
+        if ((path.size() >= extension.size()) && (path.compare(path.size() - extension.size(), extension.size(), extension) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Файлы папки рекурсивно, скрытые файлы и папки пропускаются
+static void collectFiles(const std::string& path, std::vector<std::string>& result){
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES) {
+        return;
+    }
+    if ((attributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+        result.push_back(path);
+        return;
+    }
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((path + "\\*").c_str(), &findData);
+    if (findHandle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (findData.cFileName[0] != '.') {
+            collectFiles(path + "/" + findData.cFileName, result);
+        }
+    } while (FindNextFileA(findHandle, &findData));
+    FindClose(findHandle);
+#else
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0) {
+        return;
+    }
+    if (S_ISREG(fileStat.st_mode)) {
+        result.push_back(path);
+        return;
+    }
+    if (S_ISDIR(fileStat.st_mode) == false) {
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            collectFiles(path + "/" + entry->d_name, result);
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+static bool readWholeFile(const std::string& path, std::vector<unsigned char>& result){
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t fileSize = (size_t)file.tellg();
+    result.resize(fileSize);
+    file.seekg(0);
+    file.read((char*)result.data(), fileSize);
+    return file.good() || (fileSize == 0);
+}
+
+static uint64_t alignOffset(uint64_t offset, uint64_t alignment){
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool writeArchive(const PackSettings& settings, std::vector<PackEntry>& entries){
+    // Индекс отсортирован по хешу - записи одной корзины лежат подряд
+    std::sort(entries.begin(), entries.end(), [](const PackEntry& a, const PackEntry& b){
+        return a.entry.pathHash < b.entry.pathHash;
+    });
+    
+    AssetArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entriesCount = static_cast<uint32_t>(entries.size());
+    header.bucketBits = getAssetArchiveBucketBits(header.entriesCount);
+    
+    uint32_t bucketsCount = 1u << header.bucketBits;
+    std::vector<uint32_t> buckets(bucketsCount + 1, 0);
+    for (const PackEntry& entry: entries) {
+        buckets[getAssetArchiveBucket(entry.entry.pathHash, header.bucketBits) + 1]++;
+    }
+    for (uint32_t i = 0; i < bucketsCount; i++) {
+        buckets[i + 1] += buckets[i];
+    }
+    
+    std::string names;
+    for (PackEntry& entry: entries) {
+        entry.entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.entry.nameSize = static_cast<uint32_t>(entry.path.size());
+        names += entry.path;
+    }
+    
+    header.bucketsOffset = sizeof(AssetArchiveHeader);
+    header.entriesOffset = alignOffset(header.bucketsOffset + buckets.size() * sizeof(uint32_t), sizeof(uint64_t));
+    header.namesOffset = header.entriesOffset + entries.size() * sizeof(AssetArchiveEntry);
+    header.namesSize = names.size();
+    
+    uint64_t offset = alignOffset(header.namesOffset + header.namesSize, ASSET_ARCHIVE_ALIGNMENT);
+    for (PackEntry& entry: entries) {
+        entry.entry.offset = offset;
+        offset = alignOffset(offset + entry.entry.storedSize, ASSET_ARCHIVE_ALIGNMENT);
+    }
+    
+    std::ofstream file(settings.outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<char> padding(ASSET_ARCHIVE_ALIGNMENT, 0);
+    uint64_t position = 0;
+    auto writeBytes = [&file, &position](const void* data, size_t size){
+        file.write((const char*)data, size);
+        position += size;
+    };
+    auto writePadding = [&padding, &position, &writeBytes](uint64_t targetOffset){
+        writeBytes(padding.data(), static_cast<size_t>(targetOffset - position));
+    };
+    
+    writeBytes(&header, sizeof(header));
+    writeBytes(buckets.data(), buckets.size() * sizeof(uint32_t));
+    writePadding(header.entriesOffset);
+    for (const PackEntry& entry: entries) {
+        writeBytes(&entry.entry, sizeof(AssetArchiveEntry));
+    }
+    writeBytes(names.data(), names.size());
+    for (const PackEntry& entry: entries) {
+        writePadding(entry.entry.offset);
+        writeBytes(entry.data.data(), entry.data.size());
+    }
+    return file.good();
+}
+
+int main(int argc, char** argv){
+    PackSettings settings;
+    std::vector<std::string> inputs;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((arg == "-o") && hasValue) {
+            settings.outputPath = argv[++i];
+        } else if (arg == "--lz4") {
+            settings.lz4 = true;
+        } else if ((arg == "--min-ratio") && hasValue) {
+            settings.minRatio = atof(argv[++i]);
+        } else if ((arg == "--ext") && hasValue) {
+            std::string list = argv[++i];
+            size_t begin = 0;
+            while (begin <= list.size()) {
+                size_t end = list.find(',', begin);
+                if (end == std::string::npos) {
+                    end = list.size();
+                }
+                if (end > begin) {
+                    settings.extensions.push_back(list.substr(begin, end - begin));
+                }
+                begin = end + 1;
+            }
+        } else if ((arg.empty() == false) && (arg[0] == '-')) {
+            printUsage();
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    std::vector<std::string> files;
+    for (const std::string& input: inputs) {
+        collectFiles(input, files);
+    }
+    
+    std::vector<PackEntry> entries;
+    std::set<std::string> packedPaths;
+    uint64_t inputBytes = 0;
+    uint64_t storedBytes = 0;
+    int compressedCount = 0;
+    for (const std::string& filePath: files) {
+        if (hasAnyExtension(filePath, settings.extensions) == false) {
+            continue;
+        }
+        
+        PackEntry entry;
+        entry.path = normalizeAssetPath(filePath);
+        // Одинаковые пути при пересекающихся входах кладем один раз
+        if (packedPaths.insert(entry.path).second == false) {
+            continue;
+        }
+        if (readWholeFile(filePath, entry.data) == false) {
+            printf("Failed to read %s\n", filePath.c_str());
+            return 1;
+        }
+        memset(&entry.entry, 0, sizeof(AssetArchiveEntry));
+        entry.entry.pathHash = hashAssetPath(entry.path);
+        entry.entry.size = entry.data.size();
+        entry.entry.compression = ASSET_ARCHIVE_COMPRESSION_NONE;
+        
+        if (settings.lz4 && (entry.data.empty() == false)) {
+            std::vector<unsigned char> compressed(getLZ4CompressBound(entry.data.size()));
+            size_t compressedSize = compressLZ4Block(entry.data.data(), entry.data.size(), compressed.data(), compressed.size());
+            if ((compressedSize > 0) && (double(compressedSize) <= double(entry.data.size()) * settings.minRatio)) {
+                compressed.resize(compressedSize);
+                entry.data.swap(compressed);
+                entry.entry.compression = ASSET_ARCHIVE_COMPRESSION_LZ4;
+                compressedCount++;
+            }
+        }
+        entry.entry.storedSize = entry.data.size();
+        
+        
+        printf("%s: %llu -> %llu bytes%s\n", entry.path.c_str(), (unsigned long long)entry.entry.size,
+               (unsigned long long)entry.entry.storedSize, (entry.entry.compression == ASSET_ARCHIVE_COMPRESSION_LZ4) ? " (lz4)" : "");
+        inputBytes += entry.entry.size;
+        storedBytes += entry.entry.storedSize;
+        entries.push_back(std::move(entry));
+    }
+    if (entries.empty()) {
+        printf("No files to pack\n");
+        return 1;
+    }
+    
+    if (writeArchive(settings, entries) == false) {
+        printf("Failed to write %s\n", settings.outputPath.c_str());
+        return 1;
+    }
+    printf("Packed %d files (%d compressed) into %s: %.1f MB -> %.1f MB of data\n",
+           (int)entries.size(), compressedCount, settings.outputPath.c_str(),
+           double(inputBytes) / (1024.0 * 1024.0), double(storedBytes) / (1024.0 * 1024.0));
+    return 0;
+}
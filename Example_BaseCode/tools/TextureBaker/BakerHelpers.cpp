@@ -0,0 +1,110 @@
+#include "BakerHelpers.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+
+void parallelFor(size_t count, const std::function<void(size_t)>& func){
+    size_t threadsCount = std::min((size_t)std::max(std::thread::hardware_concurrency(), 1u), count);
+    if (threadsCount <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+    
+    // Задачи раздаются по одной - время кодирования блоков сильно разное
+    std::atomic<size_t> nextIndex(0);
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount);
+    for (size_t t = 0; t < threadsCount; t++) {
+        threads.push_back(std::thread([&nextIndex, count, &func](){
+            for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+                func(i);
+            }
+        }));
+    }
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+}
+
+uint64_t hashData(const void* data, size_t size, uint64_t hash){
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashString(const std::string& text, uint64_t hash){
+    return hashData(text.data(), text.size(), hash);
+}
+
+bool readWholeFile(const std::string& path, std::vector<unsigned char>& result){
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t fileSize = (size_t)file.tellg();
+    result.resize(fileSize);
+    file.seekg(0);
+    file.read((char*)result.data(), fileSize);
+    return true;
+}
+
+bool writeWholeFile(const std::string& path, const void* data, size_t size){
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write((const char*)data, size);
+    return file.good();
+}
+
+bool isFileExists(const std::string& path){
+    std::ifstream file(path, std::ios::binary);
+    return file.is_open();
+}
+
+std::string getFileStem(const std::string& path){
+    size_t slash = path.find_last_of("/\\");
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return (dot == std::string::npos) ? name : name.substr(0, dot);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+BakeCache::BakeCache(const std::string& path):
+    _path(path){
+    
+    std::ifstream file(path);
+    std::string outputPath;
+    std::string hashText;
+    while (file >> hashText >> outputPath) {
+        _hashes[outputPath] = strtoull(hashText.c_str(), nullptr, 16);
+    }
+}
+
+bool BakeCache::isUpToDate(const std::string& outputPath, uint64_t inputHash) const{
+    std::map<std::string, uint64_t>::const_iterator it = _hashes.find(outputPath);
+    return (it != _hashes.end()) && (it->second == inputHash) && isFileExists(outputPath);
+}
+
+void BakeCache::update(const std::string& outputPath, uint64_t inputHash){
+    _hashes[outputPath] = inputHash;
+}
+
+void BakeCache::save() const{
+    std::ofstream file(_path, std::ios::trunc);
+    for (const std::pair<const std::string, uint64_t>& it: _hashes) {
+        char hashText[32];
+        snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)it.second);
+        file << hashText << " " << it.first << "\n";
+    }
+}
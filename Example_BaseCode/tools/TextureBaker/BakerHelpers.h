@@ -0,0 +1,40 @@
+#ifndef BAKER_HELPERS_H
+#define BAKER_HELPERS_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+
+// Выполнение func(i) для i в [0, count) на всех ядрах, возврат после завершения всех задач
+void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+// FNV-1a 64, продолжает переданный хеш
+uint64_t hashData(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL);
+uint64_t hashString(const std::string& text, uint64_t hash = 14695981039346656037ULL);
+
+// Файлы целиком, readFile возвращает false если файла нет
+bool readWholeFile(const std::string& path, std::vector<unsigned char>& result);
+bool writeWholeFile(const std::string& path, const void* data, size_t size);
+bool isFileExists(const std::string& path);
+
+// Имя файла без пути и расширения
+std::string getFileStem(const std::string& path);
+
+// Хеши входов уже запеченных файлов: выходной путь -> хеш исходника и настроек.
+// Хранится текстом рядом с результатами, запекаются только изменившиеся входы
+class BakeCache {
+public:
+    BakeCache(const std::string& path);
+    bool isUpToDate(const std::string& outputPath, uint64_t inputHash) const;
+    void update(const std::string& outputPath, uint64_t inputHash);
+    void save() const;
+    
+private:
+    std::string _path;
+    std::map<std::string, uint64_t> _hashes;
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "BlockEncoder.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "BakerHelpers.h"
+
+
+// Главная ось облака текселей через степенной метод по матрице ковариации.
+// channels - 3 для RGB, 4 для RGBA
+static void findPrincipalAxis(const unsigned char* texels, int channels, float* mean, float* axis){
+    for (int c = 0; c < channels; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            mean[c] += texels[i * 4 + c];
+        }
+        mean[c] /= 16.0f;
+    }
+    
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        float diff[4];
+        for (int c = 0; c < channels; c++) {
+            diff[c] = texels[i * 4 + c] - mean[c];
+        }
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                covariance[a][b] += diff[a] * diff[b];
+            }
+        }
+    }
+    
+    for (int c = 0; c < channels; c++) {
+        axis[c] = 1.0f;
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        // Одноцветный блок - ось не важна
+        if (length < 1e-8f) {
+            break;
+        }
+        length = 1.0f / sqrtf(length);
+        for (int c = 0; c < channels; c++) {
+            axis[c] = next[c] * length;
+        }
+    }
+}
+
+// Концы отрезка по проекции текселей на ось
+static void findEndpoints(const unsigned char* texels, int channels, float* endpoint0, float* endpoint1){
+    float mean[4];
+    float axis[4];
+    findPrincipalAxis(texels, channels, mean, axis);
+    
+    float minT = 0.0f;
+    float maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (texels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < channels; c++) {
+        endpoint0[c] = std::min(std::max(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+        endpoint1[c] = std::min(std::max(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+    }
+}
+
+static int colorDistance(const int* a, const unsigned char* b, int channels){
+    int result = 0;
+    for (int c = 0; c < channels; c++) {
+        int diff = a[c] - b[c];
+        result += diff * diff;
+    }
+    return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint16_t packColor565(const float* color){
+    int r = std::min((int)(color[0] * 31.0f / 255.0f + 0.5f), 31);
+    int g = std::min((int)(color[1] * 63.0f / 255.0f + 0.5f), 63);
+    int b = std::min((int)(color[2] * 31.0f / 255.0f + 0.5f), 31);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackColor565(uint16_t color, int* result){
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    result[0] = (r << 3) | (r >> 2);
+    result[1] = (g << 2) | (g >> 4);
+    result[2] = (b << 3) | (b >> 2);
+}
+
+void encodeBC1Block(const unsigned char* texels, unsigned char* result){
+    float endpoint0[4];
+    float endpoint1[4];
+    findEndpoints(texels, 3, endpoint0, endpoint1);
+    
+    // c0 > c1 - четырехцветный режим без прозрачности
+    uint16_t color0 = packColor565(endpoint1);
+    uint16_t color1 = packColor565(endpoint0);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpackColor565(color0, palette[0]);
+        unpackColor565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+        
+        for (int i = 0; i < 16; i++) {
+            int bestIndex = 0;
+            int bestDistance = colorDistance(palette[0], texels + i * 4, 3);
+            for (int p = 1; p < 4; p++) {
+                int distance = colorDistance(palette[p], texels + i * 4, 3);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= (uint32_t)bestIndex << (i * 2);
+        }
+    }
+    
+    result[0] = color0 & 0xFF;
+    result[1] = color0 >> 8;
+    result[2] = color1 & 0xFF;
+    result[3] = color1 >> 8;
+    for (int i = 0; i < 4; i++) {
+        result[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const int BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Запись битов в 128 битный блок начиная с младших
+struct BC7BitWriter {
+    unsigned char* data;
+    uint32_t position;
+    
+    void write(uint32_t value, uint32_t bitsCount){
+        for (uint32_t i = 0; i < bitsCount; i++) {
+            uint32_t bit = position + i;
+            if ((value >> i) & 1) {
+                data[bit / 8] |= (unsigned char)(1 << (bit % 8));
+            }
+        }
+        position += bitsCount;
+    }
+};
+
+// Квантование конца отрезка в 7 бит + общий p-бит, p-бит подбирается по минимальной ошибке
+static void quantizeBC7Endpoint(const float* endpoint, uint32_t* quantized, uint32_t& pBit){
+    float bestError = 0.0f;
+    for (uint32_t p = 0; p < 2; p++) {
+        uint32_t values[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            int value = (int)floorf((endpoint[c] - float(p)) / 2.0f + 0.5f);
+            values[c] = (uint32_t)std::min(std::max(value, 0), 127);
+            float diff = float((values[c] << 1) | p) - endpoint[c];
+            error += diff * diff;
+        }
+        if ((p == 0) || (error < bestError)) {
+            bestError = error;
+            pBit = p;
+            memcpy(quantized, values, sizeof(values));
+        }
+    }
+}
+
+void encodeBC7Block(const unsigned char* texels, unsigned char* result){
+    float endpointsFloat[2][4];
+    findEndpoints(texels, 4, endpointsFloat[0], endpointsFloat[1]);
+    
+    uint32_t endpoints[2][4];
+    uint32_t pBits[2];
+    quantizeBC7Endpoint(endpointsFloat[0], endpoints[0], pBits[0]);
+    quantizeBC7Endpoint(endpointsFloat[1], endpoints[1], pBits[1]);
+    
+    int palette[16][4];
+    for (int c = 0; c < 4; c++) {
+        int value0 = (int)((endpoints[0][c] << 1) | pBits[0]);
+        int value1 = (int)((endpoints[1][c] << 1) | pBits[1]);
+        for (int i = 0; i < 16; i++) {
+            palette[i][c] = ((64 - BC7_WEIGHTS_4[i]) * value0 + BC7_WEIGHTS_4[i] * value1 + 32) >> 6;
+        }
+    }
+    
+    uint32_t indices[16];
+    for (int i = 0; i < 16; i++) {
+        int bestIndex = 0;
+        int bestDistance = colorDistance(palette[0], texels + i * 4, 4);
+        for (int p = 1; p < 16; p++) {
+            int distance = colorDistance(palette[p], texels + i * 4, 4);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                bestIndex = p;
+            }
+        }
+        indices[i] = (uint32_t)bestIndex;
+    }
+    
+    // У первого индекса старший бит не хранится и должен быть 0 - иначе меняем концы местами
+    if (indices[0] & 8) {
+        for (int c = 0; c < 4; c++) {
+            std::swap(endpoints[0][c], endpoints[1][c]);
+        }
+        std::swap(pBits[0], pBits[1]);
+        for (int i = 0; i < 16; i++) {
+            indices[i] = 15 - indices[i];
+        }
+    }
+    
+    memset(result, 0, 16);
+    BC7BitWriter writer = {result, 0};
+    writer.write(1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(endpoints[0][c], 7);
+        writer.write(endpoints[1][c], 7);
+    }
+    writer.write(pBits[0], 1);
+    writer.write(pBits[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        writer.write(indices[i], 4);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void encodeBlockImage(BakeBlockFormat format, const unsigned char* rgba, uint32_t width, uint32_t height, std::vector<unsigned char>& result){
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockBytes = (format == BAKE_BLOCK_FORMAT_BC1) ? 8 : 16;
+    result.resize((size_t)blocksX * blocksY * blockBytes);
+    
+    parallelFor(blocksY, [=, &result](size_t blockY){
+        unsigned char texels[16 * 4];
+        for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t srcY = std::min((uint32_t)blockY * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+                    memcpy(texels + (y * 4 + x) * 4, rgba + ((size_t)srcY * width + srcX) * 4, 4);
+                }
+            }
+            
+            unsigned char* block = result.data() + ((size_t)blockY * blocksX + blockX) * blockBytes;
+            if (format == BAKE_BLOCK_FORMAT_BC1) {
+                encodeBC1Block(texels, block);
+            } else {
+                encodeBC7Block(texels, block);
+            }
+        }
+    });
+}
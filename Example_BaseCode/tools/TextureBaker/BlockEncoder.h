@@ -0,0 +1,22 @@
+#ifndef BAKER_BLOCK_ENCODER_H
+#define BAKER_BLOCK_ENCODER_H
+
+#include <vector>
+#include <cstdint>
+
+
+enum BakeBlockFormat {
+    BAKE_BLOCK_FORMAT_BC1 = 0,     // 8 байт на блок 4x4, 4-цветный режим, альфа не сохраняется
+    BAKE_BLOCK_FORMAT_BC7 = 1      // 16 байт на блок 4x4, только режим 6 (RGBA 7.7.7.7 + p-бит, 4 бита на индекс)
+};
+
+// Кодирование одного блока 4x4 из 16 RGBA8 текселей.
+// Ошибка считается в том пространстве, в котором лежат байты (для sRGB - в гамма пространстве, как и семплирует железо)
+void encodeBC1Block(const unsigned char* texels, unsigned char* result);
+void encodeBC7Block(const unsigned char* texels, unsigned char* result);
+
+// Кодирование всей картинки RGBA8 по блокам, неполные блоки по краям дополняются повтором крайних текселей.
+// Строки блоков кодируются параллельно
+void encodeBlockImage(BakeBlockFormat format, const unsigned char* rgba, uint32_t width, uint32_t height, std::vector<unsigned char>& result);
+
+#endif
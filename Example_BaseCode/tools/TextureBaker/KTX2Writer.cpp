@@ -0,0 +1,167 @@
+#include "KTX2Writer.h"
+#include <cstdio>
+#include <cstring>
+#include "BakerHelpers.h"
+
+
+static const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const size_t KTX2_HEADER_SIZE = 80;
+static const size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+// Значения из Khronos Data Format Specification
+static const uint8_t KHR_DF_MODEL_RGBSDA = 1;
+static const uint8_t KHR_DF_MODEL_BC1A = 128;
+static const uint8_t KHR_DF_MODEL_BC7 = 134;
+static const uint8_t KHR_DF_MODEL_ASTC = 162;
+static const uint8_t KHR_DF_PRIMARIES_BT709 = 1;
+static const uint8_t KHR_DF_TRANSFER_LINEAR = 1;
+static const uint8_t KHR_DF_TRANSFER_SRGB = 2;
+static const uint8_t KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x80;
+static const uint8_t KHR_DF_CHANNEL_BC1A_ALPHAPRESENT = 1;
+static const uint8_t KHR_DF_CHANNEL_RGBSDA_ALPHA = 15;
+
+BakeLevel::BakeLevel():
+    width(0),
+    height(0){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void appendUint8(std::vector<unsigned char>& data, uint8_t value){
+    data.push_back(value);
+}
+
+static void appendUint16(std::vector<unsigned char>& data, uint16_t value){
+    appendUint8(data, value & 0xFF);
+    appendUint8(data, value >> 8);
+}
+
+static void appendUint32(std::vector<unsigned char>& data, uint32_t value){
+    appendUint16(data, value & 0xFFFF);
+    appendUint16(data, value >> 16);
+}
+
+static void appendUint64(std::vector<unsigned char>& data, uint64_t value){
+    appendUint32(data, (uint32_t)(value & 0xFFFFFFFF));
+    appendUint32(data, (uint32_t)(value >> 32));
+}
+
+static void writeUint32(std::vector<unsigned char>& data, size_t offset, uint32_t value){
+    for (size_t i = 0; i < 4; i++) {
+        data[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+static void writeUint64(std::vector<unsigned char>& data, size_t offset, uint64_t value){
+    writeUint32(data, offset, (uint32_t)(value & 0xFFFFFFFF));
+    writeUint32(data, offset + 4, (uint32_t)(value >> 32));
+}
+
+static void appendSample(std::vector<unsigned char>& data, uint16_t bitOffset, uint8_t bitLength, uint8_t channelType, uint32_t upper){
+    appendUint16(data, bitOffset);
+    appendUint8(data, bitLength - 1);
+    appendUint8(data, channelType);
+    appendUint32(data, 0);  // samplePosition
+    appendUint32(data, 0);  // sampleLower
+    appendUint32(data, upper);
+}
+
+// Базовый блок DFD для поддерживаемых форматов
+static std::vector<unsigned char> makeDataFormatDescriptor(BakeVkFormat format){
+    bool srgb = (format == BAKE_VK_FORMAT_R8G8B8A8_SRGB) ||
+                (format == BAKE_VK_FORMAT_BC1_RGBA_SRGB_BLOCK) ||
+                (format == BAKE_VK_FORMAT_BC7_SRGB_BLOCK) ||
+                (format == BAKE_VK_FORMAT_ASTC_4x4_SRGB_BLOCK);
+    bool uncompressed = (format == BAKE_VK_FORMAT_R8G8B8A8_UNORM) || (format == BAKE_VK_FORMAT_R8G8B8A8_SRGB);
+    
+    uint8_t colorModel = KHR_DF_MODEL_RGBSDA;
+    uint8_t blockBytes = 4;
+    if ((format == BAKE_VK_FORMAT_BC1_RGBA_UNORM_BLOCK) || (format == BAKE_VK_FORMAT_BC1_RGBA_SRGB_BLOCK)) {
+        colorModel = KHR_DF_MODEL_BC1A;
+        blockBytes = 8;
+    } else if ((format == BAKE_VK_FORMAT_BC7_UNORM_BLOCK) || (format == BAKE_VK_FORMAT_BC7_SRGB_BLOCK)) {
+        colorModel = KHR_DF_MODEL_BC7;
+        blockBytes = 16;
+    } else if ((format == BAKE_VK_FORMAT_ASTC_4x4_UNORM_BLOCK) || (format == BAKE_VK_FORMAT_ASTC_4x4_SRGB_BLOCK)) {
+        colorModel = KHR_DF_MODEL_ASTC;
+        blockBytes = 16;
+    }
+    
+    uint32_t samplesCount = uncompressed ? 4 : 1;
+    uint32_t blockSize = 24 + 16 * samplesCount;
+    
+    std::vector<unsigned char> data;
+    appendUint32(data, 4 + blockSize);                 // dfdTotalSize
+    appendUint32(data, 0);                             // vendorId, descriptorType
+    appendUint32(data, 2 | (blockSize << 16));         // versionNumber, descriptorBlockSize
+    appendUint8(data, colorModel);
+    appendUint8(data, KHR_DF_PRIMARIES_BT709);
+    appendUint8(data, srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR);
+    appendUint8(data, 0);                              // flags - альфа не умножена
+    for (int i = 0; i < 4; i++) {
+        appendUint8(data, (uncompressed || (i >= 2)) ? 0 : 3);  // Размер блока минус 1
+    }
+    appendUint8(data, blockBytes);
+    for (int i = 1; i < 8; i++) {
+        appendUint8(data, 0);
+    }
+    
+    if (uncompressed) {
+        for (uint8_t c = 0; c < 3; c++) {
+            appendSample(data, c * 8, 8, c, 255);
+        }
+        // Альфа не кодируется через sRGB
+        appendSample(data, 24, 8, KHR_DF_CHANNEL_RGBSDA_ALPHA | (srgb ? KHR_DF_SAMPLE_DATATYPE_LINEAR : 0), 255);
+    } else {
+        uint8_t channel = (colorModel == KHR_DF_MODEL_BC1A) ? KHR_DF_CHANNEL_BC1A_ALPHAPRESENT : 0;
+        appendSample(data, 0, blockBytes * 8, channel, 0xFFFFFFFF);
+    }
+    return data;
+}
+
+bool writeKTX2(const std::string& path, BakeVkFormat format, const std::vector<BakeLevel>& levels){
+    if (levels.empty()) {
+        return false;
+    }
+    
+    std::vector<unsigned char> dfd = makeDataFormatDescriptor(format);
+    bool uncompressed = (format == BAKE_VK_FORMAT_R8G8B8A8_UNORM) || (format == BAKE_VK_FORMAT_R8G8B8A8_SRGB);
+    size_t alignment = uncompressed ? 4 : ((format == BAKE_VK_FORMAT_BC1_RGBA_UNORM_BLOCK) || (format == BAKE_VK_FORMAT_BC1_RGBA_SRGB_BLOCK) ? 8 : 16);
+    
+    std::vector<unsigned char> file(KTX2_IDENTIFIER, KTX2_IDENTIFIER + sizeof(KTX2_IDENTIFIER));
+    appendUint32(file, format);
+    appendUint32(file, 1);                                 // typeSize
+    appendUint32(file, levels[0].width);
+    appendUint32(file, levels[0].height);
+    appendUint32(file, 0);                                 // pixelDepth
+    appendUint32(file, 0);                                 // layerCount
+    appendUint32(file, 1);                                 // faceCount
+    appendUint32(file, (uint32_t)levels.size());
+    appendUint32(file, 0);                                 // supercompressionScheme
+    
+    size_t dfdOffset = KTX2_HEADER_SIZE + levels.size() * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+    appendUint32(file, (uint32_t)dfdOffset);
+    appendUint32(file, (uint32_t)dfd.size());
+    appendUint32(file, 0);                                 // kvdByteOffset
+    appendUint32(file, 0);                                 // kvdByteLength
+    appendUint64(file, 0);                                 // sgdByteOffset
+    appendUint64(file, 0);                                 // sgdByteLength
+    
+    // Индекс уровней заполняется после раскладки данных
+    file.resize(dfdOffset, 0);
+    file.insert(file.end(), dfd.begin(), dfd.end());
+    
+    for (size_t i = levels.size(); i > 0; i--) {
+        const BakeLevel& level = levels[i - 1];
+        while (file.size() % alignment) {
+            file.push_back(0);
+        }
+        size_t entryOffset = KTX2_HEADER_SIZE + (i - 1) * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        writeUint64(file, entryOffset, file.size());
+        writeUint64(file, entryOffset + 8, level.data.size());
+        writeUint64(file, entryOffset + 16, level.data.size());
+        file.insert(file.end(), level.data.begin(), level.data.end());
+    }
+    
+    return writeWholeFile(path, file.data(), file.size());
+}
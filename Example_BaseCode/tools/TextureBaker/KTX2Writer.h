@@ -0,0 +1,34 @@
+#ifndef BAKER_KTX2_WRITER_H
+#define BAKER_KTX2_WRITER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+// Значения VkFormat, чтобы не тянуть заголовки Vulkan в утилиту
+enum BakeVkFormat {
+    BAKE_VK_FORMAT_R8G8B8A8_UNORM = 37,
+    BAKE_VK_FORMAT_R8G8B8A8_SRGB = 43,
+    BAKE_VK_FORMAT_BC1_RGBA_UNORM_BLOCK = 133,
+    BAKE_VK_FORMAT_BC1_RGBA_SRGB_BLOCK = 134,
+    BAKE_VK_FORMAT_BC7_UNORM_BLOCK = 145,
+    BAKE_VK_FORMAT_BC7_SRGB_BLOCK = 146,
+    BAKE_VK_FORMAT_ASTC_4x4_UNORM_BLOCK = 157,
+    BAKE_VK_FORMAT_ASTC_4x4_SRGB_BLOCK = 158
+};
+
+// Уровни мипмапов начиная с самого большого, данные уже в целевом формате
+struct BakeLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> data;
+    
+    BakeLevel();
+};
+
+// Запись 2D текстуры в KTX2 без суперкомпрессии: заголовок, индекс уровней, базовый Data Format Descriptor.
+// Уровни в файле лежат от самого маленького к самому большому, как рекомендует спецификация
+bool writeKTX2(const std::string& path, BakeVkFormat format, const std::vector<BakeLevel>& levels);
+
+#endif
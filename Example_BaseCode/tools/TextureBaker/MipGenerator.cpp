@@ -0,0 +1,138 @@
+#include "MipGenerator.h"
+#include <cmath>
+#include <algorithm>
+#include "BakerHelpers.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define BAKER_USE_SSE2 1
+#endif
+
+
+BakeImage::BakeImage():
+    width(0),
+    height(0){
+}
+
+BakeImage::BakeImage(uint32_t w, uint32_t h):
+    width(w),
+    height(h),
+    pixels((size_t)w * h * 4, 0.0f){
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static float srgbToLinear(float value){
+    if (value <= 0.04045f) {
+        return value / 12.92f;
+    }
+    return powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float value){
+    if (value <= 0.0031308f) {
+        return value * 12.92f;
+    }
+    return 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static unsigned char floatToByte(float value){
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    return (unsigned char)(value * 255.0f + 0.5f);
+}
+
+BakeImage makeBakeImage(const unsigned char* rgba, uint32_t width, uint32_t height, bool srgb){
+    // Таблица на все 256 значений, чтобы не считать pow на каждый пиксель
+    float colorTable[256];
+    float alphaTable[256];
+    for (int i = 0; i < 256; i++) {
+        alphaTable[i] = float(i) / 255.0f;
+        colorTable[i] = srgb ? srgbToLinear(alphaTable[i]) : alphaTable[i];
+    }
+    
+    BakeImage image(width, height);
+    size_t valuesCount = image.pixels.size();
+    for (size_t i = 0; i < valuesCount; i += 4) {
+        image.pixels[i + 0] = colorTable[rgba[i + 0]];
+        image.pixels[i + 1] = colorTable[rgba[i + 1]];
+        image.pixels[i + 2] = colorTable[rgba[i + 2]];
+        image.pixels[i + 3] = alphaTable[rgba[i + 3]];
+    }
+    return image;
+}
+
+void convertBakeImageToRGBA8(const BakeImage& image, bool srgb, std::vector<unsigned char>& result){
+    result.resize(image.pixels.size());
+    parallelFor(image.height, [&image, srgb, &result](size_t y){
+        size_t begin = y * image.width * 4;
+        size_t end = begin + image.width * 4;
+        for (size_t i = begin; i < end; i += 4) {
+            for (size_t c = 0; c < 3; c++) {
+                float value = image.pixels[i + c];
+                result[i + c] = floatToByte(srgb ? linearToSrgb(std::max(value, 0.0f)) : value);
+            }
+            result[i + 3] = floatToByte(image.pixels[i + 3]);
+        }
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Веса фильтра для текселей 2x-1, 2x, 2x+1, 2x+2
+static const float FILTER_WEIGHTS[4] = {1.0f / 8.0f, 3.0f / 8.0f, 3.0f / 8.0f, 1.0f / 8.0f};
+
+// dst += src * weight для строки RGBA пикселей
+static void accumulateRow(float* dst, const float* src, float weight, size_t valuesCount){
+    size_t i = 0;
+#ifdef BAKER_USE_SSE2
+    __m128 weightVec = _mm_set1_ps(weight);
+    for (; i + 4 <= valuesCount; i += 4) {
+        __m128 value = _mm_mul_ps(_mm_loadu_ps(src + i), weightVec);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), value));
+    }
+#endif
+    for (; i < valuesCount; i++) {
+        dst[i] += src[i] * weight;
+    }
+}
+
+static BakeImage downsample(const BakeImage& source){
+    uint32_t dstWidth = std::max(source.width / 2, 1u);
+    uint32_t dstHeight = std::max(source.height / 2, 1u);
+    
+    // Сначала по горизонтали во временную картинку, потом по вертикали
+    BakeImage horizontal(dstWidth, source.height);
+    parallelFor(source.height, [&source, &horizontal, dstWidth](size_t y){
+        const float* srcRow = source.pixels.data() + y * source.width * 4;
+        float* dstRow = horizontal.pixels.data() + y * dstWidth * 4;
+        for (int32_t x = 0; x < (int32_t)dstWidth; x++) {
+            float* dst = dstRow + x * 4;
+            for (int32_t tap = 0; tap < 4; tap++) {
+                int32_t srcX = std::min(std::max(x * 2 - 1 + tap, 0), (int32_t)source.width - 1);
+                accumulateRow(dst, srcRow + srcX * 4, FILTER_WEIGHTS[tap], 4);
+            }
+        }
+    });
+    
+    // Вертикальный проход - целые строки, поэтому SIMD работает на всю ширину
+    BakeImage result(dstWidth, dstHeight);
+    parallelFor(dstHeight, [&horizontal, &result, dstWidth](size_t y){
+        float* dstRow = result.pixels.data() + y * dstWidth * 4;
+        for (int32_t tap = 0; tap < 4; tap++) {
+            int32_t srcY = std::min(std::max((int32_t)y * 2 - 1 + tap, 0), (int32_t)horizontal.height - 1);
+            const float* srcRow = horizontal.pixels.data() + srcY * dstWidth * 4;
+            accumulateRow(dstRow, srcRow, FILTER_WEIGHTS[tap], dstWidth * 4);
+        }
+    });
+    
+    return result;
+}
+
+void generateMips(const BakeImage& source, std::vector<BakeImage>& result){
+    result.clear();
+    result.push_back(source);
+    while ((result.back().width > 1) || (result.back().height > 1)) {
+        BakeImage next = downsample(result.back());
+        result.push_back(std::move(next));
+    }
+}
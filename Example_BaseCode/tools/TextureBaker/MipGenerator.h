@@ -0,0 +1,28 @@
+#ifndef BAKER_MIP_GENERATOR_H
+#define BAKER_MIP_GENERATOR_H
+
+#include <vector>
+#include <cstdint>
+
+
+// Картинка RGBA float, для цветных данных хранится в линейном пространстве
+struct BakeImage {
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> pixels;
+    
+    BakeImage();
+    BakeImage(uint32_t w, uint32_t h);
+};
+
+// Перевод 8 бит RGBA в float, при srgb цвет переводится в линейное пространство, альфа всегда линейная
+BakeImage makeBakeImage(const unsigned char* rgba, uint32_t width, uint32_t height, bool srgb);
+// Обратный перевод в 8 бит с округлением
+void convertBakeImageToRGBA8(const BakeImage& image, bool srgb, std::vector<unsigned char>& result);
+
+// Полная цепочка мипмапов до 1x1 начиная с исходной картинки.
+// Уменьшение в 2 раза сепарабельным фильтром [1 3 3 1]/8 в линейном пространстве,
+// для нечетных размеров края зажимаются. Строки считаются параллельно
+void generateMips(const BakeImage& source, std::vector<BakeImage>& result);
+
+#endif
@@ -0,0 +1,263 @@
+// Офлайн запекание текстур в KTX2 для рантайма (VulkanTextureLoader):
+// мипмапы с гамма-корректной фильтрацией и сжатие в BC7/BC1/ASTC.
+// Запекаются только входы, у которых изменилось содержимое или настройки
+//
+// TextureBaker [-f bc7|bc1|astc|rgba8] [-linear] [-o outDir] [--astcenc path] input1.png input2.jpg ...
+//
+// Результат: <outDir>/<имя>_<формат>.ktx2, например chalet_bc7.ktx2
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "BakerHelpers.h"
+#include "MipGenerator.h"
+#include "BlockEncoder.h"
+#include "KTX2Writer.h"
+
+
+// Изменение алгоритмов запекания должно менять версию, чтобы старые результаты перезапеклись
+#define BAKER_VERSION "1"
+#define BAKE_CACHE_FILE_NAME ".texture_bake_cache"
+
+enum BakeTargetFormat {
+    BAKE_TARGET_BC7 = 0,
+    BAKE_TARGET_BC1,
+    BAKE_TARGET_ASTC,
+    BAKE_TARGET_RGBA8
+};
+
+struct BakeSettings {
+    BakeTargetFormat format;
+    bool linear;            // Данные не цветные (нормали, маски) - без sRGB
+    std::string outDir;
+    std::string astcencPath;
+    
+    BakeSettings():
+        format(BAKE_TARGET_BC7),
+        linear(false),
+        outDir("."),
+        astcencPath("astcenc"){
+    }
+};
+
+static const char* getFormatName(BakeTargetFormat format){
+    switch (format) {
+        case BAKE_TARGET_BC7: return "bc7";
+        case BAKE_TARGET_BC1: return "bc1";
+        case BAKE_TARGET_ASTC: return "astc";
+        case BAKE_TARGET_RGBA8: return "rgba8";
+    }
+    return "";
+}
+
+static BakeVkFormat getVkFormat(BakeTargetFormat format, bool srgb){
+    switch (format) {
+        case BAKE_TARGET_BC7: return srgb ? BAKE_VK_FORMAT_BC7_SRGB_BLOCK : BAKE_VK_FORMAT_BC7_UNORM_BLOCK;
+        case BAKE_TARGET_BC1: return srgb ? BAKE_VK_FORMAT_BC1_RGBA_SRGB_BLOCK : BAKE_VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case BAKE_TARGET_ASTC: return srgb ? BAKE_VK_FORMAT_ASTC_4x4_SRGB_BLOCK : BAKE_VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+        case BAKE_TARGET_RGBA8: return srgb ? BAKE_VK_FORMAT_R8G8B8A8_SRGB : BAKE_VK_FORMAT_R8G8B8A8_UNORM;
+    }
+    return BAKE_VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+static void printUsage(){
+    printf("Usage: TextureBaker [-f bc7|bc1|astc|rgba8] [-linear] [-o outDir] [--astcenc path] inputs...\n");
+    printf("    -f          target format, bc7 by default\n");
+    printf("    -linear     source is not a color data (normals, masks), no sRGB\n");
+    printf("    -o          output directory, current by default\n");
+    printf("    --astcenc   path to the ARM astcenc tool used for the astc format\n");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Несжатая TGA 32 бита, сверху вниз - вход для astcenc
+static bool writeTGA(const std::string& path, const std::vector<unsigned char>& rgba, uint32_t width, uint32_t height){
+    std::vector<unsigned char> file(18, 0);
+    file[2] = 2;                    // Несжатый truecolor
+    file[12] = width & 0xFF;
+    file[13] = (width >> 8) & 0xFF;
+    file[14] = height & 0xFF;
+    file[15] = (height >> 8) & 0xFF;
+    file[16] = 32;
+    file[17] = 0x28;                // 8 бит альфы, начало сверху слева
+    file.reserve(18 + rgba.size());
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        file.push_back(rgba[i + 2]);
+        file.push_back(rgba[i + 1]);
+        file.push_back(rgba[i + 0]);
+        file.push_back(rgba[i + 3]);
+    }
+    return writeWholeFile(path, file.data(), file.size());
+}
+
+// Кодирование уровня в ASTC 4x4 внешним astcenc, из результата берутся только блоки без 16 байт заголовка
+static bool encodeASTCLevel(const BakeSettings& settings, const std::string& tempName, const std::vector<unsigned char>& rgba,
+                            uint32_t width, uint32_t height, std::vector<unsigned char>& result){
+    std::string tgaPath = tempName + ".tga";
+    std::string astcPath = tempName + ".astc";
+    if (writeTGA(tgaPath, rgba, width, height) == false) {
+        printf("Failed to write temporary file %s\n", tgaPath.c_str());
+        return false;
+    }
+    
+    std::string command = "\"" + settings.astcencPath + "\" " + (settings.linear ? "-cl" : "-cs") +
+                          " \"" + tgaPath + "\" \"" + astcPath + "\" 4x4 -medium -silent";
+    int status = system(command.c_str());
+    
+    std::vector<unsigned char> astcFile;
+    bool loaded = (status == 0) && readWholeFile(astcPath, astcFile);
+    remove(tgaPath.c_str());
+    remove(astcPath.c_str());
+    
+    const unsigned char magic[4] = {0x13, 0xAB, 0xA1, 0x5C};
+    size_t blocksSize = (size_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+    if ((loaded == false) || (astcFile.size() != 16 + blocksSize) || (memcmp(astcFile.data(), magic, 4) != 0)) {
+        printf("Failed to encode ASTC with '%s'\n", command.c_str());
+        return false;
+    }
+    result.assign(astcFile.begin() + 16, astcFile.end());
+    return true;
+}
+
+static bool bakeTexture(const BakeSettings& settings, const std::string& inputPath, const std::vector<unsigned char>& inputBytes, const std::string& outputPath){
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(inputBytes.data(), (int)inputBytes.size(), &width, &height, &channels, STBI_rgb_alpha);
+    if (pixels == nullptr) {
+        printf("Failed to load image %s: %s\n", inputPath.c_str(), stbi_failure_reason());
+        return false;
+    }
+    
+    bool srgb = (settings.linear == false);
+    BakeImage source = makeBakeImage(pixels, (uint32_t)width, (uint32_t)height, srgb);
+    stbi_image_free(pixels);
+    
+    std::vector<BakeImage> mips;
+    generateMips(source, mips);
+    
+    std::vector<BakeLevel> levels(mips.size());
+    for (size_t i = 0; i < mips.size(); i++) {
+        BakeLevel& level = levels[i];
+        level.width = mips[i].width;
+        level.height = mips[i].height;
+        
+        // Кодировщики работают с байтами в пространстве хранения
+        std::vector<unsigned char> rgba;
+        convertBakeImageToRGBA8(mips[i], srgb, rgba);
+        
+        switch (settings.format) {
+            case BAKE_TARGET_BC7:
+                encodeBlockImage(BAKE_BLOCK_FORMAT_BC7, rgba.data(), level.width, level.height, level.data);
+                break;
+            case BAKE_TARGET_BC1:
+                encodeBlockImage(BAKE_BLOCK_FORMAT_BC1, rgba.data(), level.width, level.height, level.data);
+                break;
+            case BAKE_TARGET_ASTC:
+                if (encodeASTCLevel(settings, outputPath + ".mip" + std::to_string(i), rgba, level.width, level.height, level.data) == false) {
+                    return false;
+                }
+                break;
+            case BAKE_TARGET_RGBA8:
+                level.data.swap(rgba);
+                break;
+        }
+    }
+    
+    if (writeKTX2(outputPath, getVkFormat(settings.format, srgb), levels) == false) {
+        printf("Failed to write %s\n", outputPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv){
+    BakeSettings settings;
+    std::vector<std::string> inputs;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((arg == "-f") && hasValue) {
+            std::string format = argv[++i];
+            if (format == "bc7") {
+                settings.format = BAKE_TARGET_BC7;
+            } else if (format == "bc1") {
+                settings.format = BAKE_TARGET_BC1;
+            } else if (format == "astc") {
+                settings.format = BAKE_TARGET_ASTC;
+            } else if (format == "rgba8") {
+                settings.format = BAKE_TARGET_RGBA8;
+            } else {
+                printf("Unknown format %s\n", format.c_str());
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "-linear") {
+            settings.linear = true;
+        } else if ((arg == "-o") && hasValue) {
+            settings.outDir = argv[++i];
+        } else if ((arg == "--astcenc") && hasValue) {
+            settings.astcencPath = argv[++i];
+        } else if ((arg.empty() == false) && (arg[0] == '-')) {
+            printUsage();
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    // Хеш настроек общий для всех входов
+    std::string settingsText = std::string(BAKER_VERSION) + getFormatName(settings.format) + (settings.linear ? "linear" : "srgb");
+    uint64_t settingsHash = hashString(settingsText);
+    
+    BakeCache cache(settings.outDir + "/" + BAKE_CACHE_FILE_NAME);
+    int bakedCount = 0;
+    int skippedCount = 0;
+    int failedCount = 0;
+    
+    for (const std::string& inputPath: inputs) {
+        std::vector<unsigned char> inputBytes;
+        if (readWholeFile(inputPath, inputBytes) == false) {
+            printf("Failed to read %s\n", inputPath.c_str());
+            failedCount++;
+            continue;
+        }
+        
+        std::string outputPath = settings.outDir + "/" + getFileStem(inputPath) + "_" + getFormatName(settings.format) + ".ktx2";
+        uint64_t inputHash = hashData(inputBytes.data(), inputBytes.size(), settingsHash);
+        if (cache.isUpToDate(outputPath, inputHash)) {
+            skippedCount++;
+            continue;
+        }
+        
+        std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+        if (bakeTexture(settings, inputPath, inputBytes, outputPath) == false) {
+            failedCount++;
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+        printf("Baked %s -> %s (%.2f sec)\n", inputPath.c_str(), outputPath.c_str(), seconds);
+        
+        // Сохраняем после каждого файла, чтобы прерванный запуск не терял готовые результаты
+        cache.update(outputPath, inputHash);
+        cache.save();
+        bakedCount++;
+    }
+    
+    printf("Textures baked: %d, up to date: %d, failed: %d\n", bakedCount, skippedCount, failedCount);
+    return (failedCount > 0) ? 1 : 0;
+}
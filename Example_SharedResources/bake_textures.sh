@@ -0,0 +1,16 @@
+#! /usr/bin/env bash
+
+# Запекание общих текстур в KTX2 для всех вариантов, которые пробует Example_3 (chalet_bc7.ktx2, chalet_astc.ktx2, ...)
+# Использование: ./bake_textures.sh <путь к TextureBaker> [путь к astcenc]
+# Повторный запуск перезапекает только изменившиеся текстуры
+
+BAKER=${1:-TextureBaker}
+ASTCENC=${2:-astcenc}
+
+cd "$(dirname "$0")/textures"
+
+"$BAKER" -f bc7 -o . chalet.jpg wall.png
+"$BAKER" -f bc1 -o . chalet.jpg wall.png
+if command -v "$ASTCENC" > /dev/null; then
+	"$BAKER" -f astc --astcenc "$ASTCENC" -o . chalet.jpg wall.png
+fi